@@ -9,10 +9,15 @@
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkScalar.h"
 #include "include/core/SkShader.h"
 #include "include/core/SkString.h"
+#include "include/core/SkSurfaceProps.h"
+#include "include/core/SkTileMode.h"
 #include "include/effects/SkImageFilters.h"
 #include "src/base/SkRandom.h"
+#include "src/core/SkBlurEngine.h"
+#include "src/core/SkSpecialImage.h"
 
 #define FILTER_WIDTH_SMALL  32
 #define FILTER_HEIGHT_SMALL 32
@@ -161,3 +166,54 @@ DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, tr
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_LARGE, BLUR_SIGMA_LARGE, false, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, true, true, true);)
 DEF_BENCH(return new BlurImageFilterBench(BLUR_SIGMA_HUGE, BLUR_SIGMA_HUGE, false, true, true);)
+
+// Blurs a large image with the raster blur engine directly, since the image filter cache would
+// answer all but the first draw of the benches above. The sigmas cover the range that the engine
+// uses successive box blurs for without rescaling.
+class RasterBlurEngineBench : public Benchmark {
+public:
+    explicit RasterBlurEngineBench(SkScalar sigma) : fSigma(sigma) {
+        fName.printf("raster_blur_engine_%.2f", sigma);
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    void onDelayedSetup() override {
+        SkBitmap bitmap;
+        bitmap.allocN32Pixels(1024, 1024);
+        SkRandom rand;
+        for (int y = 0; y < bitmap.height(); ++y) {
+            for (int x = 0; x < bitmap.width(); ++x) {
+                *bitmap.getAddr32(x, y) = rand.nextU() | 0xff000000;
+            }
+        }
+        fSource = SkSpecialImages::MakeFromRaster(SkIRect::MakeSize(bitmap.dimensions()), bitmap,
+                                                  SkSurfaceProps{});
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        const SkBlurEngine::Algorithm* algorithm = SkBlurEngine::GetRasterBlurEngine()
+                ->findAlgorithm({fSigma, fSigma}, kN32_SkColorType);
+        // Decal tiling, which every algorithm supports, so --disableRasterBoxBlur can compare.
+        const SkIRect srcRect = SkIRect::MakeSize(fSource->dimensions());
+        const SkIRect dstRect = srcRect.makeOutset(SkScalarCeilToInt(3 * fSigma),
+                                                   SkScalarCeilToInt(3 * fSigma));
+        for (int i = 0; i < loops; i++) {
+            algorithm->blur({fSigma, fSigma}, fSource, srcRect, SkTileMode::kDecal, dstRect);
+        }
+    }
+
+private:
+    SkString              fName;
+    SkScalar              fSigma;
+    sk_sp<SkSpecialImage> fSource;
+};
+
+DEF_BENCH(return new RasterBlurEngineBench(2.f);)
+DEF_BENCH(return new RasterBlurEngineBench(5.f);)
+DEF_BENCH(return new RasterBlurEngineBench(20.f);)
+DEF_BENCH(return new RasterBlurEngineBench(50.f);)
+DEF_BENCH(return new RasterBlurEngineBench(100.f);)
@@ -23,7 +23,8 @@
 enum class ImageMode {
     kShared, // 1. One shared image referenced by every rectangle
     kUnique, // 2. Unique image for every rectangle
-    kNone    // 3. No image, solid color shading per rectangle
+    kNone,   // 3. No image, solid color shading per rectangle
+    kColor   // 4. No image, one solid color shared by every rectangle
 };
 //   X
 enum class DrawMode {
@@ -41,7 +42,10 @@ enum class RectangleLayout {
 template<int kRectCount, RectangleLayout kLayout, ImageMode kImageMode, DrawMode kDrawMode>
 class BulkRectBench : public Benchmark {
 public:
-    static_assert(kImageMode == ImageMode::kNone || kDrawMode != DrawMode::kQuad,
+    inline static constexpr bool kSolidColor = kImageMode == ImageMode::kNone ||
+                                               kImageMode == ImageMode::kColor;
+
+    static_assert(kSolidColor || kDrawMode != DrawMode::kQuad,
                   "kQuad only supported for solid color draws");
 
     inline static constexpr int kWidth      = 1024;
@@ -49,10 +53,10 @@ public:
 
     // There will either be 0 images, 1 image, or 1 image per rect
     inline static constexpr int kImageCount = kImageMode == ImageMode::kShared ?
-            1 : (kImageMode == ImageMode::kNone ? 0 : kRectCount);
+            1 : (kSolidColor ? 0 : kRectCount);
 
     bool isSuitableFor(Backend backend) override {
-        if (kDrawMode == DrawMode::kBatch && kImageMode == ImageMode::kNone) {
+        if (kDrawMode == DrawMode::kBatch && kSolidColor) {
             // Currently the bulk color quad API is only available on
             // skgpu::ganesh::SurfaceDrawContext
             return backend == Backend::kGanesh;
@@ -79,8 +83,10 @@ protected:
             fName.append("_sharedimage");
         } else if (kImageMode == ImageMode::kUnique) {
             fName.append("_uniqueimages");
-        } else {
+        } else if (kImageMode == ImageMode::kNone) {
             fName.append("_solidcolor");
+        } else {
+            fName.append("_sharedcolor");
         }
         if (kDrawMode == DrawMode::kBatch) {
             fName.append("_batch");
@@ -91,8 +97,12 @@ protected:
         }
     }
 
+    const SkColor4f& color(int i) const {
+        return kImageMode == ImageMode::kColor ? fColors[0] : fColors[i];
+    }
+
     void drawImagesBatch(SkCanvas* canvas) const {
-        SkASSERT(kImageMode != ImageMode::kNone);
+        SkASSERT(!kSolidColor);
         SkASSERT(kDrawMode == DrawMode::kBatch);
 
         SkCanvas::ImageSetEntry batch[kRectCount];
@@ -114,7 +124,7 @@ protected:
     }
 
     void drawImagesRef(SkCanvas* canvas) const {
-        SkASSERT(kImageMode != ImageMode::kNone);
+        SkASSERT(!kSolidColor);
         SkASSERT(kDrawMode == DrawMode::kRef);
 
         SkPaint paint;
@@ -131,7 +141,7 @@ protected:
     }
 
     void drawSolidColorsBatch(SkCanvas* canvas) const {
-        SkASSERT(kImageMode == ImageMode::kNone);
+        SkASSERT(kSolidColor);
         SkASSERT(kDrawMode == DrawMode::kBatch);
 
         auto context = canvas->recordingContext();
@@ -140,7 +150,7 @@ protected:
         GrQuadSetEntry batch[kRectCount];
         for (int i = 0; i < kRectCount; ++i) {
             batch[i].fRect = fRects[i];
-            batch[i].fColor = fColors[i].premul();
+            batch[i].fColor = this->color(i).premul();
             batch[i].fLocalMatrix = SkMatrix::I();
             batch[i].fAAFlags = GrQuadAAFlags::kAll;
         }
@@ -158,18 +168,18 @@ protected:
     }
 
     void drawSolidColorsRef(SkCanvas* canvas) const {
-        SkASSERT(kImageMode == ImageMode::kNone);
+        SkASSERT(kSolidColor);
         SkASSERT(kDrawMode == DrawMode::kRef || kDrawMode == DrawMode::kQuad);
 
         SkPaint paint;
         paint.setAntiAlias(true);
         for (int i = 0; i < kRectCount; ++i) {
             if (kDrawMode == DrawMode::kRef) {
-                paint.setColor4f(fColors[i]);
+                paint.setColor4f(this->color(i));
                 canvas->drawRect(fRects[i], paint);
             } else {
                 canvas->experimental_DrawEdgeAAQuad(fRects[i], nullptr, SkCanvas::kAll_QuadAAFlags,
-                                                    fColors[i], SkBlendMode::kSrcOver);
+                                                    this->color(i), SkBlendMode::kSrcOver);
             }
         }
     }
@@ -246,7 +256,7 @@ protected:
 
     void onDraw(int loops, SkCanvas* canvas) override {
         for (int i = 0; i < loops; i++) {
-            if (kImageMode == ImageMode::kNone) {
+            if (kSolidColor) {
                 if (kDrawMode == DrawMode::kBatch) {
                     this->drawSolidColorsBatch(canvas);
                 } else {
@@ -280,7 +290,10 @@ protected:
     ADD_BENCH(n, layout, ImageMode::kUnique, DrawMode::kRef)                   \
     ADD_BENCH(n, layout, ImageMode::kNone,   DrawMode::kBatch)                 \
     ADD_BENCH(n, layout, ImageMode::kNone,   DrawMode::kRef)                   \
-    ADD_BENCH(n, layout, ImageMode::kNone,   DrawMode::kQuad)
+    ADD_BENCH(n, layout, ImageMode::kNone,   DrawMode::kQuad)                  \
+    ADD_BENCH(n, layout, ImageMode::kColor,  DrawMode::kBatch)                 \
+    ADD_BENCH(n, layout, ImageMode::kColor,  DrawMode::kRef)                   \
+    ADD_BENCH(n, layout, ImageMode::kColor,  DrawMode::kQuad)
 
 ADD_BENCH_FAMILY(1000,  RectangleLayout::kRandom)
 ADD_BENCH_FAMILY(1000,  RectangleLayout::kGrid)
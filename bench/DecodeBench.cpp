@@ -6,15 +6,21 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/codec/SkAndroidCodec.h"
+#include "include/codec/SkCodec.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkPicture.h"
 #include "include/core/SkPictureRecorder.h"
+#include "include/core/SkRect.h"
 #include "modules/skottie/include/Skottie.h"
 #include "tools/DecodeUtils.h"
 #include "tools/Resources.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <memory>
+
 class DecodeBench : public Benchmark {
 protected:
     DecodeBench(const char* name, const char* source)
@@ -58,6 +64,106 @@ private:
     using INHERITED = DecodeBench;
 };
 
+// Decodes a JPEG with SkCodec, on a pool of kThreads threads, or serially if kThreads is 0. JPEGs
+// with restart markers are decoded in bands concurrently.
+template <int kThreads>
+class ParallelJpegDecodeBench final : public DecodeBench {
+public:
+    ParallelJpegDecodeBench(const char* name, const char* source)
+        : INHERITED(name, source)
+    {}
+
+    void onDelayedSetup() override {
+        INHERITED::onDelayedSetup();
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(fData);
+        fBitmap.allocPixels(codec->getInfo());
+        if (kThreads > 0) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(kThreads);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkCodec::Options options;
+        options.fExecutor = fExecutor.get();
+        while (loops-- > 0) {
+            std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(fData);
+            SkAssertResult(codec->getPixels(fBitmap.info(), fBitmap.getPixels(),
+                                            fBitmap.rowBytes(), &options) == SkCodec::kSuccess);
+        }
+    }
+
+private:
+    SkBitmap                    fBitmap;
+    std::unique_ptr<SkExecutor> fExecutor;
+
+    using INHERITED = DecodeBench;
+};
+
+// Decodes a column of square tiles down the middle of an image, sampled by fSampleSize, with one
+// SkAndroidCodec, the way a viewer decodes the tiles of a zoomed in image.
+class TileDecodeBench final : public DecodeBench {
+public:
+    TileDecodeBench(const char* name, const char* source, int tileSize, int sampleSize)
+        : INHERITED(name, source)
+        , fTileSize(tileSize)
+        , fSampleSize(sampleSize)
+    {}
+
+    void onDelayedSetup() override {
+        INHERITED::onDelayedSetup();
+        fCodec = SkAndroidCodec::MakeFromData(fData);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        const SkISize dims = fCodec->getInfo().dimensions();
+        SkAndroidCodec::AndroidOptions options;
+        options.fSampleSize = fSampleSize;
+        while (loops-- > 0) {
+            for (int y = 0; y + fTileSize <= dims.height(); y += fTileSize) {
+                SkIRect tile = SkIRect::MakeXYWH(dims.width() / 2, y, fTileSize, fTileSize);
+                SkAssertResult(fCodec->getSupportedSubset(&tile));
+                options.fSubset = &tile;
+                SkBitmap bm;
+                bm.allocPixels(fCodec->getInfo().makeDimensions(
+                        fCodec->getSampledSubsetDimensions(fSampleSize, tile)));
+                SkAssertResult(fCodec->getAndroidPixels(bm.info(), bm.getPixels(), bm.rowBytes(),
+                                                        &options) == SkCodec::kSuccess);
+            }
+        }
+    }
+
+private:
+    const int                       fTileSize;
+    const int                       fSampleSize;
+    std::unique_ptr<SkAndroidCodec> fCodec;
+
+    using INHERITED = DecodeBench;
+};
+
+// Decodes a thumbnail at least fMinSize in both dimensions from a new SkAndroidCodec.
+class ThumbnailDecodeBench final : public DecodeBench {
+public:
+    ThumbnailDecodeBench(const char* name, const char* source, SkISize minSize)
+        : INHERITED(name, source)
+        , fMinSize(minSize)
+    {}
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            std::unique_ptr<SkAndroidCodec> codec = SkAndroidCodec::MakeFromData(fData);
+            SkBitmap bm;
+            bm.allocPixels(codec->getInfo().makeDimensions(
+                    codec->getThumbnailDimensions(fMinSize)));
+            SkAssertResult(codec->getThumbnailPixels(bm.info(), bm.getPixels(), bm.rowBytes()) ==
+                           SkCodec::kSuccess);
+        }
+    }
+
+private:
+    const SkISize fMinSize;
+
+    using INHERITED = DecodeBench;
+};
 
 class SkottieDecodeBench final : public DecodeBench {
 public:
@@ -241,3 +347,23 @@ DEF_BENCH(return new BitmapDecodeBench("png_small"    /*  32x  32*/, "images/man
 DEF_BENCH(return new BitmapDecodeBench("png_phonehub_connecting"   , "images/Connecting.png"));
 DEF_BENCH(return new BitmapDecodeBench("png_phonehub_generic_error", "images/Generic_Error.png"));
 DEF_BENCH(return new BitmapDecodeBench("png_phonehub_onboard"      , "images/Onboard.png"));
+
+// Thread scaling of JPEG decoding in bands, for a 3024x4032 image with a restart marker per row of
+// MCUs.
+DEF_BENCH(return new ParallelJpegDecodeBench<0>("jpeg_iphone", "images/iphone_13_pro.jpeg"));
+DEF_BENCH(return new ParallelJpegDecodeBench<1>("jpeg_iphone_mt1", "images/iphone_13_pro.jpeg"));
+DEF_BENCH(return new ParallelJpegDecodeBench<2>("jpeg_iphone_mt2", "images/iphone_13_pro.jpeg"));
+DEF_BENCH(return new ParallelJpegDecodeBench<4>("jpeg_iphone_mt4", "images/iphone_13_pro.jpeg"));
+DEF_BENCH(return new ParallelJpegDecodeBench<8>("jpeg_iphone_mt8", "images/iphone_13_pro.jpeg"));
+
+// Tiles of a 3024x4032 image with a restart marker per row of MCUs, and of a 512x512 one without
+// restart markers, which is re-encoded with them by its second tile that isn't at the top.
+DEF_BENCH(return new TileDecodeBench("jpeg_iphone_tiles", "images/iphone_13_pro.jpeg", 512, 1));
+DEF_BENCH(return new TileDecodeBench("jpeg_iphone_tiles_0.500",
+                                     "images/iphone_13_pro.jpeg", 512, 2));
+DEF_BENCH(return new TileDecodeBench("jpeg_mandrill_tiles",
+                                     "images/mandrill_512_q075.jpg", 128, 1));
+DEF_BENCH(return new ThumbnailDecodeBench("jpeg_iphone_thumbnail_256", "images/iphone_13_pro.jpeg",
+                                          {256, 256}));
+DEF_BENCH(return new ThumbnailDecodeBench("jpeg_iphone_thumbnail_1024",
+                                          "images/iphone_13_pro.jpeg", {1024, 1024}));
@@ -7,12 +7,15 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkStream.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
 #include "include/encode/SkWebpEncoder.h"
 #include "tools/DecodeUtils.h"
 
+#include <memory>
+
 // Like other Benchmark subclasses, Encoder benchmarks are run by:
 // nanobench --match ^Encode_
 //
@@ -82,6 +85,15 @@ static bool encode_png(SkWStream* dst,
     return SkPngEncoder::Encode(dst, src, opts);
 }
 
+// Encodes blocks of rows concurrently on a pool of kThreads threads.
+template <int kThreads>
+static bool encode_png_parallel(SkWStream* dst, const SkPixmap& src) {
+    static std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(kThreads);
+    SkPngEncoder::Options opts;
+    opts.fExecutor = executor.get();
+    return SkPngEncoder::Encode(dst, src, opts);
+}
+
 #define PNG(FLAG, ZLIBLEVEL) [](SkWStream* d, const SkPixmap& s) { \
            return encode_png(d, s, SkPngEncoder::FilterFlag::FLAG, ZLIBLEVEL); }
 
@@ -122,4 +134,15 @@ DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 6), "PNG_6n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 3), "PNG_3n"));
 DEF_BENCH(return new EncodeBench(srcs[1], PNG(kNone, 1), "PNG_1n"));
 
+// Thread scaling of parallel PNG encoding, to compare with PNG above.
+DEF_BENCH(return new EncodeBench(srcs[0], encode_png_parallel<1>, "PNG_mt1"));
+DEF_BENCH(return new EncodeBench(srcs[0], encode_png_parallel<2>, "PNG_mt2"));
+DEF_BENCH(return new EncodeBench(srcs[0], encode_png_parallel<4>, "PNG_mt4"));
+DEF_BENCH(return new EncodeBench(srcs[0], encode_png_parallel<8>, "PNG_mt8"));
+
+DEF_BENCH(return new EncodeBench(srcs[1], encode_png_parallel<1>, "PNG_mt1"));
+DEF_BENCH(return new EncodeBench(srcs[1], encode_png_parallel<2>, "PNG_mt2"));
+DEF_BENCH(return new EncodeBench(srcs[1], encode_png_parallel<4>, "PNG_mt4"));
+DEF_BENCH(return new EncodeBench(srcs[1], encode_png_parallel<8>, "PNG_mt8"));
+
 #undef PNG
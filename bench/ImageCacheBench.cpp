@@ -6,7 +6,12 @@
  */
 
 #include "bench/Benchmark.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkString.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <memory>
 
 namespace {
 static void* gGlobalAddress;
@@ -72,6 +77,55 @@ private:
     using INHERITED = Benchmark;
 };
 
+/**
+ *  Finds keys in the global cache from several threads at once, each thread in its own range of
+ *  keys. Most finds hit; every eighth key is added again instead, replacing its Rec.
+ */
+class ImageCacheMTBench : public Benchmark {
+    enum {
+        CACHE_COUNT = 500,
+        FINDS_PER_THREAD = 1000,
+    };
+public:
+    ImageCacheMTBench(int threads) : fThreads(threads) {
+        fName.printf("imagecache_mt_%d", threads);
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+        for (int i = 0; i < CACHE_COUNT * fThreads; ++i) {
+            SkResourceCache::Add(new TestRec(TestKey(i), i));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int loop = 0; loop < loops; ++loop) {
+            SkTaskGroup(*fExecutor).batch(fThreads, [&](int thread) {
+                for (int i = 0; i < FINDS_PER_THREAD; ++i) {
+                    TestKey key(thread * CACHE_COUNT + (i * 7 + loop) % CACHE_COUNT);
+                    if (i % 8 == 0 || !SkResourceCache::Find(key, TestRec::Visitor, nullptr)) {
+                        SkResourceCache::Add(new TestRec(key, key.fValue));
+                    }
+                }
+            });
+        }
+    }
+
+private:
+    int                         fThreads;
+    SkString                    fName;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new ImageCacheBench(); )
+
+DEF_BENCH( return new ImageCacheMTBench(1); )
+DEF_BENCH( return new ImageCacheMTBench(4); )
+DEF_BENCH( return new ImageCacheMTBench(16); )
@@ -7,13 +7,18 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkSurface.h"
 #include "include/gpu/ganesh/GrDirectContext.h"
+#include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/gpu/ganesh/GrDirectContextPriv.h"
 #include "src/gpu/ganesh/GrResourceCache.h"
 #include "tools/ToolUtils.h"
 
+#include <cstring>
+#include <memory>
 
 #include <utility>
 
@@ -268,3 +273,125 @@ private:
 
 DEF_BENCH( return new ImageCacheBudgetDynamicBench(ImageCacheBudgetDynamicBench::Mode::kPingPong); )
 DEF_BENCH( return new ImageCacheBudgetDynamicBench(ImageCacheBudgetDynamicBench::Mode::kFlipFlop); )
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+static void* gBudgetBenchNamespace;
+
+struct PixelsKey : public SkResourceCache::Key {
+    explicit PixelsKey(int index) : fIndex(index) {
+        this->init(&gBudgetBenchNamespace, 0, sizeof(fIndex));
+    }
+    int32_t fIndex;
+};
+
+struct PixelsRec : public SkResourceCache::Rec {
+    PixelsRec(const PixelsKey& key, size_t bytes)
+            : fKey(key), fPixels(new char[bytes]), fBytes(bytes) {
+        // Stands in for decoding the image.
+        memset(fPixels.get(), key.fIndex, bytes);
+    }
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this) + fBytes; }
+    const char* getCategory() const override { return "image-cache-budget-bench"; }
+
+    static bool Visitor(const SkResourceCache::Rec&, void*) { return true; }
+
+    PixelsKey               fKey;
+    std::unique_ptr<char[]> fPixels;
+    size_t                  fBytes;
+};
+}  // namespace
+
+/**
+ * The CPU counterpart of ImageCacheBudgetBench: several threads each draw frames of the same 100
+ * images from SkResourceCache, decoding and adding the images they miss, with a namespace budget
+ * that fits budgetSize of them. Compares LRU and frequency-aware eviction under contention.
+ */
+class ImageCacheBudgetMTBench : public Benchmark {
+public:
+    ImageCacheBudgetMTBench(int budgetSize, bool shuffle, SkResourceCache::Eviction eviction)
+            : fBudgetSize(budgetSize)
+            , fShuffle(shuffle)
+            , fEviction(eviction) {
+        float imagesOverBudget = float(kImagesToDraw) / budgetSize;
+        fName.printf("image_cache_budget_mt_%.0f%s_%s", imagesOverBudget * 100,
+                     (shuffle ? "_shuffle" : ""),
+                     eviction == SkResourceCache::Eviction::kLRU ? "lru" : "frequency");
+    }
+
+    bool isSuitableFor(Backend backend) override { return Backend::kNonRendering == backend; }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        fExecutor = SkExecutor::MakeFIFOThreadPool(kThreads);
+        fIndices.reset(new int[kThreads * kSimulatedFrames * kImagesToDraw]);
+        SkRandom random;
+        for (int frame = 0; frame < kThreads * kSimulatedFrames; ++frame) {
+            int* base = fIndices.get() + frame * kImagesToDraw;
+            for (int i = 0; i < kImagesToDraw; ++i) {
+                base[i] = i;
+            }
+            for (int i = 0; fShuffle && i < kImagesToDraw - 1; ++i) {
+                int other = random.nextULessThan(kImagesToDraw - i) + i;
+                using std::swap;
+                swap(base[i], base[other]);
+            }
+        }
+    }
+
+    void onPerCanvasPreDraw(SkCanvas*) override {
+        SkResourceCache::NamespaceOptions options;
+        options.fByteLimit = fBudgetSize * (sizeof(PixelsRec) + kImageBytes);
+        options.fEviction = fEviction;
+        SkResourceCache::SetNamespaceOptions(&gBudgetBenchNamespace, options);
+    }
+
+    void onPerCanvasPostDraw(SkCanvas*) override {
+        SkResourceCache::SetNamespaceOptions(&gBudgetBenchNamespace, {});
+        SkResourceCache::PurgeAll();
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; ++i) {
+            SkTaskGroup(*fExecutor).batch(kThreads, [&](int thread) {
+                const int* indices = fIndices.get() + thread * kSimulatedFrames * kImagesToDraw;
+                for (int j = 0; j < kSimulatedFrames * kImagesToDraw; ++j) {
+                    PixelsKey key(indices[j]);
+                    if (!SkResourceCache::Find(key, PixelsRec::Visitor, nullptr)) {
+                        SkResourceCache::Add(new PixelsRec(key, kImageBytes));
+                    }
+                }
+            });
+        }
+    }
+
+private:
+    inline static constexpr int kImagesToDraw = 100;
+    inline static constexpr int kSimulatedFrames = 5;
+    inline static constexpr int kThreads = 4;
+    inline static constexpr size_t kImageBytes = kS * kS * 4;
+
+    int                         fBudgetSize;
+    bool                        fShuffle;
+    SkResourceCache::Eviction   fEviction;
+    SkString                    fName;
+    std::unique_ptr<int[]>      fIndices;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
+DEF_BENCH( return new ImageCacheBudgetMTBench(90, false, SkResourceCache::Eviction::kLRU); )
+DEF_BENCH( return new ImageCacheBudgetMTBench(50, false, SkResourceCache::Eviction::kLRU); )
+DEF_BENCH( return new ImageCacheBudgetMTBench(90, true,  SkResourceCache::Eviction::kLRU); )
+DEF_BENCH( return new ImageCacheBudgetMTBench(50, true,  SkResourceCache::Eviction::kLRU); )
+
+DEF_BENCH( return new ImageCacheBudgetMTBench(90, false, SkResourceCache::Eviction::kFrequency); )
+DEF_BENCH( return new ImageCacheBudgetMTBench(50, false, SkResourceCache::Eviction::kFrequency); )
+DEF_BENCH( return new ImageCacheBudgetMTBench(90, true,  SkResourceCache::Eviction::kFrequency); )
+DEF_BENCH( return new ImageCacheBudgetMTBench(50, true,  SkResourceCache::Eviction::kFrequency); )
@@ -7,8 +7,13 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkColorFilter.h"
 #include "include/core/SkImage.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
 #include "include/effects/SkImageFilters.h"
+#include "src/base/SkRandom.h"
 #include "tools/DecodeUtils.h"
 #include "tools/Resources.h"
 
@@ -180,7 +185,63 @@ private:
     using INHERITED = Benchmark;
 };
 
+// Scrolls a view of a large picture, blurred and then used twice by a merge, by a few pixels each
+// frame. The DAG doesn't use the source, so on raster the tiles of its output that stay in view are
+// found in the image filter cache, and only those scrolled into view are filtered.
+class ImageFilterDAGScrollBench : public Benchmark {
+public:
+    ImageFilterDAGScrollBench() {}
+
+protected:
+    const char* onGetName() override {
+        return "image_filter_dag_scroll";
+    }
+
+    SkISize onGetSize() override { return {kViewSize, kViewSize}; }
+
+    void onDelayedSetup() override {
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(kViewSize, kContentHeight));
+        SkRandom rand;
+        for (int i = 0; i < 2000; ++i) {
+            SkPaint paint;
+            paint.setColor(rand.nextU() | 0xff000000);
+            paint.setAntiAlias(true);
+            canvas->drawCircle(rand.nextRangeF(0, kViewSize), rand.nextRangeF(0, kContentHeight),
+                               rand.nextRangeF(5, 40), paint);
+        }
+        sk_sp<SkImageFilter> blur = SkImageFilters::Blur(
+                8.0f, 8.0f, SkImageFilters::Picture(recorder.finishRecordingAsPicture()));
+        fPaint.setImageFilter(SkImageFilters::Merge(
+                SkImageFilters::Offset(10.0f, 10.0f, blur),
+                SkImageFilters::ColorFilter(
+                        SkColorFilters::Blend(0x80336699, SkBlendMode::kSrcIn), blur)));
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        const SkRect content = SkRect::MakeWH(kViewSize, kContentHeight);
+        for (int j = 0; j < loops; j++) {
+            fScroll = (fScroll + kScrollStep) % (kContentHeight - kViewSize);
+            canvas->save();
+            canvas->translate(0, -fScroll);
+            canvas->drawRect(content, fPaint);
+            canvas->restore();
+        }
+    }
+
+private:
+    static constexpr int kViewSize = 1024;
+    static constexpr int kContentHeight = 8192;
+    static constexpr int kScrollStep = 16;
+
+    SkPaint fPaint;
+    int     fScroll = 0;
+
+    using INHERITED = Benchmark;
+};
+
 DEF_BENCH(return new ImageFilterDAGBench;)
 DEF_BENCH(return new ImageMakeWithFilterDAGBench;)
 DEF_BENCH(return new ImageFilterDisplacedBlur;)
 DEF_BENCH(return new ImageFilterXfermodeIn;)
+DEF_BENCH(return new ImageFilterDAGScrollBench;)
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPicture.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkSerialProcs.h"
+#include "include/core/SkSurface.h"
+#include "include/encode/SkPngEncoder.h"
+#include "src/base/SkRandom.h"
+
+#include <string>
+
+// Loads a picture of a few thousand ops and some PNG images, by copying it out of its serialized
+// form with SkPicture::MakeFromData() or reading it in place with MakeFromMappedData(). With
+// draw, the loaded picture is also played back once, which decodes its images.
+class MappedPictureBench : public Benchmark {
+public:
+    MappedPictureBench(bool mapped, bool draw) : fMapped(mapped), fDraw(draw) {
+        fName = std::string("picture_load_") + (draw ? "draw_" : "") +
+                (mapped ? "mapped" : "copied");
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    void onDelayedSetup() override {
+        SkPictureRecorder rec;
+        SkCanvas* canvas = rec.beginRecording(SkRect::MakeWH(kSize, kSize));
+        SkRandom rand;
+        sk_sp<SkImage> images[4];
+        for (sk_sp<SkImage>& image : images) {
+            sk_sp<SkSurface> surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(64, 64));
+            surface->getCanvas()->clear(rand.nextU() | 0xFF000000);
+            surface->getCanvas()->drawCircle(32, 32, 20, SkPaint(SkColors::kBlue));
+            image = surface->makeImageSnapshot();
+        }
+        for (int i = 0; i < 3000; i++) {
+            SkPaint paint;
+            paint.setColor(rand.nextU() | 0xFF000000);
+            paint.setAntiAlias(rand.nextBool());
+            const SkRect r = SkRect::MakeXYWH(rand.nextRangeF(0, kSize), rand.nextRangeF(0, kSize),
+                                              rand.nextRangeF(1, 40), rand.nextRangeF(1, 40));
+            switch (i % 4) {
+                case 0: canvas->drawRect(r, paint); break;
+                case 1: canvas->drawOval(r, paint); break;
+                case 2: {
+                    SkPath path;
+                    path.moveTo(r.fLeft, r.fTop);
+                    path.quadTo(r.fRight, r.fTop, r.fRight, r.fBottom);
+                    path.lineTo(r.fLeft, r.fBottom);
+                    canvas->drawPath(path, paint);
+                    break;
+                }
+                case 3: canvas->drawImageRect(images[(i / 4) % 4], r, SkSamplingOptions()); break;
+            }
+        }
+        sk_sp<SkPicture> pic = rec.finishRecordingAsPicture();
+
+        SkSerialProcs procs;
+        procs.fImageProc = [](SkImage* img, void*) -> sk_sp<SkData> {
+            return SkPngEncoder::Encode(nullptr, img, {});
+        };
+        fData = fMapped ? pic->serializeForMapping(&procs) : pic->serialize(&procs);
+        fDst.allocN32Pixels(kSize, kSize);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            sk_sp<SkPicture> pic = fMapped ? SkPicture::MakeFromMappedData(fData)
+                                           : SkPicture::MakeFromData(fData.get());
+            if (fDraw) {
+                SkCanvas canvas(fDst);
+                canvas.drawPicture(pic);
+            }
+        }
+    }
+
+private:
+    static constexpr int kSize = 512;
+
+    bool          fMapped;
+    bool          fDraw;
+    std::string   fName;
+    sk_sp<SkData> fData;
+    SkBitmap      fDst;
+};
+
+DEF_BENCH(return new MappedPictureBench(/*mapped=*/false, /*draw=*/false);)
+DEF_BENCH(return new MappedPictureBench(/*mapped=*/true,  /*draw=*/false);)
+DEF_BENCH(return new MappedPictureBench(/*mapped=*/false, /*draw=*/true);)
+DEF_BENCH(return new MappedPictureBench(/*mapped=*/true,  /*draw=*/true);)
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "src/base/SkArenaAlloc.h"
+#include "src/core/SkRasterPipeline.h"
+#include "src/core/SkRasterPipelineOpContexts.h"
+#include "src/core/SkRasterPipelineOpList.h"
+
+#include <functional>
+#include <string>
+
+extern bool gUseRasterPipelineJIT;
+
+// Short lowp pipelines like those the blitters build, run through the interpreter or through
+// generated code. Each draw covers the same 256x64 area in 8 row-sized calls, so per-call setup
+// is included the way a blitter sees it.
+enum class Shape {
+    kCopy,           // load_8888, swap_rb, store_8888
+    kSolidCoverage,  // uniform_color, scale_u8, srcover_rgba_8888
+    kImageLerp,      // load_8888, load_8888_dst, srcover, lerp_u8, store_8888
+};
+
+static const char* shape_name(Shape s) {
+    switch (s) {
+        case Shape::kCopy:          return "Copy";
+        case Shape::kSolidCoverage: return "SolidCoverage";
+        case Shape::kImageLerp:     return "ImageLerp";
+        default:                    SkUNREACHABLE;
+    }
+}
+
+class RasterPipelineBench : public Benchmark {
+public:
+    RasterPipelineBench(Shape shape, bool jit) : fShape(shape), fJIT(jit) {
+        fName = std::string("RasterPipeline_") + shape_name(shape) + (jit ? "_jit" : "_interp");
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    void onDelayedSetup() override {
+        for (int i = 0; i < kWidth * kHeight; i++) {
+            fSrc[i] = 0x80402010 + i;
+            fDst[i] = 0xff204080 - i;
+            fCov[i] = (uint8_t)(i * 7);
+        }
+        fSrcCtx = {fSrc, kWidth};
+        fDstCtx = {fDst, kWidth};
+        fCovCtx = {fCov, kWidth};
+
+        using Op = SkRasterPipelineOp;
+        switch (fShape) {
+            case Shape::kCopy:
+                fPipeline.append(Op::load_8888, &fSrcCtx);
+                fPipeline.append(Op::swap_rb);
+                fPipeline.append(Op::store_8888, &fDstCtx);
+                break;
+            case Shape::kSolidCoverage: {
+                const float color[] = {0.1f, 0.2f, 0.3f, 0.5f};
+                fPipeline.appendConstantColor(&fAlloc, color);
+                fPipeline.append(Op::scale_u8, &fCovCtx);
+                fPipeline.append(Op::srcover_rgba_8888, &fDstCtx);
+                break;
+            }
+            case Shape::kImageLerp:
+                fPipeline.append(Op::load_8888, &fSrcCtx);
+                fPipeline.append(Op::load_8888_dst, &fDstCtx);
+                fPipeline.append(Op::srcover);
+                fPipeline.append(Op::lerp_u8, &fCovCtx);
+                fPipeline.append(Op::store_8888, &fDstCtx);
+                break;
+        }
+
+        const bool wasJIT = gUseRasterPipelineJIT;
+        gUseRasterPipelineJIT = fJIT;
+        fCompiled = fPipeline.compile();
+        gUseRasterPipelineJIT = wasJIT;
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            for (int y = 0; y < kHeight; y += kHeight / 8) {
+                fCompiled(0, y, kWidth, kHeight / 8);
+            }
+        }
+    }
+
+private:
+    static constexpr int kWidth  = 256;
+    static constexpr int kHeight = 64;
+
+    Shape       fShape;
+    bool        fJIT;
+    std::string fName;
+
+    SkSTArenaAlloc<256>        fAlloc;
+    SkRasterPipeline_<256>     fPipeline;
+    SkRasterPipeline_MemoryCtx fSrcCtx, fDstCtx, fCovCtx;
+    uint32_t fSrc[kWidth * kHeight];
+    uint32_t fDst[kWidth * kHeight];
+    uint8_t  fCov[kWidth * kHeight];
+
+    std::function<void(size_t, size_t, size_t, size_t)> fCompiled;
+};
+
+DEF_BENCH(return new RasterPipelineBench(Shape::kCopy,          /*jit=*/false);)
+DEF_BENCH(return new RasterPipelineBench(Shape::kCopy,          /*jit=*/true);)
+DEF_BENCH(return new RasterPipelineBench(Shape::kSolidCoverage, /*jit=*/false);)
+DEF_BENCH(return new RasterPipelineBench(Shape::kSolidCoverage, /*jit=*/true);)
+DEF_BENCH(return new RasterPipelineBench(Shape::kImageLerp,     /*jit=*/false);)
+DEF_BENCH(return new RasterPipelineBench(Shape::kImageLerp,     /*jit=*/true);)
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
+
+#include <string>
+
+extern bool gSkDisableBlitPipelineCache;
+
+// Many small solid-color draws into an F16 dst, which always blits with the raster pipeline
+// blitter. Every draw makes a new blitter, so this is dominated by building its blit pipeline,
+// which the blitter's cache of compiled constant-color pipelines skips.
+class RasterPipelineBlitterBench : public Benchmark {
+public:
+    RasterPipelineBlitterBench(bool aa, bool cached) : fAA(aa), fCached(cached) {
+        fName = std::string("RasterPipelineBlitter_solid") + (aa ? "_aa" : "_bw") +
+                (cached ? "_cached" : "_uncached");
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    void onDelayedSetup() override {
+        fBitmap.allocPixels(SkImageInfo::Make(256, 256, kRGBA_F16_SkColorType,
+                                              kPremul_SkAlphaType));
+        fBitmap.eraseColor(SK_ColorWHITE);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        const bool wasDisabled = gSkDisableBlitPipelineCache;
+        gSkDisableBlitPipelineCache = !fCached;
+
+        SkCanvas canvas(fBitmap);
+        SkPaint paint;
+        paint.setAntiAlias(fAA);
+        for (int i = 0; i < loops; i++) {
+            for (int j = 0; j < kDraws; j++) {
+                paint.setColor4f({(j & 7) / 7.0f, 0.5f, 1 - (j & 3) / 3.0f, 0.75f});
+                const float x = (j * 37) % 240,
+                            y = (j * 53) % 240;
+                canvas.drawRect(SkRect::MakeXYWH(x + 0.25f, y + 0.5f, 12.5f, 9.5f), paint);
+            }
+        }
+
+        gSkDisableBlitPipelineCache = wasDisabled;
+    }
+
+private:
+    static constexpr int kDraws = 100;
+
+    bool        fAA;
+    bool        fCached;
+    std::string fName;
+    SkBitmap    fBitmap;
+};
+
+DEF_BENCH(return new RasterPipelineBlitterBench(/*aa=*/false, /*cached=*/false);)
+DEF_BENCH(return new RasterPipelineBlitterBench(/*aa=*/false, /*cached=*/true);)
+DEF_BENCH(return new RasterPipelineBlitterBench(/*aa=*/true,  /*cached=*/false);)
+DEF_BENCH(return new RasterPipelineBlitterBench(/*aa=*/true,  /*cached=*/true);)
@@ -51,9 +51,11 @@ void RecordingBench::onDraw(int loops, SkCanvas*) {
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 #include "include/core/SkSerialProcs.h"
 
-DeserializePictureBench::DeserializePictureBench(const char* name, sk_sp<SkData> data)
+DeserializePictureBench::DeserializePictureBench(const char* name, sk_sp<SkData> data,
+                                                 bool mapped)
     : fName(name)
     , fEncodedPicture(std::move(data))
+    , fMapped(mapped)
 {}
 
 const char* DeserializePictureBench::onGetName() {
@@ -68,8 +70,20 @@ SkISize DeserializePictureBench::onGetSize() {
     return SkISize::Make(128, 128);
 }
 
+void DeserializePictureBench::onDelayedSetup() {
+    if (fMapped) {
+        if (sk_sp<SkPicture> pic = SkPicture::MakeFromData(fEncodedPicture.get())) {
+            fEncodedPicture = pic->serializeForMapping();
+        }
+    }
+}
+
 void DeserializePictureBench::onDraw(int loops, SkCanvas*) {
     for (int i = 0; i < loops; ++i) {
-        SkPicture::MakeFromData(fEncodedPicture.get());
+        if (fMapped) {
+            SkPicture::MakeFromMappedData(fEncodedPicture);
+        } else {
+            SkPicture::MakeFromData(fEncodedPicture.get());
+        }
     }
 }
@@ -40,19 +40,23 @@ private:
     using INHERITED = PictureCentricBench;
 };
 
+// If mapped, the picture is reserialized with serializeForMapping() and read back in place with
+// SkPicture::MakeFromMappedData().
 class DeserializePictureBench : public Benchmark {
 public:
-    DeserializePictureBench(const char* name, sk_sp<SkData> encodedPicture);
+    DeserializePictureBench(const char* name, sk_sp<SkData> encodedPicture, bool mapped = false);
 
 protected:
     const char* onGetName() override;
     bool isSuitableFor(Backend) override;
     SkISize onGetSize() override;
+    void onDelayedSetup() override;
     void onDraw(int loops, SkCanvas*) override;
 
 private:
     SkString      fName;
     sk_sp<SkData> fEncodedPicture;
+    bool          fMapped;
 
     using INHERITED = Benchmark;
 };
@@ -10,6 +10,7 @@
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColorSpace.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontMgr.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkTypeface.h"
@@ -22,6 +23,9 @@
 #include "tools/fonts/FontToolUtils.h"
 #include "tools/text/SkTextBlobTrace.h"
 
+#include <memory>
+#include <vector>
+
 using namespace skia_private;
 
 static void do_font_stuff(SkFont* font) {
@@ -117,10 +121,73 @@ private:
     SkString fName;
 };
 
+// Threads repeatedly look up a mix of a few hot strikes and many others, each time taking a few
+// glyphs, to see how lookups scale with the number of threads.
+class SkGlyphCacheMT : public Benchmark {
+public:
+    explicit SkGlyphCacheMT(int threads) : fThreads(threads) {
+        fName.printf("SkGlyphCacheMT_%dthreads", fThreads);
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == Backend::kNonRendering;
+    }
+
+    void onDelayedSetup() override {
+        SkFont font = ToolUtils::DefaultFont();
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        font.setSubpixel(true);
+        font.setTypeface(ToolUtils::CreatePortableTypeface("serif", SkFontStyle::Normal()));
+        for (int i = 0; i < kStrikeCount; i++) {
+            font.setSize(8 + i);
+            fSpecs.push_back(SkStrikeSpec::MakeMask(
+                    font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                    SkScalerContextFlags::kNone, SkMatrix::I()));
+            fGlyphs[i] = font.unicharToGlyph('a' + i % 26);
+        }
+        fExecutor = SkExecutor::MakeFIFOThreadPool(fThreads);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        // The same total work for each thread count.
+        constexpr int kLookups = 64 * 1024;
+        SkTaskGroup tg(*fExecutor);
+        for (int loop = 0; loop < loops; loop++) {
+            tg.batch(fThreads, [&](int thread) {
+                uint32_t x = thread * 0x9E3779B9;
+                for (int i = 0; i < kLookups / fThreads; i++) {
+                    x = x * 1664525 + 1013904223;
+                    // Three in four lookups are of one of four hot strikes.
+                    const int s = (x >> 28) < 12 ? (x >> 20) % 4 : (x >> 20) % kStrikeCount;
+                    SkBulkGlyphMetrics metrics{fSpecs[s]};
+                    const SkGlyphID glyph[] = {fGlyphs[s]};
+                    (void)metrics.glyphs(glyph);
+                }
+            });
+        }
+    }
+
+private:
+    static constexpr int kStrikeCount = 48;
+
+    const int                   fThreads;
+    SkString                    fName;
+    std::vector<SkStrikeSpec>   fSpecs;
+    SkGlyphID                   fGlyphs[kStrikeCount];
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
 DEF_BENCH( return new SkGlyphCacheBasic(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheBasic(32 * 1024 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(256 * 1024); )
 DEF_BENCH( return new SkGlyphCacheStressTest(32 * 1024 * 1024); )
+DEF_BENCH( return new SkGlyphCacheMT(1); )
+DEF_BENCH( return new SkGlyphCacheMT(4); )
+DEF_BENCH( return new SkGlyphCacheMT(16); )
+DEF_BENCH( return new SkGlyphCacheMT(64); )
 
 namespace {
 class DiscardableManager : public SkStrikeServer::DiscardableHandleManager,
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "bench/Benchmark.h"
+#include "bench/BigPath.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPathUtils.h"
+#include "include/core/SkSurfaceProps.h"
+#include "src/base/SkArenaAlloc.h"
+#include "src/core/SkBlitter.h"
+#include "src/core/SkRasterClip.h"
+#include "src/core/SkScan.h"
+
+#include <memory>
+#include <string>
+
+// Fills the BigPath corpus (a detailed map outline) with analytic AA or with sparse strips,
+// serially or with bands spread over a thread pool. The path is scaled to fit a square of the
+// given size, and either filled directly or first stroked, which multiplies its edge count.
+enum class Filler { kAAA, kSparseStrip, kSparseStripMT };
+
+static const char* filler_name(Filler f) {
+    switch (f) {
+        case Filler::kAAA:           return "aaa";
+        case Filler::kSparseStrip:   return "strips";
+        case Filler::kSparseStripMT: return "strips_mt";
+        default:                     SkUNREACHABLE;
+    }
+}
+
+class SparseStripBench : public Benchmark {
+public:
+    SparseStripBench(Filler filler, bool stroke, int size)
+            : fFiller(filler), fStroke(stroke), fSize(size) {
+        fName = std::string("sparse_strip_bigpath_") + (stroke ? "stroke_" : "fill_") +
+                std::to_string(size) + "_" + filler_name(filler);
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override { return backend == Backend::kNonRendering; }
+
+    void onDelayedSetup() override {
+        SkPath path = BenchUtils::make_big_path();
+        if (fStroke) {
+            SkPaint stroke;
+            stroke.setStyle(SkPaint::kStroke_Style);
+            stroke.setStrokeWidth(2);
+            SkPath stroked;
+            skpathutils::FillPathWithPaint(path, stroke, &stroked);
+            path = stroked;
+        }
+        fPath = path.makeTransform(SkMatrix::RectToRect(path.getBounds(),
+                                                        SkRect::MakeIWH(fSize, fSize),
+                                                        SkMatrix::kCenter_ScaleToFit));
+
+        fDst.allocN32Pixels(fSize, fSize);
+        fDst.eraseColor(SK_ColorWHITE);
+        SkPaint paint;
+        paint.setColor(0xff336699);
+        paint.setAntiAlias(true);
+        fBlitter = SkBlitter::Choose(fDst.pixmap(), SkMatrix::I(), paint, &fAlloc,
+                                     /*drawCoverage=*/false, /*clipShader=*/nullptr,
+                                     SkSurfaceProps());
+        fClip.setRect(SkIRect::MakeWH(fSize, fSize));
+
+        if (fFiller == Filler::kSparseStripMT) {
+            fExecutor = SkExecutor::MakeFIFOThreadPool(4);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            if (fFiller == Filler::kAAA) {
+                SkScan::AntiFillPath(fPath, fClip, fBlitter);
+            } else {
+                SkScan::SparseStripFillPath(fPath, fClip, fBlitter, fExecutor.get());
+            }
+        }
+    }
+
+private:
+    Filler      fFiller;
+    bool        fStroke;
+    int         fSize;
+    std::string fName;
+
+    SkPath                      fPath;
+    SkBitmap                    fDst;
+    SkSTArenaAlloc<2048>        fAlloc;
+    SkBlitter*                  fBlitter = nullptr;
+    SkRasterClip                fClip;
+    std::unique_ptr<SkExecutor> fExecutor;
+};
+
+DEF_BENCH(return new SparseStripBench(Filler::kAAA,           /*stroke=*/false, 512);)
+DEF_BENCH(return new SparseStripBench(Filler::kSparseStrip,   /*stroke=*/false, 512);)
+DEF_BENCH(return new SparseStripBench(Filler::kSparseStripMT, /*stroke=*/false, 512);)
+
+DEF_BENCH(return new SparseStripBench(Filler::kAAA,           /*stroke=*/false, 2048);)
+DEF_BENCH(return new SparseStripBench(Filler::kSparseStrip,   /*stroke=*/false, 2048);)
+DEF_BENCH(return new SparseStripBench(Filler::kSparseStripMT, /*stroke=*/false, 2048);)
+
+DEF_BENCH(return new SparseStripBench(Filler::kAAA,           /*stroke=*/true,  512);)
+DEF_BENCH(return new SparseStripBench(Filler::kSparseStrip,   /*stroke=*/true,  512);)
+DEF_BENCH(return new SparseStripBench(Filler::kSparseStripMT, /*stroke=*/true,  512);)
+
+DEF_BENCH(return new SparseStripBench(Filler::kAAA,           /*stroke=*/true,  2048);)
+DEF_BENCH(return new SparseStripBench(Filler::kSparseStrip,   /*stroke=*/true,  2048);)
+DEF_BENCH(return new SparseStripBench(Filler::kSparseStripMT, /*stroke=*/true,  2048);)
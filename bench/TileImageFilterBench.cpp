@@ -7,9 +7,13 @@
 
 #include "bench/Benchmark.h"
 #include "include/core/SkCanvas.h"
+#include "include/core/SkImage.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkSamplingOptions.h"
 #include "include/core/SkString.h"
 #include "include/effects/SkImageFilters.h"
+#include "tools/DecodeUtils.h"
+#include "tools/Resources.h"
 
 #define WIDTH 512
 #define HEIGHT 512
@@ -65,6 +69,45 @@ private:
     using INHERITED = Benchmark;
 };
 
+// Scrolls a view of a large area tiled with part of an image, by a few pixels each frame. The
+// filter doesn't use the source, so on raster the tiles of its output that stay in view are found
+// in the image filter cache, and only those scrolled into view are filtered.
+class TileImageFilterScrollBench : public Benchmark {
+protected:
+    const char* onGetName() override {
+        return "tile_image_filter_scroll";
+    }
+
+    SkISize onGetSize() override { return {kViewSize, kViewSize}; }
+
+    void onDelayedSetup() override {
+        sk_sp<SkImage> image = ToolUtils::GetResourceAsImage("images/mandrill_512.png");
+        fPaint.setImageFilter(SkImageFilters::Tile(
+                SkRect::MakeWH(50, 50), SkRect::MakeWH(kViewSize, kContentHeight),
+                SkImageFilters::Image(std::move(image), SkSamplingOptions(SkFilterMode::kLinear))));
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; i++) {
+            fScroll = (fScroll + kScrollStep) % (kContentHeight - kViewSize);
+            canvas->save();
+            canvas->translate(0, -fScroll);
+            canvas->drawRect(SkRect::MakeWH(kViewSize, kContentHeight), fPaint);
+            canvas->restore();
+        }
+    }
+
+private:
+    static constexpr int kViewSize = 1024;
+    static constexpr int kContentHeight = 8192;
+    static constexpr int kScrollStep = 16;
+
+    SkPaint fPaint;
+    int     fScroll = 0;
+    using INHERITED = Benchmark;
+};
+
 DEF_BENCH(return new TileImageFilterBench(0);)
 DEF_BENCH(return new TileImageFilterBench(32);)
 DEF_BENCH(return new TileImageFilterBench(64);)
+DEF_BENCH(return new TileImageFilterScrollBench;)
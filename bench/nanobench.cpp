@@ -28,6 +28,7 @@
 #include "include/core/SkBBHFactory.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkGraphics.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkString.h"
@@ -88,6 +89,12 @@
 
 extern bool gSkForceRasterPipelineBlitter;
 extern bool gForceHighPrecisionRasterPipeline;
+extern bool gUseRasterPipelineJIT;
+extern bool gSkUseSparseStripPathFill;
+extern bool gSkDisableFillBlitterCache;
+extern bool gSkDisableImageFilterTiles;
+extern bool gSkDisableRasterBoxBlur;
+extern bool gSkDisablePixelKernels;
 
 #ifndef SK_BUILD_FOR_WIN
 #include <unistd.h>
@@ -164,6 +171,12 @@ static DEFINE_string(benchType,  "",
 
 static DEFINE_bool(forceRasterPipeline, false, "sets gSkForceRasterPipelineBlitter");
 static DEFINE_bool(forceRasterPipelineHP, false, "sets gSkForceRasterPipelineBlitter and gForceHighPrecisionRasterPipeline");
+static DEFINE_bool(rasterPipelineJIT, false, "sets gUseRasterPipelineJIT");
+static DEFINE_bool(sparseStripPathFill, false, "sets gSkUseSparseStripPathFill");
+static DEFINE_bool(disableFillBlitterCache, false, "sets gSkDisableFillBlitterCache");
+static DEFINE_bool(disableImageFilterTiles, false, "sets gSkDisableImageFilterTiles");
+static DEFINE_bool(disableRasterBoxBlur, false, "sets gSkDisableRasterBoxBlur");
+static DEFINE_bool(disablePixelKernels, false, "sets gSkDisablePixelKernels");
 
 static DEFINE_bool2(pre_log, p, false,
                     "Log before running each test. May be incomprehensible when threading");
@@ -247,6 +260,28 @@ bool Target::capturePixels(SkBitmap* bmp) {
     return true;
 }
 
+// Draws into SkSurfaces::RasterTiled, rasterizing its tiles on the default SkExecutor. Comparing
+// this config against 8888 with different --threads counts shows the speedup from tiling.
+static constexpr char kTiledRasterConfig[] = "tiled8888";
+
+struct TiledRasterTarget : public Target {
+    explicit TiledRasterTarget(const Config& c) : Target(c) {}
+
+    bool init(SkImageInfo info, Benchmark*) override {
+        this->surface = SkSurfaces::RasterTiled(info, &SkExecutor::GetDefault());
+        return this->surface != nullptr;
+    }
+    void endTiming() override {
+        // The canvas only records; rasterize what was drawn while we're still timing.
+        SkPixmap pixmap;
+        this->surface->peekPixels(&pixmap);
+    }
+    bool capturePixels(SkBitmap* bmp) override {
+        bmp->allocPixels(this->surface->imageInfo());
+        return this->surface->readPixels(*bmp, 0, 0);
+    }
+};
+
 struct GPUTarget : public Target {
     explicit GPUTarget(const Config& c) : Target(c) {}
     ContextInfo contextInfo;
@@ -683,6 +718,7 @@ static std::optional<Config> create_config(const SkCommandLineConfig* config) {
     CPU_CONFIG("bgra",  Backend::kRaster,  kBGRA_8888_SkColorType, kPremul_SkAlphaType)
     CPU_CONFIG("f16",   Backend::kRaster,   kRGBA_F16_SkColorType, kPremul_SkAlphaType)
     CPU_CONFIG("srgba", Backend::kRaster, kSRGBA_8888_SkColorType, kPremul_SkAlphaType)
+    CPU_CONFIG(kTiledRasterConfig, Backend::kRaster, kN32_SkColorType, kPremul_SkAlphaType)
 
 #undef CPU_CONFIG
 
@@ -736,7 +772,11 @@ static Target* is_enabled(Benchmark* bench, const Config& config) {
         break;
 #endif
     default:
-        target = new Target(config);
+        if (config.name.equals(kTiledRasterConfig)) {
+            target = new TiledRasterTarget(config);
+        } else {
+            target = new Target(config);
+        }
         break;
     }
 
@@ -985,6 +1025,21 @@ public:
             return new DeserializePictureBench(name.c_str(), std::move(data));
         }
 
+        // And again, reading them in place as SkPicture::MakeFromMappedData() would.
+        while (fCurrentMappedPicture < fSKPs.size()) {
+            const SkString& path = fSKPs[fCurrentMappedPicture++];
+            sk_sp<SkData> data = SkData::MakeFromFileName(path.c_str());
+            if (!data) {
+                continue;
+            }
+            SkString name = SkOSPath::Basename(path.c_str());
+            fSourceType = "skp";
+            fBenchType  = "deserial_mapped";
+            fSKPBytes = static_cast<double>(data->size());
+            fSKPOps   = 0;
+            return new DeserializePictureBench(name.c_str(), std::move(data), /*mapped=*/true);
+        }
+
         // Then once each for each scale as SKPBenches (playback).
         while (fCurrentScale < fScales.size()) {
             while (fCurrentSKP < fSKPs.size()) {
@@ -1307,6 +1362,7 @@ private:
     const char* fBenchType;   // How we bench it: micro, recording, playback, ...
     int fCurrentRecording = 0;
     int fCurrentDeserialPicture = 0;
+    int fCurrentMappedPicture = 0;
     int fCurrentMSKP = 0;
     int fCurrentScale = 0;
     int fCurrentSKP = 0;
@@ -1456,6 +1512,12 @@ int main(int argc, char** argv) {
 
     gSkForceRasterPipelineBlitter     = FLAGS_forceRasterPipelineHP || FLAGS_forceRasterPipeline;
     gForceHighPrecisionRasterPipeline = FLAGS_forceRasterPipelineHP;
+    gUseRasterPipelineJIT             = FLAGS_rasterPipelineJIT;
+    gSkUseSparseStripPathFill         = FLAGS_sparseStripPathFill;
+    gSkDisableFillBlitterCache        = FLAGS_disableFillBlitterCache;
+    gSkDisableImageFilterTiles        = FLAGS_disableImageFilterTiles;
+    gSkDisableRasterBoxBlur           = FLAGS_disableRasterBoxBlur;
+    gSkDisablePixelKernels            = FLAGS_disablePixelKernels;
 
     // The SkSL memory benchmark must run before any GPU painting occurs. SkSL allocates memory for
     // its modules the first time they are accessed, and this test is trying to measure the size of
@@ -83,6 +83,9 @@ using namespace skia_private;
 
 extern bool gSkForceRasterPipelineBlitter;
 extern bool gForceHighPrecisionRasterPipeline;
+extern bool gUseRasterPipelineJIT;
+extern bool gSkUseSparseStripPathFill;
+extern bool gSkDisableFillBlitterCache;
 extern bool gCreateProtectedContext;
 
 static DEFINE_string(src, "tests gm skp mskp lottie rive svg image colorImage",
@@ -118,6 +121,9 @@ static DEFINE_int(shard,  0, "Which shard do I run?");
 static DEFINE_string(mskps, "", "Directory to read mskps from, or a single mskp file.");
 static DEFINE_bool(forceRasterPipeline, false, "sets gSkForceRasterPipelineBlitter");
 static DEFINE_bool(forceRasterPipelineHP, false, "sets gSkForceRasterPipelineBlitter and gForceHighPrecisionRasterPipeline");
+static DEFINE_bool(rasterPipelineJIT, false, "sets gUseRasterPipelineJIT");
+static DEFINE_bool(sparseStripPathFill, false, "sets gSkUseSparseStripPathFill");
+static DEFINE_bool(disableFillBlitterCache, false, "sets gSkDisableFillBlitterCache");
 static DEFINE_bool(createProtected, false, "attempts to create a protected backend context");
 
 static DEFINE_string(bisect, "",
@@ -1590,6 +1596,9 @@ int main(int argc, char** argv) {
 
     gSkForceRasterPipelineBlitter     = FLAGS_forceRasterPipelineHP || FLAGS_forceRasterPipeline;
     gForceHighPrecisionRasterPipeline = FLAGS_forceRasterPipelineHP;
+    gUseRasterPipelineJIT             = FLAGS_rasterPipelineJIT;
+    gSkUseSparseStripPathFill         = FLAGS_sparseStripPathFill;
+    gSkDisableFillBlitterCache        = FLAGS_disableFillBlitterCache;
     gCreateProtectedContext           = FLAGS_createProtected;
 
     // The bots like having a verbose.log to upload, so always touch the file even if --verbose.
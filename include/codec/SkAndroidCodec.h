@@ -257,6 +257,27 @@ public:
      */
     SkCodec::Result getAndroidPixels(const SkImageInfo& info, void* pixels, size_t rowBytes);
 
+    /**
+     *  Returns dimensions, at least |minSize| in both directions, that getThumbnailPixels() can
+     *  quickly decode the whole image to. If the image is no larger than |minSize|, returns its
+     *  dimensions.
+     *
+     *  If the underlying codec can scale while decoding (e.g. a JPEG by 1/8 to 7/8, in the DCT
+     *  domain), these are the smallest dimensions it can scale to, since that decodes faster and
+     *  is better filtered than sampling. The image is only sampled to get smaller than that.
+     */
+    SkISize getThumbnailDimensions(SkISize minSize) const;
+
+    /**
+     *  Decodes the whole image, downscaled to the dimensions of |info|, which must have come from
+     *  getThumbnailDimensions(). |options| may not specify a subset, and its fSampleSize is
+     *  ignored.
+     *
+     *  @return Result kSuccess, or another value explaining the type of failure.
+     */
+    SkCodec::Result getThumbnailPixels(const SkImageInfo& info, void* pixels, size_t rowBytes,
+                                       const AndroidOptions* options = nullptr);
+
     SkCodec::Result getPixels(const SkImageInfo& info, void* pixels, size_t rowBytes) {
         return this->getAndroidPixels(info, pixels, rowBytes);
     }
@@ -30,6 +30,7 @@
 #include <vector>
 
 class SkData;
+class SkExecutor;
 class SkFrameHolder;
 class SkImage;
 class SkPngChunkReader;
@@ -334,6 +335,7 @@ public:
             , fSubset(nullptr)
             , fFrameIndex(0)
             , fPriorFrame(kNoFrame)
+            , fExecutor(nullptr)
         {}
 
         ZeroInitialized            fZeroInitialized;
@@ -377,6 +379,16 @@ public:
          *  If set to kNoFrame, the codec will decode any necessary required frame(s) first.
          */
         int                        fPriorFrame;
+
+        /**
+         *  If not NULL, getPixels() may use this to decode parts of the image
+         *  concurrently, returning once they are all done.
+         *
+         *  Currently only used by JPEG, for large baseline images with restart
+         *  markers decoded without scaling or a subset. Other images are
+         *  decoded on the calling thread, as usual.
+         */
+        SkExecutor*                fExecutor;
     };
 
     /**
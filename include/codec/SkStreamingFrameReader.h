@@ -0,0 +1,108 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkStreamingFrameReader_DEFINED
+#define SkStreamingFrameReader_DEFINED
+
+#include "include/codec/SkCodec.h"
+#include "include/codec/SkEncodedImageFormat.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSize.h"
+#include "include/core/SkTypes.h"
+#include "include/private/base/SkNoncopyable.h"
+
+#include <memory>
+
+class SkData;
+class SkStream;
+
+/**
+ *  Reads the frames of a GIF, WebP or PNG (including APNG) image from a stream that need not seek,
+ *  rewind or know its length, such as one backed by a network connection, as its bytes arrive.
+ *
+ *  SkCodec holds (or copies) the whole stream, so that it can decode any frame. This reads the
+ *  stream once, from start to end, and holds only the bytes of the structure it is reading. Each
+ *  frame's SkCodec::FrameInfo is available as soon as the frame's header has been read.
+ *
+ *  If asked to, it also keeps each frame's bytes, as a standalone still image of the frame that
+ *  SkCodec can decode, until the client takes them. The client composites the decoded frame onto
+ *  the frames before it, as its FrameInfo describes.
+ */
+class SK_API SkStreamingFrameReader : SkNoncopyable {
+public:
+    struct Options {
+        Options()
+            : fKeepFrameData(false)
+        {}
+
+        /**
+         *  Whether to keep the bytes of each frame, for takeFrameData(). Otherwise, only the
+         *  frames' FrameInfo is kept.
+         */
+        bool fKeepFrameData;
+    };
+
+    /**
+     *  Reads nothing from the stream until read() is called.
+     */
+    static std::unique_ptr<SkStreamingFrameReader> Make(std::unique_ptr<SkStream>,
+                                                        const Options& = Options());
+
+    virtual ~SkStreamingFrameReader() = default;
+
+    /**
+     *  Reads the bytes the stream has available, until a read() from it returns none, and indexes
+     *  the frames in them. Picks up where the last call left off, so call this again once more
+     *  bytes have arrived.
+     *
+     *  Returns kSuccess once the whole image has been read, and kIncompleteInput while more of it
+     *  is expected. Returns kUnimplemented if the stream is not a GIF, WebP or PNG, and
+     *  kErrorInInput if it is malformed, in which case the frames read before the error are still
+     *  available.
+     */
+    virtual SkCodec::Result read() = 0;
+
+    /**
+     *  Whether read() has read enough of the image to report its format, dimensions and
+     *  repetition count.
+     */
+    virtual bool hasHeader() const = 0;
+
+    virtual SkEncodedImageFormat getEncodedFormat() const = 0;
+
+    virtual SkISize dimensions() const = 0;
+
+    /**
+     *  As SkCodec::getRepetitionCount(). This may change as read() reads a GIF, whose loop count
+     *  can follow its first frame.
+     */
+    virtual int getRepetitionCount() const = 0;
+
+    /**
+     *  The number of frames whose headers read() has read so far. A still image has one frame,
+     *  which covers the image.
+     */
+    virtual int getFrameCount() const = 0;
+
+    /**
+     *  As SkCodec::getFrameInfo(). fFullyReceived is set once read() has read all of the frame's
+     *  bytes.
+     */
+    virtual bool getFrameInfo(int index, SkCodec::FrameInfo*) const = 0;
+
+    /**
+     *  Returns the bytes of a fully received frame, as a still GIF, WebP or PNG image of the
+     *  frame's rectangle, and forgets them. Returns nullptr if the frame has not been fully
+     *  received, if its bytes have already been taken, or if fKeepFrameData was false.
+     *
+     *  A frame that extends past the image decodes to its full size. Its top left corner belongs
+     *  at the top left of fFrameRect, which is clipped to the image.
+     */
+    virtual sk_sp<SkData> takeFrameData(int index) = 0;
+};
+
+#endif  // SkStreamingFrameReader_DEFINED
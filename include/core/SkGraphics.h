@@ -96,6 +96,21 @@ public:
      */
     static void PurgePinnedFontCache();
 
+    /**
+     *  Returns the metrics, masks and paths of the glyphs in the font cache, to be saved to a
+     *  file and passed to SetPersistentFontCacheData() by a later process.
+     */
+    static sk_sp<SkData> SerializeFontCacheGlyphs();
+
+    /**
+     *  Seeds new font cache strikes with glyphs from SerializeFontCacheGlyphs(), so they need not
+     *  be generated again. The data is used in place, so it can be a file mapped with
+     *  SkData::MakeFromFileName and shared by many processes. Returns false, and keeps using any
+     *  previous data, if the data is not from this version of Skia or fails its checksum.
+     *  Passing nullptr stops seeding.
+     */
+    static bool SetPersistentFontCacheData(sk_sp<SkData>);
+
     /**
      *  This function returns the memory used for temporary images and other resources.
      */
@@ -16,9 +16,12 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <memory>
 
 class SkCanvas;
 class SkData;
+class SkExecutor;
 class SkMatrix;
 class SkStream;
 class SkWStream;
@@ -87,6 +90,22 @@ public:
     static sk_sp<SkPicture> MakeFromData(const void* data, size_t size,
                                          const SkDeserialProcs* procs = nullptr);
 
+    /** Recreates SkPicture from data written by serializeForMapping(), drawing from data in
+        place rather than copying it. Meant for data from SkData::MakeFromFileName(), which
+        maps the file: the drawing commands and encoded images are used directly from the
+        mapping, and images are decoded lazily when drawn. Paints, paths and the like are still
+        parsed when the picture is created. The returned SkPicture keeps data alive.
+
+        Data written by serialize() is accepted too, but is copied as MakeFromData() would.
+        Returns nullptr if data does not permit constructing valid SkPicture.
+
+        @param data   serial data written by serializeForMapping()
+        @param procs  custom serial data decoders; may be nullptr
+        @return       SkPicture constructed from data
+    */
+    static sk_sp<SkPicture> MakeFromMappedData(sk_sp<SkData> data,
+                                               const SkDeserialProcs* procs = nullptr);
+
     /** \class SkPicture::AbortCallback
         AbortCallback is an abstract class. An implementation of AbortCallback may
         passed as a parameter to SkPicture::playback, to stop it before all drawing
@@ -135,6 +154,32 @@ public:
     */
     virtual void playback(SkCanvas* canvas, AbortCallback* callback = nullptr) const = 0;
 
+    /** Returns a canvas to receive the drawing commands that intersect band, which is in
+        SkPicture coordinates. The canvas matrix maps SkPicture coordinates to the canvas
+        device, as for playback(). May return nullptr to skip band.
+    */
+    using BandCanvasFactory = std::function<std::unique_ptr<SkCanvas>(const SkIRect& band)>;
+
+    /** Replays the drawing commands in horizontal bands of cullRect(), concurrently.
+
+        cullRect() is split into bandCount bands. For each band, canvasForBand is called to
+        make a canvas, which is clipped to the band before the commands are replayed into it.
+        If SkPicture has a bounding box hierarchy, each band only replays the commands whose
+        bounds intersect that band.
+
+        Bands are replayed on executor, or in order on the calling thread if executor is
+        nullptr; canvasForBand may be called from any thread. All bands are done when
+        playbackParallel returns. If the canvas matrices only scale and translate, bands
+        cover disjoint device rows, so their canvases may share pixels.
+
+        @param canvasForBand  returns the receiver of drawing commands for each band
+        @param executor       runs the bands; may be nullptr
+        @param bandCount      number of bands to split cullRect() into
+    */
+    void playbackParallel(const BandCanvasFactory& canvasForBand,
+                          SkExecutor* executor,
+                          int bandCount = 8) const;
+
     /** Returns cull SkRect for this picture, passed in when SkPicture was created.
         Returned SkRect does not specify clipping SkRect for SkPicture; cull is hint
         of SkPicture bounds.
@@ -191,6 +236,23 @@ public:
     */
     void serialize(SkWStream* stream, const SkSerialProcs* procs = nullptr) const;
 
+    /** Like serialize(), but pads the data so MakeFromMappedData() can use it in place.
+        The result can also be read by MakeFromStream() and MakeFromData().
+
+        @param procs  custom serial data encoders; may be nullptr
+        @return       storage containing serialized SkPicture
+    */
+    sk_sp<SkData> serializeForMapping(const SkSerialProcs* procs = nullptr) const;
+
+    /** Like serialize(), but pads the data so MakeFromMappedData() can use it in place.
+        Padding is relative to the start of stream, so if bytes have already been written to
+        it, their count should be a multiple of 4 for the picture to map in place.
+
+        @param stream  writable serial data stream
+        @param procs   custom serial data encoders; may be nullptr
+    */
+    void serializeForMapping(SkWStream* stream, const SkSerialProcs* procs = nullptr) const;
+
     /** Returns a placeholder SkPicture. Result does not draw, and contains only
         cull SkRect, a hint of its bounds. Result is immutable; it cannot be changed
         later. Result identifier is unique.
@@ -252,13 +314,16 @@ private:
     SkPicture();
     friend class SkBigPicture;
     friend class SkEmptyPicture;
+    friend class SkMappedPicture;
     friend class SkPicturePriv;
 
     void serialize(SkWStream*, const SkSerialProcs*, class SkRefCntSet* typefaces,
-        bool textBlobsOnly=false) const;
+        bool textBlobsOnly=false, bool alignForMapping=false) const;
+    // If sharedData is set, stream must be reading it from its start.
     static sk_sp<SkPicture> MakeFromStreamPriv(SkStream*, const SkDeserialProcs*,
                                                class SkTypefacePlayback*,
-                                               int recursionLimit);
+                                               int recursionLimit,
+                                               const SkData* sharedData = nullptr);
     friend class SkPictureData;
 
     /** Return true if the SkStream/Buffer represents a serialized picture, and
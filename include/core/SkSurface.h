@@ -30,6 +30,7 @@ class SkBitmap;
 class SkCanvas;
 class SkCapabilities;
 class SkColorSpace;
+class SkExecutor;
 class SkPaint;
 class SkSurface;
 struct SkIRect;
@@ -82,6 +83,31 @@ inline sk_sp<SkSurface> Raster(const SkImageInfo& imageInfo,
     return Raster(imageInfo, 0, props);
 }
 
+/** Allocates raster SkSurface whose SkCanvas records draws instead of rasterizing them
+    immediately. The recorded draws are binned into tileSize x tileSize tiles and rasterized,
+    one task per tile on executor, when the contents are needed: makeImageSnapshot(), draw(),
+    peekPixels(), readPixels() or writePixels(). Pixels are zeroed before use.
+
+    The result does not depend on executor or its thread count, and is the same as Raster()'s:
+    draws whose geometry would be clipped by a tile boundary are rasterized over the whole
+    surface on the calling thread instead.
+
+    The canvas cannot read or access pixels itself; use the SkSurface methods above instead.
+
+    @param imageInfo     width, height, SkColorType, SkAlphaType, SkColorSpace,
+                         of raster surface; width and height must be greater than zero
+    @param executor      runs the tiles; may be nullptr to rasterize on the calling thread.
+                         Must outlive the SkSurface.
+    @param tileSize      width and height of the tiles, greater than zero
+    @param surfaceProps  LCD striping orientation and setting for device independent fonts;
+                         may be nullptr
+    @return              SkSurface if parameters are valid and memory was allocated, else nullptr.
+*/
+SK_API sk_sp<SkSurface> RasterTiled(const SkImageInfo& imageInfo,
+                                    SkExecutor* executor,
+                                    int tileSize = 256,
+                                    const SkSurfaceProps* surfaceProps = nullptr);
+
 /** Allocates raster SkSurface. SkCanvas returned by SkSurface draws directly into the
     provided pixels.
 
@@ -171,6 +171,19 @@ struct Metadata {
     */
     SkExecutor* fExecutor = nullptr;
 
+    /** If true and fExecutor is set, the canvas returned by beginPage() records the page, and
+        endPage() hands the recording to fExecutor to be converted to PDF, so that pages are
+        converted in parallel with each other and with the drawing of later pages. Fonts,
+        images, shaders and graphic states are still shared between pages, and the pages are
+        written in order.
+
+        Pages of a tagged PDF (see fStructureElementTreeRoot) are always converted as they are
+        drawn.
+
+        Experimental.
+    */
+    bool fConcurrentPages = false;
+
     /** PDF streams may be compressed to save space.
         Use this to specify the desired compression vs time tradeoff.
     */
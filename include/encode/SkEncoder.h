@@ -43,21 +43,44 @@ public:
      */
     bool encodeRows(int numRows);
 
+    /**
+     *  Encode the rows of |rows| as the next rows of input, instead of rows of the src. |rows|
+     *  must have the src's width, color type and alpha type, and no more rows than remain.
+     *
+     *  This lets an image be encoded a strip at a time without all of it in memory: the src
+     *  passed to Make() must have the image's info, but only the rows passed here are read.
+     *  Returns false for encoders made from YUVA planes, which read their own planes.
+     */
+    bool encodeRows(const SkPixmap& rows);
+
     virtual ~SkEncoder() {}
 
 protected:
 
     virtual bool onEncodeRows(int numRows) = 0;
 
+    // Whether onEncodeRows() reads its input through srcRowAddr(), so that encodeRows(SkPixmap)
+    // can supply it.
+    virtual bool onReadsSrcRows() const { return true; }
+
     SkEncoder(const SkPixmap& src, size_t storageBytes)
         : fSrc(src)
         , fCurrRow(0)
         , fStorage(storageBytes)
     {}
 
+    // Row |y| of the input, which is in the src unless it was passed to encodeRows(SkPixmap).
+    const void* srcRowAddr(int y) const {
+        return fRows.addr() ? fRows.addr(0, y - fRowsTop) : fSrc.addr(0, y);
+    }
+
     const SkPixmap&        fSrc;
     int                    fCurrRow;
     skia_private::AutoTMalloc<uint8_t> fStorage;
+
+private:
+    SkPixmap               fRows;
+    int                    fRowsTop = 0;
 };
 
 #endif
@@ -19,6 +19,7 @@
 
 class GrDirectContext;
 class SkData;
+class SkExecutor;
 class SkImage;
 class SkPixmap;
 class SkWStream;
@@ -94,6 +95,16 @@ struct Options {
      */
     const SkPixmap* fGainmap = nullptr;
     const SkGainmapInfo* fGainmapInfo = nullptr;
+
+    /**
+     *  If non-null, blocks of rows are filtered and compressed concurrently on this executor,
+     *  and their deflate streams are joined (with sync flushes) into the image data.
+     *
+     *  Rows are then filtered by Skia rather than libpng, choosing among |fFilterFlags| with the
+     *  same heuristic, so the pixels encoded are the same but the bytes are not, and the output
+     *  is typically a little larger.  The executor must outlive the encoder.
+     */
+    SkExecutor* fExecutor = nullptr;
 };
 
 /**
@@ -22,6 +22,7 @@
 
 class SkAnimCodecPlayer;
 class SkCodec;
+class SkExecutor;
 class SkImage;
 
 namespace skresources {
@@ -107,6 +108,10 @@ public:
     // If the client has already decoded the data, they can use this constructor.
     static sk_sp<MultiFrameImageAsset> Make(std::unique_ptr<SkCodec>,
                                             ImageDecodeStrategy = ImageDecodeStrategy::kLazyDecode);
+    // Animated images are decoded ahead of playback on the executor, which must outlive the
+    // asset, so that getFrame() seldom waits for a frame to decode.
+    static sk_sp<MultiFrameImageAsset> Make(sk_sp<SkData>, SkExecutor*,
+                                            ImageDecodeStrategy = ImageDecodeStrategy::kLazyDecode);
 
 
     bool isMultiFrame() override;
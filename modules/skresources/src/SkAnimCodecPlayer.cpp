@@ -20,8 +20,11 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
 #include "include/core/SkSize.h"
+#include "include/core/SkStream.h"
 #include "include/core/SkTypes.h"
+#include "include/private/base/SkTo.h"
 #include "src/codec/SkCodecImageGenerator.h"
+#include "src/core/SkTaskGroup.h"
 
 #include <algorithm>
 #include <cstddef>
@@ -29,10 +32,48 @@
 #include <utility>
 #include <vector>
 
-SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec) : fCodec(std::move(codec)) {
+namespace {
+
+// How many frames after |from| playback reaches |to|, wrapping around after the last frame.
+int frames_until(int from, int to, int frameCount) {
+    return (to - from + frameCount) % frameCount;
+}
+
+}  // namespace
+
+struct SkAnimCodecPlayer::RecentFrames {
+    static constexpr int kCount = 2;  // enough to skip over a kRestorePrevious frame
+
+    sk_sp<SkImage> find(int index) const {
+        for (int i = 0; i < kCount; ++i) {
+            if (fIndices[i] == index) {
+                return fImages[i];
+            }
+        }
+        return nullptr;
+    }
+
+    void add(int index, sk_sp<SkImage> image) {
+        for (int i = kCount - 1; i > 0; --i) {
+            fIndices[i] = fIndices[i - 1];
+            fImages[i] = std::move(fImages[i - 1]);
+        }
+        fIndices[0] = index;
+        fImages[0] = std::move(image);
+    }
+
+    int            fIndices[kCount] = {-1, -1};
+    sk_sp<SkImage> fImages[kCount];
+};
+
+SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec)
+        : SkAnimCodecPlayer(std::move(codec), PrefetchOptions()) {}
+
+SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec,
+                                     const PrefetchOptions& options)
+        : fCodec(std::move(codec)) {
     fImageInfo = fCodec->getInfo();
     fFrameInfos = fCodec->getFrameInfo();
-    fImages.resize(fFrameInfos.size());
 
     // change the interpretation of fDuration to a end-time for that frame
     size_t dur = 0;
@@ -45,18 +86,56 @@ SkAnimCodecPlayer::SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec) : fCodec(st
     if (!fTotalDuration) {
         // Static image -- may or may not have returned a single frame info.
         fFrameInfos.clear();
-        fImages.clear();
-        fImages.push_back(SkImages::DeferredFromGenerator(
-                SkCodecImageGenerator::MakeFromCodec(std::move(fCodec))));
+        fStaticImage = SkImages::DeferredFromGenerator(
+                SkCodecImageGenerator::MakeFromCodec(std::move(fCodec)));
+        return;
+    }
+
+    const int frameCount = SkToInt(fFrameInfos.size());
+    fImages.resize(frameCount);
+    fPending.resize(frameCount);
+    fKeyFrames.resize(frameCount);
+    for (int i = 0; i < frameCount; ++i) {
+        const int requiredFrame = fFrameInfos[i].fRequiredFrame;
+        SkASSERT(requiredFrame < i);
+        fKeyFrames[i] = requiredFrame == SkCodec::kNoFrame ? i : fKeyFrames[requiredFrame];
+    }
+
+    if (options.fExecutor && frameCount > 1) {
+        // Workers decode copies of the data, which must be possible to make.
+        std::unique_ptr<SkStream> stream = fCodec->getEncodedData();
+        if (!stream) {
+            return;
+        }
+        fWorkers.push_back(std::make_unique<Worker>());
+        fWorkers.back()->fStream = std::move(stream);
+        fIdleWorkers.push_back(fWorkers.back().get());
+
+        fExecutor = options.fExecutor;
+        fFramesAhead = std::max(options.fFramesAhead, 0);
+        fMaxCachedFrames = std::max(options.fMaxCachedFrames, fFramesAhead + 1);
+        fTasks = std::make_unique<SkTaskGroup>(*fExecutor);
+        fQueues.resize(frameCount);
+        fDecodingKeyFrame.resize(frameCount);
+        this->prefetch(0, fFramesAhead + 1);
     }
 }
 
-SkAnimCodecPlayer::~SkAnimCodecPlayer() {}
+SkAnimCodecPlayer::~SkAnimCodecPlayer() {
+    if (fTasks) {
+        {
+            SkAutoMutexExclusive lock(fMutex);
+            for (std::vector<int>& queue : fQueues) {
+                queue.clear();
+            }
+        }
+        fTasks->wait();
+    }
+}
 
 SkISize SkAnimCodecPlayer::dimensions() const {
     if (!fCodec) {
-        auto image = fImages.front();
-        return image ? image->dimensions() : SkISize::MakeEmpty();
+        return fStaticImage ? fStaticImage->dimensions() : SkISize::MakeEmpty();
     }
     if (SkEncodedOriginSwapsWidthHeight(fCodec->getOrigin())) {
         return { fImageInfo.height(), fImageInfo.width() };
@@ -67,10 +146,33 @@ SkISize SkAnimCodecPlayer::dimensions() const {
 sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
     SkASSERT((unsigned)index < fFrameInfos.size());
 
-    if (fImages[index]) {
-        return fImages[index];
+    bool decoding;
+    {
+        SkAutoMutexExclusive lock(fMutex);
+        if (fImages[index]) {
+            return fImages[index];
+        }
+        decoding = fPending[index];
+        if (decoding) {
+            fWaitingFor = index;
+        }
+    }
+    if (decoding) {
+        fFrameDecoded.wait();
+        SkAutoMutexExclusive lock(fMutex);
+        if (fWaitedFrame) {
+            return std::move(fWaitedFrame);
+        }
     }
 
+    sk_sp<SkImage> image = this->decodeWithRequiredFrames(fCodec.get(), index, nullptr);
+    SkAutoMutexExclusive lock(fMutex);
+    this->cacheFrame(index, image);
+    return image;
+}
+
+sk_sp<SkImage> SkAnimCodecPlayer::decodeFrame(SkCodec* codec, int index,
+                                              sk_sp<SkImage> requiredImage) const {
     size_t rb = fImageInfo.minRowBytes();
     size_t size = fImageInfo.computeByteSize(rb);
     auto data = SkData::MakeUninitialized(size);
@@ -78,8 +180,10 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
     SkCodec::Options opts;
     opts.fFrameIndex = index;
 
-    const auto origin = fCodec->getOrigin();
-    const auto orientedDims = this->dimensions();
+    const auto origin = codec->getOrigin();
+    const auto orientedDims = SkEncodedOriginSwapsWidthHeight(origin)
+            ? SkISize{fImageInfo.height(), fImageInfo.width()}
+            : fImageInfo.dimensions();
     const auto originMatrix = SkEncodedOriginToMatrix(origin, orientedDims.width(),
                                                               orientedDims.height());
 
@@ -91,8 +195,7 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
         imageInfo = imageInfo.makeAlphaType(kPremul_SkAlphaType);
     }
     const int requiredFrame = fFrameInfos[index].fRequiredFrame;
-    if (requiredFrame != SkCodec::kNoFrame && fImages[requiredFrame]) {
-        auto requiredImage = fImages[requiredFrame];
+    if (requiredFrame != SkCodec::kNoFrame && requiredImage) {
         auto canvas = SkCanvas::MakeRasterDirect(imageInfo, data->writable_data(), rb);
         if (origin != kDefault_SkEncodedOrigin) {
             // The required frame is stored after applying the origin. Undo that,
@@ -110,7 +213,7 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
         opts.fPriorFrame = requiredFrame;
     }
 
-    if (SkCodec::kSuccess != fCodec->getPixels(imageInfo, data->writable_data(), rb, &opts)) {
+    if (SkCodec::kSuccess != codec->getPixels(imageInfo, data->writable_data(), rb, &opts)) {
         return nullptr;
     }
 
@@ -125,15 +228,174 @@ sk_sp<SkImage> SkAnimCodecPlayer::getFrameAt(int index) {
         canvas->drawImage(image, 0, 0, SkSamplingOptions(), &paint);
         image = SkImages::RasterFromData(imageInfo, std::move(data), rb);
     }
-    return fImages[index] = image;
+    return image;
+}
+
+sk_sp<SkImage> SkAnimCodecPlayer::decodeWithRequiredFrames(SkCodec* codec, int index,
+                                                           RecentFrames* recent) {
+    // Left to itself, the codec would decode the chain of required frames into the same pixels
+    // for every frame. Instead, start from the latest one already decoded, and keep the rest.
+    std::vector<int> frames;
+    sk_sp<SkImage> image;
+    for (int i = index; i != SkCodec::kNoFrame; i = fFrameInfos[i].fRequiredFrame) {
+        if ((image = this->cachedFrame(i, recent))) {
+            break;
+        }
+        frames.push_back(i);
+    }
+
+    for (auto i = frames.rbegin(); i != frames.rend(); ++i) {
+        image = this->decodeFrame(codec, *i, std::move(image));
+        if (!image) {
+            return nullptr;
+        }
+        if (recent) {
+            recent->add(*i, image);
+        }
+        if (*i != index) {
+            SkAutoMutexExclusive lock(fMutex);
+            this->cacheFrame(*i, image);
+        }
+    }
+    return image;
+}
+
+sk_sp<SkImage> SkAnimCodecPlayer::cachedFrame(int index, const RecentFrames* recent) const {
+    if (recent) {
+        if (sk_sp<SkImage> image = recent->find(index)) {
+            return image;
+        }
+    }
+    SkAutoMutexExclusive lock(fMutex);
+    return fImages[index];
+}
+
+void SkAnimCodecPlayer::cacheFrame(int index, sk_sp<SkImage> image) {
+    if (!image) {
+        return;
+    }
+    if (!fMaxCachedFrames) {
+        fImages[index] = std::move(image);
+        return;
+    }
+    if (!fImages[index]) {
+        fCachedFrames.push_back(index);
+    }
+    fImages[index] = std::move(image);
+
+    // Drop the frames that playback reaches last.
+    const int frameCount = SkToInt(fFrameInfos.size());
+    while (fCachedFrames.size() > fMaxCachedFrames) {
+        auto last = std::max_element(fCachedFrames.begin(), fCachedFrames.end(),
+                                     [&](int a, int b) {
+            return frames_until(fPlaybackIndex, a, frameCount) <
+                   frames_until(fPlaybackIndex, b, frameCount);
+        });
+        fImages[*last] = nullptr;
+        *last = fCachedFrames.back();
+        fCachedFrames.pop_back();
+    }
+}
+
+void SkAnimCodecPlayer::prefetch(int firstFrame, int frameCount) {
+    if (!fExecutor) {
+        return;
+    }
+    const int totalFrames = SkToInt(fFrameInfos.size());
+    SkASSERT(0 <= firstFrame && firstFrame < totalFrames);
+    frameCount = std::min(frameCount, totalFrames);
+
+    std::vector<std::pair<Worker*, int>> started;
+    {
+        SkAutoMutexExclusive lock(fMutex);
+        for (int i = 0; i < frameCount; ++i) {
+            const int index = (firstFrame + i) % totalFrames;
+            if (fImages[index] || fPending[index]) {
+                continue;
+            }
+            // Frames with the same key frame are decoded by the same worker, since each likely
+            // depends on the one before.
+            const int keyFrame = fKeyFrames[index];
+            if (!fDecodingKeyFrame[keyFrame]) {
+                if (fIdleWorkers.empty()) {
+                    std::unique_ptr<SkStream> stream = fCodec->getEncodedData();
+                    if (!stream) {
+                        // getFrame() will decode it.
+                        continue;
+                    }
+                    fWorkers.push_back(std::make_unique<Worker>());
+                    fWorkers.back()->fStream = std::move(stream);
+                    fIdleWorkers.push_back(fWorkers.back().get());
+                }
+                started.emplace_back(fIdleWorkers.back(), keyFrame);
+                fIdleWorkers.pop_back();
+                fDecodingKeyFrame[keyFrame] = true;
+            }
+            fQueues[keyFrame].push_back(index);
+            fPending[index] = true;
+        }
+    }
+
+    // The executor may run tasks right away, on this thread.
+    for (auto [worker, keyFrame] : started) {
+        fTasks->add([this, worker = worker, keyFrame = keyFrame] {
+            this->decodeAhead(worker, keyFrame);
+        });
+    }
+}
+
+void SkAnimCodecPlayer::decodeAhead(Worker* worker, int keyFrame) {
+    if (worker->fStream) {
+        worker->fCodec = SkCodec::MakeFromStream(std::move(worker->fStream));
+        if (worker->fCodec) {
+            // Read the frames' headers, as the player's codec has.
+            worker->fCodec->getFrameCount();
+        }
+    }
+
+    RecentFrames recent;
+    for (;;) {
+        int index;
+        {
+            SkAutoMutexExclusive lock(fMutex);
+            std::vector<int>& queue = fQueues[keyFrame];
+            if (queue.empty()) {
+                fDecodingKeyFrame[keyFrame] = false;
+                fIdleWorkers.push_back(worker);
+                return;
+            }
+            // Decode the frame that playback reaches first.
+            const int frameCount = SkToInt(fFrameInfos.size());
+            auto next = std::min_element(queue.begin(), queue.end(), [&](int a, int b) {
+                return frames_until(fPlaybackIndex, a, frameCount) <
+                       frames_until(fPlaybackIndex, b, frameCount);
+            });
+            index = *next;
+            queue.erase(next);
+        }
+
+        sk_sp<SkImage> image;
+        if (worker->fCodec) {
+            image = this->decodeWithRequiredFrames(worker->fCodec.get(), index, &recent);
+        }
+
+        SkAutoMutexExclusive lock(fMutex);
+        fPending[index] = false;
+        this->cacheFrame(index, image);
+        if (fWaitingFor == index) {
+            fWaitingFor = -1;
+            fWaitedFrame = std::move(image);
+            fFrameDecoded.signal();
+        }
+    }
 }
 
 sk_sp<SkImage> SkAnimCodecPlayer::getFrame() {
-    SkASSERT(fTotalDuration > 0 || fImages.size() == 1);
+    SkASSERT(fTotalDuration > 0 || fFrameInfos.empty());
 
     return fTotalDuration > 0
         ? this->getFrameAt(fCurrIndex)
-        : fImages.front();
+        : fStaticImage;
 }
 
 bool SkAnimCodecPlayer::seek(uint32_t msec) {
@@ -149,6 +411,13 @@ bool SkAnimCodecPlayer::seek(uint32_t msec) {
                                   });
     int prevIndex = fCurrIndex;
     fCurrIndex = lower - fFrameInfos.begin();
+    if (fCurrIndex != prevIndex && fExecutor) {
+        {
+            SkAutoMutexExclusive lock(fMutex);
+            fPlaybackIndex = fCurrIndex;
+        }
+        this->prefetch(fCurrIndex, fFramesAhead + 1);
+    }
     return fCurrIndex != prevIndex;
 }
 
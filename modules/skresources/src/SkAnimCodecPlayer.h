@@ -12,16 +12,43 @@
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSize.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkSemaphore.h"
+#include "include/private/base/SkThreadAnnotations.h"
 
 #include <cstdint>
 #include <memory>
 #include <vector>
 
+class SkExecutor;
 class SkImage;
+class SkStream;
+class SkTaskGroup;
 
 class SkAnimCodecPlayer {
 public:
     SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec);
+
+    struct PrefetchOptions {
+        // Frames are decoded on this executor, which must outlive the player.
+        SkExecutor* fExecutor = nullptr;
+        // The number of frames after the current one to decode ahead of playback.
+        int fFramesAhead = 4;
+        // The most decoded frames to keep. At least fFramesAhead + 1 are kept.
+        int fMaxCachedFrames = 8;
+    };
+
+    /**
+     *  Like the above, but decodes frames ahead of playback on an executor, so that getFrame()
+     *  rarely has to wait for one. Frames that depend on the same earlier frames (as reported by
+     *  SkCodec::FrameInfo::fRequiredFrame) are decoded in order, by a copy of the codec. Frames
+     *  that don't are decoded concurrently, by other copies. Only the frames playback reaches
+     *  soonest are kept.
+     *
+     *  If the codec's data can't be duplicated, this decodes frames on demand, like the above.
+     */
+    SkAnimCodecPlayer(std::unique_ptr<SkCodec> codec, const PrefetchOptions&);
+
     ~SkAnimCodecPlayer();
 
     /**
@@ -51,16 +78,58 @@ public:
      */
     bool seek(uint32_t msec);
 
+    /**
+     *  Starts decoding frameCount frames, starting at firstFrame and wrapping around to the first
+     *  frame after the last, on the executor. seek() does this for the frames after the one it
+     *  seeks to. Does nothing if the player was not given an executor.
+     */
+    void prefetch(int firstFrame, int frameCount);
 
 private:
+    // A copy of the codec that decodes frames ahead of playback.
+    struct Worker {
+        std::unique_ptr<SkStream> fStream;
+        std::unique_ptr<SkCodec>  fCodec;
+    };
+    // The frames a worker decoded most recently, which the next frames likely depend on.
+    struct RecentFrames;
+
     std::unique_ptr<SkCodec>        fCodec;
     SkImageInfo                     fImageInfo;
     std::vector<SkCodec::FrameInfo> fFrameInfos;
-    std::vector<sk_sp<SkImage> >    fImages;
+    sk_sp<SkImage>                  fStaticImage;
     int                             fCurrIndex = 0;
     uint32_t                        fTotalDuration;
 
+    // Frames are keyed by the first frame of their chain of required frames; frames with the same
+    // key are decoded in order, by one worker at a time.
+    std::vector<int>                fKeyFrames;
+    SkExecutor*                     fExecutor = nullptr;
+    int                             fFramesAhead = 0;
+    size_t                          fMaxCachedFrames = 0;  // 0 means no limit
+    std::unique_ptr<SkTaskGroup>    fTasks;
+
+    mutable SkMutex                       fMutex;
+    std::vector<sk_sp<SkImage> >          fImages           SK_GUARDED_BY(fMutex);
+    std::vector<int>                      fCachedFrames     SK_GUARDED_BY(fMutex);
+    std::vector<bool>                     fPending          SK_GUARDED_BY(fMutex);
+    // The frames waiting for a worker, for each key frame.
+    std::vector<std::vector<int>>         fQueues           SK_GUARDED_BY(fMutex);
+    std::vector<bool>                     fDecodingKeyFrame SK_GUARDED_BY(fMutex);
+    std::vector<std::unique_ptr<Worker>>  fWorkers          SK_GUARDED_BY(fMutex);
+    std::vector<Worker*>                  fIdleWorkers      SK_GUARDED_BY(fMutex);
+    int                                   fPlaybackIndex    SK_GUARDED_BY(fMutex) = 0;
+    // getFrame() waits on fFrameDecoded for the frame it needs, if a worker is decoding it.
+    int                                   fWaitingFor       SK_GUARDED_BY(fMutex) = -1;
+    sk_sp<SkImage>                        fWaitedFrame      SK_GUARDED_BY(fMutex);
+    SkSemaphore                           fFrameDecoded;
+
     sk_sp<SkImage> getFrameAt(int index);
+    sk_sp<SkImage> decodeFrame(SkCodec*, int index, sk_sp<SkImage> requiredImage) const;
+    sk_sp<SkImage> decodeWithRequiredFrames(SkCodec*, int index, RecentFrames*);
+    sk_sp<SkImage> cachedFrame(int index, const RecentFrames*) const;
+    void cacheFrame(int index, sk_sp<SkImage>) SK_REQUIRES(fMutex);
+    void decodeAhead(Worker*, int keyFrame);
 };
 
 #endif
@@ -122,6 +122,18 @@ sk_sp<MultiFrameImageAsset> MultiFrameImageAsset::Make(std::unique_ptr<SkCodec>
             std::make_unique<SkAnimCodecPlayer>(std::move(codec)), strat));
 }
 
+sk_sp<MultiFrameImageAsset> MultiFrameImageAsset::Make(sk_sp<SkData> data, SkExecutor* executor,
+                                                       ImageDecodeStrategy strat) {
+    if (auto codec = SkCodec::MakeFromData(std::move(data))) {
+        SkAnimCodecPlayer::PrefetchOptions options;
+        options.fExecutor = executor;
+        return sk_sp<MultiFrameImageAsset>(new MultiFrameImageAsset(
+                std::make_unique<SkAnimCodecPlayer>(std::move(codec), options), strat));
+    }
+
+    return nullptr;
+}
+
 MultiFrameImageAsset::MultiFrameImageAsset(std::unique_ptr<SkAnimCodecPlayer> player,
                                            ImageDecodeStrategy strat)
         : fPlayer(std::move(player)), fStrategy(strat) {
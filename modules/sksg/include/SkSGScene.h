@@ -8,12 +8,17 @@
 #ifndef SkSGScene_DEFINED
 #define SkSGScene_DEFINED
 
+#include "include/core/SkColor.h"
+#include "include/core/SkMatrix.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkRegion.h"
 #include "include/core/SkTypes.h"
 
 #include <memory>
 
 class SkCanvas;
+class SkSurface;
+struct SkImageInfo;
 struct SkPoint;
 
 namespace sksg {
@@ -42,6 +47,54 @@ private:
     const sk_sp<RenderNode> fRoot;
 };
 
+/**
+ * Renders a scene into a raster surface which is kept between frames, so that each frame only
+ * repaints the areas the scene reports as damaged while revalidating.
+ *
+ * The scene should only be revalidated through render(), or damage will be missed.
+ */
+class IncrementalRasterRenderer final {
+public:
+    struct Options {
+        // Damaged areas are cleared to this before the scene is drawn over them.
+        SkColor4f fBackground     = SkColors::kTransparent;
+
+        // Damage rects are merged until there are at most this many, which keeps the clip
+        // simple when a frame damages many small areas. Zero means no limit.
+        int       fMaxDamageRects = 8;
+    };
+
+    static std::unique_ptr<IncrementalRasterRenderer> Make(const SkImageInfo&,
+                                                           const SkMatrix& sceneToSurface,
+                                                           const Options&);
+    static std::unique_ptr<IncrementalRasterRenderer> Make(const SkImageInfo& info) {
+        return Make(info, SkMatrix::I(), Options());
+    }
+    ~IncrementalRasterRenderer();
+    IncrementalRasterRenderer(const IncrementalRasterRenderer&) = delete;
+    IncrementalRasterRenderer& operator=(const IncrementalRasterRenderer&) = delete;
+
+    /**
+     * Revalidates the scene and repaints what it damaged, or the whole surface on the first frame
+     * and after invalidateAll(). Returns the repainted area, in surface coordinates.
+     */
+    const SkRegion& render(Scene*);
+
+    /** Makes the next render() repaint the whole surface. */
+    void invalidateAll() { fRepaintAll = true; }
+
+    SkSurface* surface() const { return fSurface.get(); }
+
+private:
+    IncrementalRasterRenderer(sk_sp<SkSurface>, const SkMatrix& sceneToSurface, const Options&);
+
+    const sk_sp<SkSurface> fSurface;
+    const SkMatrix         fSceneToSurface;
+    const Options          fOptions;
+    SkRegion               fDamage;
+    bool                   fRepaintAll = true;
+};
+
 } // namespace sksg
 
 #endif // SkSGScene_DEFINED
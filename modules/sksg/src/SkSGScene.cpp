@@ -5,11 +5,20 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkImageInfo.h"
 #include "include/core/SkMatrix.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkSurface.h"
+#include "include/private/base/SkTo.h"
+#include "modules/sksg/include/SkSGInvalidationController.h"
 #include "modules/sksg/include/SkSGRenderNode.h"
 #include "modules/sksg/include/SkSGScene.h"
 
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 namespace sksg {
 
@@ -33,4 +42,92 @@ const RenderNode* Scene::nodeAt(const SkPoint& p) const {
     return fRoot->nodeAt(p);
 }
 
+namespace {
+
+int64_t area(const SkIRect& r) {
+    return (int64_t)r.width() * r.height();
+}
+
+// Reduces rects to at most maxCount, by keeping the largest ones and joining each of the others
+// into whichever of those grows the least.
+void merge_rects(std::vector<SkIRect>* rects, int maxCount) {
+    if (maxCount <= 0 || rects->size() <= (size_t)maxCount) {
+        return;
+    }
+
+    std::sort(rects->begin(), rects->end(), [](const SkIRect& a, const SkIRect& b) {
+        return area(a) > area(b);
+    });
+    for (size_t i = maxCount; i < rects->size(); ++i) {
+        const SkIRect& r = (*rects)[i];
+        SkIRect* best = nullptr;
+        int64_t  bestGrowth = 0;
+        for (int j = 0; j < maxCount; ++j) {
+            SkIRect joined = (*rects)[j];
+            joined.join(r);
+            const int64_t growth = area(joined) - area((*rects)[j]);
+            if (!best || growth < bestGrowth) {
+                best = &(*rects)[j];
+                bestGrowth = growth;
+            }
+        }
+        best->join(r);
+    }
+    rects->resize(maxCount);
+}
+
+} // namespace
+
+std::unique_ptr<IncrementalRasterRenderer> IncrementalRasterRenderer::Make(
+        const SkImageInfo& info, const SkMatrix& sceneToSurface, const Options& options) {
+    auto surface = SkSurfaces::Raster(info);
+    return surface ? std::unique_ptr<IncrementalRasterRenderer>(
+                             new IncrementalRasterRenderer(std::move(surface), sceneToSurface,
+                                                           options))
+                   : nullptr;
+}
+
+IncrementalRasterRenderer::IncrementalRasterRenderer(sk_sp<SkSurface> surface,
+                                                     const SkMatrix& sceneToSurface,
+                                                     const Options& options)
+    : fSurface(std::move(surface))
+    , fSceneToSurface(sceneToSurface)
+    , fOptions(options) {}
+
+IncrementalRasterRenderer::~IncrementalRasterRenderer() = default;
+
+const SkRegion& IncrementalRasterRenderer::render(Scene* scene) {
+    InvalidationController ic;
+    scene->revalidate(&ic);
+
+    const SkIRect surfaceBounds = fSurface->imageInfo().bounds();
+    if (fRepaintAll) {
+        fDamage.setRect(surfaceBounds);
+        fRepaintAll = false;
+    } else {
+        std::vector<SkIRect> rects;
+        rects.reserve(ic.end() - ic.begin());
+        for (const SkRect& r : ic) {
+            // Anti-aliasing only touches pixels which the bounds at least partially cover.
+            SkIRect devRect = fSceneToSurface.mapRect(r).roundOut();
+            if (devRect.intersect(surfaceBounds)) {
+                rects.push_back(devRect);
+            }
+        }
+        merge_rects(&rects, fOptions.fMaxDamageRects);
+        fDamage.setRects(rects.data(), SkToInt(rects.size()));
+    }
+
+    if (!fDamage.isEmpty()) {
+        SkCanvas* canvas = fSurface->getCanvas();
+        SkAutoCanvasRestore acr(canvas, true);
+        canvas->clipRegion(fDamage);
+        canvas->drawColor(fOptions.fBackground, SkBlendMode::kSrc);
+        canvas->concat(fSceneToSurface);
+        scene->render(canvas);
+    }
+
+    return fDamage;
+}
+
 } // namespace sksg
@@ -9,7 +9,11 @@
 
 #if !defined(SK_BUILD_FOR_GOOGLE3)
 
+#include "include/core/SkBitmap.h"
+#include "include/core/SkImageInfo.h"
 #include "include/core/SkRect.h"
+#include "include/core/SkRegion.h"
+#include "include/core/SkSurface.h"
 #include "include/private/base/SkTo.h"
 #include "modules/sksg/include/SkSGDraw.h"
 #include "modules/sksg/include/SkSGGroup.h"
@@ -17,11 +21,15 @@
 #include "modules/sksg/include/SkSGPaint.h"
 #include "modules/sksg/include/SkSGRect.h"
 #include "modules/sksg/include/SkSGRenderEffect.h"
+#include "modules/sksg/include/SkSGScene.h"
 #include "modules/sksg/include/SkSGTransform.h"
 #include "src/core/SkRectPriv.h"
 
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 
+#include <functional>
+#include <iterator>
 #include <vector>
 
 static void check_inval(skiatest::Reporter* reporter, const sk_sp<sksg::Node>& root,
@@ -355,4 +363,64 @@ DEF_TEST(SGInvalidation, reporter) {
     inval_group_remove(reporter);
 }
 
+static SkBitmap read_surface(SkSurface* surface) {
+    SkBitmap bm;
+    bm.allocPixels(surface->imageInfo());
+    SkAssertResult(surface->readPixels(bm, 0, 0));
+    return bm;
+}
+
+DEF_TEST(SGIncrementalRaster, reporter) {
+    const auto info = SkImageInfo::MakeN32Premul(200, 150);
+    const auto sceneToSurface = SkMatrix::Scale(0.75f, 0.75f).postTranslate(3.5f, 2.25f);
+
+    for (int maxDamageRects : {0, 1, 8}) {
+        // A grid of anti-aliased rects, with fractional edges once scaled to the surface.
+        std::vector<sk_sp<sksg::Rect>>  rects;
+        std::vector<sk_sp<sksg::Color>> colors;
+        auto grp = sksg::Group::Make();
+        for (int i = 0; i < 12; ++i) {
+            rects.push_back(sksg::Rect::Make(SkRect::MakeXYWH((i % 4) * 60 + 5.3f,
+                                                              (i / 4) * 60 + 7.1f, 41, 37)));
+            colors.push_back(sksg::Color::Make(SkColorSetRGB(20 * i, 255 - 20 * i, 128)));
+            colors.back()->setAntiAlias(true);
+            grp->addChild(sksg::Draw::Make(rects.back(), colors.back()));
+        }
+        auto scene = sksg::Scene::Make(grp);
+
+        sksg::IncrementalRasterRenderer::Options options;
+        options.fBackground = SkColors::kWhite;
+        options.fMaxDamageRects = maxDamageRects;
+        auto renderer = sksg::IncrementalRasterRenderer::Make(info, sceneToSurface, options);
+
+        const std::function<void()> frames[] = {
+            [] {},
+            [&] { rects[0]->setL(9.6f); rects[0]->setR(51.2f); },
+            [&] { colors[5]->setColor(SK_ColorRED); colors[11]->setOpacity(0.5f); },
+            [&] { for (int i : {1, 6, 8, 10}) { rects[i]->setT(rects[i]->getT() + 3.7f); } },
+            [] {},
+        };
+        for (size_t f = 0; f < std::size(frames); ++f) {
+            frames[f]();
+            const SkRegion& damage = renderer->render(scene.get());
+
+            if (f == 0) {
+                REPORTER_ASSERT(reporter, damage.getBounds() == info.bounds());
+            } else if (f == std::size(frames) - 1) {
+                REPORTER_ASSERT(reporter, damage.isEmpty());
+            } else {
+                // Nothing is drawn below the grid, so small changes should never repaint there.
+                REPORTER_ASSERT(reporter, !damage.contains(20, 140), "frame %zu", f);
+            }
+
+            auto reference = sksg::IncrementalRasterRenderer::Make(info, sceneToSurface, options);
+            reference->render(scene.get());
+            REPORTER_ASSERT(reporter,
+                            ToolUtils::equal_pixels(read_surface(renderer->surface()),
+                                                    read_surface(reference->surface())),
+                            "max rects %d, frame %zu", maxDamageRects, f);
+        }
+    }
+}
+
 #endif // !defined(SK_BUILD_FOR_GOOGLE3)
@@ -541,6 +541,67 @@ SkCodec::Result SkAndroidCodec::getAndroidPixels(const SkImageInfo& info, void*
     return this->getAndroidPixels(info, pixels, rowBytes, nullptr);
 }
 
+SkISize SkAndroidCodec::getThumbnailDimensions(SkISize minSize) const {
+    const auto origDims = fCodec->dimensions();
+    if (!strictly_bigger_than(origDims, minSize)) {
+        return origDims;
+    }
+    minSize = SkISize::Make(std::max(1, minSize.width()), std::max(1, minSize.height()));
+
+    // The smallest scale that the codec supports natively, such as a JPEG's eighths, which
+    // decodes faster and looks better than sampling.
+    SkISize best = origDims;
+    for (int eighths = 7; eighths >= 1; eighths--) {
+        const SkISize scaled = fCodec->getScaledDimensions(eighths / 8.0f);
+        if (smaller_than(scaled, minSize)) {
+            return best;
+        }
+        best = scaled;
+    }
+
+    // Sample to go smaller than that: the largest sample size whose dimensions are still big
+    // enough.
+    int sampleSize = std::min(origDims.width() / minSize.width(),
+                              origDims.height() / minSize.height());
+    for (; sampleSize > 1; sampleSize--) {
+        const SkISize sampled = this->getSampledDimensions(sampleSize);
+        if (!smaller_than(sampled, minSize)) {
+            if (strictly_bigger_than(best, sampled)) {
+                best = sampled;
+            }
+            break;
+        }
+    }
+    return best;
+}
+
+SkCodec::Result SkAndroidCodec::getThumbnailPixels(const SkImageInfo& info, void* pixels,
+        size_t rowBytes, const AndroidOptions* options) {
+    AndroidOptions thumbnailOptions;
+    if (options) {
+        if (options->fSubset) {
+            return SkCodec::kInvalidParameters;
+        }
+        thumbnailOptions = *options;
+    }
+
+    // Prefer the codec's own scaling, which getAndroidPixels() uses for a sample size of 1.
+    if (fCodec->dimensionsSupported(info.dimensions())) {
+        thumbnailOptions.fSampleSize = 1;
+        return this->getAndroidPixels(info, pixels, rowBytes, &thumbnailOptions);
+    }
+
+    // Otherwise find the sample size that getThumbnailDimensions() chose.
+    const int estimate = fCodec->dimensions().width() / std::max(1, info.width());
+    for (int sampleSize : {estimate, estimate + 1, estimate - 1}) {
+        if (sampleSize > 1 && this->getSampledDimensions(sampleSize) == info.dimensions()) {
+            thumbnailOptions.fSampleSize = sampleSize;
+            return this->getAndroidPixels(info, pixels, rowBytes, &thumbnailOptions);
+        }
+    }
+    return SkCodec::kInvalidScale;
+}
+
 bool SkAndroidCodec::getGainmapAndroidCodec(SkGainmapInfo* info,
                                             std::unique_ptr<SkAndroidCodec>* outCodec) {
     if (outCodec) {
@@ -20,23 +20,31 @@
 #include "include/core/SkYUVAInfo.h"
 #include "include/private/base/SkAlign.h"
 #include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
 #include "modules/skcms/skcms.h"
 #include "src/codec/SkCodecPriv.h"
 #include "src/codec/SkJpegConstants.h"
 #include "src/codec/SkJpegDecoderMgr.h"
 #include "src/codec/SkJpegMetadataDecoderImpl.h"
 #include "src/codec/SkJpegPriv.h"
+#include "src/codec/SkJpegRestartBands.h"
 #include "src/codec/SkParseEncodedOrigin.h"
 #include "src/codec/SkSwizzler.h"
+#include "src/core/SkTaskGroup.h"
 
 #ifdef SK_CODEC_DECODES_JPEG_GAINMAPS
 #include "include/private/SkGainmapInfo.h"
 #endif  // SK_CODEC_DECODES_JPEG_GAINMAPS
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <csetjmp>
+#include <cstdint>
 #include <cstring>
+#include <memory>
 #include <utility>
+#include <vector>
 
 using namespace skia_private;
 
@@ -273,6 +281,7 @@ bool SkJpegCodec::onRewind() {
     }
     SkASSERT(nullptr != decoderMgr);
     fDecoderMgr.reset(decoderMgr);
+    fBandStream.reset();
 
     fSwizzler.reset(nullptr);
     fSwizzleSrcRow = nullptr;
@@ -484,6 +493,12 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
         return kUnimplemented;
     }
 
+    if (options.fExecutor && this->decodeBandsInParallel(dstInfo, dst, dstRowBytes, options)) {
+        return kSuccess;
+    }
+
+    this->switchToReencodedImage();
+
     // Get a pointer to the decompress info since we will use it quite frequently
     jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
 
@@ -519,6 +534,184 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
     return kSuccess;
 }
 
+bool SkJpegCodec::decodeBandsInParallel(const SkImageInfo& dstInfo,
+                                        void* dst,
+                                        size_t dstRowBytes,
+                                        const Options& options) {
+    // Bands of at least this many pixels, so each is worth the extra headers and overlap.
+    constexpr int64_t kMinBandPixels = 1024 * 1024;
+    constexpr int kMaxBands = 32;
+
+    if (dstInfo.dimensions() != this->dimensions()) {
+        return false;
+    }
+    const int maxBands = SkToInt(std::min<int64_t>(kMaxBands, dstInfo.width() * (int64_t)
+                                                              dstInfo.height() / kMinBandPixels));
+    const SkJpegRestartBands* restartBands = this->restartBands(/*reencode=*/false);
+    if (maxBands < 2 || !restartBands) {
+        return false;
+    }
+    std::vector<SkJpegBand> bands = restartBands->split(maxBands);
+    if (bands.size() < 2) {
+        return false;
+    }
+
+    // Each band is decoded by its own codec, which converts colors (and swizzles) just as this
+    // one would, given the same profile.
+    const skcms_ICCProfile* profile = this->getEncodedInfo().profile();
+    Options bandOptions = options;
+    bandOptions.fExecutor = nullptr;
+    std::atomic<bool> ok{true};
+    SkTaskGroup tasks(*options.fExecutor);
+    tasks.batch(SkToInt(bands.size()), [&](int i) {
+        SkJpegBand& band = bands[i];
+        Result result;
+        std::unique_ptr<SkCodec> codec = SkJpegCodec::MakeFromStream(
+                std::move(band.fStream),
+                &result,
+                profile ? SkEncodedInfo::ICCProfile::Make(*profile) : nullptr);
+        if (!codec ||
+            codec->startScanlineDecode(dstInfo.makeDimensions(codec->dimensions()),
+                                       &bandOptions) != kSuccess ||
+            !codec->skipScanlines(band.fSkipRows) ||
+            codec->getScanlines(SkTAddOffset<void>(dst, band.fTop * dstRowBytes),
+                                band.fHeight,
+                                dstRowBytes) != band.fHeight) {
+            ok = false;
+        }
+    });
+    tasks.wait();
+    return ok;
+}
+
+const SkJpegRestartBands* SkJpegCodec::restartBands(bool reencode) {
+    // The index refers to the stream's memory, which lives as long as this codec.
+    SkStream* stream = this->stream();
+    if (!stream->getMemoryBase() || !stream->hasLength()) {
+        return nullptr;
+    }
+    if (!fRestartBandsIndexed) {
+        fRestartBandsIndexed = true;
+        fRestartBands = SkJpegRestartBands::Make(
+                SkData::MakeWithoutCopy(stream->getMemoryBase(), stream->getLength()));
+    }
+    if (!fRestartBands && reencode && !fRestartBandsReencoded) {
+        fRestartBandsReencoded = true;
+        fRestartBands = SkJpegRestartBands::MakeReencoded(
+                *SkData::MakeWithoutCopy(stream->getMemoryBase(), stream->getLength()));
+    }
+    return fRestartBands.get();
+}
+
+std::unique_ptr<JpegDecoderMgr> SkJpegCodec::makeBandDecoderMgr(
+        SkJpegBand* band, std::unique_ptr<SkStream>* bandStream) {
+    std::unique_ptr<SkStream> stream = std::move(band->fStream);
+    JpegDecoderMgr* decoderMgr = nullptr;
+    if (kSuccess != ReadHeader(stream.get(), nullptr, &decoderMgr, nullptr)) {
+        return nullptr;
+    }
+    std::unique_ptr<JpegDecoderMgr> bandMgr(decoderMgr);
+
+    const jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    jpeg_decompress_struct* bandInfo = bandMgr->dinfo();
+    if (bandInfo->jpeg_color_space != dinfo->jpeg_color_space ||
+        bandInfo->image_width != dinfo->image_width) {
+        return nullptr;
+    }
+    bandInfo->out_color_space = dinfo->out_color_space;
+    bandInfo->scale_num = dinfo->scale_num;
+    bandInfo->scale_denom = dinfo->scale_denom;
+    bandInfo->dct_method = dinfo->dct_method;
+    bandInfo->dither_mode = dinfo->dither_mode;
+    bandInfo->do_fancy_upsampling = dinfo->do_fancy_upsampling;
+    bandInfo->do_block_smoothing = dinfo->do_block_smoothing;
+
+    *bandStream = std::move(stream);
+    return bandMgr;
+}
+
+void SkJpegCodec::switchToReencodedImage() {
+    // A progressive image is entropy decoded in full before its first row is output. Once it has
+    // been re-encoded for region decodes, decode the (baseline) re-encoded image instead.
+    if (!fDecoderMgr->dinfo()->progressive_mode || !fRestartBands) {
+        return;
+    }
+    SkJpegBand band = fRestartBands->band(0, fRestartBands->height());
+    std::unique_ptr<SkStream> bandStream;
+    if (std::unique_ptr<JpegDecoderMgr> bandMgr = this->makeBandDecoderMgr(&band, &bandStream)) {
+        fDecoderMgr = std::move(bandMgr);
+        fBandStream = std::move(bandStream);
+    }
+}
+
+bool SkJpegCodec::seekToScanline(int row) {
+    // Skipping fewer rows of the image than this isn't worth finding (let alone making) restart
+    // markers for.
+    constexpr int kMinSeekRows = 128;
+
+    // Output rows are scaled from the image's by scale_num / scale_denom, and rows of MCUs
+    // (whose heights are multiples of 8) scale exactly.
+    const jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    const int num = dinfo->scale_num, denom = dinfo->scale_denom;
+    const int imageRow = row * denom / num;
+    if (imageRow < kMinSeekRows) {
+        return false;
+    }
+
+    // Re-encoding costs more than decoding the image once, so it is only worth it for an image
+    // that is decoded in regions repeatedly.
+    const SkJpegRestartBands* restartBands = this->restartBands(fUnindexedSeeks > 0);
+    if (!restartBands) {
+        fUnindexedSeeks++;
+        return false;
+    }
+
+    SkJpegBand band = restartBands->band(imageRow, restartBands->height());
+    const int bandTop = band.fTop - band.fSkipRows;
+    if (bandTop == 0 || (bandTop * num) % denom) {
+        return false;
+    }
+    const int rowsAbove = bandTop * num / denom;
+
+    std::unique_ptr<SkStream> bandStream;
+    std::unique_ptr<JpegDecoderMgr> bandMgr = this->makeBandDecoderMgr(&band, &bandStream);
+    if (!bandMgr) {
+        return false;
+    }
+    {
+        skjpeg_error_mgr::AutoPushJmpBuf jmp(bandMgr->errorMgr());
+        if (setjmp(jmp)) {
+            return bandMgr->returnFalse("seekToScanline");
+        }
+        jpeg_decompress_struct* bandInfo = bandMgr->dinfo();
+        if (!jpeg_start_decompress(bandInfo)) {
+            return false;
+        }
+        // Crop the band's rows as the image's were.
+        if (const SkIRect* subset = this->options().fSubset) {
+            uint32_t startX = subset->x();
+            uint32_t width = subset->width();
+            jpeg_crop_scanline(bandInfo, &startX, &width);
+            if (subset->x() - SkToInt(startX) != fSwizzlerSubset.x()) {
+                return false;
+            }
+        }
+        if (bandInfo->output_width != dinfo->output_width ||
+            bandInfo->output_height != dinfo->output_height - rowsAbove ||
+            bandInfo->out_color_components != dinfo->out_color_components) {
+            return false;
+        }
+        const int rows = row - rowsAbove;
+        if ((uint32_t) rows != jpeg_skip_scanlines(bandInfo, rows)) {
+            return false;
+        }
+    }
+
+    fDecoderMgr = std::move(bandMgr);
+    fBandStream = std::move(bandStream);
+    return true;
+}
+
 bool SkJpegCodec::allocateStorage(const SkImageInfo& dstInfo) {
     int dstWidth = dstInfo.width();
 
@@ -612,6 +805,8 @@ SkSampler* SkJpegCodec::getSampler(bool createIfNecessary) {
 
 SkCodec::Result SkJpegCodec::onStartScanlineDecode(const SkImageInfo& dstInfo,
         const Options& options) {
+    this->switchToReencodedImage();
+
     // Set the jump location for libjpeg errors
     skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
     if (setjmp(jmp)) {
@@ -687,6 +882,11 @@ int SkJpegCodec::onGetScanlines(void* dst, int count, size_t dstRowBytes) {
 }
 
 bool SkJpegCodec::onSkipScanlines(int count) {
+    // Skipping from the top of the image can start from a restart marker instead.
+    if (this->currScanline() == 0 && count > 0 && this->seekToScanline(count)) {
+        return true;
+    }
+
     // Set the jump location for libjpeg errors
     skjpeg_error_mgr::AutoPushJmpBuf jmp(fDecoderMgr->errorMgr());
     if (setjmp(jmp)) {
@@ -23,11 +23,13 @@
 #include <memory>
 
 class JpegDecoderMgr;
+class SkJpegRestartBands;
 class SkSampler;
 class SkStream;
 class SkSwizzler;
 struct SkGainmapInfo;
 struct SkImageInfo;
+struct SkJpegBand;
 
 /*
  *
@@ -127,6 +129,41 @@ private:
                 JpegDecoderMgr* decoderMgr,
                 SkEncodedOrigin origin);
 
+    /*
+     * Decodes bands of rows that start at restart markers concurrently, each with its own decoder,
+     * on options.fExecutor. Returns false, having written nothing or only some of the rows, if the
+     * image can't be split into bands or a band fails to decode.
+     */
+    bool decodeBandsInParallel(const SkImageInfo& dstInfo, void* dst, size_t dstRowBytes,
+                               const Options& options);
+
+    /*
+     * Returns the restart intervals of the image, if its stream is in memory and it has restart
+     * markers. Otherwise, if reencode is true, it losslessly re-encodes the image with restart
+     * markers, and indexes that. The result is cached.
+     */
+    const SkJpegRestartBands* restartBands(bool reencode);
+
+    /*
+     * Creates a decoder manager for band, with the same output parameters as fDecoderMgr. Its
+     * stream is returned in bandStream, which must outlive it.
+     */
+    std::unique_ptr<JpegDecoderMgr> makeBandDecoderMgr(SkJpegBand* band,
+                                                       std::unique_ptr<SkStream>* bandStream);
+
+    /*
+     * Called at the start of a scanline decode, to skip to a later row by decoding from a
+     * restart marker above it, rather than from the top of the image. Returns false, leaving
+     * fDecoderMgr unchanged, if the image has no restart marker that helps.
+     */
+    bool seekToScanline(int row);
+
+    /*
+     * If the image is progressive and has been re-encoded, has fDecoderMgr decode the re-encoded
+     * image, before it starts decompressing.
+     */
+    void switchToReencodedImage();
+
     void initializeSwizzler(const SkImageInfo& dstInfo, const Options& options,
                             bool needsCMYKToRGB);
     [[nodiscard]] bool allocateStorage(const SkImageInfo& dstInfo);
@@ -141,6 +178,16 @@ private:
     int onGetScanlines(void* dst, int count, size_t rowBytes) override;
     bool onSkipScanlines(int count) override;
 
+    // Restart intervals for decoding regions (and bands in parallel) without decoding the
+    // whole image above them.
+    std::unique_ptr<SkJpegRestartBands> fRestartBands;
+    bool                               fRestartBandsIndexed = false;
+    bool                               fRestartBandsReencoded = false;
+    // Scanline decodes that skipped rows at the start without fRestartBands.
+    int                                fUnindexedSeeks = 0;
+
+    // The stream of the band fDecoderMgr decodes, if it's not decoding this->stream().
+    std::unique_ptr<SkStream>          fBandStream;
     std::unique_ptr<JpegDecoderMgr>    fDecoderMgr;
 
     // We will save the state of the decompress struct after reading the header.
@@ -0,0 +1,505 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/codec/SkJpegRestartBands.h"
+
+#include "include/private/base/SkAssert.h"
+#include "include/private/base/SkTo.h"
+#include "src/codec/SkCodecPriv.h"
+#include "src/codec/SkJpegConstants.h"
+#include "src/codec/SkJpegDecoderMgr.h"
+#include "src/codec/SkJpegPriv.h"
+#include "src/codec/SkJpegUtility.h"
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <utility>
+
+extern "C" {
+    #include "jerror.h"   // NO_G3_REWRITE
+    #include "jpeglib.h"  // NO_G3_REWRITE
+}
+
+namespace {
+
+constexpr uint8_t kMarkerStartOfFrameBaseline = 0xC0;
+constexpr uint8_t kMarkerStartOfFrameExtended = 0xC1;
+constexpr uint8_t kMarkerStartOfFrameLast = 0xCF;
+constexpr uint8_t kMarkerDefineHuffmanTable = 0xC4;
+constexpr uint8_t kMarkerJPEGExtension = 0xC8;
+constexpr uint8_t kMarkerDefineArithmeticConditioning = 0xCC;
+constexpr uint8_t kMarkerDefineRestartInterval = 0xDD;
+constexpr uint8_t kMarkerRestart0 = 0xD0;
+constexpr uint8_t kMarkerRestart7 = 0xD7;
+constexpr uint8_t kMarkerAPP14 = 0xEE;
+constexpr uint8_t kMarkerLastAPP = 0xEF;
+constexpr uint8_t kMarkerComment = 0xFE;
+// Restart markers are numbered modulo this.
+constexpr int kRestartMarkerCount = 8;
+
+uint16_t read_u16(const uint8_t* p) { return SkToU16((p[0] << 8) | p[1]); }
+
+// Whether a band keeps a segment. Pixels don't depend on application segments, other than JFIF's
+// and Adobe's, which determine the color space.
+bool band_needs_segment(uint8_t marker) {
+    if (marker == kMarkerComment) {
+        return false;
+    }
+    if (marker > kJpegMarkerAPP0 && marker <= kMarkerLastAPP) {
+        return marker == kMarkerAPP14;
+    }
+    return true;
+}
+
+// A band's JPEG: its header, a range of the original's entropy coded data, with its restart
+// markers renumbered as they are read, and an end of image marker.
+class BandStream final : public SkStreamAsset {
+public:
+    BandStream(sk_sp<SkData> header,
+               sk_sp<SkData> jpeg,
+               size_t begin,
+               size_t end,
+               std::vector<size_t> restarts)
+            : fHeader(std::move(header))
+            , fJpeg(std::move(jpeg))
+            , fBegin(begin)
+            , fEnd(end)
+            , fRestarts(std::move(restarts))
+            , fLength(fHeader->size() + (fEnd - fBegin) + kJpegMarkerCodeSize) {}
+
+    size_t read(void* buffer, size_t size) override {
+        size = std::min(size, fLength - fPosition);
+        if (buffer && size) {
+            this->copy(static_cast<uint8_t*>(buffer), size);
+        }
+        fPosition += size;
+        return size;
+    }
+
+    bool isAtEnd() const override { return fPosition == fLength; }
+
+    bool rewind() override {
+        fPosition = 0;
+        return true;
+    }
+
+    bool hasPosition() const override { return true; }
+    size_t getPosition() const override { return fPosition; }
+
+    bool seek(size_t position) override {
+        fPosition = std::min(position, fLength);
+        return true;
+    }
+
+    bool move(long offset) override {
+        if (offset < 0 && static_cast<size_t>(-offset) > fPosition) {
+            return this->seek(0);
+        }
+        return this->seek(fPosition + offset);
+    }
+
+    bool hasLength() const override { return true; }
+    size_t getLength() const override { return fLength; }
+
+private:
+    SkStreamAsset* onDuplicate() const override {
+        return new BandStream(fHeader, fJpeg, fBegin, fEnd, fRestarts);
+    }
+
+    SkStreamAsset* onFork() const override {
+        auto fork = new BandStream(fHeader, fJpeg, fBegin, fEnd, fRestarts);
+        fork->fPosition = fPosition;
+        return fork;
+    }
+
+    void copy(uint8_t* dst, size_t size) const {
+        static constexpr uint8_t kEndOfImage[] = {0xFF, kJpegMarkerEndOfImage};
+        const uint8_t* pieces[] = {fHeader->bytes(), fJpeg->bytes() + fBegin, kEndOfImage};
+        const size_t sizes[] = {fHeader->size(), fEnd - fBegin, sizeof(kEndOfImage)};
+        size_t pieceStart = 0, position = fPosition, left = size;
+        uint8_t* out = dst;
+        for (int i = 0; i < 3 && left; ++i) {
+            if (position < pieceStart + sizes[i]) {
+                const size_t n = std::min(left, pieceStart + sizes[i] - position);
+                memcpy(out, pieces[i] + (position - pieceStart), n);
+                out += n;
+                position += n;
+                left -= n;
+            }
+            pieceStart += sizes[i];
+        }
+
+        // Renumber the second bytes of the restart markers that were copied.
+        auto markerNumberAt = [this](size_t restart) {
+            return fHeader->size() + (restart - fBegin) + 1;
+        };
+        auto it = std::lower_bound(fRestarts.begin(), fRestarts.end(), fPosition,
+                                   [&](size_t restart, size_t position) {
+                                       return markerNumberAt(restart) < position;
+                                   });
+        for (; it != fRestarts.end() && markerNumberAt(*it) < fPosition + size; ++it) {
+            const size_t index = it - fRestarts.begin();
+            dst[markerNumberAt(*it) - fPosition] =
+                    SkToU8(kMarkerRestart0 + index % kRestartMarkerCount);
+        }
+    }
+
+    const sk_sp<SkData>       fHeader;
+    const sk_sp<SkData>       fJpeg;
+    const size_t              fBegin;
+    const size_t              fEnd;
+    const std::vector<size_t> fRestarts;  // offsets in fJpeg of the band's restart markers
+    const size_t              fLength;
+    size_t                    fPosition = 0;
+};
+
+// Writes a compressed JPEG to an SkWStream.
+struct DestinationMgr : jpeg_destination_mgr {
+    explicit DestinationMgr(SkWStream* stream) : fStream(stream) {
+        this->init_destination = &InitDestination;
+        this->empty_output_buffer = &EmptyOutputBuffer;
+        this->term_destination = &TermDestination;
+    }
+
+    static void InitDestination(j_compress_ptr cinfo) {
+        auto* dest = static_cast<DestinationMgr*>(cinfo->dest);
+        dest->next_output_byte = dest->fBuffer;
+        dest->free_in_buffer = kBufferSize;
+    }
+
+    static boolean EmptyOutputBuffer(j_compress_ptr cinfo) {
+        auto* dest = static_cast<DestinationMgr*>(cinfo->dest);
+        if (!dest->fStream->write(dest->fBuffer, kBufferSize)) {
+            ERREXIT(cinfo, JERR_FILE_WRITE);
+        }
+        InitDestination(cinfo);
+        return TRUE;
+    }
+
+    static void TermDestination(j_compress_ptr cinfo) {
+        auto* dest = static_cast<DestinationMgr*>(cinfo->dest);
+        if (!dest->fStream->write(dest->fBuffer, kBufferSize - dest->free_in_buffer)) {
+            ERREXIT(cinfo, JERR_FILE_WRITE);
+        }
+    }
+
+    static constexpr size_t kBufferSize = 16 * 1024;
+
+    SkWStream* const fStream;
+    uint8_t fBuffer[kBufferSize];
+};
+
+void output_message(j_common_ptr info) {
+#if defined(SK_PRINT_CODEC_MESSAGES)
+    char buffer[JMSG_LENGTH_MAX];
+    info->err->format_message(info, buffer);
+    SkCodecPrintf("libjpeg error %d <%s>\n", info->err->msg_code, buffer);
+#endif
+}
+
+// Compresses the coefficients read by dinfo, which owns them, with a restart marker at every row
+// of MCUs.
+sk_sp<SkData> write_coefficients(jpeg_decompress_struct* dinfo, jvirt_barray_ptr* coefficients) {
+    SkDynamicMemoryWStream stream;
+    DestinationMgr dest(&stream);
+    skjpeg_error_mgr errorMgr;
+    jpeg_compress_struct cinfo;
+    cinfo.err = jpeg_std_error(&errorMgr);
+    errorMgr.error_exit = skjpeg_err_exit;
+    errorMgr.output_message = output_message;
+    jpeg_create_compress(&cinfo);
+
+    bool success = false;
+    {
+        skjpeg_error_mgr::AutoPushJmpBuf jmp(&errorMgr);
+        if (!setjmp(jmp)) {
+            cinfo.dest = &dest;
+            jpeg_copy_critical_parameters(dinfo, &cinfo);
+            cinfo.restart_in_rows = 1;
+            jpeg_write_coefficients(&cinfo, coefficients);
+            jpeg_finish_compress(&cinfo);
+            success = true;
+        }
+    }
+    jpeg_destroy_compress(&cinfo);
+    return success ? stream.detachAsData() : nullptr;
+}
+
+}  // namespace
+
+// Where the parts of a JPEG that matter for splitting it are.
+struct SkJpegRestartBands::Layout {
+    sk_sp<SkData> fHeader;      // the segments a band needs, from SOI through SOS
+    size_t fHeightOffset = 0;   // of the frame's height in fHeader
+    size_t fEntropyStart = 0;   // offset of the first byte after the SOS segment
+    size_t fEndOfImage = 0;     // offset of the EOI marker
+    std::vector<size_t> fRestarts;  // offset of each RSTn marker in the entropy coded data
+    int fWidth = 0;
+    int fHeight = 0;
+    int fMCUWidth = 0;
+    int fMCUHeight = 0;
+    int fRestartInterval = 0;   // in MCUs
+    bool fUpsamplesVertically = false;
+
+    int64_t fMCUsPerRow = 0;
+    int64_t fMCURows = 0;
+    int64_t fIntervals = 0;
+    int64_t fMCURowStep = 0;    // bands may start at multiples of this many rows of MCUs
+
+    bool readHeaders(const uint8_t* data, size_t size);
+    bool readEntropyCodedData(const uint8_t* data, size_t size);
+};
+
+// Reads the segments up to the start of the scan, requiring a baseline (or extended sequential
+// Huffman) frame with a single scan of all its components, and a restart interval.
+bool SkJpegRestartBands::Layout::readHeaders(const uint8_t* data, size_t size) {
+    if (size < 4 || data[0] != 0xFF || data[1] != kJpegMarkerStartOfImage) {
+        return false;
+    }
+    SkDynamicMemoryWStream header;
+    header.write(data, kJpegMarkerCodeSize);
+    int components = 0;
+    size_t pos = 2;
+    for (;;) {
+        // Markers may be preceded by any number of fill bytes.
+        while (pos + 1 < size && data[pos] == 0xFF && data[pos + 1] == 0xFF) {
+            pos++;
+        }
+        if (pos + 4 > size || data[pos] != 0xFF) {
+            return false;
+        }
+        const uint8_t marker = data[pos + 1];
+        if (marker == 0x01 || (marker >= kMarkerRestart0 && marker <= kMarkerRestart7)) {
+            pos += 2;
+            continue;
+        }
+        if (marker == kJpegMarkerEndOfImage) {
+            return false;
+        }
+        const size_t length = read_u16(data + pos + 2);
+        if (length < 2 || pos + 2 + length > size) {
+            return false;
+        }
+        const uint8_t* params = data + pos + 4;
+
+        if (marker == kMarkerStartOfFrameBaseline || marker == kMarkerStartOfFrameExtended) {
+            // P, Y, X, Nf, then Nf components of C, H << 4 | V, Tq.
+            if (fWidth || length < 8 || params[0] != 8) {
+                return false;
+            }
+            fHeightOffset = header.bytesWritten() + 5;
+            fHeight = read_u16(params + 1);
+            fWidth = read_u16(params + 3);
+            components = params[5];
+            if (!fHeight || !fWidth || components < 1 || components > 4 ||
+                length != 8 + 3u * components) {
+                return false;
+            }
+            int maxH = 1, maxV = 1, minV = 4;
+            for (int i = 0; i < components; ++i) {
+                const int h = params[7 + 3 * i] >> 4, v = params[7 + 3 * i] & 0xF;
+                if (h < 1 || h > 4 || v < 1 || v > 4) {
+                    return false;
+                }
+                maxH = std::max(maxH, h);
+                maxV = std::max(maxV, v);
+                minV = std::min(minV, v);
+            }
+            // A scan of a single component has an MCU of one block, whatever its sampling.
+            fMCUWidth = components == 1 ? 8 : 8 * maxH;
+            fMCUHeight = components == 1 ? 8 : 8 * maxV;
+            fUpsamplesVertically = components > 1 && minV < maxV;
+        } else if (marker > kMarkerStartOfFrameExtended && marker <= kMarkerStartOfFrameLast &&
+                   marker != kMarkerDefineHuffmanTable && marker != kMarkerJPEGExtension &&
+                   marker != kMarkerDefineArithmeticConditioning) {
+            // Progressive, lossless, hierarchical or arithmetic coded frames.
+            return false;
+        } else if (marker == kMarkerDefineRestartInterval) {
+            if (length != 4) {
+                return false;
+            }
+            fRestartInterval = read_u16(params);
+        } else if (marker == kJpegMarkerStartOfScan) {
+            // A frame that is split over several scans can't be decoded a band at a time.
+            if (!fWidth || length < 3 || params[0] != components || fRestartInterval <= 0) {
+                return false;
+            }
+            header.write(data + pos, 2 + length);
+            fHeader = header.detachAsData();
+            fEntropyStart = pos + 2 + length;
+            return true;
+        }
+        if (band_needs_segment(marker)) {
+            header.write(data + pos, 2 + length);
+        }
+        pos += 2 + length;
+    }
+}
+
+// Finds the restart markers in the entropy coded data, and its end.
+bool SkJpegRestartBands::Layout::readEntropyCodedData(const uint8_t* data, size_t size) {
+    size_t pos = fEntropyStart;
+    for (;;) {
+        const void* ff = memchr(data + pos, 0xFF, size - pos);
+        if (!ff) {
+            return false;
+        }
+        pos = static_cast<const uint8_t*>(ff) - data;
+        if (pos + 1 >= size) {
+            return false;
+        }
+        const uint8_t next = data[pos + 1];
+        if (next == 0x00) {
+            // A stuffed 0xFF byte.
+            pos += 2;
+        } else if (next == 0xFF) {
+            // Fill before a marker.
+            pos += 1;
+        } else if (next >= kMarkerRestart0 && next <= kMarkerRestart7) {
+            if (next - kMarkerRestart0 != SkToInt(fRestarts.size() % kRestartMarkerCount)) {
+                return false;
+            }
+            fRestarts.push_back(pos);
+            pos += 2;
+        } else if (next == kJpegMarkerEndOfImage) {
+            fEndOfImage = pos;
+            return true;
+        } else {
+            // DNL, or more scans.
+            return false;
+        }
+    }
+}
+
+std::unique_ptr<SkJpegRestartBands> SkJpegRestartBands::Make(sk_sp<SkData> jpeg) {
+    if (!jpeg) {
+        return nullptr;
+    }
+    auto layout = std::make_unique<Layout>();
+    if (!layout->readHeaders(jpeg->bytes(), jpeg->size()) ||
+        !layout->readEntropyCodedData(jpeg->bytes(), jpeg->size())) {
+        return nullptr;
+    }
+
+    layout->fMCUsPerRow = (layout->fWidth + layout->fMCUWidth - 1) / layout->fMCUWidth;
+    layout->fMCURows = (layout->fHeight + layout->fMCUHeight - 1) / layout->fMCUHeight;
+    const int64_t interval = layout->fRestartInterval;
+    layout->fIntervals = (layout->fMCUsPerRow * layout->fMCURows + interval - 1) / interval;
+    if (SkToS64(layout->fRestarts.size()) != layout->fIntervals - 1) {
+        return nullptr;
+    }
+    // Bands may start at intervals that begin a row of MCUs.
+    const int64_t intervalStep = layout->fMCUsPerRow / std::gcd(interval, layout->fMCUsPerRow);
+    layout->fMCURowStep = intervalStep * interval / layout->fMCUsPerRow;
+
+    return std::unique_ptr<SkJpegRestartBands>(
+            new SkJpegRestartBands(std::move(jpeg), std::move(layout)));
+}
+
+std::unique_ptr<SkJpegRestartBands> SkJpegRestartBands::MakeReencoded(const SkData& jpeg) {
+    SkMemoryStream stream(jpeg.data(), jpeg.size(), /*copyData=*/false);
+    JpegDecoderMgr decoderMgr(&stream);
+    skjpeg_error_mgr::AutoPushJmpBuf jmp(decoderMgr.errorMgr());
+    if (setjmp(jmp)) {
+        return nullptr;
+    }
+    decoderMgr.init();
+    jpeg_decompress_struct* dinfo = decoderMgr.dinfo();
+    if (jpeg_read_header(dinfo, TRUE) != JPEG_HEADER_OK || dinfo->data_precision != 8 ||
+        (dinfo->jpeg_color_space != JCS_YCbCr && dinfo->jpeg_color_space != JCS_GRAYSCALE)) {
+        return nullptr;
+    }
+    // Corrupt or truncated data would be re-encoded as if it were complete, which decodes
+    // differently.
+    jvirt_barray_ptr* coefficients = jpeg_read_coefficients(dinfo);
+    if (!coefficients || dinfo->err->num_warnings > 0) {
+        return nullptr;
+    }
+    return Make(write_coefficients(dinfo, coefficients));
+}
+
+SkJpegRestartBands::SkJpegRestartBands(sk_sp<SkData> jpeg, std::unique_ptr<Layout> layout)
+        : fData(std::move(jpeg)), fLayout(std::move(layout)), fHeight(fLayout->fHeight) {}
+
+SkJpegRestartBands::~SkJpegRestartBands() = default;
+
+SkJpegBand SkJpegRestartBands::makeBand(int firstMCURow, int endMCURow) const {
+    const Layout& layout = *fLayout;
+    const int64_t interval = layout.fRestartInterval;
+    auto rowOf = [&](int64_t mcuRow) {
+        return SkToInt(std::min<int64_t>(layout.fHeight, mcuRow * layout.fMCUHeight));
+    };
+
+    // Fancy upsampling blends each row of chroma with the rows next to it, so when chroma is
+    // subsampled vertically, also decode the MCU rows around the band: from a start before it,
+    // and one past its end.
+    int64_t streamFirstMCURow = firstMCURow, streamEndMCURow = endMCURow;
+    if (layout.fUpsamplesVertically) {
+        streamFirstMCURow = std::max<int64_t>(0, streamFirstMCURow - 1);
+        streamEndMCURow = std::min(layout.fMCURows, streamEndMCURow + 1);
+    }
+    streamFirstMCURow -= streamFirstMCURow % layout.fMCURowStep;
+    const int64_t firstInterval = streamFirstMCURow * layout.fMCUsPerRow / interval;
+    const int64_t endInterval = std::min(
+            layout.fIntervals, (streamEndMCURow * layout.fMCUsPerRow + interval - 1) / interval);
+
+    const size_t begin = firstInterval == 0 ? layout.fEntropyStart
+                                            : layout.fRestarts[firstInterval - 1] + 2;
+    const size_t end = endInterval == layout.fIntervals ? layout.fEndOfImage
+                                                        : layout.fRestarts[endInterval - 1];
+    std::vector<size_t> restarts(layout.fRestarts.begin() + firstInterval,
+                                 layout.fRestarts.begin() + (endInterval - 1));
+
+    // The band's image is only as tall as the rows it has.
+    const int streamTop = rowOf(streamFirstMCURow);
+    const int streamHeight = rowOf(streamEndMCURow) - streamTop;
+    sk_sp<SkData> header = SkData::MakeWithCopy(layout.fHeader->data(), layout.fHeader->size());
+    uint8_t* height = static_cast<uint8_t*>(header->writable_data()) + layout.fHeightOffset;
+    height[0] = SkToU8(streamHeight >> 8);
+    height[1] = SkToU8(streamHeight & 0xFF);
+
+    SkJpegBand band;
+    band.fStream = std::make_unique<BandStream>(
+            std::move(header), fData, begin, end, std::move(restarts));
+    band.fTop = rowOf(firstMCURow);
+    band.fHeight = rowOf(endMCURow) - band.fTop;
+    band.fSkipRows = band.fTop - streamTop;
+    return band;
+}
+
+std::vector<SkJpegBand> SkJpegRestartBands::split(int maxBands) const {
+    const Layout& layout = *fLayout;
+    const int64_t starts = (layout.fMCURows + layout.fMCURowStep - 1) / layout.fMCURowStep;
+    const int64_t bandCount = std::min<int64_t>(maxBands, starts);
+    if (bandCount < 2) {
+        return {};
+    }
+    std::vector<SkJpegBand> bands;
+    bands.reserve(bandCount);
+    for (int64_t b = 0; b < bandCount; ++b) {
+        const int64_t firstMCURow = (b * starts / bandCount) * layout.fMCURowStep;
+        const int64_t endMCURow = b + 1 < bandCount
+                                          ? ((b + 1) * starts / bandCount) * layout.fMCURowStep
+                                          : layout.fMCURows;
+        bands.push_back(this->makeBand(SkToInt(firstMCURow), SkToInt(endMCURow)));
+    }
+    return bands;
+}
+
+SkJpegBand SkJpegRestartBands::band(int top, int bottom) const {
+    SkASSERT(0 <= top && top < bottom && bottom <= fHeight);
+    const int mcuHeight = fLayout->fMCUHeight;
+    SkJpegBand band = this->makeBand(top / mcuHeight, (bottom + mcuHeight - 1) / mcuHeight);
+    // The band's own rows may start and end within its rows of MCUs.
+    band.fSkipRows += top - band.fTop;
+    band.fTop = top;
+    band.fHeight = bottom - top;
+    return band;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkJpegRestartBands_codec_DEFINED
+#define SkJpegRestartBands_codec_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkStream.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/*
+ * A horizontal band of a JPEG image, as a standalone JPEG that can be decoded on its own.
+ */
+struct SkJpegBand {
+    // A JPEG with the original's tables, whose image is the original's rows starting at
+    // fTop - fSkipRows.
+    std::unique_ptr<SkStreamAsset> fStream;
+    // The first row of the original image that this band decodes.
+    int fTop = 0;
+    // The number of rows of the original image that this band decodes.
+    int fHeight = 0;
+    // Rows at the top of fStream's image to skip before the band's own rows. They are decoded
+    // only so that vertically upsampled chroma matches decoding the whole image. Likewise fStream's
+    // image may continue below the band's own rows.
+    int fSkipRows = 0;
+};
+
+/*
+ * The restart intervals of a baseline, single scan JPEG. Since the entropy coded data of each
+ * interval can be decoded without the intervals before it, a band of the image can be decoded
+ * from any restart marker that begins a row of MCUs, without decoding the rows above it.
+ *
+ * Bands read the original data, renumbering their restart markers to start from RST0, and carry
+ * only the segments that affect decoding pixels. In particular, they have no ICC profile.
+ */
+class SkJpegRestartBands {
+public:
+    /*
+     * Returns nullptr unless jpeg is a baseline (or extended sequential Huffman) JPEG with a
+     * single scan of all its components and restart markers.
+     */
+    static std::unique_ptr<SkJpegRestartBands> Make(sk_sp<SkData> jpeg);
+
+    /*
+     * Losslessly re-encodes a YCbCr or grayscale JPEG, which may be progressive or have no restart
+     * markers, as a baseline JPEG with a restart marker at every row of MCUs. It decodes to the
+     * same pixels. This entropy decodes the whole image, and holds its DCT coefficients (about 3
+     * bytes per pixel, for 4:2:0) while it does.
+     */
+    static std::unique_ptr<SkJpegRestartBands> MakeReencoded(const SkData& jpeg);
+
+    ~SkJpegRestartBands();
+
+    int height() const { return fHeight; }
+
+    /*
+     * Splits the image into at most maxBands bands of similar heights, which cover it from top
+     * to bottom. Returns fewer than two bands if the image is too short to split.
+     */
+    std::vector<SkJpegBand> split(int maxBands) const;
+
+    /*
+     * Returns a band that decodes rows [top, bottom) of the image, starting from the last
+     * restart marker above them that it can.
+     */
+    SkJpegBand band(int top, int bottom) const;
+
+private:
+    struct Layout;
+
+    SkJpegRestartBands(sk_sp<SkData> jpeg, std::unique_ptr<Layout>);
+
+    SkJpegBand makeBand(int firstMCURow, int endMCURow) const;
+
+    const sk_sp<SkData>           fData;
+    const std::unique_ptr<Layout> fLayout;
+    const int                     fHeight;
+};
+
+#endif  // SkJpegRestartBands_codec_DEFINED
@@ -0,0 +1,1091 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/codec/SkStreamingFrameReader.h"
+
+#include "include/codec/SkCodecAnimation.h"
+#include "include/core/SkData.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkStream.h"
+#include "include/private/SkEncodedInfo.h"
+#include "include/private/base/SkAssert.h"
+#include "include/private/base/SkTo.h"
+#include "src/codec/SkFrameHolder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// How much to ask the stream for at a time.
+constexpr size_t kReadSize = 16 * 1024;
+
+// Ancillary chunks (PNG's PLTE, iCCP etc., WebP's ICCP) are held, to copy into each frame. Larger
+// ones are dropped rather than buffered.
+constexpr size_t kMaxHeldChunk = 1 << 20;
+
+uint32_t get_le16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+uint32_t get_le24(const uint8_t* p) { return p[0] | (p[1] << 8) | (p[2] << 16); }
+uint32_t get_le32(const uint8_t* p) { return get_le24(p) | ((uint32_t)p[3] << 24); }
+uint32_t get_be16(const uint8_t* p) { return (p[0] << 8) | p[1]; }
+uint32_t get_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+void put_le16(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; }
+void put_le24(uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; }
+void put_le32(uint8_t* p, uint32_t v) { put_le24(p, v); p[3] = v >> 24; }
+void put_be32(uint8_t* p, uint32_t v) { p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v; }
+
+constexpr std::array<uint32_t, 256> make_crc_table() {
+    std::array<uint32_t, 256> table = {};
+    for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; ++k) {
+            c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+        }
+        table[n] = c;
+    }
+    return table;
+}
+
+constexpr std::array<uint32_t, 256> kCRCTable = make_crc_table();
+
+// The CRC of PNG chunks, which starts at, and is finished by xoring with, 0xFFFFFFFF.
+uint32_t update_crc(uint32_t crc, const uint8_t* bytes, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        crc = kCRCTable[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+class Frame final : public SkFrame {
+public:
+    Frame(int id, SkEncodedInfo::Alpha alpha)
+        : SkFrame(id)
+        , fReportedAlpha(alpha)
+    {}
+
+    bool          fFullyReceived = false;
+    sk_sp<SkData> fData;
+
+protected:
+    SkEncodedInfo::Alpha onReportedAlpha() const override { return fReportedAlpha; }
+
+private:
+    const SkEncodedInfo::Alpha fReportedAlpha;
+};
+
+class FrameIndex final : public SkFrameHolder {
+public:
+    void setScreenSize(int width, int height) {
+        fScreenWidth = width;
+        fScreenHeight = height;
+    }
+
+    int count() const { return SkToInt(fFrames.size()); }
+
+    Frame* frame(int i) { return fFrames[i].get(); }
+    const Frame* frame(int i) const { return fFrames[i].get(); }
+
+    Frame* append(SkEncodedInfo::Alpha alpha, SkIRect rect,
+                  SkCodecAnimation::DisposalMethod disposalMethod, int duration,
+                  SkCodecAnimation::Blend blend) {
+        auto frame = std::make_unique<Frame>(this->count(), alpha);
+        if (!rect.intersect(SkIRect::MakeWH(fScreenWidth, fScreenHeight))) {
+            rect.setEmpty();
+        }
+        frame->setXYWH(rect.x(), rect.y(), rect.width(), rect.height());
+        frame->setDisposalMethod(disposalMethod);
+        frame->setDuration(duration);
+        frame->setBlend(blend);
+        this->setAlphaAndRequiredFrame(frame.get());
+        fFrames.push_back(std::move(frame));
+        return fFrames.back().get();
+    }
+
+protected:
+    const SkFrame* onGetFrame(int i) const override { return fFrames[i].get(); }
+
+private:
+    std::vector<std::unique_ptr<Frame>> fFrames;
+};
+
+class StreamingFrameReader;
+
+// Reads the structures of one format. parse() reads as many as are buffered, and returns
+// kIncompleteInput when it needs more bytes, or has asked the reader to pass a payload through.
+class FormatParser {
+public:
+    virtual ~FormatParser() = default;
+
+    virtual SkCodec::Result parse(StreamingFrameReader*) = 0;
+
+    // Wraps the bytes written for a frame, if they are not yet a whole image.
+    virtual sk_sp<SkData> finishFrameData(sk_sp<SkData> data, const Frame&) { return data; }
+};
+
+class StreamingFrameReader final : public SkStreamingFrameReader {
+public:
+    StreamingFrameReader(std::unique_ptr<SkStream> stream, const Options& options)
+        : fStream(std::move(stream))
+        , fKeepFrameData(options.fKeepFrameData) {}
+
+    SkCodec::Result read() override;
+
+    bool hasHeader() const override { return fHasHeader; }
+    SkEncodedImageFormat getEncodedFormat() const override { return fFormat; }
+
+    SkISize dimensions() const override {
+        return {fFrames.screenWidth(), fFrames.screenHeight()};
+    }
+
+    int getRepetitionCount() const override { return fRepetitionCount; }
+    int getFrameCount() const override { return fFrames.count(); }
+
+    bool getFrameInfo(int index, SkCodec::FrameInfo* info) const override {
+        if (index < 0 || index >= fFrames.count()) {
+            return false;
+        }
+        if (info) {
+            const Frame* frame = fFrames.frame(index);
+            frame->fillIn(info, frame->fFullyReceived);
+        }
+        return true;
+    }
+
+    sk_sp<SkData> takeFrameData(int index) override {
+        if (index < 0 || index >= fFrames.count()) {
+            return nullptr;
+        }
+        return std::move(fFrames.frame(index)->fData);
+    }
+
+    // For the FormatParsers.
+
+    // Returns the next |size| bytes, if they have been buffered. Does not consume them.
+    const uint8_t* peek(size_t size) const {
+        return fBuffer.size() - fPos >= size ? fBuffer.data() + fPos : nullptr;
+    }
+
+    void consume(size_t size) {
+        SkASSERT(size <= fBuffer.size() - fPos);
+        fPos += size;
+    }
+
+    enum class Sink {
+        kDiscard,
+        kFrame,         // Append to the current frame's bytes.
+        kFrameWithCRC,  // Same, and add to the CRC of the PNG chunk being written.
+    };
+
+    // Moves the next |size| bytes from the stream to |sink|, without buffering them all.
+    void pass(size_t size, Sink sink) {
+        fPassRemaining = size;
+        fPassSink = sink;
+    }
+
+    bool isPassing() const { return fPassRemaining > 0; }
+
+    // Starts keeping the bytes written for the next frame, if they are kept, before the frame
+    // itself is known.
+    void beginFrameData() { fWritingFrame = fKeepFrameData; }
+
+    bool isWritingFrame() const { return fWritingFrame; }
+
+    // Appends to the current frame's bytes, if they are kept.
+    void write(const void* bytes, size_t size) {
+        if (fWritingFrame) {
+            fFrameBytes.write(bytes, size);
+        }
+    }
+
+    // Writes the CRC of the PNG chunk whose payload was passed with kFrameWithCRC.
+    void startCRC(const uint8_t type[4]) { fCRC = update_crc(0xFFFFFFFF, type, 4); }
+    void writeCRC() {
+        uint8_t crc[4];
+        put_be32(crc, fCRC ^ 0xFFFFFFFF);
+        this->write(crc, sizeof(crc));
+    }
+
+    void setHeader(SkEncodedImageFormat format, int width, int height) {
+        fFormat = format;
+        fFrames.setScreenSize(width, height);
+    }
+    void setHasHeader() { fHasHeader = true; }
+    void setRepetitionCount(int count) { fRepetitionCount = count; }
+
+    bool hasCurrentFrame() const { return fCurrentFrame; }
+
+    // Starts a frame, whose bytes the parser then writes.
+    Frame* startFrame(SkEncodedInfo::Alpha alpha, SkIRect rect,
+                      SkCodecAnimation::DisposalMethod disposalMethod, int duration,
+                      SkCodecAnimation::Blend blend) {
+        SkASSERT(!fCurrentFrame);
+        fCurrentFrame = fFrames.append(alpha, rect, disposalMethod, duration, blend);
+        this->beginFrameData();
+        return fCurrentFrame;
+    }
+
+    void finishFrame() {
+        SkASSERT(fCurrentFrame);
+        if (fWritingFrame) {
+            fCurrentFrame->fData = fParser->finishFrameData(fFrameBytes.detachAsData(),
+                                                            *fCurrentFrame);
+        }
+        fCurrentFrame->fFullyReceived = true;
+        fCurrentFrame = nullptr;
+        fWritingFrame = false;
+    }
+
+private:
+    // Reads what the stream has available, after dropping the consumed bytes. Returns whether
+    // it read anything.
+    bool fill();
+
+    SkCodec::Result detectFormat();
+
+    const std::unique_ptr<SkStream> fStream;
+    const bool                      fKeepFrameData;
+
+    std::unique_ptr<FormatParser>   fParser;
+    SkCodec::Result                 fResult = SkCodec::kIncompleteInput;
+
+    std::vector<uint8_t>            fBuffer;
+    size_t                          fPos = 0;
+
+    size_t                          fPassRemaining = 0;
+    Sink                            fPassSink = Sink::kDiscard;
+    uint32_t                        fCRC = 0;
+
+    bool                            fHasHeader = false;
+    SkEncodedImageFormat            fFormat = SkEncodedImageFormat::kPNG;
+    int                             fRepetitionCount = 0;
+    FrameIndex                      fFrames;
+
+    Frame*                          fCurrentFrame = nullptr;
+    bool                            fWritingFrame = false;
+    SkDynamicMemoryWStream          fFrameBytes;
+};
+
+using Sink = StreamingFrameReader::Sink;
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// GIF
+
+class GifParser final : public FormatParser {
+public:
+    SkCodec::Result parse(StreamingFrameReader*) override;
+
+private:
+    enum class State {
+        kScreen,
+        kGlobalColorTable,
+        kBlock,
+        kExtension,
+        kImage,
+        kImageData,
+    };
+
+    State                fState = State::kScreen;
+    uint8_t              fScreen[7];  // The logical screen descriptor.
+    std::vector<uint8_t> fGlobalColorTable;
+    uint8_t              fExtensionLabel = 0;
+    bool                 fFirstSubBlock = false;
+    bool                 fLoopExtension = false;
+    bool                 fSawLoopCount = false;
+
+    // The graphic control extension of the next image.
+    bool                 fHasControl = false;
+    uint8_t              fControlFlags = 0;
+    uint32_t             fDelay = 0;
+    uint8_t              fTransparentIndex = 0;
+};
+
+static size_t gif_color_table_size(uint8_t flags) {
+    return flags & 0x80 ? 3 << ((flags & 7) + 1) : 0;
+}
+
+SkCodec::Result GifParser::parse(StreamingFrameReader* reader) {
+    while (!reader->isPassing()) {
+        switch (fState) {
+            case State::kScreen: {
+                // The signature, then the logical screen descriptor.
+                const uint8_t* p = reader->peek(13);
+                if (!p) {
+                    return SkCodec::kIncompleteInput;
+                }
+                memcpy(fScreen, p + 6, sizeof(fScreen));
+                reader->setHeader(SkEncodedImageFormat::kGIF, get_le16(p + 6), get_le16(p + 8));
+                // As Wuffs does, report that an image without a loop count repeats forever,
+                // until it turns out to have a second frame.
+                reader->setRepetitionCount(SkCodec::kRepetitionCountInfinite);
+                reader->setHasHeader();
+                reader->consume(13);
+                fGlobalColorTable.resize(gif_color_table_size(fScreen[4]));
+                fState = State::kGlobalColorTable;
+                break;
+            }
+            case State::kGlobalColorTable: {
+                const uint8_t* p = reader->peek(fGlobalColorTable.size());
+                if (!p) {
+                    return SkCodec::kIncompleteInput;
+                }
+                std::copy_n(p, fGlobalColorTable.size(), fGlobalColorTable.data());
+                reader->consume(fGlobalColorTable.size());
+                fState = State::kBlock;
+                break;
+            }
+            case State::kBlock: {
+                const uint8_t* p = reader->peek(1);
+                if (!p) {
+                    return SkCodec::kIncompleteInput;
+                }
+                if (p[0] == 0x3B) {  // The trailer.
+                    reader->consume(1);
+                    return SkCodec::kSuccess;
+                }
+                if (p[0] == 0x21) {
+                    if (!(p = reader->peek(2))) {
+                        return SkCodec::kIncompleteInput;
+                    }
+                    fExtensionLabel = p[1];
+                    fFirstSubBlock = true;
+                    fLoopExtension = false;
+                    reader->consume(2);
+                    fState = State::kExtension;
+                    break;
+                }
+                if (p[0] == 0x2C) {
+                    fState = State::kImage;
+                    break;
+                }
+                return SkCodec::kErrorInInput;
+            }
+            case State::kExtension: {
+                const uint8_t* p = reader->peek(1);
+                if (!p || !(p = reader->peek(1 + p[0]))) {
+                    return SkCodec::kIncompleteInput;
+                }
+                const size_t size = p[0];
+                if (size == 0) {
+                    reader->consume(1);
+                    fState = State::kBlock;
+                    break;
+                }
+                if (fFirstSubBlock) {
+                    if (fExtensionLabel == 0xF9 && size >= 4) {
+                        fHasControl = true;
+                        fControlFlags = p[1];
+                        fDelay = get_le16(p + 2);
+                        fTransparentIndex = p[4];
+                    } else if (fExtensionLabel == 0xFF && size == 11) {
+                        fLoopExtension = !memcmp(p + 1, "NETSCAPE2.0", 11) ||
+                                         !memcmp(p + 1, "ANIMEXTS1.0", 11);
+                    }
+                } else if (fLoopExtension && size >= 3 && p[1] == 1) {
+                    const int loops = get_le16(p + 2);
+                    fSawLoopCount = true;
+                    reader->setRepetitionCount(loops ? loops : SkCodec::kRepetitionCountInfinite);
+                }
+                fFirstSubBlock = false;
+                reader->consume(1 + size);
+                break;
+            }
+            case State::kImage: {
+                // The image descriptor, its local color table and LZW minimum code size.
+                const uint8_t* p = reader->peek(10);
+                if (!p) {
+                    return SkCodec::kIncompleteInput;
+                }
+                const size_t size = 10 + gif_color_table_size(p[9]) + 1;
+                if (!(p = reader->peek(size))) {
+                    return SkCodec::kIncompleteInput;
+                }
+                const uint32_t width = get_le16(p + 5), height = get_le16(p + 7);
+                if (!fSawLoopCount && reader->getFrameCount() == 1) {
+                    reader->setRepetitionCount(0);
+                }
+
+                using DisposalMethod = SkCodecAnimation::DisposalMethod;
+                DisposalMethod disposalMethod = DisposalMethod::kKeep;
+                switch ((fControlFlags >> 2) & 7) {
+                    case 2: disposalMethod = DisposalMethod::kRestoreBGColor;  break;
+                    case 3: disposalMethod = DisposalMethod::kRestorePrevious; break;
+                }
+                const bool transparent = fHasControl && (fControlFlags & 1);
+                reader->startFrame(transparent ? SkEncodedInfo::kUnpremul_Alpha
+                                               : SkEncodedInfo::kOpaque_Alpha,
+                                   SkIRect::MakeXYWH(get_le16(p + 1), get_le16(p + 3),
+                                                     width, height),
+                                   disposalMethod, fDelay * 10, SkCodecAnimation::Blend::kSrcOver);
+
+                if (reader->isWritingFrame()) {
+                    // A still GIF the size of the frame, with the frame at its origin.
+                    uint8_t screen[13];
+                    memcpy(screen, "GIF89a", 6);
+                    memcpy(screen + 6, fScreen, sizeof(fScreen));
+                    put_le16(screen + 6, width);
+                    put_le16(screen + 8, height);
+                    reader->write(screen, sizeof(screen));
+                    reader->write(fGlobalColorTable.data(), fGlobalColorTable.size());
+                    if (transparent) {
+                        const uint8_t control[] = {0x21, 0xF9, 4, 1, 0, 0, fTransparentIndex, 0};
+                        reader->write(control, sizeof(control));
+                    }
+                    uint8_t image[10];
+                    memcpy(image, p, sizeof(image));
+                    put_le16(image + 1, 0);
+                    put_le16(image + 3, 0);
+                    reader->write(image, sizeof(image));
+                    reader->write(p + 10, size - 10);
+                }
+                reader->consume(size);
+                fHasControl = false;
+                fControlFlags = 0;
+                fDelay = 0;
+                fState = State::kImageData;
+                break;
+            }
+            case State::kImageData: {
+                const uint8_t* p = reader->peek(1);
+                if (!p || !(p = reader->peek(1 + p[0]))) {
+                    return SkCodec::kIncompleteInput;
+                }
+                const size_t size = 1 + p[0];
+                reader->write(p, size);
+                reader->consume(size);
+                if (size == 1) {
+                    const uint8_t trailer = 0x3B;
+                    reader->write(&trailer, 1);
+                    reader->finishFrame();
+                    fState = State::kBlock;
+                }
+                break;
+            }
+        }
+    }
+    return SkCodec::kIncompleteInput;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// WebP
+
+class WebpParser final : public FormatParser {
+public:
+    SkCodec::Result parse(StreamingFrameReader*) override;
+
+    sk_sp<SkData> finishFrameData(sk_sp<SkData>, const Frame&) override;
+
+private:
+    enum class State {
+        kHeader,
+        kChunk,
+        kStillImageEnd,
+        kFrameChunk,
+    };
+
+    // Reads the start of a VP8 or VP8L chunk, to find the image's dimensions and whether it has
+    // alpha. Returns false if there aren't enough bytes yet.
+    bool readImageHeader(StreamingFrameReader*, const uint8_t* chunk, uint32_t size,
+                         SkISize* dimensions, bool* hasAlpha, bool* valid);
+
+    State                fState = State::kHeader;
+    uint64_t             fRiffRemaining = 0;
+    bool                 fExtended = false;
+    std::vector<uint8_t> fICCChunk;
+    bool                 fSawAlphaChunk = false;
+
+    // The ANMF chunk being read.
+    uint64_t             fFrameRemaining = 0;
+    SkIRect              fFrameRect;
+    int                  fFrameDuration = 0;
+    uint8_t              fFrameFlags = 0;
+};
+
+bool WebpParser::readImageHeader(StreamingFrameReader* reader, const uint8_t* chunk,
+                                 uint32_t size, SkISize* dimensions, bool* hasAlpha,
+                                 bool* valid) {
+    *valid = true;
+    if (!memcmp(chunk, "VP8L", 4)) {
+        const uint8_t* p = reader->peek(8 + std::min<uint32_t>(size, 5));
+        if (!p) {
+            return false;
+        }
+        if (size < 5 || p[8] != 0x2F) {
+            *valid = false;
+            return true;
+        }
+        // 14 bits of width - 1, 14 bits of height - 1, then whether alpha is used.
+        const uint32_t bits = get_le32(p + 9);
+        *dimensions = {SkToInt((bits & 0x3FFF) + 1), SkToInt(((bits >> 14) & 0x3FFF) + 1)};
+        *hasAlpha = (bits >> 28) & 1;
+        return true;
+    }
+    const uint8_t* p = reader->peek(8 + std::min<uint32_t>(size, 10));
+    if (!p) {
+        return false;
+    }
+    // A frame tag, the start code, then 14 bits each of width and height.
+    if (size < 10 || memcmp(p + 11, "\x9D\x01\x2A", 3)) {
+        *valid = false;
+        return true;
+    }
+    *dimensions = {SkToInt(get_le16(p + 14) & 0x3FFF), SkToInt(get_le16(p + 16) & 0x3FFF)};
+    *hasAlpha = false;
+    return true;
+}
+
+SkCodec::Result WebpParser::parse(StreamingFrameReader* reader) {
+    while (!reader->isPassing()) {
+        switch (fState) {
+            case State::kHeader: {
+                const uint8_t* p = reader->peek(12);
+                if (!p) {
+                    return SkCodec::kIncompleteInput;
+                }
+                fRiffRemaining = get_le32(p + 4);
+                if (fRiffRemaining < 4) {
+                    return SkCodec::kErrorInInput;
+                }
+                fRiffRemaining -= 4;
+                reader->consume(12);
+                fState = State::kChunk;
+                break;
+            }
+            case State::kStillImageEnd:
+                reader->finishFrame();
+                fState = State::kChunk;
+                break;
+            case State::kChunk: {
+                if (fRiffRemaining < 8) {
+                    // Ignore any bytes after the RIFF container.
+                    return SkCodec::kSuccess;
+                }
+                const uint8_t* p = reader->peek(8);
+                if (!p) {
+                    return SkCodec::kIncompleteInput;
+                }
+                const uint32_t size = get_le32(p + 4);
+                const uint64_t paddedSize = (uint64_t)size + (size & 1);
+                if (8 + paddedSize > fRiffRemaining) {
+                    return SkCodec::kErrorInInput;
+                }
+
+                if (!memcmp(p, "VP8X", 4) || !memcmp(p, "ANIM", 4)) {
+                    if (!(p = reader->peek(8 + paddedSize))) {
+                        return SkCodec::kIncompleteInput;
+                    }
+                    if (!memcmp(p, "VP8X", 4)) {
+                        if (size < 10) {
+                            return SkCodec::kErrorInInput;
+                        }
+                        fExtended = true;
+                        reader->setHeader(SkEncodedImageFormat::kWEBP, get_le24(p + 12) + 1,
+                                          get_le24(p + 15) + 1);
+                        if (!(p[8] & 0x02)) {
+                            // Animated images also need the ANIM chunk.
+                            reader->setHasHeader();
+                        }
+                    } else if (size >= 6) {
+                        const int loops = get_le16(p + 12);
+                        reader->setRepetitionCount(loops ? loops - 1
+                                                         : SkCodec::kRepetitionCountInfinite);
+                        reader->setHasHeader();
+                    }
+                    reader->consume(8 + paddedSize);
+                } else if (!memcmp(p, "ICCP", 4) && paddedSize <= kMaxHeldChunk) {
+                    if (!(p = reader->peek(8 + paddedSize))) {
+                        return SkCodec::kIncompleteInput;
+                    }
+                    fICCChunk.assign(p, p + 8 + paddedSize);
+                    reader->consume(8 + paddedSize);
+                } else if (!memcmp(p, "ANMF", 4)) {
+                    if (size < 16) {
+                        return SkCodec::kErrorInInput;
+                    }
+                    if (!(p = reader->peek(24))) {
+                        return SkCodec::kIncompleteInput;
+                    }
+                    fFrameRect = SkIRect::MakeXYWH(2 * get_le24(p + 8), 2 * get_le24(p + 11),
+                                                   get_le24(p + 14) + 1, get_le24(p + 17) + 1);
+                    fFrameDuration = get_le24(p + 20);
+                    fFrameFlags = p[23];
+                    fFrameRemaining = paddedSize - 16;
+                    fSawAlphaChunk = false;
+                    reader->consume(24);
+                    reader->beginFrameData();
+                    fState = State::kFrameChunk;
+                } else if (!memcmp(p, "ALPH", 4)) {
+                    fSawAlphaChunk = true;
+                    reader->beginFrameData();
+                    reader->write(p, 8);
+                    reader->consume(8);
+                    reader->pass(paddedSize, Sink::kFrame);
+                } else if (!memcmp(p, "VP8 ", 4) || !memcmp(p, "VP8L", 4)) {
+                    if (reader->hasCurrentFrame()) {
+                        return SkCodec::kErrorInInput;
+                    }
+                    SkISize dimensions;
+                    bool hasAlpha, valid;
+                    if (!this->readImageHeader(reader, p, size, &dimensions, &hasAlpha, &valid)) {
+                        return SkCodec::kIncompleteInput;
+                    }
+                    if (!valid) {
+                        return SkCodec::kErrorInInput;
+                    }
+                    if (!fExtended) {
+                        reader->setHeader(SkEncodedImageFormat::kWEBP, dimensions.width(),
+                                          dimensions.height());
+                        reader->setHasHeader();
+                    }
+                    hasAlpha |= fSawAlphaChunk;
+                    reader->startFrame(hasAlpha ? SkEncodedInfo::kUnpremul_Alpha
+                                                : SkEncodedInfo::kOpaque_Alpha,
+                                       SkIRect::MakeSize(reader->dimensions()),
+                                       SkCodecAnimation::DisposalMethod::kKeep, 0,
+                                       SkCodecAnimation::Blend::kSrcOver);
+                    // The ALPH chunk came before the frame started.
+                    fSawAlphaChunk = false;
+                    reader->write(p, 8);
+                    reader->consume(8);
+                    reader->pass(paddedSize, Sink::kFrame);
+                    fState = State::kStillImageEnd;
+                } else {
+                    reader->consume(8);
+                    reader->pass(paddedSize, Sink::kDiscard);
+                }
+                fRiffRemaining -= 8 + paddedSize;
+                break;
+            }
+            case State::kFrameChunk: {
+                if (fFrameRemaining < 8) {
+                    const uint8_t* p = reader->peek(fFrameRemaining);
+                    if (!p) {
+                        return SkCodec::kIncompleteInput;
+                    }
+                    reader->consume(fFrameRemaining);
+                    if (!reader->hasCurrentFrame()) {
+                        return SkCodec::kErrorInInput;
+                    }
+                    reader->finishFrame();
+                    fState = State::kChunk;
+                    break;
+                }
+                const uint8_t* p = reader->peek(8);
+                if (!p) {
+                    return SkCodec::kIncompleteInput;
+                }
+                const uint32_t size = get_le32(p + 4);
+                const uint64_t paddedSize = (uint64_t)size + (size & 1);
+                if (8 + paddedSize > fFrameRemaining) {
+                    return SkCodec::kErrorInInput;
+                }
+                if (!memcmp(p, "ALPH", 4)) {
+                    fSawAlphaChunk = true;
+                    reader->write(p, 8);
+                    reader->consume(8);
+                    reader->pass(paddedSize, Sink::kFrame);
+                } else if (!memcmp(p, "VP8 ", 4) || !memcmp(p, "VP8L", 4)) {
+                    if (reader->hasCurrentFrame()) {
+                        return SkCodec::kErrorInInput;
+                    }
+                    SkISize dimensions;
+                    bool hasAlpha, valid;
+                    if (!this->readImageHeader(reader, p, size, &dimensions, &hasAlpha, &valid)) {
+                        return SkCodec::kIncompleteInput;
+                    }
+                    if (!valid) {
+                        return SkCodec::kErrorInInput;
+                    }
+                    hasAlpha |= fSawAlphaChunk;
+                    reader->startFrame(hasAlpha ? SkEncodedInfo::kUnpremul_Alpha
+                                                : SkEncodedInfo::kOpaque_Alpha,
+                                       fFrameRect,
+                                       fFrameFlags & 1
+                                               ? SkCodecAnimation::DisposalMethod::kRestoreBGColor
+                                               : SkCodecAnimation::DisposalMethod::kKeep,
+                                       fFrameDuration,
+                                       fFrameFlags & 2 ? SkCodecAnimation::Blend::kSrc
+                                                       : SkCodecAnimation::Blend::kSrcOver);
+                    reader->write(p, 8);
+                    reader->consume(8);
+                    reader->pass(paddedSize, Sink::kFrame);
+                } else {
+                    reader->consume(8);
+                    reader->pass(paddedSize, Sink::kDiscard);
+                }
+                fFrameRemaining -= 8 + paddedSize;
+                break;
+            }
+        }
+    }
+    return SkCodec::kIncompleteInput;
+}
+
+sk_sp<SkData> WebpParser::finishFrameData(sk_sp<SkData> body, const Frame& frame) {
+    // A still, extended WebP the size of the frame, with its color profile.
+    uint8_t header[30];
+    memcpy(header, "RIFF", 4);
+    put_le32(header + 4, SkToU32(sizeof(header) - 8 + fICCChunk.size() + body->size()));
+    memcpy(header + 8, "WEBPVP8X", 8);
+    put_le32(header + 16, 10);
+    header[20] = (frame.reportedAlpha() != SkEncodedInfo::kOpaque_Alpha ? 0x10 : 0) |
+                 (fICCChunk.empty() ? 0 : 0x20);
+    header[21] = header[22] = header[23] = 0;
+    // The frame's rectangle may have been clipped, so the size comes from its bitstream.
+    const uint8_t* chunk = body->bytes();
+    if (!memcmp(chunk, "ALPH", 4)) {
+        const uint32_t size = get_le32(chunk + 4);
+        chunk += 8 + size + (size & 1);
+    }
+    uint32_t width, height;
+    if (!memcmp(chunk, "VP8L", 4)) {
+        const uint32_t bits = get_le32(chunk + 9);
+        width = (bits & 0x3FFF) + 1;
+        height = ((bits >> 14) & 0x3FFF) + 1;
+    } else {
+        width = get_le16(chunk + 14) & 0x3FFF;
+        height = get_le16(chunk + 16) & 0x3FFF;
+    }
+    put_le24(header + 24, width - 1);
+    put_le24(header + 27, height - 1);
+
+    SkDynamicMemoryWStream image;
+    image.write(header, sizeof(header));
+    image.write(fICCChunk.data(), fICCChunk.size());
+    image.write(body->data(), body->size());
+    return image.detachAsData();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// PNG
+
+class PngParser final : public FormatParser {
+public:
+    SkCodec::Result parse(StreamingFrameReader*) override;
+
+private:
+    enum class State {
+        kSignature,
+        kChunk,
+        kCRC,  // The CRC of an fdAT chunk, which was rewritten as an IDAT chunk.
+    };
+
+    // Writes the start of a still PNG of the frame.
+    void writeFrameHeader(StreamingFrameReader*, uint32_t width, uint32_t height);
+
+    // Starts the frame described by the payload of an fcTL chunk.
+    void startControlledFrame(StreamingFrameReader*, const uint8_t* payload);
+
+    State                fState = State::kSignature;
+    uint8_t              fHeader[13];        // The IHDR payload.
+    bool                 fSawHeader = false;
+    bool                 fHasAlpha = false;
+    bool                 fAnimated = false;
+    bool                 fSawImageData = false;
+    std::vector<uint8_t> fAncillaryChunks;   // Chunks that precede the image data.
+    uint8_t              fFirstControl[26];  // The fcTL payload of a frame that is the IDAT.
+    bool                 fHasFirstControl = false;
+};
+
+void PngParser::writeFrameHeader(StreamingFrameReader* reader, uint32_t width, uint32_t height) {
+    if (!reader->isWritingFrame()) {
+        return;
+    }
+    uint8_t header[8 + 25];
+    memcpy(header, "\x89PNG\r\n\x1A\n", 8);
+    put_be32(header + 8, sizeof(fHeader));
+    memcpy(header + 12, "IHDR", 4);
+    memcpy(header + 16, fHeader, sizeof(fHeader));
+    put_be32(header + 16, width);
+    put_be32(header + 20, height);
+    put_be32(header + 29, update_crc(0xFFFFFFFF, header + 12, 4 + sizeof(fHeader)) ^ 0xFFFFFFFF);
+    reader->write(header, sizeof(header));
+    reader->write(fAncillaryChunks.data(), fAncillaryChunks.size());
+}
+
+void PngParser::startControlledFrame(StreamingFrameReader* reader, const uint8_t* payload) {
+    const uint32_t width = get_be32(payload + 4);
+    const uint32_t height = get_be32(payload + 8);
+    const uint32_t delayDen = get_be16(payload + 22);
+    const int duration = get_be16(payload + 20) * 1000 / (delayDen ? delayDen : 100);
+
+    using DisposalMethod = SkCodecAnimation::DisposalMethod;
+    DisposalMethod disposalMethod = DisposalMethod::kKeep;
+    switch (payload[24]) {
+        case 1: disposalMethod = DisposalMethod::kRestoreBGColor; break;
+        case 2:
+            // With no previous frame, restore to the background.
+            disposalMethod = reader->getFrameCount() == 0 ? DisposalMethod::kRestoreBGColor
+                                                          : DisposalMethod::kRestorePrevious;
+            break;
+    }
+    reader->startFrame(fHasAlpha ? SkEncodedInfo::kUnpremul_Alpha : SkEncodedInfo::kOpaque_Alpha,
+                       SkIRect::MakeXYWH(get_be32(payload + 12), get_be32(payload + 16),
+                                         width, height),
+                       disposalMethod, duration,
+                       payload[25] ? SkCodecAnimation::Blend::kSrcOver
+                                   : SkCodecAnimation::Blend::kSrc);
+    this->writeFrameHeader(reader, width, height);
+}
+
+static void write_end(StreamingFrameReader* reader) {
+    static constexpr uint8_t kEnd[] = {0, 0, 0, 0, 'I', 'E', 'N', 'D', 0xAE, 0x42, 0x60, 0x82};
+    reader->write(kEnd, sizeof(kEnd));
+}
+
+SkCodec::Result PngParser::parse(StreamingFrameReader* reader) {
+    while (!reader->isPassing()) {
+        switch (fState) {
+            case State::kSignature:
+                if (!reader->peek(8)) {
+                    return SkCodec::kIncompleteInput;
+                }
+                reader->consume(8);
+                fState = State::kChunk;
+                break;
+            case State::kCRC:
+                if (!reader->peek(4)) {
+                    return SkCodec::kIncompleteInput;
+                }
+                reader->consume(4);
+                reader->writeCRC();
+                fState = State::kChunk;
+                break;
+            case State::kChunk: {
+                const uint8_t* p = reader->peek(8);
+                if (!p) {
+                    return SkCodec::kIncompleteInput;
+                }
+                const uint32_t size = get_be32(p);
+                if (size > 0x7FFFFFFF) {
+                    return SkCodec::kErrorInInput;
+                }
+                const uint8_t* type = p + 4;
+                if (!fSawHeader && memcmp(type, "IHDR", 4)) {
+                    return SkCodec::kErrorInInput;
+                }
+
+                auto isType = [type](const char* name) { return !memcmp(type, name, 4); };
+                if (isType("IHDR") || isType("acTL") || isType("fcTL") || isType("IEND")) {
+                    if (!(p = reader->peek(8 + size + 4))) {
+                        return SkCodec::kIncompleteInput;
+                    }
+                    const uint8_t* payload = p + 8;
+                    if (isType("IHDR")) {
+                        if (fSawHeader || size != sizeof(fHeader)) {
+                            return SkCodec::kErrorInInput;
+                        }
+                        memcpy(fHeader, payload, sizeof(fHeader));
+                        fSawHeader = true;
+                        // Gray + alpha, or RGBA.
+                        fHasAlpha = fHeader[9] == 4 || fHeader[9] == 6;
+                        reader->setHeader(SkEncodedImageFormat::kPNG, get_be32(payload),
+                                          get_be32(payload + 4));
+                    } else if (isType("acTL")) {
+                        if (size < 8) {
+                            return SkCodec::kErrorInInput;
+                        }
+                        if (!fSawImageData) {
+                            fAnimated = true;
+                            const int plays = get_be32(payload + 4);
+                            reader->setRepetitionCount(
+                                    plays ? plays - 1 : SkCodec::kRepetitionCountInfinite);
+                            reader->setHasHeader();
+                        }
+                    } else if (isType("fcTL")) {
+                        if (size < 26) {
+                            return SkCodec::kErrorInInput;
+                        }
+                        if (fAnimated) {
+                            if (reader->hasCurrentFrame()) {
+                                write_end(reader);
+                                reader->finishFrame();
+                            }
+                            if (fSawImageData) {
+                                this->startControlledFrame(reader, payload);
+                            } else {
+                                // Chunks like PLTE and tRNS may still come before the image
+                                // data, so start the first frame when its data arrives.
+                                memcpy(fFirstControl, payload, sizeof(fFirstControl));
+                                fHasFirstControl = true;
+                            }
+                        }
+                    } else {  // IEND
+                        if (reader->hasCurrentFrame()) {
+                            write_end(reader);
+                            reader->finishFrame();
+                        }
+                        reader->consume(8 + size + 4);
+                        return fSawImageData ? SkCodec::kSuccess : SkCodec::kErrorInInput;
+                    }
+                    reader->consume(8 + size + 4);
+                    break;
+                }
+
+                if (isType("IDAT")) {
+                    if (!fSawImageData) {
+                        fSawImageData = true;
+                        reader->setHasHeader();
+                        if (!fAnimated) {
+                            reader->startFrame(fHasAlpha ? SkEncodedInfo::kUnpremul_Alpha
+                                                         : SkEncodedInfo::kOpaque_Alpha,
+                                               SkIRect::MakeSize(reader->dimensions()),
+                                               SkCodecAnimation::DisposalMethod::kKeep, 0,
+                                               SkCodecAnimation::Blend::kSrcOver);
+                            this->writeFrameHeader(reader, get_be32(fHeader),
+                                                   get_be32(fHeader + 4));
+                        } else if (fHasFirstControl) {
+                            this->startControlledFrame(reader, fFirstControl);
+                        }
+                    }
+                    // Without a preceding fcTL, the image data is not part of the animation.
+                    const bool inFrame = reader->hasCurrentFrame();
+                    if (inFrame) {
+                        reader->write(p, 8);
+                    }
+                    reader->consume(8);
+                    reader->pass(size + 4, inFrame ? Sink::kFrame : Sink::kDiscard);
+                    break;
+                }
+
+                if (isType("fdAT")) {
+                    if (size < 4) {
+                        return SkCodec::kErrorInInput;
+                    }
+                    if (!reader->peek(12)) {
+                        return SkCodec::kIncompleteInput;
+                    }
+                    if (!reader->hasCurrentFrame()) {
+                        reader->consume(8);
+                        reader->pass(size + 4, Sink::kDiscard);
+                        break;
+                    }
+                    // Rewrite it as an IDAT chunk, without the sequence number.
+                    uint8_t header[8];
+                    put_be32(header, size - 4);
+                    memcpy(header + 4, "IDAT", 4);
+                    reader->write(header, sizeof(header));
+                    reader->startCRC(header + 4);
+                    reader->consume(12);
+                    reader->pass(size - 4, Sink::kFrameWithCRC);
+                    fState = State::kCRC;
+                    break;
+                }
+
+                const bool isAncillary = isType("PLTE") || isType("tRNS") || isType("gAMA") ||
+                                         isType("cHRM") || isType("sRGB") || isType("iCCP") ||
+                                         isType("sBIT") || isType("cICP");
+                if (isAncillary && !fSawImageData && size <= kMaxHeldChunk) {
+                    if (!(p = reader->peek(8 + size + 4))) {
+                        return SkCodec::kIncompleteInput;
+                    }
+                    fAncillaryChunks.insert(fAncillaryChunks.end(), p, p + 8 + size + 4);
+                    if (isType("tRNS")) {
+                        fHasAlpha = true;
+                    }
+                    reader->consume(8 + size + 4);
+                    break;
+                }
+                reader->consume(8);
+                reader->pass(size + 4, Sink::kDiscard);
+                break;
+            }
+        }
+    }
+    return SkCodec::kIncompleteInput;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool StreamingFrameReader::fill() {
+    fBuffer.erase(fBuffer.begin(), fBuffer.begin() + fPos);
+    fPos = 0;
+    const size_t size = fBuffer.size();
+    fBuffer.resize(size + kReadSize);
+    const size_t bytesRead = fStream->read(fBuffer.data() + size, kReadSize);
+    fBuffer.resize(size + bytesRead);
+    return bytesRead > 0;
+}
+
+SkCodec::Result StreamingFrameReader::detectFormat() {
+    const uint8_t* p = this->peek(12);
+    if (!p) {
+        return SkCodec::kIncompleteInput;
+    }
+    if (!memcmp(p, "GIF87a", 6) || !memcmp(p, "GIF89a", 6)) {
+        fParser = std::make_unique<GifParser>();
+    } else if (!memcmp(p, "\x89PNG\r\n\x1A\n", 8)) {
+        fParser = std::make_unique<PngParser>();
+    } else if (!memcmp(p, "RIFF", 4) && !memcmp(p + 8, "WEBP", 4)) {
+        fParser = std::make_unique<WebpParser>();
+    } else {
+        return SkCodec::kUnimplemented;
+    }
+    return SkCodec::kSuccess;
+}
+
+SkCodec::Result StreamingFrameReader::read() {
+    if (fResult != SkCodec::kIncompleteInput) {
+        return fResult;
+    }
+    for (;;) {
+        if (fPassRemaining) {
+            const size_t size = std::min(fPassRemaining, fBuffer.size() - fPos);
+            const uint8_t* bytes = fBuffer.data() + fPos;
+            if (fPassSink == Sink::kFrameWithCRC) {
+                fCRC = update_crc(fCRC, bytes, size);
+            }
+            if (fPassSink != Sink::kDiscard) {
+                this->write(bytes, size);
+            }
+            this->consume(size);
+            fPassRemaining -= size;
+            if (fPassRemaining) {
+                if (!this->fill()) {
+                    return SkCodec::kIncompleteInput;
+                }
+                continue;
+            }
+        }
+
+        SkCodec::Result result;
+        if (fParser) {
+            result = fParser->parse(this);
+        } else if ((result = this->detectFormat()) == SkCodec::kSuccess) {
+            continue;
+        }
+        if (result != SkCodec::kIncompleteInput) {
+            // Drop the buffer, and any frame left incomplete by an error.
+            fResult = result;
+            fBuffer = {};
+            fPos = 0;
+            fFrameBytes.reset();
+            fCurrentFrame = nullptr;
+            fWritingFrame = false;
+            return fResult;
+        }
+        if (!fPassRemaining && !this->fill()) {
+            return SkCodec::kIncompleteInput;
+        }
+    }
+}
+
+}  // namespace
+
+std::unique_ptr<SkStreamingFrameReader> SkStreamingFrameReader::Make(
+        std::unique_ptr<SkStream> stream, const Options& options) {
+    if (!stream) {
+        return nullptr;
+    }
+    return std::make_unique<StreamingFrameReader>(std::move(stream), options);
+}
@@ -42,6 +42,7 @@ public:
                                         drawCoverage,
                                         draw.fRC->clipShader(),
                                         SkSurfacePropsCopyOrDefault(draw.fProps));
+        fBlitter = draw.clipToWriteBounds(fBlitter, &fAlloc);
         return fBlitter;
     }
 
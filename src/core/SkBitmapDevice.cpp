@@ -8,8 +8,10 @@
 #include "src/core/SkBitmapDevice.h"
 
 #include "include/core/SkAlphaType.h"
+#include "include/core/SkBlendMode.h"
 #include "include/core/SkBlender.h"
 #include "include/core/SkClipOp.h"
+#include "include/core/SkColor.h"
 #include "include/core/SkColorType.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
@@ -29,7 +31,9 @@
 #include "include/core/SkTileMode.h"
 #include "include/private/base/SkAssert.h"
 #include "include/private/base/SkTo.h"
+#include "src/base/SkArenaAlloc.h"
 #include "src/base/SkTLazy.h"
+#include "src/core/SkBlitter.h"
 #include "src/core/SkDraw.h"
 #include "src/core/SkImagePriv.h"
 #include "src/core/SkMatrixPriv.h"
@@ -38,10 +42,16 @@
 #include "src/image/SkImage_Base.h"
 #include "src/text/GlyphRun.h"
 
+#include <optional>
 #include <utility>
 
 class SkVertices;
 
+extern bool gSkForceRasterPipelineBlitter;
+
+// Lets tests and benchmarks compare against choosing a new blitter for every rect and rrect fill.
+bool gSkDisableFillBlitterCache{false};
+
 struct Bounder {
     SkRect  fBounds;
     bool    fHasBounds;
@@ -71,6 +81,7 @@ class SkDrawTiler {
     // fTileMatrix... are only used if fNeedTiling
     SkTLazy<SkMatrix> fTileMatrix;
     SkRasterClip      fTileRC;
+    SkIRect           fTileWriteBounds;
     SkIPoint          fOrigin;
 
     bool            fDone, fNeedsTiling;
@@ -129,6 +140,7 @@ public:
             fDraw.fDst = fRootPixmap;
             fDraw.fCTM = &dev->localToDevice();
             fDraw.fRC = &dev->fRCStack.rc();
+            fDraw.fWriteBounds = dev->fWriteBounds ? &*dev->fWriteBounds : nullptr;
             fOrigin.set(0, 0);
         }
 
@@ -184,6 +196,16 @@ private:
         fDraw.fCTM = fTileMatrix.get();
         fDevice->fRCStack.rc().translate(-fOrigin.x(), -fOrigin.y(), &fTileRC);
         fTileRC.op(SkIRect::MakeSize(fDraw.fDst.dimensions()), SkClipOp::kIntersect);
+
+        fDraw.fWriteBounds = nullptr;
+        if (fDevice->fWriteBounds) {
+            fTileWriteBounds = fDevice->fWriteBounds->makeOffset(-fOrigin.x(), -fOrigin.y());
+            if (fTileWriteBounds.intersect(SkIRect::MakeSize(fDraw.fDst.dimensions()))) {
+                fDraw.fWriteBounds = &fTileWriteBounds;
+            } else {
+                fTileRC.setEmpty();  // Nothing in this tile can be written.
+            }
+        }
     }
 };
 
@@ -208,9 +230,55 @@ public:
         }
         fCTM = &dev->localToDevice();
         fRC = &dev->fRCStack.rc();
+        fWriteBounds = dev->fWriteBounds ? &*dev->fWriteBounds : nullptr;
     }
 };
 
+// Runs of rect fills with the same solid paint are common (backgrounds, cells, and the quads from
+// experimental_DrawEdgeAAQuad), and for small rects choosing and building the blitter can cost
+// more than the fill itself. A blitter for a paint without a shader, color filter or other
+// effects only depends on the paint's color, blending and dithering, the clip shader and the
+// destination, so we keep the last one and reuse it until one of those changes.
+class SkBitmapDevice::FillBlitterCache {
+public:
+    SkBlitter* get(const SkPixmap& dst, const SkMatrix& ctm, const SkPaint& paint,
+                   sk_sp<SkShader> clipShader, const SkSurfaceProps& props) {
+        const std::optional<SkBlendMode> mode = paint.asBlendMode();
+        SkASSERT(mode.has_value());
+        if (!fBlitter ||
+            paint.getColor4f()         != fColor                        ||
+            mode.value()               != fMode                         ||
+            paint.isDither()           != fDither                       ||
+            clipShader                 != fClipShader                   ||
+            dst.addr()                 != fDst.addr()                   ||
+            dst.rowBytes()             != fDst.rowBytes()               ||
+            dst.info()                 != fDst.info()                   ||
+            gSkForceRasterPipelineBlitter != fForceRasterPipeline) {
+            fBlitter = nullptr;
+            fAlloc.reset();
+            fBlitter = SkBlitter::Choose(dst, ctm, paint, &fAlloc, /*drawCoverage=*/false,
+                                         clipShader, props);
+            fColor = paint.getColor4f();
+            fMode = mode.value();
+            fDither = paint.isDither();
+            fClipShader = std::move(clipShader);
+            fDst = dst;
+            fForceRasterPipeline = gSkForceRasterPipelineBlitter;
+        }
+        return fBlitter;
+    }
+
+private:
+    SkSTArenaAllocWithReset<kSkBlitterContextSize> fAlloc;
+    SkBlitter*      fBlitter = nullptr;
+    SkColor4f       fColor;
+    SkBlendMode     fMode;
+    bool            fDither;
+    sk_sp<SkShader> fClipShader;
+    SkPixmap        fDst;
+    bool            fForceRasterPipeline;
+};
+
 static bool valid_for_bitmap_device(const SkImageInfo& info,
                                     SkAlphaType* newAlphaType) {
     if (info.width() < 0 || info.height() < 0 || kUnknown_SkColorType == info.colorType()) {
@@ -243,6 +311,8 @@ SkBitmapDevice::SkBitmapDevice(const SkBitmap& bitmap, const SkSurfaceProps& sur
     SkASSERT(valid_for_bitmap_device(bitmap.info(), nullptr));
 }
 
+SkBitmapDevice::~SkBitmapDevice() = default;
+
 sk_sp<SkBitmapDevice> SkBitmapDevice::Create(const SkImageInfo& origInfo,
                                              const SkSurfaceProps& surfaceProps,
                                              SkRasterHandleAllocator* allocator) {
@@ -348,7 +418,28 @@ void SkBitmapDevice::drawPoints(SkCanvas::PointMode mode, size_t count,
     LOOP_TILER( drawPoints(mode, count, pts, paint, nullptr), nullptr)
 }
 
+SkBlitter* SkBitmapDevice::fillBlitter(const SkPaint& paint) {
+    if (gSkDisableFillBlitterCache ||
+        paint.getStyle() != SkPaint::kFill_Style ||
+        paint.getShader() || paint.getColorFilter() || paint.getMaskFilter() ||
+        paint.getPathEffect() || paint.getImageFilter() || !paint.asBlendMode() ||
+        !fBitmap.getPixels() || SkDrawTiler::NeedsTiling(this) || fWriteBounds) {
+        return nullptr;
+    }
+    if (!fFillBlitterCache) {
+        fFillBlitterCache = std::make_unique<FillBlitterCache>();
+    }
+    return fFillBlitterCache->get(fBitmap.pixmap(), this->localToDevice(), paint,
+                                  fRCStack.rc().clipShader(), this->surfaceProps());
+}
+
 void SkBitmapDevice::drawRect(const SkRect& r, const SkPaint& paint) {
+    if (SkBlitter* blitter = this->fillBlitter(paint)) {
+        BDDraw draw(this);
+        draw.fProps = &this->surfaceProps();
+        draw.drawRect(r, paint, nullptr, nullptr, blitter);
+        return;
+    }
     LOOP_TILER( drawRect(r, paint), Bounder(r, paint))
 }
 
@@ -364,6 +455,12 @@ void SkBitmapDevice::drawRRect(const SkRRect& rrect, const SkPaint& paint) {
     // required to override drawRRect.
     this->drawPath(SkPath::RRect(rrect), paint, true);
 #else
+    if (SkBlitter* blitter = this->fillBlitter(paint)) {
+        BDDraw draw(this);
+        draw.fProps = &this->surfaceProps();
+        draw.drawRRect(rrect, paint, blitter);
+        return;
+    }
     LOOP_TILER( drawRRect(rrect, paint), Bounder(rrect.getBounds(), paint))
 #endif
 }
@@ -584,6 +681,7 @@ void SkBitmapDevice::drawSpecial(SkSpecialImage* src,
         }
         draw.fCTM = &localToDevice;
         draw.fRC = &fRCStack.rc();
+        draw.fWriteBounds = fWriteBounds ? &*fWriteBounds : nullptr;
         draw.drawBitmap(resultBM, SkMatrix::I(), nullptr, sampling, paint);
     }
 }
@@ -19,8 +19,11 @@
 #include "src/core/SkRasterClipStack.h"
 
 #include <cstddef>
+#include <memory>
+#include <optional>
 
 class SkBlender;
+class SkBlitter;
 class SkImage;
 class SkMatrix;
 class SkMesh;
@@ -59,6 +62,8 @@ public:
     SkBitmapDevice(const SkBitmap& bitmap, const SkSurfaceProps& surfaceProps,
                    void* externalHandle = nullptr);
 
+    ~SkBitmapDevice() override;
+
     static sk_sp<SkBitmapDevice> Create(const SkImageInfo&, const SkSurfaceProps&,
                                         SkRasterHandleAllocator* = nullptr);
 
@@ -115,6 +120,13 @@ public:
 
     void* getRasterHandle() const override { return fRasterHandle; }
 
+    /**
+     *  Restricts every pixel this device writes to these bounds (in device coordinates), without
+     *  changing the clip: everything is drawn as if over the whole device, and the pixels inside
+     *  the bounds are the same as they would be then. Layers are unaffected until restored.
+     */
+    void setWriteBounds(const SkIRect& bounds) { fWriteBounds = bounds; }
+
 private:
     friend class SkDraw;
     friend class SkDrawBase;
@@ -122,6 +134,7 @@ private:
     friend class SkSurface_Raster;
 
     class BDDraw;
+    class FillBlitterCache;
 
     // Used to change the backend's pixels (and possibly config/rowbytes) but cannot change the
     // width/height, so there should be no change to any clip information.
@@ -139,10 +152,16 @@ private:
     void drawBitmap(const SkBitmap&, const SkMatrix&, const SkRect* dstOrNull,
                     const SkSamplingOptions&, const SkPaint&);
 
+    // Returns a blitter for filling a rect or rrect with this paint, shared with previous fills
+    // that used the same color and blending, or null if the paint or device needs the general path.
+    SkBlitter* fillBlitter(const SkPaint&);
+
     SkBitmap    fBitmap;
     void*       fRasterHandle = nullptr;
     SkRasterClipStack  fRCStack;
     SkGlyphRunListPainterCPU fGlyphPainter;
+    std::unique_ptr<FillBlitterCache> fFillBlitterCache;
+    std::optional<SkIRect> fWriteBounds;
 };
 
 #endif // SkBitmapDevice_DEFINED
@@ -14,10 +14,12 @@
 #include "include/core/SkColor.h"
 #include "include/core/SkColorSpace.h" // IWYU pragma: keep
 #include "include/core/SkColorType.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkM44.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPaint.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkSamplingOptions.h"
@@ -29,19 +31,24 @@
 #include "include/private/base/SkFeatures.h"
 #include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkMath.h"
+#include "include/private/base/SkTPin.h"
+#include "include/private/base/SkTemplates.h"
 #include "include/private/base/SkTo.h"
 #include "src/base/SkArenaAlloc.h"
 #include "src/base/SkVx.h"
 #include "src/core/SkBitmapDevice.h"
 #include "src/core/SkDevice.h"
+#include "src/core/SkImageInfoPriv.h"
 #include "src/core/SkKnownRuntimeEffects.h"
 #include "src/core/SkSpecialImage.h"
+#include "src/core/SkTaskGroup.h"
 
 #include <algorithm>
 #include <array>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <utility>
 
 
@@ -57,6 +64,10 @@
 // RasterBlurEngine
 // ----------------------------------------------------------------------------
 
+// When set, the raster blur engine uses the blurs it had before RasterBoxBlurAlgorithm: successive
+// box blurs in 8888 with only decal tiling, and shader blurs for other color types.
+bool gSkDisableRasterBoxBlur{false};
+
 namespace {
 
 class Pass {
@@ -866,6 +877,281 @@ public:
 
 };
 
+// Maps 'v' into [0, n) as 'tileMode' does for pixels outside of an image n pixels wide, or returns
+// -1 if the pixel is transparent black.
+static int tile_coord(int v, int n, SkTileMode tileMode) {
+    if (0 <= v && v < n) {
+        return v;
+    }
+    switch (tileMode) {
+        case SkTileMode::kDecal:
+            return -1;
+        case SkTileMode::kClamp:
+            return SkTPin(v, 0, n - 1);
+        case SkTileMode::kRepeat: {
+            int m = v % n;
+            return m < 0 ? m + n : m;
+        }
+        case SkTileMode::kMirror: {
+            int m = v % (2 * n);
+            m = m < 0 ? m + 2 * n : m;
+            return m < n ? m : 2 * n - 1 - m;
+        }
+    }
+    SkUNREACHABLE;
+}
+
+// The successive box blurs of SkBlurEngine::BoxBlurWindow() as the widths of the three boxes and
+// the offset of the first pixel of each box from the pixel it writes. Odd windows use three
+// centered boxes; even windows use two boxes shifted by half a pixel to either side and a third
+// box one wider, as in GaussPass.
+struct BoxBlur {
+    explicit BoxBlur(int window) {
+        if (window <= 1) {
+            fWidths = {1, 1, 1};
+            fOffsets = {0, 0, 0};
+        } else if (window & 1) {
+            fWidths = {window, window, window};
+            fOffsets = {-(window / 2), -(window / 2), -(window / 2)};
+        } else {
+            fWidths = {window, window, window + 1};
+            fOffsets = {-(window / 2), -(window / 2) + 1, -(window / 2)};
+        }
+        fRadius = -(fOffsets[0] + fOffsets[1] + fOffsets[2]);
+    }
+
+    bool isIdentity() const { return fRadius == 0; }
+
+    std::array<int, 3> fWidths;
+    std::array<int, 3> fOffsets;
+    int fRadius;  // the number of pixels the three boxes reach to either side
+};
+
+// Writes the average of each run of 'width' values in 'src' to 'dst', using running sums. Each
+// value is 'floats' floats, a multiple of 4, and the values are 'srcStride' and 'dstStride' floats
+// apart. 'dst' gets 'count' values and 'src' must hold count + width - 1 of them. Both axes run
+// this over a strip of rows: the X passes over rows interleaved pixel by pixel, and the Y passes
+// over a strip of columns a row at a time. So the floats of a value are contiguous, and their
+// sums are independent lanes of the vectors in 'sums', which has room for floats / 4 of them.
+//
+// The sums are kept in double so that their rounding error never shows in the output. Otherwise
+// each pixel would depend on where the sum started, and blurs of neighboring tiles wouldn't match
+// at their seams.
+static void box_pass(const float* src, size_t srcStride,
+                     float* dst, size_t dstStride,
+                     int count, int width, int floats, skvx::double4* sums) {
+    SkASSERT(floats % 4 == 0);
+    const int vectors = floats / 4;
+    const skvx::double4 scale = 1.0 / width;
+    auto load = [](const float* p) { return skvx::cast<double>(skvx::float4::Load(p)); };
+
+    std::fill_n(sums, vectors, skvx::double4(0.0));
+    for (int i = 0; i < width - 1; ++i) {
+        const float* s = src + i * srcStride;
+        for (int j = 0; j < vectors; ++j) {
+            sums[j] += load(s + 4 * j);
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        const float* lead = src + (i + width - 1) * srcStride;
+        const float* trail = src + i * srcStride;
+        float* d = dst + i * dstStride;
+        for (int j = 0; j < vectors; ++j) {
+            const skvx::double4 sum = sums[j] + load(lead + 4 * j);
+            skvx::cast<float>(sum * scale).store(d + 4 * j);
+            sums[j] = sum - load(trail + 4 * j);
+        }
+    }
+}
+
+// A successive box blur, like Raster8888BlurAlgorithm, for every color type and tile mode. The
+// pixels are blurred as float RGBA, which is converted from and to the image's color type as the
+// rows are read and written, and the tile mode is applied as the source is read. Each axis takes
+// three running-sum passes, on strips of a few rows for X and of a few columns for Y, that run as
+// tasks on the default SkExecutor.
+//
+// RasterBlurEngine uses this in place of Raster8888BlurAlgorithm for sigmas from 2 to 135. Its
+// output differs from that blur's by up to 1 in 255, as that one rounds to 8 bits between the
+// axes, so raster expectations of blurred content need rebaselining.
+class RasterBoxBlurAlgorithm : public SkBlurEngine::Algorithm {
+public:
+    // Running sums in double have no practical limit on the window, but larger blurs are faster
+    // to evaluate on a rescaled image. This matches the sigmas where Raster8888BlurAlgorithm used
+    // GaussPass.
+    float maxSigma() const override { return 135.f; }
+
+    bool supportsOnlyDecalTiling() const override { return false; }
+
+    sk_sp<SkSpecialImage> blur(SkSize sigma,
+                               sk_sp<SkSpecialImage> input,
+                               const SkIRect& srcRect,
+                               SkTileMode tileMode,
+                               const SkIRect& dstRect) const override {
+        SkASSERT(SkIRect::MakeSize(input->dimensions()).contains(srcRect));
+
+        SkBitmap src;
+        if (!SkSpecialImages::AsBitmap(input.get(), &src)) {
+            return nullptr; // Should only have been called by CPU-backed images
+        }
+
+        const BoxBlur boxX{SkBlurEngine::BoxBlurWindow(sigma.width())},
+                      boxY{SkBlurEngine::BoxBlurWindow(sigma.height())};
+        SkBitmap dst;
+        if (!dst.tryAllocPixels(src.info().makeWH(dstRect.width(), dstRect.height()))) {
+            return nullptr;
+        }
+
+        // The X-blurred rows that the Y passes read, which reach past 'dstRect' by boxY's radius,
+        // relative to 'srcRect'. They are kept as half floats, at 8 bytes per pixel, unless the
+        // image has channels that those can't hold to spare.
+        const SkIRect midRect = dstRect.makeOutset(0, boxY.fRadius)
+                                       .makeOffset(-srcRect.left(), -srcRect.top());
+        const int midWidth = midRect.width(),
+                  midHeight = midRect.height();
+        const SkImageInfo floatInfo = src.info().makeColorType(kRGBA_F32_SkColorType);
+        const SkColorType midColorType = SkColorTypeMaxBitsPerChannel(src.colorType()) <= 10
+                                                 ? kRGBA_F16_SkColorType
+                                                 : kRGBA_F32_SkColorType;
+        SkBitmap mid;
+        if (!mid.tryAllocPixels(floatInfo.makeColorType(midColorType).makeWH(midWidth,
+                                                                             midHeight))) {
+            return nullptr;
+        }
+
+        SkPixmap srcPixels;
+        SkAssertResult(src.pixmap().extractSubset(&srcPixels, srcRect));
+
+        SkTaskGroup tasks{SkExecutor::GetDefault()};
+        tasks.batch((midHeight + kRowsPerTask - 1) / kRowsPerTask, [&](int task) {
+            const int rowEnd = std::min(midHeight, (task + 1) * kRowsPerTask);
+            // The source row, a strip of rows extended by the tile mode and interleaved pixel by
+            // pixel, room for the passes, and one blurred row.
+            const int extendedWidth = midWidth + 2 * boxX.fRadius;
+            std::unique_ptr<skvx::float4[]> srcRow{new skvx::float4[srcRect.width()]},
+                                            lines{new skvx::float4[kStripRows * extendedWidth]},
+                                            scratch{new skvx::float4[kStripRows * extendedWidth]},
+                                            midRow{new skvx::float4[midWidth]};
+            std::unique_ptr<skvx::double4[]> sums{new skvx::double4[kStripRows]};
+            const SkPixmap floatRow{floatInfo.makeWH(srcRect.width(), 1),
+                                    srcRow.get(),
+                                    srcRect.width() * sizeof(skvx::float4)};
+            const SkPixmap floatMidRow{floatInfo.makeWH(midWidth, 1),
+                                       midRow.get(),
+                                       midWidth * sizeof(skvx::float4)};
+            int lastSrcY = -1;
+            for (int top = task * kRowsPerTask; top < rowEnd; top += kStripRows) {
+                const int rows = std::min(kStripRows, rowEnd - top);
+                for (int r = 0; r < rows; ++r) {
+                    // Pixel i of the strip's row r.
+                    auto extended = [&](int i) -> skvx::float4& { return lines[i * rows + r]; };
+                    const int srcY = tile_coord(midRect.top() + top + r, srcRect.height(),
+                                                tileMode);
+                    if (srcY < 0) {
+                        for (int i = 0; i < extendedWidth; ++i) {
+                            extended(i) = skvx::float4(0.f);
+                        }
+                        continue;
+                    }
+                    if (srcY != lastSrcY) {
+                        SkAssertResult(srcPixels.readPixels(floatRow, 0, srcY));
+                        lastSrcY = srcY;
+                    }
+
+                    // Copy the part of the row inside the source, and tile the rest.
+                    const int extendedLeft = midRect.left() - boxX.fRadius,
+                              insideStart = SkTPin(-extendedLeft, 0, extendedWidth),
+                              insideEnd = SkTPin(srcRect.width() - extendedLeft, 0, extendedWidth);
+                    auto tileX = [&](int i) {
+                        const int srcX = tile_coord(extendedLeft + i, srcRect.width(), tileMode);
+                        extended(i) = srcX < 0 ? skvx::float4(0.f) : srcRow[srcX];
+                    };
+                    for (int i = 0; i < insideStart; ++i) {
+                        tileX(i);
+                    }
+                    for (int i = insideStart; i < insideEnd; ++i) {
+                        extended(i) = srcRow[extendedLeft + i];
+                    }
+                    for (int i = std::max(insideStart, insideEnd); i < extendedWidth; ++i) {
+                        tileX(i);
+                    }
+                }
+
+                const skvx::float4* blurred = lines.get();
+                if (!boxX.isIdentity()) {
+                    float* a = reinterpret_cast<float*>(lines.get());
+                    float* b = reinterpret_cast<float*>(scratch.get());
+                    const int floats = 4 * rows;
+                    int count = extendedWidth - (boxX.fWidths[0] - 1);
+                    box_pass(a, floats, b, floats, count, boxX.fWidths[0], floats, sums.get());
+                    count -= boxX.fWidths[1] - 1;
+                    box_pass(b, floats, a, floats, count, boxX.fWidths[1], floats, sums.get());
+                    count -= boxX.fWidths[2] - 1;
+                    SkASSERT(count == midWidth);
+                    box_pass(a, floats, b, floats, count, boxX.fWidths[2], floats, sums.get());
+                    blurred = scratch.get();
+                }
+                for (int r = 0; r < rows; ++r) {
+                    for (int i = 0; i < midWidth; ++i) {
+                        midRow[i] = blurred[i * rows + r];
+                    }
+                    SkPixmap midPixels;
+                    SkAssertResult(mid.pixmap().extractSubset(
+                            &midPixels, SkIRect::MakeXYWH(0, top + r, midWidth, 1)));
+                    SkAssertResult(floatMidRow.readPixels(midPixels));
+                }
+            }
+        });
+        tasks.wait();
+
+        const int dstHeight = dstRect.height();
+        tasks.batch((midWidth + kStripWidth - 1) / kStripWidth, [&](int task) {
+            const int left = task * kStripWidth,
+                      width = std::min(midWidth - left, kStripWidth),
+                      floats = 4 * width;
+            SkPixmap midStrip, dstStrip;
+            SkAssertResult(mid.pixmap().extractSubset(
+                    &midStrip, SkIRect::MakeXYWH(left, 0, width, midHeight)));
+            SkAssertResult(dst.pixmap().extractSubset(
+                    &dstStrip, SkIRect::MakeXYWH(left, 0, width, dstHeight)));
+            if (boxY.isIdentity()) {
+                SkAssertResult(midStrip.readPixels(dstStrip));
+                return;
+            }
+
+            skia_private::AutoTMalloc<float> bufferA(SkToSizeT(floats) * midHeight),
+                                             bufferB(SkToSizeT(floats) * midHeight);
+            std::unique_ptr<skvx::double4[]> sums{new skvx::double4[width]};
+            SkAssertResult(midStrip.readPixels(SkPixmap(floatInfo.makeWH(width, midHeight),
+                                                        bufferB.get(),
+                                                        floats * sizeof(float))));
+            int count = midHeight - (boxY.fWidths[0] - 1);
+            box_pass(bufferB.get(), floats, bufferA.get(), floats,
+                     count, boxY.fWidths[0], floats, sums.get());
+            count -= boxY.fWidths[1] - 1;
+            box_pass(bufferA.get(), floats, bufferB.get(), floats,
+                     count, boxY.fWidths[1], floats, sums.get());
+            count -= boxY.fWidths[2] - 1;
+            SkASSERT(count == dstHeight);
+            box_pass(bufferB.get(), floats, bufferA.get(), floats,
+                     count, boxY.fWidths[2], floats, sums.get());
+            SkAssertResult(SkPixmap(floatInfo.makeWH(width, dstHeight), bufferA.get(),
+                                    floats * sizeof(float)).readPixels(dstStrip));
+        });
+        tasks.wait();
+
+        return SkSpecialImages::MakeFromRaster(SkIRect::MakeSize(dst.dimensions()), dst,
+                                               SkSurfaceProps{});
+    }
+
+private:
+    // Enough rows or columns per task to amortize the setup, and few enough columns that a strip
+    // of the Y passes stays in cache.
+    static constexpr int kRowsPerTask = 32;
+    // The rows that the X passes blur at once, as independent lanes of their sums.
+    static constexpr int kStripRows = 4;
+    static constexpr int kStripWidth = 64;
+};
+
 class RasterShaderBlurAlgorithm : public SkShaderBlurAlgorithm {
 public:
     sk_sp<SkDevice> makeDevice(const SkImageInfo& imageInfo) const override {
@@ -890,21 +1176,33 @@ public:
         // blur along the other axis.
         const bool smallBlur = sigma.width() < kBoxBlurMinSigma &&
                                sigma.height() < kBoxBlurMinSigma;
-        // The box blur doesn't actually care about channel order as long as it's 4 8-bit channels.
-        const bool rgba8Blur = colorType == kRGBA_8888_SkColorType ||
-                               colorType == kBGRA_8888_SkColorType;
-        // TODO: Specialize A8 color types as well by reusing the mask filter blur impl
-        if (smallBlur || !rgba8Blur) {
+        if (smallBlur) {
             return &fShaderBlurAlgorithm;
-        } else {
-            return &fRGBA8BlurAlgorithm;
         }
+
+        // Every other blur up to the box blur's max sigma takes the box blur, which replaces the
+        // 8888 algorithm and the shader fallback there. Legacy blurs that don't rescale ask for
+        // larger sigmas than the box blur supports, and rely on the TentPass of the 8888 algorithm
+        // to blur them.
+        const bool largeBlur = sigma.width() > fBoxBlurAlgorithm.maxSigma() ||
+                               sigma.height() > fBoxBlurAlgorithm.maxSigma();
+        if (gSkDisableRasterBoxBlur || largeBlur) {
+            // The 8888 blur doesn't actually care about channel order as long as it's 4 8-bit
+            // channels.
+            const bool rgba8Blur = colorType == kRGBA_8888_SkColorType ||
+                                   colorType == kBGRA_8888_SkColorType;
+            return rgba8Blur ? static_cast<const Algorithm*>(&fRGBA8BlurAlgorithm)
+                             : &fShaderBlurAlgorithm;
+        }
+        return &fBoxBlurAlgorithm;
     }
 
 private:
-    // For small sigmas and non-8888 or A8 color types, use the shader algorithm
+    // For small sigmas, use the shader algorithm
     RasterShaderBlurAlgorithm fShaderBlurAlgorithm;
-    // For large blurs with RGBA8 or BGRA8, use consecutive box blurs
+    // For larger blurs of any color type, use successive box blurs
+    RasterBoxBlurAlgorithm fBoxBlurAlgorithm;
+    // For legacy blurs with RGBA8 or BGRA8, use the single pass successive box blurs or tent blurs
     Raster8888BlurAlgorithm fRGBA8BlurAlgorithm;
 };
 
@@ -71,9 +71,9 @@ public:
         return IsEffectivelyIdentity(sigma) ? 0 : sk_float_ceil2int(3.f * sigma);
     }
 
-    // Get the default CPU-backed SkBlurEngine. This has specialized algorithms for 32-bit RGBA
-    // and BGRA colors, and A8 alpha-only images when the sigma is large enough. For small blurs
-    // and other color types, it uses SkShaderBlurAlgorithm backed by the raster pipeline.
+    // Get the default CPU-backed SkBlurEngine. When the sigma is large enough, this uses successive
+    // box blurs for every color type and tile mode. For small blurs, it uses SkShaderBlurAlgorithm
+    // backed by the raster pipeline.
     static const SkBlurEngine* GetRasterBlurEngine();
 
     // TODO: These are internal functions of the raster blur engine but need to be public for legacy
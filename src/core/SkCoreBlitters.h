@@ -148,4 +148,12 @@ SkBlitter* SkCreateRasterPipelineBlitter(const SkPixmap&, const SkPaint&,
                                          bool shader_is_opaque,
                                          SkArenaAlloc*, sk_sp<SkShader> clipShader);
 
+// The raster pipeline blitter caches whole compiled blit pipelines for paints that fold to a
+// constant color, per thread, keyed by color op, blend mode, dst format and coverage kind.
+struct SkRasterPipelineBlitterShapeCacheStats {
+    uint64_t fHits   = 0;
+    uint64_t fMisses = 0;
+};
+SkRasterPipelineBlitterShapeCacheStats SkRasterPipelineBlitterShapeCacheStatsForThisThread();
+
 #endif
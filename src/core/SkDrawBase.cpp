@@ -22,10 +22,12 @@
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkFloatingPoint.h"
 #include "include/private/base/SkTemplates.h"
+#include "src/base/SkArenaAlloc.h"
 #include "src/base/SkTLazy.h"
 #include "src/base/SkZip.h"
 #include "src/core/SkAutoBlitterChoose.h"
 #include "src/core/SkBlendModePriv.h"
+#include "src/core/SkBlitter.h"
 #include "src/core/SkBlitter_A8.h"
 #include "src/core/SkDevice.h"
 #include "src/core/SkDrawBase.h"
@@ -48,10 +50,22 @@ class SkMaskFilter;
 
 using namespace skia_private;
 
+// Fills anti-aliased paths with SkScan::SparseStripFillPath instead of SkScan::AntiFillPath.
+bool gSkUseSparseStripPathFill{false};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 SkDrawBase::SkDrawBase() {}
 
+SkBlitter* SkDrawBase::clipToWriteBounds(SkBlitter* blitter, SkArenaAlloc* alloc) const {
+    if (!fWriteBounds || !blitter) {
+        return blitter;
+    }
+    auto clipped = alloc->make<SkRectClipBlitter>();
+    clipped->init(blitter, *fWriteBounds);
+    return clipped;
+}
+
 bool SkDrawBase::computeConservativeLocalClipBounds(SkRect* localBounds) const {
     if (fRC->isEmpty()) {
         return false;
@@ -157,7 +171,8 @@ static void draw_rect_as_path(const SkDrawBase& orig,
 }
 
 void SkDrawBase::drawRect(const SkRect& prePaintRect, const SkPaint& paint,
-                      const SkMatrix* paintMatrix, const SkRect* postPaintRect) const {
+                      const SkMatrix* paintMatrix, const SkRect* postPaintRect,
+                      SkBlitter* customBlitter) const {
     SkDEBUGCODE(this->validate();)
 
     // nothing to draw
@@ -215,9 +230,10 @@ void SkDrawBase::drawRect(const SkRect& prePaintRect, const SkPaint& paint,
         return;
     }
 
-    SkAutoBlitterChoose blitterStorage(*this, matrix, paint);
+    SkAutoBlitterChoose blitterStorage;
     const SkRasterClip& clip = *fRC;
-    SkBlitter*          blitter = blitterStorage.get();
+    SkBlitter*          blitter = customBlitter ? customBlitter
+                                                : blitterStorage.choose(*this, matrix, paint);
 
     // we want to "fill" if we are kFill or kStrokeAndFill, since in the latter
     // case we are also hairline (if we've gotten to here), which devolves to
@@ -283,7 +299,8 @@ bool SkDrawTreatAAStrokeAsHairline(SkScalar strokeWidth, const SkMatrix& matrix,
     return false;
 }
 
-void SkDrawBase::drawRRect(const SkRRect& rrect, const SkPaint& paint) const {
+void SkDrawBase::drawRRect(const SkRRect& rrect, const SkPaint& paint,
+                           SkBlitter* customBlitter) const {
     SkDEBUGCODE(this->validate());
 
     if (fRC->isEmpty()) {
@@ -308,8 +325,10 @@ void SkDrawBase::drawRRect(const SkRRect& rrect, const SkPaint& paint) const {
         // Transform the rrect into device space.
         SkRRect devRRect;
         if (rrect.transform(*fCTM, &devRRect)) {
-            SkAutoBlitterChoose blitter(*this, nullptr, paint);
-            if (as_MFB(paint.getMaskFilter())->filterRRect(devRRect, *fCTM, *fRC, blitter.get())) {
+            SkAutoBlitterChoose blitterStorage;
+            SkBlitter* blitter = customBlitter ? customBlitter
+                                               : blitterStorage.choose(*this, nullptr, paint);
+            if (as_MFB(paint.getMaskFilter())->filterRRect(devRRect, *fCTM, *fRC, blitter)) {
                 return;  // filterRRect() called the blitter, so we're done
             }
         }
@@ -319,7 +338,7 @@ DRAW_PATH:
     // Now fall back to the default case of using a path.
     SkPath path;
     path.addRRect(rrect);
-    this->drawPath(path, paint, nullptr, true);
+    this->drawPath(path, paint, nullptr, true, false, customBlitter);
 }
 
 void SkDrawBase::drawDevPath(const SkPath& devPath, const SkPaint& paint, bool drawCoverage,
@@ -346,7 +365,11 @@ void SkDrawBase::drawDevPath(const SkPath& devPath, const SkPaint& paint, bool d
     void (*proc)(const SkPath&, const SkRasterClip&, SkBlitter*);
     if (doFill) {
         if (paint.isAntiAlias()) {
-            proc = SkScan::AntiFillPath;
+            if (gSkUseSparseStripPathFill) {
+                proc = SkScan::SparseStripFillPath;
+            } else {
+                proc = SkScan::AntiFillPath;
+            }
         } else {
             proc = SkScan::FillPath;
         }
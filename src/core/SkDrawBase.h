@@ -42,12 +42,16 @@ public:
     SkDrawBase();
 
     void    drawPaint(const SkPaint&) const;
+    /**
+     *  If customBlitter is not null, it is used in place of choosing a blitter for the paint,
+     *  and must be equivalent to the one that would have been chosen.
+     */
     void    drawRect(const SkRect& prePaintRect, const SkPaint&, const SkMatrix* paintMatrix,
-                     const SkRect* postPaintRect) const;
+                     const SkRect* postPaintRect, SkBlitter* customBlitter = nullptr) const;
     void    drawRect(const SkRect& rect, const SkPaint& paint) const {
         this->drawRect(rect, paint, nullptr, nullptr);
     }
-    void    drawRRect(const SkRRect&, const SkPaint&) const;
+    void    drawRRect(const SkRRect&, const SkPaint&, SkBlitter* customBlitter = nullptr) const;
     /**
      *  To save on mallocs, we allow a flag that tells us that srcPath is
      *  mutable, so that we don't have to make copies of it as we transform it.
@@ -118,6 +122,13 @@ public:
                                        sk_sp<SkShader> clipShader,
                                        const SkSurfaceProps&);
 
+    /**
+     *  If fWriteBounds is set, wraps the blitter so that it never writes outside of them. Only
+     *  the pixels written are clipped, not the geometry, so the coverage of those that are
+     *  written is the same as without fWriteBounds.
+     */
+    SkBlitter* clipToWriteBounds(SkBlitter*, SkArenaAlloc*) const;
+
 
 private:
     // not supported
@@ -155,6 +166,7 @@ public:
     const SkMatrix*         fCTM{nullptr};             // required
     const SkRasterClip*     fRC{nullptr};              // required
     const SkSurfaceProps*   fProps{nullptr};           // optional
+    const SkIRect*          fWriteBounds{nullptr};     // optional, in fDst's coordinates
 
 #ifdef SK_DEBUG
     void validate() const;
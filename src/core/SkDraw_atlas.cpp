@@ -127,6 +127,7 @@ void SkDraw::drawAtlas(const SkRSXform xform[],
     if (!blitter) {
         return;
     }
+    blitter = this->clipToWriteBounds(blitter, &alloc);
     SkPath scratchPath;
 
     for (int i = 0; i < count; ++i) {
@@ -292,6 +292,7 @@ void SkDraw::drawFixedVertices(const SkVertices* vertices,
     if (!blitter) {
         return;
     }
+    blitter = this->clipToWriteBounds(blitter, outerAlloc);
     while (vertProc(&state)) {
         if (triColorShader && !triColorShader->update(ctmInverse, positions, dstColors,
                                                       state.f0, state.f1, state.f2)) {
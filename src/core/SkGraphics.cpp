@@ -7,6 +7,7 @@
 
 #include "include/core/SkGraphics.h"
 
+#include "include/core/SkData.h"
 #include "src/core/SkBitmapProcState.h"
 #include "src/core/SkBlitMask.h"
 #include "src/core/SkBlitRow.h"
@@ -14,6 +15,7 @@
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkMemset.h"
 #include "src/core/SkOpts.h"
+#include "src/core/SkPersistentGlyphCache.h"
 #include "src/core/SkResourceCache.h"
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkSwizzlePriv.h"
@@ -78,6 +80,22 @@ void SkGraphics::PurgePinnedFontCache() {
     SkStrikeCache::GlobalStrikeCache()->purgePinned();
 }
 
+sk_sp<SkData> SkGraphics::SerializeFontCacheGlyphs() {
+    return SkPersistentGlyphCache::Serialize(SkStrikeCache::GlobalStrikeCache());
+}
+
+bool SkGraphics::SetPersistentFontCacheData(sk_sp<SkData> data) {
+    sk_sp<SkPersistentGlyphCache> cache;
+    if (data) {
+        cache = SkPersistentGlyphCache::Make(std::move(data));
+        if (!cache) {
+            return false;
+        }
+    }
+    SkStrikeCache::GlobalStrikeCache()->setPersistentGlyphCache(std::move(cache));
+    return true;
+}
+
 static int gTypefaceCacheCountLimit = 1024; // historical default value
 
 int SkGraphics::GetTypefaceCacheCountLimit() {
@@ -231,9 +231,8 @@ void SkImageFilter_Base::flatten(SkWriteBuffer& buffer) const {
 skif::FilterResult SkImageFilter_Base::filterImage(const skif::Context& context) const {
     context.markVisitedImageFilter();
 
-    skif::FilterResult result;
     if (context.desiredOutput().isEmpty() || !context.mapping().layerMatrix().isFinite()) {
-        return result;
+        return {};
     }
 
     // Some image filters that operate on the source image still affect transparent black, so if
@@ -244,22 +243,50 @@ skif::FilterResult SkImageFilter_Base::filterImage(const skif::Context& context)
     uint32_t srcGenID = srcInKey ? context.source().image()->uniqueID() : SK_InvalidUniqueID;
     const SkIRect srcSubset = srcInKey ? context.source().image()->subset() : SkIRect::MakeWH(0, 0);
 
-    SkImageFilterCacheKey key(fUniqueID,
-                              context.mapping().layerMatrix(),
-                              SkIRect(context.desiredOutput()),
-                              srcGenID, srcSubset);
-    if (context.backend()->cache() && context.backend()->cache()->get(key, &result)) {
-        context.markCacheHit();
-        return result;
-    }
-
-    result = this->onFilterImage(context);
-
-    if (context.backend()->cache()) {
-        context.backend()->cache()->set(key, this, result);
+    auto keyFor = [&](const skif::Context& ctx) {
+        return SkImageFilterCacheKey(fUniqueID,
+                                     ctx.mapping().layerMatrix(),
+                                     SkIRect(ctx.desiredOutput()),
+                                     srcGenID, srcSubset);
+    };
+    auto findCached = [&](const skif::Context& ctx, skif::FilterResult* cached) {
+        if (ctx.backend()->cache() && ctx.backend()->cache()->get(keyFor(ctx), cached)) {
+            ctx.markCacheHit();
+            return true;
+        }
+        return false;
+    };
+    auto addToCache = [&](const skif::Context& ctx, const skif::FilterResult& filtered) {
+        if (ctx.backend()->cache()) {
+            ctx.backend()->cache()->set(keyFor(ctx), this, filtered);
+        }
+    };
+    auto filterWithCache = [&](const skif::Context& ctx) {
+        skif::FilterResult filtered;
+        if (!findCached(ctx, &filtered)) {
+            filtered = this->onFilterImage(ctx);
+            addToCache(ctx, filtered);
+        }
+        return filtered;
+    };
+
+    // Large outputs are filtered and cached in tiles, so that when the output moves only the newly
+    // exposed tiles are filtered. The tiles can move with the layer matrix unless they depend on
+    // the source, which is keyed by its ID alone. Deferred outputs are cheaper to produce whole
+    // than to draw back together from tiles. The merged output is cached as well, so an output
+    // that hasn't moved is found without going to its tiles at all.
+    if (!this->onDefersOutput() && context.shouldEvaluateInTiles()) {
+        skif::FilterResult merged;
+        if (!findCached(context, &merged)) {
+            merged = skif::FilterResult::MakeFromTiles(context,
+                                                       /*translationInvariant=*/!srcInKey,
+                                                       findCached,
+                                                       filterWithCache);
+            addToCache(context, merged);
+        }
+        return merged;
     }
-
-    return result;
+    return filterWithCache(context);
 }
 
 sk_sp<SkImage> SkImageFilter_Base::makeImageWithFilter(sk_sp<skif::Backend> backend,
@@ -8,17 +8,20 @@
 #include "src/core/SkImageFilterTypes.h"
 
 #include "include/core/SkAlphaType.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkBlendMode.h"
 #include "include/core/SkBlender.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkClipOp.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorType.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkM44.h"
 #include "include/core/SkPaint.h"
 #include "include/core/SkPicture.h"  // IWYU pragma: keep
+#include "include/core/SkPixmap.h"
 #include "include/core/SkShader.h"
 #include "include/effects/SkRuntimeEffect.h"
 #include "include/private/base/SkDebug.h"
@@ -36,17 +39,40 @@
 #include "src/core/SkKnownRuntimeEffects.h"
 #include "src/core/SkMatrixPriv.h"
 #include "src/core/SkRectPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkTraceEvent.h"
 #include "src/effects/colorfilters/SkColorFilterBase.h"
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <limits>
+#include <vector>
+
+// When set, large outputs are always evaluated whole, as GPU backends do.
+bool gSkDisableImageFilterTiles{false};
+
+// When set, raster backends draw filters with shaders instead of processing pixels directly. See
+// FilterResult::Builder::evalPixels().
+bool gSkDisablePixelKernels{false};
 
 namespace skif {
 
 namespace {
 
+// Outputs are split into tiles of this size when they cover at least two of them. The tiles are
+// large so that the margins that blurs and other neighborhood filters add to their inputs don't
+// multiply the work by much, and small enough that scrolling exposes only a few new ones.
+static constexpr int kTileSize = 512;
+// Outputs are never so large in practice, but this keeps the tile coordinates from overflowing.
+static constexpr int kMaxTiledCoord = 1 << 28;
+// Outputs that would need more tiles than this are evaluated whole: the tiles are only worth
+// caching while they fit in the cache, and the merged output is at least as large as all of them.
+static constexpr int kMaxTiles = 64;
+// Tiles are evaluated in batches of at most this many, each drawn into the output and released
+// (if not cached) before the next, so that only a few tiles are in memory besides the output.
+static constexpr int kTilesPerBatch = 16;
+
 // This exists to cover up issues where infinite precision would produce integers but float
 // math produces values just larger/smaller than an int and roundOut/In on bounds would produce
 // nearly a full pixel error. One such case is crbug.com/1313579 where the caller has produced
@@ -202,6 +228,10 @@ public:
         return SkImages::RasterFromBitmap(data);
     }
 
+    SkExecutor* tileExecutor() const override { return &SkExecutor::GetDefault(); }
+
+    bool supportsPixelKernels() const override { return !gSkDisablePixelKernels; }
+
 #if defined(SK_USE_LEGACY_BLUR_RASTER)
     const SkBlurEngine* getBlurEngine() const override { return nullptr; }
 #else
@@ -250,6 +280,14 @@ void Stats::dumpStats() const {
              fNumShaderBasedTilingDraws);
 }
 
+void Stats::add(const Stats& other) {
+    fNumVisitedImageFilters += other.fNumVisitedImageFilters;
+    fNumCacheHits += other.fNumCacheHits;
+    fNumOffscreenSurfaces += other.fNumOffscreenSurfaces;
+    fNumShaderClampedDraws += other.fNumShaderClampedDraws;
+    fNumShaderBasedTilingDraws += other.fNumShaderBasedTilingDraws;
+}
+
 void Stats::reportStats() const {
     TRACE_EVENT_INSTANT2("skia", "ImageFilter Graph Size", TRACE_EVENT_SCOPE_THREAD,
                          "count", fNumVisitedImageFilters, "cache hits", fNumCacheHits);
@@ -1939,6 +1977,118 @@ FilterResult FilterResult::MakeFromShader(const Context& ctx,
     return surface.snap();
 }
 
+FilterResult FilterResult::MakeFromTiles(
+        const Context& ctx,
+        bool translationInvariant,
+        const std::function<bool(const Context&, FilterResult*)>& findTile,
+        const std::function<FilterResult(const Context&)>& evalTile) {
+    SkASSERT(ctx.shouldEvaluateInTiles());
+
+    // Move layer space so that the layer matrix has no integer translation. The grid then moves
+    // with the content when the matrix scrolls it, and the tiles of the new output that show
+    // the same content as before have the same bounds and layer matrix as before.
+    Context gridCtx = ctx;
+    LayerSpace<IVector> shift({0, 0});
+    const SkMatrix& layerMatrix = ctx.mapping().layerMatrix();
+    if (translationInvariant && !layerMatrix.hasPerspective()) {
+        shift = LayerSpace<IVector>({sk_float_floor2int(layerMatrix.getTranslateX()),
+                                     sk_float_floor2int(layerMatrix.getTranslateY())});
+    }
+    if (shift.x() != 0 || shift.y() != 0) {
+        Mapping mapping = ctx.mapping();
+        mapping.applyOrigin(LayerSpace<SkIPoint>({shift.x(), shift.y()}));
+        LayerSpace<SkIRect> desiredOutput = ctx.desiredOutput();
+        desiredOutput.offset(-shift);
+        // The source isn't used by translation invariant outputs, so it needn't be moved.
+        gridCtx = ctx.withNewMapping(mapping)
+                     .withNewDesiredOutput(desiredOutput)
+                     .withNewSource({});
+    }
+
+    auto evalWhole = [&]() {
+        Context wholeCtx = ctx;
+        wholeCtx.fInTile = true;
+        return evalTile(wholeCtx);
+    };
+    const SkIRect output = SkIRect(gridCtx.desiredOutput());
+    if (!SkIRect::MakeLTRB(-kMaxTiledCoord, -kMaxTiledCoord, kMaxTiledCoord, kMaxTiledCoord)
+                 .contains(output)) {
+        return evalWhole();
+    }
+    auto floorDiv = [](int v) {
+        return v >= 0 ? v / kTileSize : -((kTileSize - 1 - v) / kTileSize);
+    };
+    const int left = floorDiv(output.fLeft),
+              top = floorDiv(output.fTop),
+              cols = floorDiv(output.fRight - 1) + 1 - left,
+              rows = floorDiv(output.fBottom - 1) + 1 - top;
+    if ((int64_t)cols * rows > kMaxTiles) {
+        return evalWhole();
+    }
+    const int tileCount = cols * rows;
+
+    AutoSurface surface{gridCtx, gridCtx.desiredOutput(), PixelBoundary::kTransparent,
+                        /*renderInParameterSpace=*/false};
+    if (!surface) {
+        return {};
+    }
+
+    // Tiles inside the output are evaluated whole, so that their results don't depend on where the
+    // output is. Tiles on its edge only evaluate the part within it, unless the whole tile was
+    // cached when it was inside an earlier output.
+    struct Tile {
+        FilterResult fResult;
+        Stats        fStats;
+    };
+    std::vector<Tile> tiles(std::min(tileCount, kTilesPerBatch));
+    LayerSpace<SkIRect> drawnBounds{SkIRect::MakeEmpty()};
+    for (int first = 0; first < tileCount; first += kTilesPerBatch) {
+        const int batchCount = std::min(tileCount - first, kTilesPerBatch);
+        SkTaskGroup(*ctx.backend()->tileExecutor()).batch(batchCount, [&](int j) {
+            const int i = first + j;
+            const LayerSpace<SkIRect> bounds{SkIRect::MakeXYWH((left + i % cols) * kTileSize,
+                                                               (top + i / cols) * kTileSize,
+                                                               kTileSize, kTileSize)};
+            Context tileCtx = gridCtx.withNewDesiredOutput(bounds);
+            tileCtx.fInTile = true;
+            tileCtx.fStats = &tiles[j].fStats;
+            FilterResult result;
+            if (gridCtx.desiredOutput().contains(bounds)) {
+                result = evalTile(tileCtx);
+            } else if (!findTile(tileCtx, &result)) {
+                LayerSpace<SkIRect> clipped = bounds;
+                SkAssertResult(clipped.intersect(gridCtx.desiredOutput()));
+                tileCtx = tileCtx.withNewDesiredOutput(clipped);
+                result = evalTile(tileCtx);
+            }
+            tiles[j].fResult = result.applyCrop(tileCtx, tileCtx.desiredOutput());
+        });
+
+        for (int j = 0; j < batchCount; j++) {
+            Tile& tile = tiles[j];
+            if (ctx.fStats) {
+                ctx.fStats->add(tile.fStats);
+            }
+            if (tile.fResult) {
+                tile.fResult.draw(gridCtx, surface.device(), /*preserveDeviceState=*/true);
+                drawnBounds.join(tile.fResult.layerBounds());
+            }
+            tile = {};
+        }
+    }
+    if (drawnBounds.isEmpty() || !drawnBounds.intersect(gridCtx.desiredOutput())) {
+        return {};
+    }
+    // Only as much of the output as the tiles drew in, as when the output is evaluated whole.
+    FilterResult result = surface.snap().applyCrop(gridCtx, drawnBounds);
+    if (shift.x() != 0 || shift.y() != 0) {
+        result = result.applyTransform(
+                ctx, LayerSpace<SkMatrix>(SkMatrix::Translate(shift.x(), shift.y())),
+                kDefaultSampling);
+    }
+    return result;
+}
+
 FilterResult FilterResult::MakeFromImage(const Context& ctx,
                                          sk_sp<SkImage> image,
                                          SkRect srcRect,
@@ -2100,6 +2250,44 @@ FilterResult FilterResult::Builder::merge() {
     return surface.snap();
 }
 
+FilterResult FilterResult::Builder::evalPixels(const SkIRect& kernelBounds,
+                                               const PixelKernel& kernel,
+                                               std::optional<LayerSpace<SkIRect>> explicitOutput) {
+    SkASSERT(fInputs.size() == 1);
+    SkASSERT(fContext.backend()->supportsPixelKernels());
+    SkASSERT(!kernelBounds.isEmpty());
+
+    auto outputBounds = this->outputBounds(explicitOutput);
+    if (outputBounds.isEmpty()) {
+        return {};
+    }
+
+    SkIRect sampleBounds = SkIRect(outputBounds);
+    sampleBounds.adjust(kernelBounds.fLeft, kernelBounds.fTop,
+                        kernelBounds.fRight - 1, kernelBounds.fBottom - 1);
+    // An empty result means the input is transparent black everywhere the kernel reads.
+    FilterResult resolved = fInputs[0].fImage.resolve(fContext, LayerSpace<SkIRect>(sampleBounds));
+    SkBitmap src;
+    SkIPoint srcOrigin = {0, 0};
+    if (resolved) {
+        if (!SkSpecialImages::AsBitmap(resolved.image(), &src)) {
+            return {};
+        }
+        SkASSERT(src.colorType() == kN32_SkColorType && src.alphaType() == kPremul_SkAlphaType);
+        srcOrigin = SkIPoint(resolved.layerBounds().topLeft()) - SkIPoint(outputBounds.topLeft());
+    }
+
+    SkBitmap dst;
+    if (!dst.tryAllocPixels(SkImageInfo::MakeN32Premul(SkISize(outputBounds.size()),
+                                                       fContext.refColorSpace()))) {
+        return {};
+    }
+    kernel(src.pixmap(), srcOrigin, dst.pixmap());
+    dst.setImmutable();
+    return {SkSpecialImages::MakeFromRaster(SkIRect::MakeSize(dst.dimensions()), dst, {}),
+            outputBounds.topLeft()};
+}
+
 FilterResult FilterResult::Builder::blur(const LayerSpace<SkSize>& sigma) {
     SkASSERT(fInputs.size() == 1);
 
@@ -2249,4 +2437,19 @@ FilterResult FilterResult::Builder::blur(const LayerSpace<SkSize>& sigma) {
     return result;
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Context
+
+bool Context::shouldEvaluateInTiles() const {
+    if (fInTile || gSkDisableImageFilterTiles || !fBackend->tileExecutor() || !fBackend->cache()) {
+        return false;
+    }
+    // Outputs too large to tile are caught by FilterResult::MakeFromTiles() too, but this avoids
+    // the overhead of moving the grid for them.
+    const SkIRect output = SkIRect(fDesiredOutput);
+    const int64_t area = output.width64() * output.height64();
+    return area >= 2 * kTileSize * kTileSize &&
+           area <= (int64_t)kMaxTiles * kTileSize * kTileSize;
+}
+
 } // end namespace skif
@@ -29,6 +29,7 @@
 #include "src/core/SkSpecialImage.h"
 
 #include <cstdint>
+#include <functional>
 #include <optional>
 #include <utility>
 
@@ -37,10 +38,12 @@ class SkBitmap;
 class SkBlender;
 class SkBlurEngine;
 class SkDevice;
+class SkExecutor;
 class SkImage;
 class SkImageFilter;
 class SkImageFilterCache;
 class SkPicture;
+class SkPixmap;
 class SkShader;
 enum SkColorType : int;
 
@@ -717,6 +720,23 @@ public:
                                        sk_sp<SkShader> shader,
                                        bool dither);
 
+    // Produces the output for the context's desired output from tiles on a grid fixed in layer
+    // space, where 'evalTile' produces the output for a context whose desired output is one tile,
+    // or the part of one that is within the output. Each tile can then be cached on its own, and
+    // when the desired output moves, e.g. when scrolling, only the newly exposed tiles are
+    // evaluated. A tile on the edge of the output is first looked for whole with 'findTile', in
+    // case it was inside an earlier output. If 'translationInvariant' is true, the grid is fixed
+    // relative to the layer matrix less its integer translation instead, so it moves along with
+    // content that is scrolled by the matrix. The tiles are evaluated concurrently on the
+    // backend's tile executor, a batch at a time, and drawn into the output as each batch
+    // finishes. Outputs that would need too many tiles are evaluated whole by 'evalTile' instead.
+    // See Context::shouldEvaluateInTiles().
+    static FilterResult MakeFromTiles(
+            const Context& ctx,
+            bool translationInvariant,
+            const std::function<bool(const Context&, FilterResult*)>& findTile,
+            const std::function<FilterResult(const Context&)>& evalTile);
+
     // Converts image to a FilterResult. If 'srcRect' is pixel-aligned it does so without rendering.
     // Otherwise it draws the src->dst sampling of 'image' into an optimally sized surface based
     // on the context's desired output. 'image' must not be null.
@@ -1000,7 +1020,8 @@ public:
     // eval() to control how 'input' is converted to an SkShader. 'inputSampling' specifies the
     // sampling options to use on the input's image when sampled by the final shader created in eval
     //
-    // 'sampleBounds', 'inputFlags' and 'inputSampling' must not be used with merge() or blur().
+    // 'sampleBounds', 'inputFlags' and 'inputSampling' must not be used with merge(), blur() or
+    // evalPixels().
     Builder& add(const FilterResult& input,
                  std::optional<LayerSpace<SkIRect>> sampleBounds = {},
                  SkEnumBitMask<ShaderFlags> inputFlags = ShaderFlags::kNone,
@@ -1018,6 +1039,22 @@ public:
     // Builder's Context.
     FilterResult blur(const LayerSpace<SkSize>& sigma);
 
+    // A kernel for evalPixels() that writes every pixel of 'dst' from the pixels of 'src', both N32
+    // premul. 'srcOrigin' is the position of the top-left of 'src' relative to the top-left of
+    // 'dst', and the input is transparent black outside of 'src', which may be empty.
+    using PixelKernel = std::function<void(const SkPixmap& src,
+                                           const SkIPoint& srcOrigin,
+                                           const SkPixmap& dst)>;
+
+    // Process the single input on the CPU with 'kernel' instead of drawing a shader, which requires
+    // that the Context's backend supportsPixelKernels(). 'kernelBounds' holds the offsets from each
+    // output pixel to the input pixels that the kernel reads, and the input is resolved over those
+    // (with its tiling, transform and color filter applied). The output bounds are determined as
+    // they are for eval().
+    FilterResult evalPixels(const SkIRect& kernelBounds,
+                            const PixelKernel& kernel,
+                            std::optional<LayerSpace<SkIRect>> explicitOutput = {});
+
     // Combine all added inputs by transforming them into equivalent SkShaders and invoking the
     // shader factory that binds them together into a single shader that fills the output surface.
     //
@@ -1104,6 +1141,14 @@ public:
 
     SkImageFilterCache* cache() const { return fCache.get(); }
 
+    // The executor to evaluate the tiles of large outputs on, or null if outputs should always be
+    // evaluated whole. See FilterResult::MakeFromTiles().
+    virtual SkExecutor* tileExecutor() const { return nullptr; }
+
+    // Whether this backend's images are raster, so that filters can process their pixels directly
+    // on the CPU with FilterResult::Builder::evalPixels() instead of drawing with shaders.
+    virtual bool supportsPixelKernels() const { return false; }
+
 protected:
     Backend(sk_sp<SkImageFilterCache> cache,
             const SkSurfaceProps& surfaceProps,
@@ -1127,6 +1172,8 @@ struct Stats {
 
     void dumpStats() const;   // log to std out
     void reportStats() const; // trace event counters
+
+    void add(const Stats& other); // e.g. from evaluating tiles on other threads
 };
 
 // The context contains all necessary information to describe how the image filter should be
@@ -1207,6 +1254,11 @@ public:
     }
 
 
+    // Whether the desired output is large enough to be worth evaluating in tiles with
+    // FilterResult::MakeFromTiles(), but not so large that its tiles would be too many to keep,
+    // and the backend supports it. Always false within a tile.
+    bool shouldEvaluateInTiles() const;
+
     // Stats tracking
     void markVisitedImageFilter() const {
         if (fStats) {
@@ -1235,6 +1287,7 @@ public:
 
 private:
     friend class ::FilterResultTestAccess; // For controlling Stats
+    friend class FilterResult;             // For MakeFromTiles()
 
     sk_sp<Backend> fBackend;
 
@@ -1247,6 +1300,8 @@ private:
     sk_sp<SkColorSpace> fColorSpace;
 
     Stats* fStats;
+    // Set for the contexts of tiles, which are not split again.
+    bool   fInTile = false;
 };
 
 } // end namespace skif
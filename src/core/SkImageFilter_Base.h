@@ -239,6 +239,13 @@ private:
      */
     virtual bool ignoreInputsAffectsTransparentBlack() const { return false; }
 
+    /**
+     *  Return true if this filter's output is normally deferred, e.g. as a transform, crop or
+     *  color filter of its input that is applied when the output is drawn, rather than rendered.
+     *  Large outputs of such filters are not evaluated in tiles, though their inputs may be.
+     */
+    virtual bool onDefersOutput() const { return false; }
+
     /**
      *  This is the virtual which should be overridden by the derived class to perform image
      *  filtering. Subclasses are responsible for recursing to their input filters, although the
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkMappedPicture.h"
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkScalar.h"
+#include "include/private/base/SkAssert.h"
+#include "include/utils/SkNoDrawCanvas.h"
+#include "src/core/SkPictureData.h"
+#include "src/core/SkPicturePlayback.h"
+
+#include <utility>
+
+sk_sp<SkPicture> SkMappedPicture::Make(std::unique_ptr<SkPictureData> data) {
+    if (!data || !data->opData()) {
+        return nullptr;
+    }
+    return sk_sp<SkPicture>(new SkMappedPicture(std::move(data)));
+}
+
+SkMappedPicture::SkMappedPicture(std::unique_ptr<SkPictureData> data) : fData(std::move(data)) {}
+
+SkMappedPicture::~SkMappedPicture() = default;
+
+void SkMappedPicture::playback(SkCanvas* canvas, AbortCallback* callback) const {
+    SkASSERT(canvas);
+    SkPicturePlayback(fData.get()).draw(canvas, callback, nullptr);
+}
+
+SkRect SkMappedPicture::cullRect() const { return fData->info().fCullRect; }
+
+int SkMappedPicture::approximateOpCount(bool nested) const {
+    int count = fOpCount.load(std::memory_order_relaxed);
+    if (count < 0) {
+        // The playback asks whether to abort before each op.
+        struct OpCounter final : public AbortCallback {
+            bool abort() override { fCount++; return false; }
+            int fCount = 0;
+        } counter;
+        const SkRect cull = this->cullRect();
+        SkNoDrawCanvas canvas(SkScalarCeilToInt(cull.right()), SkScalarCeilToInt(cull.bottom()));
+        this->playback(&canvas, &counter);
+        count = counter.fCount;
+        fOpCount.store(count, std::memory_order_relaxed);
+    }
+    if (nested) {
+        for (const sk_sp<const SkPicture>& picture : fData->pictures()) {
+            count += picture->approximateOpCount(true);
+        }
+    }
+    return count;
+}
+
+size_t SkMappedPicture::approximateBytesUsed() const {
+    // The ops are left in the mapping, so they aren't counted.
+    size_t bytes = sizeof(*this) + fData->approximateParsedBytesUsed();
+    for (const sk_sp<const SkPicture>& picture : fData->pictures()) {
+        bytes += picture->approximateBytesUsed();
+    }
+    return bytes;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkMappedPicture_DEFINED
+#define SkMappedPicture_DEFINED
+
+#include "include/core/SkPicture.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+class SkCanvas;
+class SkPictureData;
+
+// An SkPicture that plays back serialized SkPictureData directly, instead of first recording it
+// into an SkRecord. Made by SkPicture::MakeFromMappedData(), where the ops and encoded images
+// in that data still point into the mapped file.
+class SkMappedPicture final : public SkPicture {
+public:
+    static sk_sp<SkPicture> Make(std::unique_ptr<SkPictureData>);
+
+    ~SkMappedPicture() override;
+
+// SkPicture overrides
+    void playback(SkCanvas*, AbortCallback*) const override;
+    SkRect cullRect() const override;
+    int approximateOpCount(bool nested) const override;
+    size_t approximateBytesUsed() const override;
+
+private:
+    explicit SkMappedPicture(std::unique_ptr<SkPictureData>);
+
+    std::unique_ptr<const SkPictureData> fData;
+    // Counted by playing back the ops, the first time it's asked for.
+    mutable std::atomic<int>             fOpCount{-1};
+};
+
+#endif//SkMappedPicture_DEFINED
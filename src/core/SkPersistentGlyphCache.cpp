@@ -0,0 +1,284 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkPersistentGlyphCache.h"
+
+#include "include/core/SkFontArguments.h"
+#include "include/core/SkStream.h"
+#include "include/core/SkTypeface.h"
+#include "include/private/base/SkAlign.h"
+#include "include/private/base/SkTemplates.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkDescriptor.h"
+#include "src/core/SkScalerContext.h"
+#include "src/core/SkStrike.h"
+#include "src/core/SkStrikeCache.h"
+#include "src/core/SkWriteBuffer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace {
+// Bump the version whenever the layout below, SkScalerContextRec, or the glyph flattening change.
+constexpr uint32_t kMagic = SkSetFourByteTag('s', 'k', 'g', 'c');
+constexpr uint32_t kVersion = 2;
+
+struct Header {
+    uint32_t fMagic;
+    uint32_t fVersion;
+    uint32_t fStrikeCount;
+    uint32_t fPadding;
+    uint64_t fPayloadSize;  // everything after the header
+    uint64_t fChecksum;     // of the payload
+};
+
+// Followed by the descriptor, the flattened glyphs and the glyph index, each padded to 8 bytes.
+struct StrikeHeader {
+    uint64_t      fTypefaceHash;
+    uint32_t      fDescriptorSize;
+    uint32_t      fGlyphsSize;
+    uint32_t      fGlyphCount;
+    uint32_t      fPadding;
+    SkFontMetrics fFontMetrics;
+};
+
+constexpr size_t kAlignment = 8;
+static_assert(sizeof(Header) % kAlignment == 0);
+static_assert(sizeof(StrikeHeader) % kAlignment == 0);
+
+// A copy of the descriptor whose typeface ID is 0, as that differs from process to process.
+SkAutoDescriptor without_typeface_id(const SkDescriptor& desc) {
+    SkAutoDescriptor copy{desc};
+    uint32_t length;
+    void* entry = const_cast<void*>(copy.getDesc()->findEntry(kRec_SkDescriptorTag, &length));
+    if (entry && length == sizeof(SkScalerContextRec)) {
+        SkScalerContextRec rec = *static_cast<const SkScalerContextRec*>(entry);
+        rec.fTypefaceID = 0;
+        memcpy(entry, &rec, sizeof(rec));
+        copy.getDesc()->computeChecksum();
+    }
+    return copy;
+}
+
+uint64_t key_for(const SkDescriptor& normalized, uint64_t typefaceHash) {
+    return SkChecksum::Mix(normalized.getChecksum()) ^ typefaceHash;
+}
+
+// Hashes the font data, collection index and variation of the typeface, or returns 0 if its data
+// can't be read.
+uint64_t hash_typeface(const SkTypeface& typeface) {
+    int ttcIndex;
+    std::unique_ptr<SkStreamAsset> stream = typeface.openStream(&ttcIndex);
+    if (!stream) {
+        return 0;
+    }
+    sk_sp<SkData> data;
+    const void* bytes = stream->getMemoryBase();
+    size_t size = stream->getLength();
+    if (!bytes) {
+        data = SkData::MakeFromStream(stream.get(), size);
+        if (!data) {
+            return 0;
+        }
+        bytes = data->data();
+    }
+    uint64_t hash = SkChecksum::Hash64(bytes, size, ttcIndex);
+
+    const int axisCount = typeface.getVariationDesignPosition(nullptr, 0);
+    if (axisCount > 0) {
+        skia_private::AutoTArray<SkFontArguments::VariationPosition::Coordinate> coords(axisCount);
+        if (typeface.getVariationDesignPosition(coords.get(), axisCount) == axisCount) {
+            hash = SkChecksum::Hash64(coords.get(), axisCount * sizeof(coords[0]), hash);
+        }
+    }
+    return hash ? hash : 1;
+}
+
+void pad(SkWStream* stream, size_t size) {
+    static constexpr char kZeros[kAlignment] = {};
+    stream->write(kZeros, SkAlignTo(size, kAlignment) - size);
+}
+}  // namespace
+
+sk_sp<SkPersistentGlyphCache> SkPersistentGlyphCache::Make(sk_sp<SkData> data) {
+    if (!data || data->size() < sizeof(Header) ||
+        !SkIsAlign8(reinterpret_cast<uintptr_t>(data->data()))) {
+        return nullptr;
+    }
+    Header header;
+    memcpy(&header, data->data(), sizeof(header));
+    const char* payload = static_cast<const char*>(data->data()) + sizeof(Header);
+    if (header.fMagic != kMagic || header.fVersion != kVersion ||
+        header.fPayloadSize != data->size() - sizeof(Header) ||
+        header.fChecksum != SkChecksum::Hash64(payload, header.fPayloadSize)) {
+        return nullptr;
+    }
+
+    sk_sp<SkPersistentGlyphCache> cache{new SkPersistentGlyphCache(std::move(data))};
+    cache->fStrikes.reserve(header.fStrikeCount);
+    const char* cursor = payload;
+    const char* const end = payload + header.fPayloadSize;
+    for (uint32_t i = 0; i < header.fStrikeCount; ++i) {
+        if ((size_t)(end - cursor) < sizeof(StrikeHeader)) {
+            return nullptr;
+        }
+        const StrikeHeader* strike = reinterpret_cast<const StrikeHeader*>(cursor);
+        cursor += sizeof(StrikeHeader);
+
+        const size_t descriptorSpace = SkAlignTo(strike->fDescriptorSize, kAlignment),
+                     glyphsSpace = SkAlignTo(strike->fGlyphsSize, kAlignment),
+                     indexSpace = SkAlignTo(strike->fGlyphCount * sizeof(Glyph), kAlignment);
+        if (strike->fDescriptorSize < sizeof(SkDescriptor) ||
+            (size_t)(end - cursor) < descriptorSpace ||
+            (size_t)(end - cursor) - descriptorSpace < glyphsSpace ||
+            (size_t)(end - cursor) - descriptorSpace - glyphsSpace < indexSpace) {
+            return nullptr;
+        }
+        const SkDescriptor* desc = reinterpret_cast<const SkDescriptor*>(cursor);
+        if (desc->getLength() != strike->fDescriptorSize || !desc->isValid()) {
+            return nullptr;
+        }
+        cursor += descriptorSpace;
+
+        const char* glyphs = cursor;
+        cursor += glyphsSpace;
+        const Glyph* index = reinterpret_cast<const Glyph*>(cursor);
+        cursor += indexSpace;
+
+        cache->fIndexForKey.set(key_for(*desc, strike->fTypefaceHash), cache->fStrikes.size());
+        cache->fStrikes.push_back({strike->fTypefaceHash, desc,
+                                   {&strike->fFontMetrics, glyphs, strike->fGlyphsSize,
+                                    index, strike->fGlyphCount}});
+    }
+    return cursor == end ? cache : nullptr;
+}
+
+SkPersistentGlyphCache::SkPersistentGlyphCache(sk_sp<SkData> data) : fData{std::move(data)} {}
+
+auto SkPersistentGlyphCache::Strike::findGlyph(uint32_t packedID) const -> const Glyph* {
+    const Glyph* end = fIndex + fGlyphCount;
+    const Glyph* glyph = std::lower_bound(fIndex, end, packedID,
+                                          [](const Glyph& g, uint32_t id) {
+                                              return g.fPackedID < id;
+                                          });
+    return glyph != end && glyph->fPackedID == packedID ? glyph : nullptr;
+}
+
+uint64_t SkPersistentGlyphCache::typefaceHash(const SkTypeface& typeface) const {
+    {
+        SkAutoMutexExclusive lock{fTypefaceHashLock};
+        if (const uint64_t* hash = fTypefaceHashes.find(typeface.uniqueID())) {
+            return *hash;
+        }
+    }
+    // Typefaces are immutable, so a racing thread computes the same hash.
+    const uint64_t hash = hash_typeface(typeface);
+    SkAutoMutexExclusive lock{fTypefaceHashLock};
+    fTypefaceHashes.set(typeface.uniqueID(), hash);
+    return hash;
+}
+
+bool SkPersistentGlyphCache::find(const SkDescriptor& desc,
+                                  const SkTypeface& typeface,
+                                  Strike* strike) const {
+    if (fStrikes.empty()) {
+        return false;
+    }
+    const uint64_t typefaceHash = this->typefaceHash(typeface);
+    if (typefaceHash != 0) {
+        SkAutoDescriptor normalized = without_typeface_id(desc);
+        const uint64_t key = key_for(*normalized.getDesc(), typefaceHash);
+        if (const size_t* index = fIndexForKey.find(key)) {
+            const Entry& entry = fStrikes[*index];
+            if (entry.fTypefaceHash == typefaceHash &&
+                *entry.fDescriptor == *normalized.getDesc()) {
+                *strike = entry.fStrike;
+                fHits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    fMisses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void SkPersistentGlyphCache::Write(SkStrikeCache* strikeCache, SkWStream* stream) {
+    SkDynamicMemoryWStream payload;
+    uint32_t strikeCount = 0;
+    skia_private::THashMap<uint32_t, uint64_t> typefaceHashes;
+    strikeCache->forEachStrike([&](const SkStrike& strike) {
+        const SkTypeface& typeface = strike.strikeSpec().typeface();
+        uint64_t* typefaceHash = typefaceHashes.find(typeface.uniqueID());
+        if (!typefaceHash) {
+            typefaceHash = typefaceHashes.set(typeface.uniqueID(), hash_typeface(typeface));
+        }
+        if (*typefaceHash == 0) {
+            return;
+        }
+
+        SkBinaryWriteBuffer glyphs({});
+        std::vector<SkStrike::FlattenedGlyph> images, paths;
+        strike.flattenGlyphs(glyphs, &images, &paths);
+        SkAutoDescriptor desc = without_typeface_id(strike.getDescriptor());
+
+        // A glyph may have been written with its image, its path, or both.
+        std::vector<Glyph> index;
+        skia_private::THashMap<uint32_t, size_t> indexForID;
+        auto entryFor = [&](SkPackedGlyphID packedID) -> Glyph& {
+            if (const size_t* i = indexForID.find(packedID.value())) {
+                return index[*i];
+            }
+            indexForID.set(packedID.value(), index.size());
+            return index.emplace_back(Glyph{packedID.value(), Glyph::kNone, Glyph::kNone});
+        };
+        for (const SkStrike::FlattenedGlyph& image : images) {
+            entryFor(image.fPackedID).fImageOffset = SkToU32(image.fOffset);
+        }
+        for (const SkStrike::FlattenedGlyph& path : paths) {
+            entryFor(path.fPackedID).fPathOffset = SkToU32(path.fOffset);
+        }
+        std::sort(index.begin(), index.end(), [](const Glyph& a, const Glyph& b) {
+            return a.fPackedID < b.fPackedID;
+        });
+
+        StrikeHeader header;
+        memset(&header, 0, sizeof(header));
+        header.fTypefaceHash = *typefaceHash;
+        header.fDescriptorSize = desc.getDesc()->getLength();
+        header.fGlyphsSize = SkToU32(glyphs.bytesWritten());
+        header.fGlyphCount = SkToU32(index.size());
+        header.fFontMetrics = strike.getFontMetrics();
+        payload.write(&header, sizeof(header));
+        payload.write(desc.getDesc(), header.fDescriptorSize);
+        pad(&payload, header.fDescriptorSize);
+        glyphs.writeToStream(&payload);
+        pad(&payload, header.fGlyphsSize);
+        payload.write(index.data(), index.size() * sizeof(Glyph));
+        pad(&payload, index.size() * sizeof(Glyph));
+        strikeCount += 1;
+    });
+
+    sk_sp<SkData> bytes = payload.detachAsData();
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.fMagic = kMagic;
+    header.fVersion = kVersion;
+    header.fStrikeCount = strikeCount;
+    header.fPayloadSize = bytes->size();
+    header.fChecksum = SkChecksum::Hash64(bytes->data(), bytes->size());
+    stream->write(&header, sizeof(header));
+    stream->write(bytes->data(), bytes->size());
+}
+
+sk_sp<SkData> SkPersistentGlyphCache::Serialize(SkStrikeCache* strikeCache) {
+    SkDynamicMemoryWStream stream;
+    Write(strikeCache, &stream);
+    return stream.detachAsData();
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPersistentGlyphCache_DEFINED
+#define SkPersistentGlyphCache_DEFINED
+
+#include "include/core/SkData.h"
+#include "include/core/SkFontMetrics.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkTypes.h"
+#include "include/private/base/SkMutex.h"
+#include "include/private/base/SkThreadAnnotations.h"
+#include "src/core/SkTHash.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class SkDescriptor;
+class SkStrikeCache;
+class SkTypeface;
+class SkWStream;
+
+// Glyph metrics, masks and paths saved from a strike cache, so that a later process's strikes can
+// take them instead of generating them again. The saved data is used in place, so it can be a file
+// mapped read-only and shared between processes, and each glyph is only read when a strike first
+// asks for it.
+//
+// Strikes are keyed by their descriptor, less the typeface ID which only means something in one
+// process, and by a hash of the typeface's font data. Typefaces whose data can't be read are not
+// saved. The file is checked against a version and a checksum before any of it is used.
+class SkPersistentGlyphCache final : public SkNVRefCnt<SkPersistentGlyphCache> {
+public:
+    // Returns nullptr if the data was written by a different version, fails its checksum, or is
+    // malformed. The data must be 8-byte aligned, as mapped files and SkData copies are.
+    static sk_sp<SkPersistentGlyphCache> Make(sk_sp<SkData>);
+
+    // Writes the glyphs in every strike of the cache which have images or paths.
+    static void Write(SkStrikeCache*, SkWStream*);
+    static sk_sp<SkData> Serialize(SkStrikeCache*);
+
+    // Where a glyph was saved, as offsets of its metrics in Strike::fGlyphs. Sorted by ID.
+    struct Glyph {
+        static constexpr uint32_t kNone = UINT32_MAX;
+
+        uint32_t fPackedID;
+        uint32_t fImageOffset;  // followed by its image, or kNone
+        uint32_t fPathOffset;   // followed by its path, or kNone
+    };
+
+    struct Strike {
+        const SkFontMetrics* fFontMetrics;
+        const void*          fGlyphs;  // each as SkStrike::FlattenGlyphsByType writes them
+        size_t               fGlyphsSize;
+        const Glyph*         fIndex;
+        size_t               fGlyphCount;
+
+        // Returns nullptr if the glyph wasn't saved.
+        const Glyph* findGlyph(uint32_t packedID) const;
+    };
+
+    // Finds the saved glyphs for a strike with this descriptor and typeface. Hashing a typeface
+    // the first time reads all of its data, so don't call this holding a lock others may need.
+    bool find(const SkDescriptor&, const SkTypeface&, Strike*) const;
+
+    int count() const { return SkToInt(fStrikes.size()); }
+    uint64_t hits() const { return fHits.load(std::memory_order_relaxed); }
+    uint64_t misses() const { return fMisses.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        uint64_t            fTypefaceHash;
+        const SkDescriptor* fDescriptor;
+        Strike              fStrike;
+    };
+
+    explicit SkPersistentGlyphCache(sk_sp<SkData>);
+
+    uint64_t typefaceHash(const SkTypeface&) const;
+
+    const sk_sp<SkData>                      fData;
+    std::vector<Entry>                       fStrikes;
+    skia_private::THashMap<uint64_t, size_t> fIndexForKey;
+
+    // Hashing a typeface reads all its data, so remember the hashes. 0 means it can't be saved.
+    mutable SkMutex                                  fTypefaceHashLock;
+    mutable skia_private::THashMap<uint32_t, uint64_t> fTypefaceHashes
+            SK_GUARDED_BY(fTypefaceHashLock);
+
+    mutable std::atomic<uint64_t> fHits{0};
+    mutable std::atomic<uint64_t> fMisses{0};
+};
+
+#endif  // SkPersistentGlyphCache_DEFINED
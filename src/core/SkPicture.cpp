@@ -7,6 +7,7 @@
 
 #include "include/core/SkPicture.h"
 
+#include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
 #include "include/core/SkPictureRecorder.h"
 #include "include/core/SkSerialProcs.h"
@@ -15,6 +16,7 @@
 #include "include/private/base/SkTo.h"
 #include "src/base/SkMathPriv.h"
 #include "src/core/SkCanvasPriv.h"
+#include "src/core/SkMappedPicture.h"
 #include "src/core/SkPictureData.h"
 #include "src/core/SkPicturePlayback.h"
 #include "src/core/SkPicturePriv.h"
@@ -22,8 +24,10 @@
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkResourceCache.h"
 #include "src/core/SkStreamPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkWriteBuffer.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
 #include <memory>
@@ -38,6 +42,8 @@ enum {
     kFailure_TrailingStreamByteAfterPictInfo     = 0,   // nothing follows
     kPictureData_TrailingStreamByteAfterPictInfo = 1,   // SkPictureData follows
     kCustom_TrailingStreamByteAfterPictInfo      = 2,   // -size32 follows
+    kMappablePictureData_TrailingStreamByteAfterPictInfo = 3,   // SkPictureData follows, with
+                                                                // each tag 4-byte aligned
 };
 
 /* SkPicture impl.  This handles generic responsibilities like unique IDs and serialization. */
@@ -165,8 +171,17 @@ sk_sp<SkPicture> SkPicture::MakeFromData(const SkData* data, const SkDeserialPro
     return MakeFromStreamPriv(&stream, procs, nullptr, kNestedSKPLimit);
 }
 
+sk_sp<SkPicture> SkPicture::MakeFromMappedData(sk_sp<SkData> data, const SkDeserialProcs* procs) {
+    if (!data) {
+        return nullptr;
+    }
+    SkMemoryStream stream(data);
+    return MakeFromStreamPriv(&stream, procs, nullptr, kNestedSKPLimit, data.get());
+}
+
 sk_sp<SkPicture> SkPicture::MakeFromStreamPriv(SkStream* stream, const SkDeserialProcs* procsPtr,
-                                               SkTypefacePlayback* typefaces, int recursionLimit) {
+                                               SkTypefacePlayback* typefaces, int recursionLimit,
+                                               const SkData* sharedData) {
     if (recursionLimit <= 0) {
         return nullptr;
     }
@@ -189,6 +204,17 @@ sk_sp<SkPicture> SkPicture::MakeFromStreamPriv(SkStream* stream, const SkDeseria
                                                     recursionLimit));
             return Forwardport(info, data.get(), nullptr);
         }
+        case kMappablePictureData_TrailingStreamByteAfterPictInfo: {
+            std::unique_ptr<SkPictureData> data(
+                    SkPictureData::CreateFromStream(stream, info, procs, typefaces,
+                                                    recursionLimit, /*alignedTags=*/true,
+                                                    sharedData));
+            if (sharedData) {
+                // Play back straight from the data, rather than re-recording it.
+                return SkMappedPicture::Make(std::move(data));
+            }
+            return Forwardport(info, data.get(), nullptr);
+        }
         case kCustom_TrailingStreamByteAfterPictInfo: {
             int32_t ssize;
             if (!stream->readS32(&ssize) || ssize >= 0 || !procs.fPictureProc) {
@@ -252,6 +278,16 @@ sk_sp<SkData> SkPicture::serialize(const SkSerialProcs* procs) const {
     return stream.detachAsData();
 }
 
+void SkPicture::serializeForMapping(SkWStream* stream, const SkSerialProcs* procs) const {
+    this->serialize(stream, procs, nullptr, /*textBlobsOnly=*/false, /*alignForMapping=*/true);
+}
+
+sk_sp<SkData> SkPicture::serializeForMapping(const SkSerialProcs* procs) const {
+    SkDynamicMemoryWStream stream;
+    this->serializeForMapping(&stream, procs);
+    return stream.detachAsData();
+}
+
 static sk_sp<SkData> custom_serialize(const SkPicture* picture, const SkSerialProcs& procs) {
     if (procs.fPictureProc) {
         auto data = procs.fPictureProc(const_cast<SkPicture*>(picture), procs.fPictureCtx);
@@ -281,7 +317,8 @@ static bool write_pad32(SkWStream* stream, const void* data, size_t size) {
 // SkPictureData::serialize makes a first pass on all subpictures, indicated by textBlobsOnly=true,
 // to fill typefaceSet.
 void SkPicture::serialize(SkWStream* stream, const SkSerialProcs* procsPtr,
-                          SkRefCntSet* typefaceSet, bool textBlobsOnly) const {
+                          SkRefCntSet* typefaceSet, bool textBlobsOnly,
+                          bool alignForMapping) const {
     SkSerialProcs procs;
     if (procsPtr) {
         procs = *procsPtr;
@@ -304,8 +341,9 @@ void SkPicture::serialize(SkWStream* stream, const SkSerialProcs* procsPtr,
 
     std::unique_ptr<SkPictureData> data(this->backport());
     if (data) {
-        stream->write8(kPictureData_TrailingStreamByteAfterPictInfo);
-        data->serialize(stream, procs, typefaceSet, textBlobsOnly);
+        stream->write8(alignForMapping ? kMappablePictureData_TrailingStreamByteAfterPictInfo
+                                       : kPictureData_TrailingStreamByteAfterPictInfo);
+        data->serialize(stream, procs, typefaceSet, textBlobsOnly, alignForMapping);
     } else {
         stream->write8(kFailure_TrailingStreamByteAfterPictInfo);
     }
@@ -334,6 +372,40 @@ void SkPicturePriv::Flatten(const sk_sp<const SkPicture> picture, SkWriteBuffer&
     }
 }
 
+void SkPicture::playbackParallel(const BandCanvasFactory& canvasForBand,
+                                 SkExecutor* executor,
+                                 int bandCount) const {
+    const SkIRect cull = this->cullRect().roundOut();
+    if (cull.isEmpty()) {
+        return;
+    }
+    const int64_t height = cull.height64();
+    bandCount = SkTo<int>(std::clamp<int64_t>(bandCount, 1, height));
+
+    auto drawBand = [&](int i) {
+        const SkIRect band = SkIRect::MakeLTRB(cull.fLeft,
+                                               SkTo<int>(cull.fTop + height *  i      / bandCount),
+                                               cull.fRight,
+                                               SkTo<int>(cull.fTop + height * (i + 1) / bandCount));
+        std::unique_ptr<SkCanvas> canvas = canvasForBand(band);
+        if (!canvas) {
+            return;
+        }
+        // Each band's local clip bounds select its own query into the picture's BBH, if any.
+        SkAutoCanvasRestore acr(canvas.get(), /*doSave=*/true);
+        canvas->clipRect(SkRect::Make(band));
+        this->playback(canvas.get());
+    };
+
+    if (executor && bandCount > 1) {
+        SkTaskGroup(*executor).batch(bandCount, drawBand);
+    } else {
+        for (int i = 0; i < bandCount; i++) {
+            drawBand(i);
+        }
+    }
+}
+
 sk_sp<SkPicture> SkPicture::MakePlaceholder(SkRect cull) {
     struct Placeholder : public SkPicture {
           explicit Placeholder(SkRect cull) : fCull(cull) {}
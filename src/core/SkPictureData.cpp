@@ -13,6 +13,7 @@
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/core/SkTypeface.h"
+#include "include/private/base/SkAlign.h"
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkTFitsIn.h"
 #include "include/private/base/SkTemplates.h"
@@ -101,6 +102,14 @@ static void write_tag_size(SkWStream* stream, uint32_t tag, size_t size) {
     stream->write32(SkToU32(size));
 }
 
+// Pads so the next tag starts at a multiple of 4 bytes into the stream.
+static void align_tag(SkWStream* stream) {
+    if (size_t misalignment = stream->bytesWritten() & 3) {
+        static constexpr uint32_t kZero = 0;
+        stream->write(&kZero, 4 - misalignment);
+    }
+}
+
 void SkPictureData::WriteFactories(SkWStream* stream, const SkFactorySet& rec) {
     int count = rec.count();
 
@@ -225,8 +234,16 @@ static SkSerialProcs skip_typeface_proc(const SkSerialProcs& procs) {
 // possible that is not relevant to collecting text blobs in topLevelTypeFaceSet
 // TODO(nifong): dedupe typefaces and all other shared resources in a faster and more readable way.
 void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
-                              SkRefCntSet* topLevelTypeFaceSet, bool textBlobsOnly) const {
+                              SkRefCntSet* topLevelTypeFaceSet, bool textBlobsOnly,
+                              bool alignForMapping) const {
+    auto alignTag = [&] {
+        if (alignForMapping) {
+            align_tag(stream);
+        }
+    };
+
     // This can happen at pretty much any time, so might as well do it first.
+    alignTag();
     write_tag_size(stream, SK_PICT_READER_TAG, fOpData->size());
     stream->write(fOpData->bytes(), fOpData->size());
 
@@ -257,24 +274,30 @@ void SkPictureData::serialize(SkWStream* stream, const SkSerialProcs& procs,
 
     // We need to write factories before we write the buffer.
     // We need to write typefaces before we write the buffer or any sub-picture.
+    alignTag();
     WriteFactories(stream, factSet);
     // Pass the original typefaceproc (if any) now that we're ready to actually serialize the
     // typefaces. We skipped this proc before, when we were serializing paints, so that the
     // paints would just write indices into our typeface set.
+    alignTag();
     WriteTypefaces(stream, *typefaceSet, procs);
 
     // Write the buffer.
+    alignTag();
     write_tag_size(stream, SK_PICT_BUFFER_SIZE_TAG, buffer.bytesWritten());
     buffer.writeToStream(stream);
 
     // Write sub-pictures by calling serialize again.
     if (!fPictures.empty()) {
+        alignTag();
         write_tag_size(stream, SK_PICT_PICTURE_TAG, fPictures.size());
         for (const auto& pic : fPictures) {
-            pic->serialize(stream, &procs, typefaceSet, /*textBlobsOnly=*/ false);
+            pic->serialize(stream, &procs, typefaceSet, /*textBlobsOnly=*/ false,
+                           alignForMapping);
         }
     }
 
+    alignTag();
     stream->write32(SK_PICT_EOF_TAG);
 }
 
@@ -312,6 +335,11 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
     switch (tag) {
         case SK_PICT_READER_TAG:
             SkASSERT(nullptr == fOpData);
+            if (const void* shared = this->sharedBytes(stream, size)) {
+                fOpData = SkData::MakeSubset(fSharedData,
+                                             (const uint8_t*)shared - fSharedData->bytes(), size);
+                break;
+            }
             fOpData = SkData::MakeFromStream(stream, size);
             if (!fOpData) {
                 return false;
@@ -370,7 +398,8 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
 
             for (uint32_t i = 0; i < size; i++) {
                 auto pic = SkPicture::MakeFromStreamPriv(stream, &procs,
-                                                         topLevelTFPlayback, recursionLimit - 1);
+                                                         topLevelTFPlayback, recursionLimit - 1,
+                                                         fSharedData);
                 if (!pic) {
                     return false;
                 }
@@ -381,13 +410,22 @@ bool SkPictureData::parseStreamTag(SkStream* stream,
             if (StreamRemainingLengthIsBelow(stream, size)) {
                 return false;
             }
-            SkAutoMalloc storage(size);
-            if (stream->read(storage.get(), size) != size) {
-                return false;
+            SkAutoMalloc storage;
+            const void* bytes = this->sharedBytes(stream, size);
+            const bool shared = bytes != nullptr;
+            if (!shared) {
+                bytes = storage.reset(size);
+                if (stream->read(storage.get(), size) != size) {
+                    return false;
+                }
             }
 
-            SkReadBuffer buffer(storage.get(), size);
+            SkReadBuffer buffer(bytes, size);
             buffer.setVersion(fInfo.getVersion());
+            if (shared) {
+                // Byte arrays, like encoded images, can then be used in place too.
+                buffer.setSharedData(fSharedData);
+            }
 
             if (!fFactoryPlayback) {
                 return false;
@@ -519,18 +557,47 @@ SkPictureData* SkPictureData::CreateFromStream(SkStream* stream,
                                                const SkPictInfo& info,
                                                const SkDeserialProcs& procs,
                                                SkTypefacePlayback* topLevelTFPlayback,
-                                               int recursionLimit) {
+                                               int recursionLimit,
+                                               bool alignedTags,
+                                               const SkData* sharedData) {
     std::unique_ptr<SkPictureData> data(new SkPictureData(info));
     if (!topLevelTFPlayback) {
         topLevelTFPlayback = &data->fTFPlayback;
     }
+    if (alignedTags && !stream->hasPosition()) {
+        return nullptr;
+    }
+    data->fAlignedTags = alignedTags;
+    data->fSharedData  = alignedTags ? sharedData : nullptr;
 
     if (!data->parseStream(stream, procs, topLevelTFPlayback, recursionLimit)) {
         return nullptr;
     }
+    if (data->fSharedData) {
+        // This will be played back directly, perhaps on several threads at once.
+        data->initForPlayback();
+        data->fSharedData = nullptr;
+    }
     return data.release();
 }
 
+const void* SkPictureData::sharedBytes(SkStream* stream, size_t size) const {
+    if (!fSharedData) {
+        return nullptr;
+    }
+    const size_t offset = stream->getPosition();
+    SkASSERT(stream->getMemoryBase() == fSharedData->data());
+    if (offset > fSharedData->size() || size > fSharedData->size() - offset) {
+        return nullptr;
+    }
+    const uint8_t* bytes = fSharedData->bytes() + offset;
+    // SkReadBuffer needs its memory 4-byte aligned; tags are, but the mapping might not be.
+    if (!SkIsAlign4((uintptr_t)bytes) || stream->skip(size) != size) {
+        return nullptr;
+    }
+    return bytes;
+}
+
 SkPictureData* SkPictureData::CreateFromBuffer(SkReadBuffer& buffer,
                                                const SkPictInfo& info) {
     std::unique_ptr<SkPictureData> data(new SkPictureData(info));
@@ -547,6 +614,12 @@ bool SkPictureData::parseStream(SkStream* stream,
                                 SkTypefacePlayback* topLevelTFPlayback,
                                 int recursionLimit) {
     for (;;) {
+        if (fAlignedTags) {
+            const size_t misalignment = stream->getPosition() & 3;
+            if (misalignment && stream->skip(4 - misalignment) != 4 - misalignment) {
+                return false;
+            }
+        }
         uint32_t tag;
         if (!stream->readU32(&tag)) { return false; }
         if (SK_PICT_EOF_TAG == tag) {
@@ -580,6 +653,16 @@ bool SkPictureData::parseBuffer(SkReadBuffer& buffer) {
     return true;
 }
 
+size_t SkPictureData::approximateParsedBytesUsed() const {
+    size_t bytes = sizeof(*this) + fPaints.size_bytes() + fPaths.size_bytes() +
+                   fDrawables.size_bytes() + fTextBlobs.size_bytes() + fVertices.size_bytes() +
+                   fImages.size_bytes() + fSlugs.size_bytes() + fPictures.size_bytes();
+    for (const SkPath& path : fPaths) {
+        bytes += path.approximateBytesUsed();
+    }
+    return bytes;
+}
+
 const SkPaint* SkPictureData::optionalPaint(SkReadBuffer* reader) const {
     int index = reader->readInt();
     if (index == 0) {
@@ -89,20 +89,35 @@ class SkPictureData {
 public:
     SkPictureData(const SkPictureRecord& record, const SkPictInfo&);
     // Does not affect ownership of SkStream.
+    //
+    // alignedTags says the data was serialized with alignForMapping. In that case, if sharedData
+    // is set, the stream must be reading it from the start, and the ops and the buffer of paints,
+    // paths, images, etc. are used in place instead of being copied out of it.
     static SkPictureData* CreateFromStream(SkStream*,
                                            const SkPictInfo&,
                                            const SkDeserialProcs&,
                                            SkTypefacePlayback*,
-                                           int recursionLimit);
+                                           int recursionLimit,
+                                           bool alignedTags = false,
+                                           const SkData* sharedData = nullptr);
     static SkPictureData* CreateFromBuffer(SkReadBuffer&, const SkPictInfo&);
 
-    void serialize(SkWStream*, const SkSerialProcs&, SkRefCntSet*, bool textBlobsOnly=false) const;
+    // alignForMapping pads the stream so each tag starts at a multiple of 4 bytes from its start,
+    // which lets a reader use the data in place.
+    void serialize(SkWStream*, const SkSerialProcs&, SkRefCntSet*, bool textBlobsOnly=false,
+                   bool alignForMapping=false) const;
     void flatten(SkWriteBuffer&) const;
 
     const SkPictInfo& info() const { return fInfo; }
 
     const sk_sp<SkData>& opData() const { return fOpData; }
 
+    const skia_private::TArray<sk_sp<const SkPicture>>& pictures() const { return fPictures; }
+
+    // Memory used by what was parsed out of the serialized data, not counting the ops or the
+    // objects referred to by refcount.
+    size_t approximateParsedBytesUsed() const;
+
 protected:
     explicit SkPictureData(const SkPictInfo& info);
 
@@ -180,6 +195,14 @@ private:
 
     const SkPictInfo fInfo;
 
+    // Only used while parsing; see CreateFromStream().
+    bool          fAlignedTags = false;
+    const SkData* fSharedData  = nullptr;
+
+    // If we're parsing fSharedData, returns where the next size bytes of the stream are in it and
+    // skips past them. Returns null if they must be copied instead.
+    const void* sharedBytes(SkStream*, size_t size) const;
+
     static void WriteFactories(SkWStream* stream, const SkFactorySet& rec);
     static void WriteTypefaces(SkWStream* stream, const SkRefCntSet& rec, const SkSerialProcs&);
 
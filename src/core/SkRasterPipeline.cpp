@@ -16,6 +16,7 @@
 #include "src/base/SkVx.h"
 #include "src/core/SkImageInfoPriv.h"
 #include "src/core/SkOpts.h"
+#include "src/core/SkRasterPipelineJIT.h"
 #include "src/core/SkRasterPipelineOpContexts.h"
 #include "src/core/SkRasterPipelineOpList.h"
 
@@ -27,6 +28,7 @@ using namespace skia_private;
 using Op = SkRasterPipelineOp;
 
 bool gForceHighPrecisionRasterPipeline;
+bool gUseRasterPipelineJIT;
 
 SkRasterPipeline::SkRasterPipeline(SkArenaAlloc* alloc) : fAlloc(alloc) {
     this->reset();
@@ -660,6 +662,36 @@ std::function<void(size_t, size_t, size_t, size_t)> SkRasterPipeline::compile()
     uint8_t* tailPointer = fTailPointer;
 
     auto start_pipeline = this->buildPipeline(program + stagesNeeded);
+
+    if (gUseRasterPipelineJIT && start_pipeline == SkOpts::start_pipeline_lowp) {
+        // The JIT wants the ops and their contexts front to back.
+        Op* ops = fAlloc->makeArray<Op>(fNumStages);
+        void** ctxs = fAlloc->makeArray<void*>(fNumStages);
+        int i = fNumStages;
+        for (const StageList* st = fStages; st; st = st->prev) {
+            --i;
+            ops[i] = st->stage;
+            ctxs[i] = st->ctx;
+        }
+        if (sk_sp<SkRasterPipelineJIT::Program> jit =
+                    SkRasterPipelineJIT::Compile({ops, (size_t)fNumStages})) {
+            // Whole strides run as generated code; the interpreter picks up each row's tail.
+            return [=](size_t x, size_t y, size_t w, size_t h) {
+                const size_t body = w - w % SkRasterPipelineJIT::kStride;
+                if (body) {
+                    for (size_t row = y; row < y + h; row++) {
+                        jit->fn()(ctxs, x, row, body);
+                    }
+                }
+                if (body < w) {
+                    start_pipeline(x + body, y, x + w, y + h, program,
+                                   SkSpan{patches, numMemoryCtxs},
+                                   tailPointer);
+                }
+            };
+        }
+    }
+
     return [=](size_t x, size_t y, size_t w, size_t h) {
         start_pipeline(x, y, x + w, y + h, program,
                        SkSpan{patches, numMemoryCtxs},
@@ -26,7 +26,9 @@
 #include "src/core/SkBlitter.h"
 #include "src/core/SkColorSpacePriv.h"
 #include "src/core/SkColorSpaceXformSteps.h"
+#include "src/core/SkCoreBlitters.h"
 #include "src/core/SkEffectPriv.h"
+#include "src/core/SkLRUCache.h"
 #include "src/core/SkMask.h"
 #include "src/core/SkMemset.h"
 #include "src/core/SkRasterPipeline.h"
@@ -38,12 +40,95 @@
 #include <cstdint>
 #include <cstring>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <utility>
 
 class SkColorSpace;
 class SkShader;
 
+namespace {
+
+// A paint whose shader and color filter fold down to a constant color compiles to the same blit
+// pipeline as every other such paint with the same "shape": the constant-color op, the blend
+// mode, the dst format, and which kind of coverage the blit has. Only the color itself and the
+// per-blit contexts (dst, mask, coverage) differ, so a whole compiled pipeline can be shared by
+// patching those contexts before each blit.
+struct ShapeKey {
+    uint64_t fDstColorSpace;  // SkColorSpace::hash(), or 0 for an untagged dst.
+    uint32_t fColorOp;
+    uint32_t fBlendMode;
+    uint32_t fDstColorType;
+    uint16_t fDstAlphaType;
+    uint16_t fCoverage;
+
+    bool operator==(const ShapeKey& that) const {
+        return fDstColorSpace == that.fDstColorSpace &&
+               fColorOp       == that.fColorOp       &&
+               fBlendMode     == that.fBlendMode     &&
+               fDstColorType  == that.fDstColorType  &&
+               fDstAlphaType  == that.fDstAlphaType  &&
+               fCoverage      == that.fCoverage;
+    }
+};
+
+// The blitter-owned context a stage after the color points to.
+enum class ShapeSlot : uint8_t {
+    kNone,
+    kDst,
+    kMask,
+    kCoverage,
+    kEmboss,
+};
+
+// A compiled blit pipeline along with the contexts it points to. The pipeline and contexts live
+// in fAlloc, so an entry outlives both the blitter that built it and its eviction from the cache.
+struct CompiledShape {
+    SkSTArenaAlloc<512> fAlloc;
+    // Null for black_color and white_color, which have no context.
+    SkRasterPipeline_UniformColorCtx* fColor = nullptr;
+    SkRasterPipeline_MemoryCtx fDst  = {nullptr, 0},
+                               fMask = {nullptr, 0};
+    float fCoverage = 0.0f;
+    SkRasterPipeline_EmbossCtx fEmboss;
+    std::function<void(size_t, size_t, size_t, size_t)> fBlit;
+
+    void* slotContext(ShapeSlot slot) {
+        switch (slot) {
+            case ShapeSlot::kNone:     return nullptr;
+            case ShapeSlot::kDst:      return &fDst;
+            case ShapeSlot::kMask:     return &fMask;
+            case ShapeSlot::kCoverage: return &fCoverage;
+            case ShapeSlot::kEmboss:   return &fEmboss;
+        }
+        SkUNREACHABLE;
+    }
+};
+
+struct ShapeCache {
+    static constexpr int kMaxShapes = 64;
+
+    // A null entry records a shape that can't be shared, e.g. one whose dst needs a transfer
+    // function with its own context.
+    SkLRUCache<ShapeKey, std::shared_ptr<CompiledShape>> fShapes{kMaxShapes};
+    SkRasterPipelineBlitterShapeCacheStats fStats;
+};
+
+// Blitters are created and used on one thread, so each thread gets its own cache and no locking.
+// That also makes it safe for every blitter sharing an entry to patch its contexts in place.
+ShapeCache& shape_cache() {
+    static thread_local ShapeCache gCache;
+    return gCache;
+}
+
+}  // namespace
+
+bool gSkDisableBlitPipelineCache{false};
+
+SkRasterPipelineBlitterShapeCacheStats SkRasterPipelineBlitterShapeCacheStatsForThisThread() {
+    return shape_cache().fStats;
+}
+
 class SkRasterPipelineBlitter final : public SkBlitter {
 public:
     // This is our common entrypoint for creating the blitter once we've sorted out shaders.
@@ -73,6 +158,19 @@ public:
     void blitV     (int x, int y, int height, SkAlpha alpha)        override;
 
 private:
+    using BlitFn = std::function<void(size_t, size_t, size_t, size_t)>;
+
+    enum class Coverage : uint32_t { kRect, kAntiH, kMaskA8, kMaskLCD16, kMask3D };
+
+    // Compiles fColorPipeline followed by the stages appendRest() adds. Constant colors share a
+    // whole compiled pipeline from this thread's shape cache when an earlier blitter built one.
+    template <typename AppendFn>
+    BlitFn buildBlitPipeline(Coverage, AppendFn&& appendRest);
+    template <typename AppendFn>
+    std::shared_ptr<CompiledShape> compileShape(const SkRasterPipeline::StageList* color,
+                                                AppendFn&& appendRest) const;
+    std::optional<ShapeSlot> contextSlot(const void* ctx) const;
+
     void blitRectWithTrace(int x, int y, int w, int h, bool trace);
     void appendLoadDst      (SkRasterPipeline*) const;
     void appendStore        (SkRasterPipeline*) const;
@@ -89,6 +187,8 @@ private:
     std::optional<SkBlendMode> fBlendMode;
     // set to pipeline storage (for alpha) if we have a clipShader
     void*                  fClipShaderBuffer = nullptr; // "native" : float or U16
+    // Set when fColorPipeline has collapsed into a single constant color stage.
+    bool                   fConstantColor = false;
 
     SkRasterPipeline_MemoryCtx
         fDstPtr       = {nullptr,0},  // Always points to the top-left of fDst.
@@ -100,11 +200,11 @@ private:
     uint64_t fMemsetColor = 0;   // Big enough for largest memsettable dst format, F16.
 
     // Built lazily on first use.
-    std::function<void(size_t, size_t, size_t, size_t)> fBlitRect,
-                                                        fBlitAntiH,
-                                                        fBlitMaskA8,
-                                                        fBlitMaskLCD16,
-                                                        fBlitMask3D;
+    BlitFn fBlitRect,
+           fBlitAntiH,
+           fBlitMaskA8,
+           fBlitMaskLCD16,
+           fBlitMask3D;
 
     // These values are pointed to by the blit pipelines above,
     // which allows us to adjust them from call to call.
@@ -287,6 +387,7 @@ SkBlitter* SkRasterPipelineBlitter::Create(const SkPixmap& dst,
         colorPipeline->run(0,0,1,1);
         colorPipeline->reset();
         colorPipeline->appendConstantColor(alloc, constantColor);
+        blitter->fConstantColor = true;
 
         is_opaque = constantColor.fA == 1.0f;
     }
@@ -359,6 +460,108 @@ SkBlitter* SkRasterPipelineBlitter::Create(const SkPixmap& dst,
     return blitter;
 }
 
+template <typename AppendFn>
+SkRasterPipelineBlitter::BlitFn SkRasterPipelineBlitter::buildBlitPipeline(Coverage coverage,
+                                                                           AppendFn&& appendRest) {
+    auto compileHere = [&] {
+        SkRasterPipeline p(fAlloc);
+        p.extend(fColorPipeline);
+        appendRest(&p);
+        return p.compile();
+    };
+
+    // Only constant colors with a blend mode can be shared: shaders, color filters and runtime
+    // blenders all bring contexts of their own.
+    if (!fConstantColor || !fBlendMode.has_value() || gSkDisableBlitPipelineCache) {
+        return compileHere();
+    }
+
+    const SkRasterPipeline::StageList* color = fColorPipeline.getStageList();
+    SkASSERT(fColorPipeline.getNumStages() == 1);
+
+    const SkColorSpace* dstCS = fDst.colorSpace();
+    const ShapeKey key = {
+        dstCS ? dstCS->hash() : 0,
+        (uint32_t)color->stage,
+        (uint32_t)*fBlendMode,
+        (uint32_t)fDst.colorType(),
+        (uint16_t)fDst.alphaType(),
+        (uint16_t)coverage,
+    };
+    ShapeCache& cache = shape_cache();
+    std::shared_ptr<CompiledShape> shape;
+    if (const std::shared_ptr<CompiledShape>* found = cache.fShapes.find(key)) {
+        cache.fStats.fHits++;
+        shape = *found;
+    } else {
+        cache.fStats.fMisses++;
+        shape = this->compileShape(color, appendRest);
+        cache.fShapes.insert(key, shape);
+    }
+    if (!shape) {
+        return compileHere();
+    }
+
+    // Point the shared pipeline at this blitter's color and contexts before each blit. The
+    // callers update fDstPtr, fMaskPtr, fCurrentCoverage and fEmbossCtx before calling us.
+    auto colorCtx = static_cast<const SkRasterPipeline_UniformColorCtx*>(color->ctx);
+    return [this, shape = std::move(shape), colorCtx](size_t x, size_t y, size_t w, size_t h) {
+        if (colorCtx) {
+            *shape->fColor = *colorCtx;
+        }
+        shape->fDst      = fDstPtr;
+        shape->fMask     = fMaskPtr;
+        shape->fCoverage = fCurrentCoverage;
+        shape->fEmboss   = fEmbossCtx;
+        shape->fBlit(x, y, w, h);
+    };
+}
+
+template <typename AppendFn>
+std::shared_ptr<CompiledShape> SkRasterPipelineBlitter::compileShape(
+        const SkRasterPipeline::StageList* color, AppendFn&& appendRest) const {
+    // Build the tail once against this blitter to learn its stages and which contexts they use.
+    SkSTArenaAlloc<256> scratch;
+    SkRasterPipeline tail(&scratch);
+    appendRest(&tail);
+
+    const int n = tail.getNumStages();
+    skia_private::STArray<16, std::pair<SkRasterPipelineOp, ShapeSlot>> stages;
+    stages.push_back_n(n);
+    const SkRasterPipeline::StageList* st = tail.getStageList();
+    for (int i = n - 1; i >= 0; --i, st = st->prev) {
+        std::optional<ShapeSlot> slot = this->contextSlot(st->ctx);
+        if (!slot.has_value()) {
+            return nullptr;
+        }
+        stages[i] = {st->stage, *slot};
+    }
+
+    auto shape = std::make_shared<CompiledShape>();
+    SkRasterPipeline p(&shape->fAlloc);
+    if (auto colorCtx = static_cast<const SkRasterPipeline_UniformColorCtx*>(color->ctx)) {
+        p.appendConstantColor(&shape->fAlloc, &colorCtx->r);
+        shape->fColor = static_cast<SkRasterPipeline_UniformColorCtx*>(p.getStageList()->ctx);
+        SkASSERT(p.getStageList()->stage == color->stage);
+    } else {
+        p.append(color->stage);
+    }
+    for (const auto& [op, slot] : stages) {
+        p.append(op, shape->slotContext(slot));
+    }
+    shape->fBlit = p.compile();
+    return shape;
+}
+
+std::optional<ShapeSlot> SkRasterPipelineBlitter::contextSlot(const void* ctx) const {
+    if (!ctx)                     { return ShapeSlot::kNone; }
+    if (ctx == &fDstPtr)          { return ShapeSlot::kDst; }
+    if (ctx == &fMaskPtr)         { return ShapeSlot::kMask; }
+    if (ctx == &fCurrentCoverage) { return ShapeSlot::kCoverage; }
+    if (ctx == &fEmbossCtx)       { return ShapeSlot::kEmboss; }
+    return std::nullopt;
+}
+
 void SkRasterPipelineBlitter::appendLoadDst(SkRasterPipeline* p) const {
     p->appendLoadDst(fDst.info().colorType(), &fDstPtr);
     if (fDst.info().alphaType() == kUnpremul_SkAlphaType) {
@@ -400,32 +603,31 @@ void SkRasterPipelineBlitter::blitRectWithTrace(int x, int y, int w, int h, bool
     }
 
     if (!fBlitRect) {
-        SkRasterPipeline p(fAlloc);
-        p.extend(fColorPipeline);
-        p.appendClampIfNormalized(fDst.info());
-        if (fBlendMode == SkBlendMode::kSrcOver
-                && (fDst.info().colorType() == kRGBA_8888_SkColorType ||
-                    fDst.info().colorType() == kBGRA_8888_SkColorType)
-                && !fDst.colorSpace()
-                && fDst.info().alphaType() != kUnpremul_SkAlphaType
-                && fDitherRate == 0.0f) {
-            if (fDst.info().colorType() == kBGRA_8888_SkColorType) {
-                p.append(SkRasterPipelineOp::swap_rb);
-            }
-            this->appendClipScale(&p);
-            p.append(SkRasterPipelineOp::srcover_rgba_8888, &fDstPtr);
-        } else {
-            if (fBlendMode != SkBlendMode::kSrc) {
-                this->appendLoadDst(&p);
-                p.extend(fBlendPipeline);
-                this->appendClipLerp(&p);
-            } else if (fClipShaderBuffer) {
-                this->appendLoadDst(&p);
-                this->appendClipLerp(&p);
+        fBlitRect = this->buildBlitPipeline(Coverage::kRect, [this](SkRasterPipeline* p) {
+            p->appendClampIfNormalized(fDst.info());
+            if (fBlendMode == SkBlendMode::kSrcOver
+                    && (fDst.info().colorType() == kRGBA_8888_SkColorType ||
+                        fDst.info().colorType() == kBGRA_8888_SkColorType)
+                    && !fDst.colorSpace()
+                    && fDst.info().alphaType() != kUnpremul_SkAlphaType
+                    && fDitherRate == 0.0f) {
+                if (fDst.info().colorType() == kBGRA_8888_SkColorType) {
+                    p->append(SkRasterPipelineOp::swap_rb);
+                }
+                this->appendClipScale(p);
+                p->append(SkRasterPipelineOp::srcover_rgba_8888, &fDstPtr);
+            } else {
+                if (fBlendMode != SkBlendMode::kSrc) {
+                    this->appendLoadDst(p);
+                    p->extend(fBlendPipeline);
+                    this->appendClipLerp(p);
+                } else if (fClipShaderBuffer) {
+                    this->appendLoadDst(p);
+                    this->appendClipLerp(p);
+                }
+                this->appendStore(p);
             }
-            this->appendStore(&p);
-        }
-        fBlitRect = p.compile();
+        });
     }
 
     fBlitRect(x,y,w,h);
@@ -433,24 +635,23 @@ void SkRasterPipelineBlitter::blitRectWithTrace(int x, int y, int w, int h, bool
 
 void SkRasterPipelineBlitter::blitAntiH(int x, int y, const SkAlpha aa[], const int16_t runs[]) {
     if (!fBlitAntiH) {
-        SkRasterPipeline p(fAlloc);
-        p.extend(fColorPipeline);
-        p.appendClampIfNormalized(fDst.info());
-        if (fBlendMode.has_value() &&
-            SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/false)) {
-            p.append(SkRasterPipelineOp::scale_1_float, &fCurrentCoverage);
-            this->appendClipScale(&p);
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-        } else {
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-            p.append(SkRasterPipelineOp::lerp_1_float, &fCurrentCoverage);
-            this->appendClipLerp(&p);
-        }
+        fBlitAntiH = this->buildBlitPipeline(Coverage::kAntiH, [this](SkRasterPipeline* p) {
+            p->appendClampIfNormalized(fDst.info());
+            if (fBlendMode.has_value() &&
+                SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/false)) {
+                p->append(SkRasterPipelineOp::scale_1_float, &fCurrentCoverage);
+                this->appendClipScale(p);
+                this->appendLoadDst(p);
+                p->extend(fBlendPipeline);
+            } else {
+                this->appendLoadDst(p);
+                p->extend(fBlendPipeline);
+                p->append(SkRasterPipelineOp::lerp_1_float, &fCurrentCoverage);
+                this->appendClipLerp(p);
+            }
 
-        this->appendStore(&p);
-        fBlitAntiH = p.compile();
+            this->appendStore(p);
+        });
     }
 
     for (int16_t run = *runs; run > 0; run = *runs) {
@@ -525,68 +726,66 @@ void SkRasterPipelineBlitter::blitMask(const SkMask& mask, const SkIRect& clip)
 
     // Lazily build whichever pipeline we need, specialized for each mask format.
     if (mask.fFormat == SkMask::kA8_Format && !fBlitMaskA8) {
-        SkRasterPipeline p(fAlloc);
-        p.extend(fColorPipeline);
-        p.appendClampIfNormalized(fDst.info());
-        if (fBlendMode.has_value() &&
-            SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/false)) {
-            p.append(SkRasterPipelineOp::scale_u8, &fMaskPtr);
-            this->appendClipScale(&p);
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-        } else {
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-            p.append(SkRasterPipelineOp::lerp_u8, &fMaskPtr);
-            this->appendClipLerp(&p);
-        }
-        this->appendStore(&p);
-        fBlitMaskA8 = p.compile();
+        fBlitMaskA8 = this->buildBlitPipeline(Coverage::kMaskA8, [this](SkRasterPipeline* p) {
+            p->appendClampIfNormalized(fDst.info());
+            if (fBlendMode.has_value() &&
+                SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/false)) {
+                p->append(SkRasterPipelineOp::scale_u8, &fMaskPtr);
+                this->appendClipScale(p);
+                this->appendLoadDst(p);
+                p->extend(fBlendPipeline);
+            } else {
+                this->appendLoadDst(p);
+                p->extend(fBlendPipeline);
+                p->append(SkRasterPipelineOp::lerp_u8, &fMaskPtr);
+                this->appendClipLerp(p);
+            }
+            this->appendStore(p);
+        });
     }
     if (mask.fFormat == SkMask::kLCD16_Format && !fBlitMaskLCD16) {
-        SkRasterPipeline p(fAlloc);
-        p.extend(fColorPipeline);
-        p.appendClampIfNormalized(fDst.info());
-        if (fBlendMode.has_value() &&
-            SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/true)) {
-            // Somewhat unusually, scale_565 needs dst loaded first.
-            this->appendLoadDst(&p);
-            p.append(SkRasterPipelineOp::scale_565, &fMaskPtr);
-            this->appendClipScale(&p);
-            p.extend(fBlendPipeline);
-        } else {
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-            p.append(SkRasterPipelineOp::lerp_565, &fMaskPtr);
-            this->appendClipLerp(&p);
-        }
-        this->appendStore(&p);
-        fBlitMaskLCD16 = p.compile();
+        auto appendRest = [this](SkRasterPipeline* p) {
+            p->appendClampIfNormalized(fDst.info());
+            if (fBlendMode.has_value() &&
+                SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/true)) {
+                // Somewhat unusually, scale_565 needs dst loaded first.
+                this->appendLoadDst(p);
+                p->append(SkRasterPipelineOp::scale_565, &fMaskPtr);
+                this->appendClipScale(p);
+                p->extend(fBlendPipeline);
+            } else {
+                this->appendLoadDst(p);
+                p->extend(fBlendPipeline);
+                p->append(SkRasterPipelineOp::lerp_565, &fMaskPtr);
+                this->appendClipLerp(p);
+            }
+            this->appendStore(p);
+        };
+        fBlitMaskLCD16 = this->buildBlitPipeline(Coverage::kMaskLCD16, appendRest);
     }
     if (mask.fFormat == SkMask::k3D_Format && !fBlitMask3D) {
-        SkRasterPipeline p(fAlloc);
-        p.extend(fColorPipeline);
-        // This bit is where we differ from kA8_Format:
-        p.append(SkRasterPipelineOp::emboss, &fEmbossCtx);
-        // Now onward just as kA8.
-        p.appendClampIfNormalized(fDst.info());
-        if (fBlendMode.has_value() &&
-            SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/false)) {
-            p.append(SkRasterPipelineOp::scale_u8, &fMaskPtr);
-            this->appendClipScale(&p);
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-        } else {
-            this->appendLoadDst(&p);
-            p.extend(fBlendPipeline);
-            p.append(SkRasterPipelineOp::lerp_u8, &fMaskPtr);
-            this->appendClipLerp(&p);
-        }
-        this->appendStore(&p);
-        fBlitMask3D = p.compile();
+        fBlitMask3D = this->buildBlitPipeline(Coverage::kMask3D, [this](SkRasterPipeline* p) {
+            // This bit is where we differ from kA8_Format:
+            p->append(SkRasterPipelineOp::emboss, &fEmbossCtx);
+            // Now onward just as kA8.
+            p->appendClampIfNormalized(fDst.info());
+            if (fBlendMode.has_value() &&
+                SkBlendMode_ShouldPreScaleCoverage(*fBlendMode, /*rgb_coverage=*/false)) {
+                p->append(SkRasterPipelineOp::scale_u8, &fMaskPtr);
+                this->appendClipScale(p);
+                this->appendLoadDst(p);
+                p->extend(fBlendPipeline);
+            } else {
+                this->appendLoadDst(p);
+                p->extend(fBlendPipeline);
+                p->append(SkRasterPipelineOp::lerp_u8, &fMaskPtr);
+                this->appendClipLerp(p);
+            }
+            this->appendStore(p);
+        });
     }
 
-    std::function<void(size_t,size_t,size_t,size_t)>* blitter = nullptr;
+    BlitFn* blitter = nullptr;
     switch (mask.fFormat) {
         case SkMask::kA8_Format:    blitter = &fBlitMaskA8;    break;
         case SkMask::kLCD16_Format: blitter = &fBlitMaskLCD16; break;
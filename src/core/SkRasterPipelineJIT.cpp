@@ -0,0 +1,589 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/core/SkRasterPipelineJIT.h"
+
+#include "include/private/base/SkFeatures.h"
+#include "include/private/base/SkMutex.h"
+#include "src/core/SkChecksum.h"
+#include "src/core/SkCpu.h"
+#include "src/core/SkLRUCache.h"
+#include "src/core/SkRasterPipelineOpContexts.h"
+#include "src/core/SkRasterPipelineOpList.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(SK_CPU_X86) && defined(__x86_64__) && defined(SK_BUILD_FOR_UNIX)
+    #include <sys/mman.h>
+    #define SK_RASTER_PIPELINE_JIT_X64 1
+#else
+    #define SK_RASTER_PIPELINE_JIT_X64 0
+#endif
+
+namespace SkRasterPipelineJIT {
+
+#if SK_RASTER_PIPELINE_JIT_X64
+
+namespace {
+
+using Op = SkRasterPipelineOp;
+
+enum GP { rax, rcx, rdx, rbx, rsp, rbp, rsi, rdi, r8, r9, r10, r11, r12, r13, r14, r15 };
+
+// A memory operand, [base + disp].
+struct Mem {
+    GP  base;
+    int disp = 0;
+};
+
+// Just enough of an x86-64 assembler for the ops below. All vector instructions use the three
+// byte VEX prefix. Yn names YMM (or, for L=0 instructions, XMM) registers.
+class Assembler {
+public:
+    const std::vector<uint8_t>& code() const { return fCode; }
+    size_t here() const { return fCode.size(); }
+
+    // ~~~ Vector instructions ~~~ //
+    void vpand     (int d, int a, int b) { this->op(k66, k0F  , 0,1, 0xDB, d,a,b); }
+    void vpor      (int d, int a, int b) { this->op(k66, k0F  , 0,1, 0xEB, d,a,b); }
+    void vpxor     (int d, int a, int b) { this->op(k66, k0F  , 0,1, 0xEF, d,a,b); }
+    void vpaddw    (int d, int a, int b) { this->op(k66, k0F  , 0,1, 0xFD, d,a,b); }
+    void vpsubw    (int d, int a, int b) { this->op(k66, k0F  , 0,1, 0xF9, d,a,b); }
+    void vpmullw   (int d, int a, int b) { this->op(k66, k0F  , 0,1, 0xD5, d,a,b); }
+    void vpunpcklwd(int d, int a, int b) { this->op(k66, k0F  , 0,1, 0x61, d,a,b); }
+    void vpunpckhwd(int d, int a, int b) { this->op(k66, k0F  , 0,1, 0x69, d,a,b); }
+    void vpminuw   (int d, int a, int b) { this->op(k66, k0F38, 0,1, 0x3A, d,a,b); }
+    void vpackusdw (int d, int a, int b) { this->op(k66, k0F38, 0,1, 0x2B, d,a,b); }
+    void vpackuswb_xmm(int d, int a, int b) { this->op(k66, k0F, 0,0, 0x67, d,a,b); }
+
+    void vpsrlw(int d, int s, int imm) { this->op(k66, k0F, 0,1, 0x71, 2,d,s); this->byte(imm); }
+    void vpsllw(int d, int s, int imm) { this->op(k66, k0F, 0,1, 0x71, 6,d,s); this->byte(imm); }
+    void vpsrld(int d, int s, int imm) { this->op(k66, k0F, 0,1, 0x72, 2,d,s); this->byte(imm); }
+    void vpslld(int d, int s, int imm) { this->op(k66, k0F, 0,1, 0x72, 6,d,s); this->byte(imm); }
+
+    void vpermq(int d, int s, int imm) { this->op(k66, k0F3A, 1,1, 0x00, d,0,s); this->byte(imm); }
+    void vperm2i128(int d, int a, int b, int imm) {
+        this->op(k66, k0F3A, 0,1, 0x46, d,a,b);
+        this->byte(imm);
+    }
+    void vextracti128(int xmm, int ymm, int imm) {
+        this->op(k66, k0F3A, 0,1, 0x39, ymm,0,xmm);
+        this->byte(imm);
+    }
+
+    void vmovdqa(int d, int s) { this->op(k66, k0F, 0,1, 0x6F, d,0,s); }
+
+    void vpbroadcastw(int d, int xmm) { this->op(k66, k0F38, 0,1, 0x79, d,0,xmm); }
+    void vpbroadcastw(int d, Mem m)   { this->op(k66, k0F38, 0,1, 0x79, d,0,m); }
+    void vpbroadcastd(int d, int xmm) { this->op(k66, k0F38, 0,1, 0x58, d,0,xmm); }
+    void vpmovzxbw   (int d, Mem m)   { this->op(k66, k0F38, 0,1, 0x30, d,0,m); }
+
+    void vmovdqu    (int d, Mem m) { this->op(kF3, k0F, 0,1, 0x6F, d,0,m); }
+    void vmovdqu    (Mem m, int s) { this->op(kF3, k0F, 0,1, 0x7F, s,0,m); }
+    void vmovdqu_xmm(Mem m, int s) { this->op(kF3, k0F, 0,0, 0x7F, s,0,m); }
+
+    void vmovd     (int xmm, GP s)      { this->op(k66, k0F, 0,0, 0x6E, xmm,0,(int)s); }
+    void vmovss    (int xmm, Mem m)     { this->op(kF3, k0F, 0,0, 0x10, xmm,0,m); }
+    void vmulss    (int d, int a, int b) { this->op(kF3, k0F, 0,0, 0x59, d,a,b); }
+    void vaddss    (int d, int a, int b) { this->op(kF3, k0F, 0,0, 0x58, d,a,b); }
+    void vcvttss2si(GP d, int xmm)      { this->op(kF3, k0F, 0,0, 0x2C, (int)d,0,xmm); }
+
+    void vzeroupper() { this->byte(0xC5); this->byte(0xF8); this->byte(0x77); }
+
+    // ~~~ General purpose instructions (64-bit operands unless noted) ~~~ //
+    void mov(GP d, Mem m) { this->rex(d,0,m.base); this->byte(0x8B); this->modrm(d,m); }
+    void movsxd(GP d, Mem m) { this->rex(d,0,m.base); this->byte(0x63); this->modrm(d,m); }
+    void mov(GP d, GP s) { this->rex(s,0,d); this->byte(0x89); this->modrm(s,d); }
+    void add(GP d, GP s) { this->rex(s,0,d); this->byte(0x01); this->modrm(s,d); }
+    void cmp(GP a, GP b) { this->rex(b,0,a); this->byte(0x39); this->modrm(b,a); }
+    void imul(GP d, GP s) {
+        this->rex(d,0,s);
+        this->byte(0x0F);
+        this->byte(0xAF);
+        this->modrm(d,s);
+    }
+    void add(GP d, int32_t imm) {
+        this->rex(0,0,d);
+        this->byte(0x81);
+        this->modrm(0,d);
+        this->word(imm);
+    }
+    // d = base + index*scale
+    void lea(GP d, GP base, GP index, int scale) {
+        SkASSERT(index != rsp);
+        const int ss = scale == 8 ? 3 : scale == 4 ? 2 : scale == 2 ? 1 : 0;
+        this->rex(d,index,base);
+        this->byte(0x8D);
+        // [rbp] and [r13] can only be encoded with a displacement, so use a zero disp8.
+        const bool disp8 = (base & 7) == rbp;
+        this->byte((disp8 ? 0x44 : 0x04) | (d & 7) << 3);
+        this->byte(ss << 6 | (index & 7) << 3 | (base & 7));
+        if (disp8) {
+            this->byte(0);
+        }
+    }
+    // 32-bit d = imm, zero extended.
+    void mov32(GP d, uint32_t imm) {
+        if (d & 8) {
+            this->byte(0x41);
+        }
+        this->byte(0xB8 + (d & 7));
+        this->word(imm);
+    }
+    // Jumps back to target if below (unsigned).
+    void jb(size_t target) {
+        this->byte(0x0F);
+        this->byte(0x82);
+        this->word((int32_t)(target - (this->here() + 4)));
+    }
+    void ret() { this->byte(0xC3); }
+
+private:
+    enum { k66 = 1, kF3 = 2 };
+    enum { k0F = 1, k0F38 = 2, k0F3A = 3 };
+
+    void byte(int b) { fCode.push_back((uint8_t)b); }
+    void word(int32_t w) {
+        uint8_t bytes[4];
+        memcpy(bytes, &w, 4);
+        fCode.insert(fCode.end(), bytes, bytes + 4);
+    }
+
+    void vex(int pp, int map, bool W, bool L, int reg, int vvvv, int base) {
+        this->byte(0xC4);
+        this->byte((~reg & 8) << 4 | 0x40 /*no index*/ | (~base & 8) << 2 | map);
+        this->byte((W ? 0x80 : 0) | (~vvvv & 15) << 3 | (L ? 4 : 0) | pp);
+    }
+    void op(int pp, int map, bool W, bool L, int opcode, int reg, int vvvv, int rm) {
+        this->vex(pp, map, W, L, reg, vvvv, rm);
+        this->byte(opcode);
+        this->modrm(reg, rm);
+    }
+    void op(int pp, int map, bool W, bool L, int opcode, int reg, int vvvv, Mem m) {
+        this->vex(pp, map, W, L, reg, vvvv, m.base);
+        this->byte(opcode);
+        this->modrm(reg, m);
+    }
+
+    void rex(int reg, int index, int base) {
+        this->byte(0x48 | (reg & 8) >> 1 | (index & 8) >> 2 | (base & 8) >> 3);
+    }
+    void modrm(int reg, int rm) { this->byte(0xC0 | (reg & 7) << 3 | (rm & 7)); }
+    void modrm(int reg, Mem m) {
+        this->byte(0x80 | (reg & 7) << 3 | (m.base & 7));
+        if ((m.base & 7) == rsp) {
+            this->byte(0x24);  // SIB byte for [rsp] or [r12] with no index.
+        }
+        this->word(m.disp);
+    }
+
+    std::vector<uint8_t> fCode;
+};
+
+// Register assignment, shared by every op, mirroring the lowp interpreter's stage arguments.
+// Each YMM register holds kStride 16-bit lanes.
+enum : int { R, G, B, A, DR, DG, DB, DA,           // ymm0-7: src and dst colors
+             T0, T1, T2, T3, T4, T5,                // ymm8-13: scratch within one op
+             K128, K255 };                          // ymm14-15: constants, set up once
+
+// The generated function's arguments, per the System V calling convention.
+constexpr GP kCtxs = rdi,
+             kX    = rsi,
+             kY    = rdx,
+             kN    = rcx;
+
+bool is_supported(Op op) {
+    switch (op) {
+        case Op::load_8888:     case Op::load_8888_dst:     case Op::store_8888:
+        case Op::load_a8:       case Op::load_a8_dst:       case Op::store_a8:
+        case Op::srcover_rgba_8888:
+        case Op::uniform_color: case Op::uniform_color_dst:
+        case Op::black_color:   case Op::white_color:
+        case Op::clear:         case Op::srcover:           case Op::dstover:
+        case Op::modulate:      case Op::plus_:
+        case Op::move_src_dst:  case Op::move_dst_src:
+        case Op::swap_rb:       case Op::swap_rb_dst:
+        case Op::force_opaque:  case Op::force_opaque_dst:  case Op::clamp_01:
+        case Op::scale_1_float: case Op::lerp_1_float:
+        case Op::scale_u8:      case Op::lerp_u8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+class Compiler {
+public:
+    sk_sp<Program> compile(SkSpan<const Op> ops) {
+        // end = x + n
+        fAsm.mov(r8, kX);
+        fAsm.add(r8, kN);
+        this->splat16(K128, 128);
+        this->splat16(K255, 255);
+
+        const size_t loop = fAsm.here();
+        // Like the interpreter, every stride starts with all colors zeroed.
+        for (int reg = R; reg <= DA; reg++) {
+            fAsm.vpxor(reg, reg, reg);
+        }
+        for (size_t i = 0; i < ops.size(); i++) {
+            this->emit(ops[i], (int)i);
+        }
+        fAsm.add(kX, kStride);
+        fAsm.cmp(kX, r8);
+        fAsm.jb(loop);
+        fAsm.vzeroupper();
+        fAsm.ret();
+
+        const std::vector<uint8_t>& code = fAsm.code();
+        void* mem = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            return nullptr;
+        }
+        memcpy(mem, code.data(), code.size());
+        if (mprotect(mem, code.size(), PROT_READ | PROT_EXEC) != 0) {
+            munmap(mem, code.size());
+            return nullptr;
+        }
+        return sk_make_sp<Program>(mem, code.size());
+    }
+
+private:
+    // All 16-bit lanes of reg = v.
+    void splat16(int reg, uint16_t v) {
+        fAsm.mov32(r10, (uint32_t)v << 16 | v);
+        fAsm.vmovd(reg, r10);
+        fAsm.vpbroadcastd(reg, reg);
+    }
+
+    // rax = the i-th op's context.
+    void loadCtx(int i) { fAsm.mov(rax, Mem{kCtxs, 8*i}); }
+
+    // rax = ptr_at_xy(ctx, x,y) for the i-th op's SkRasterPipeline_MemoryCtx.
+    void loadPtr(int i, int bytesPerPixel) {
+        this->loadCtx(i);
+        fAsm.movsxd(r9, Mem{rax, (int)offsetof(SkRasterPipeline_MemoryCtx, stride)});
+        fAsm.imul(r9, kY);
+        fAsm.add(r9, kX);
+        fAsm.mov(rax, Mem{rax, (int)offsetof(SkRasterPipeline_MemoryCtx, pixels)});
+        fAsm.lea(rax, rax, r9, bytesPerPixel);
+    }
+
+    // v = (v+255)/256, or (v + 128 + ((v + 128) >> 8)) >> 8 when accurate.
+    void div255(int v, bool accurate) {
+        if (accurate) {
+            fAsm.vpaddw(v, v, K128);
+            fAsm.vpsrlw(T5, v, 8);
+            fAsm.vpaddw(v, v, T5);
+        } else {
+            fAsm.vpaddw(v, v, K255);
+        }
+        fAsm.vpsrlw(v, v, 8);
+    }
+
+    // d = x*y/255, using T5 as scratch.
+    void mulDiv255(int d, int x, int y, bool accurate) {
+        fAsm.vpmullw(d, x, y);
+        this->div255(d, accurate);
+    }
+
+    void load8888(int r, int g, int b, int a) {
+        // Split each pixel into its low (rg) and high (ba) 16 bits, and pack those down into
+        // 16-bit lanes. vpackusdw packs within 128-bit lanes, so vpermq restores pixel order.
+        fAsm.vmovdqu(T0, Mem{rax, 0});
+        fAsm.vmovdqu(T1, Mem{rax, 32});
+        fAsm.vpslld(T2, T0, 16);
+        fAsm.vpsrld(T2, T2, 16);
+        fAsm.vpslld(T3, T1, 16);
+        fAsm.vpsrld(T3, T3, 16);
+        fAsm.vpackusdw(T2, T2, T3);
+        fAsm.vpermq(T2, T2, 0xD8);
+        fAsm.vpsrld(T0, T0, 16);
+        fAsm.vpsrld(T1, T1, 16);
+        fAsm.vpackusdw(T0, T0, T1);
+        fAsm.vpermq(T0, T0, 0xD8);
+
+        fAsm.vpand (r, T2, K255);
+        fAsm.vpsrlw(g, T2, 8);
+        fAsm.vpand (b, T0, K255);
+        fAsm.vpsrlw(a, T0, 8);
+    }
+
+    void store8888() {
+        fAsm.vpminuw(T0, R, K255);
+        fAsm.vpminuw(T1, G, K255);
+        fAsm.vpsllw (T1, T1, 8);
+        fAsm.vpor   (T0, T0, T1);      // rg
+        fAsm.vpminuw(T2, B, K255);
+        fAsm.vpminuw(T3, A, K255);
+        fAsm.vpsllw (T3, T3, 8);
+        fAsm.vpor   (T2, T2, T3);      // ba
+        fAsm.vpunpcklwd(T4, T0, T2);   // pixels 0-3, 8-11
+        fAsm.vpunpckhwd(T5, T0, T2);   // pixels 4-7, 12-15
+        fAsm.vperm2i128(T0, T4, T5, 0x20);
+        fAsm.vperm2i128(T1, T4, T5, 0x31);
+        fAsm.vmovdqu(Mem{rax, 0}, T0);
+        fAsm.vmovdqu(Mem{rax, 32}, T1);
+    }
+
+    // T0 = from_float(*ctx), i.e. the float scaled to [0,255] and truncated.
+    void loadCoverageFloat(int i) {
+        this->loadCtx(i);
+        fAsm.vmovss(T0, Mem{rax, 0});
+        fAsm.mov32(r10, 0x437f0000);   // 255.0f
+        fAsm.vmovd(T1, r10);
+        fAsm.vmulss(T0, T0, T1);
+        fAsm.mov32(r10, 0x3f000000);   // 0.5f
+        fAsm.vmovd(T1, r10);
+        fAsm.vaddss(T0, T0, T1);
+        fAsm.vcvttss2si(r10, T0);
+        fAsm.vmovd(T0, r10);
+        fAsm.vpbroadcastw(T0, T0);
+    }
+
+    // Color channels = channel * c / 255.
+    void scale(int c) {
+        for (int ch = R; ch <= A; ch++) {
+            this->mulDiv255(ch, ch, c, /*accurate=*/false);
+        }
+    }
+
+    // Color channels = lerp(dst channel, channel, c).
+    void lerp(int c) {
+        fAsm.vpsubw(T1, K255, c);
+        for (int ch = R; ch <= A; ch++) {
+            fAsm.vpmullw(T2, ch + DR, T1);
+            fAsm.vpmullw(T3, ch, c);
+            fAsm.vpaddw(ch, T2, T3);
+            this->div255(ch, /*accurate=*/false);
+        }
+    }
+
+    // src = over + under*inv(over alpha)/255 for every channel, where over and under are each
+    // either the src or dst registers. The alpha is read before any channel is updated.
+    void over(int over, int under, bool accurate) {
+        fAsm.vpsubw(T1, K255, over + 3);
+        for (int ch = 0; ch < 4; ch++) {
+            this->mulDiv255(T0, under + ch, T1, accurate);
+            fAsm.vpaddw(R + ch, over + ch, T0);
+        }
+    }
+
+    void swap(int x, int y) {
+        fAsm.vmovdqa(T0, x);
+        fAsm.vmovdqa(x, y);
+        fAsm.vmovdqa(y, T0);
+    }
+
+    void emit(Op op, int i) {
+    #if defined(SK_USE_INACCURATE_DIV255_IN_BLEND)
+        constexpr bool kAccurateBlend = false;
+    #else
+        constexpr bool kAccurateBlend = true;
+    #endif
+        switch (op) {
+            case Op::load_8888:
+                this->loadPtr(i, 4);
+                this->load8888(R, G, B, A);
+                break;
+            case Op::load_8888_dst:
+                this->loadPtr(i, 4);
+                this->load8888(DR, DG, DB, DA);
+                break;
+            case Op::store_8888:
+                this->loadPtr(i, 4);
+                this->store8888();
+                break;
+            case Op::srcover_rgba_8888:
+                // Unlike Op::srcover, this compound stage always uses the fast div255.
+                this->loadPtr(i, 4);
+                this->load8888(DR, DG, DB, DA);
+                this->over(R, DR, /*accurate=*/false);
+                this->store8888();
+                break;
+
+            case Op::load_a8:
+            case Op::load_a8_dst: {
+                const int c = op == Op::load_a8 ? R : DR;
+                this->loadPtr(i, 1);
+                fAsm.vpxor(c+0, c+0, c+0);
+                fAsm.vpxor(c+1, c+1, c+1);
+                fAsm.vpxor(c+2, c+2, c+2);
+                fAsm.vpmovzxbw(c+3, Mem{rax, 0});
+                break;
+            }
+            case Op::store_a8:
+                this->loadPtr(i, 1);
+                fAsm.vpminuw(T0, A, K255);
+                fAsm.vextracti128(T1, T0, 1);
+                fAsm.vpackuswb_xmm(T0, T0, T1);
+                fAsm.vmovdqu_xmm(Mem{rax, 0}, T0);
+                break;
+
+            case Op::uniform_color:
+            case Op::uniform_color_dst: {
+                const int c = op == Op::uniform_color ? R : DR;
+                this->loadCtx(i);
+                for (int ch = 0; ch < 4; ch++) {
+                    const int offset = (int)offsetof(SkRasterPipeline_UniformColorCtx, rgba);
+                    fAsm.vpbroadcastw(c + ch, Mem{rax, offset + ch * (int)sizeof(uint16_t)});
+                }
+                break;
+            }
+            case Op::black_color:
+                fAsm.vpxor(R, R, R);
+                fAsm.vpxor(G, G, G);
+                fAsm.vpxor(B, B, B);
+                fAsm.vmovdqa(A, K255);
+                break;
+            case Op::white_color:
+                for (int ch = R; ch <= A; ch++) {
+                    fAsm.vmovdqa(ch, K255);
+                }
+                break;
+
+            case Op::clear:
+                for (int ch = R; ch <= A; ch++) {
+                    fAsm.vpxor(ch, ch, ch);
+                }
+                break;
+            case Op::srcover:
+                this->over(R, DR, kAccurateBlend);
+                break;
+            case Op::dstover:
+                this->over(DR, R, kAccurateBlend);
+                break;
+            case Op::modulate:
+                for (int ch = 0; ch < 4; ch++) {
+                    this->mulDiv255(R + ch, R + ch, DR + ch, kAccurateBlend);
+                }
+                break;
+            case Op::plus_:
+                for (int ch = 0; ch < 4; ch++) {
+                    fAsm.vpaddw (R + ch, R + ch, DR + ch);
+                    fAsm.vpminuw(R + ch, R + ch, K255);
+                }
+                break;
+
+            case Op::move_src_dst:
+                for (int ch = 0; ch < 4; ch++) {
+                    fAsm.vmovdqa(DR + ch, R + ch);
+                }
+                break;
+            case Op::move_dst_src:
+                for (int ch = 0; ch < 4; ch++) {
+                    fAsm.vmovdqa(R + ch, DR + ch);
+                }
+                break;
+            case Op::swap_rb:     this->swap(R, B);   break;
+            case Op::swap_rb_dst: this->swap(DR, DB); break;
+            case Op::force_opaque:     fAsm.vmovdqa(A,  K255); break;
+            case Op::force_opaque_dst: fAsm.vmovdqa(DA, K255); break;
+            case Op::clamp_01:
+                for (int ch = R; ch <= A; ch++) {
+                    fAsm.vpminuw(ch, ch, K255);
+                }
+                break;
+
+            case Op::scale_1_float:
+                this->loadCoverageFloat(i);
+                this->scale(T0);
+                break;
+            case Op::lerp_1_float:
+                this->loadCoverageFloat(i);
+                this->lerp(T0);
+                break;
+            case Op::scale_u8:
+                this->loadPtr(i, 1);
+                fAsm.vpmovzxbw(T0, Mem{rax, 0});
+                this->scale(T0);
+                break;
+            case Op::lerp_u8:
+                this->loadPtr(i, 1);
+                fAsm.vpmovzxbw(T0, Mem{rax, 0});
+                this->lerp(T0);
+                break;
+
+            default:
+                SkUNREACHABLE;
+        }
+    }
+
+    Assembler fAsm;
+};
+
+// Pipelines longer than this stay on the interpreter; the JIT is aimed at short ones.
+constexpr int kMaxOps = 16;
+
+struct Key {
+    int fCount;
+    Op  fOps[kMaxOps];
+
+    bool operator==(const Key& that) const {
+        return fCount == that.fCount && 0 == memcmp(fOps, that.fOps, fCount * sizeof(Op));
+    }
+};
+
+struct KeyHash {
+    uint32_t operator()(const Key& k) const {
+        return SkChecksum::Hash32(k.fOps, k.fCount * sizeof(Op));
+    }
+};
+
+constexpr int kCacheSize = 64;
+
+SkMutex& cache_mutex() {
+    static SkMutex& mutex = *(new SkMutex);
+    return mutex;
+}
+
+}  // namespace
+
+Program::~Program() {
+    munmap(fCode, fSize);
+}
+
+sk_sp<Program> Compile(SkSpan<const SkRasterPipelineOp> ops) {
+    static const bool gSupported = SkCpu::Supports(SkCpu::HSW);
+    if (!gSupported || ops.empty() || ops.size() > kMaxOps) {
+        return nullptr;
+    }
+    Key key;
+    key.fCount = (int)ops.size();
+    for (size_t i = 0; i < ops.size(); i++) {
+        if (!is_supported(ops[i])) {
+            return nullptr;
+        }
+        key.fOps[i] = ops[i];
+    }
+
+    SkAutoMutexExclusive lock(cache_mutex());
+    static auto* gCache = new SkLRUCache<Key, sk_sp<Program>, KeyHash>(kCacheSize);
+    if (sk_sp<Program>* cached = gCache->find(key)) {
+        return *cached;
+    }
+    sk_sp<Program> program = Compiler().compile(ops);
+    if (program) {
+        gCache->insert(key, program);
+    }
+    return program;
+}
+
+#else
+
+Program::~Program() {}
+
+sk_sp<Program> Compile(SkSpan<const SkRasterPipelineOp>) {
+    return nullptr;
+}
+
+#endif  // SK_RASTER_PIPELINE_JIT_X64
+
+}  // namespace SkRasterPipelineJIT
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkRasterPipelineJIT_DEFINED
+#define SkRasterPipelineJIT_DEFINED
+
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSpan.h"
+
+#include <cstddef>
+
+enum class SkRasterPipelineOp;
+
+/**
+ * An optional backend for SkRasterPipeline::compile() that turns short lowp pipelines into
+ * straight-line x86-64 (AVX2) machine code. Every stage body is inlined into a single loop, with
+ * the same fixed assignment of r,g,b,a,dr,dg,db,da to registers that the interpreter uses, so
+ * there are no calls or jumps between stages.
+ *
+ * Only a handful of the most common lowp ops (8888/a8 loads and stores, uniform colors, coverage
+ * and a few blend modes) are supported. Compile() returns nullptr for anything else, or when the
+ * CPU or platform can't run the generated code; callers fall back to the interpreter.
+ *
+ * The generated code reads each op's context through a pointer at run time, so a Program depends
+ * only on the list of ops. Programs are kept in a small LRU cache keyed by that list.
+ */
+namespace SkRasterPipelineJIT {
+
+// Generated code always processes this many pixels at a time.
+inline constexpr int kStride = 16;
+
+// Runs n pixels starting at (x,y), where n is a non-zero multiple of kStride. ctxs[i] is the
+// context pointer for the i-th op passed to Compile().
+using Fn = void (*)(void* const* ctxs, size_t x, size_t y, size_t n);
+
+class Program : public SkNVRefCnt<Program> {
+public:
+    Program(void* code, size_t size) : fCode(code), fSize(size) {}
+    ~Program();
+
+    Fn fn() const { return reinterpret_cast<Fn>(fCode); }
+
+private:
+    void*  fCode;
+    size_t fSize;
+};
+
+// Returns a program implementing ops (in pipeline order) with lowp semantics, or nullptr.
+sk_sp<Program> Compile(SkSpan<const SkRasterPipelineOp> ops);
+
+}  // namespace SkRasterPipelineJIT
+
+#endif  // SkRasterPipelineJIT_DEFINED
@@ -18,7 +18,7 @@ namespace SkSL { class TraceHook; }
 // of pixels we handle in the highp pipeline. Many of the context structs in this file are only used
 // by stages that have no lowp implementation. They can therefore use the (smaller) highp value to
 // save memory in the arena.
-inline static constexpr int SkRasterPipeline_kMaxStride = 16;
+inline static constexpr int SkRasterPipeline_kMaxStride = 32;
 inline static constexpr int SkRasterPipeline_kMaxStride_highp = 16;
 
 // How much space to allocate for each MemoryCtx scratch buffer, as part of tail-pixel handling.
@@ -32,7 +32,7 @@ struct SkRasterPipeline_MemoryCtx {
     int   stride;
 };
 
-// Raster Pipeline typically processes N (4, 8, 16) pixels at a time, in SIMT fashion. If the
+// Raster Pipeline typically processes N (4, 8, 16, 32) pixels at a time, in SIMT fashion. If the
 // number of pixels in a row isn't evenly divisible by N, there will be leftover pixels; this is
 // called the "tail". To avoid reading or writing past the end of any source or destination buffers
 // when we reach the tail:
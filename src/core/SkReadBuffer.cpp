@@ -58,6 +58,12 @@ void SkReadBuffer::setMemory(const void* data, size_t size) {
     }
 }
 
+void SkReadBuffer::setSharedData(const SkData* data) {
+    SkASSERT(!data || (data->bytes() <= (const uint8_t*)fBase &&
+                       (const uint8_t*)fStop <= data->bytes() + data->size()));
+    fSharedData = data;
+}
+
 void SkReadBuffer::setInvalid() {
     if (!fError) {
         // When an error is found, send the read cursor to the end of the stream
@@ -320,6 +326,15 @@ sk_sp<SkData> SkReadBuffer::readByteArrayAsData() {
         return nullptr;
     }
 
+    if (fSharedData) {
+        const void* bytes = this->skipByteArray(&numBytes);
+        if (!bytes) {
+            return nullptr;
+        }
+        return SkData::MakeSubset(fSharedData, (const uint8_t*)bytes - fSharedData->bytes(),
+                                  numBytes);
+    }
+
     SkAutoMalloc buffer(numBytes);
     if (!this->readByteArray(buffer.get(), numBytes)) {
         return nullptr;
@@ -58,6 +58,12 @@ public:
 
     void setMemory(const void*, size_t);
 
+    /**
+     *  Tells the buffer that its memory lies within data, so that readByteArrayAsData() can
+     *  return subsets of data instead of copies. The caller must keep data alive while reading.
+     */
+    void setSharedData(const SkData* data);
+
     /**
      *  Returns true IFF the version is older than the specified version.
      */
@@ -240,6 +246,9 @@ private:
     // Only used if we do not have an fFactoryArray.
     skia_private::THashMap<uint32_t, SkFlattenable::Factory> fFlattenableDict;
 
+    // If set, contains [fBase, fStop) and is shared by byte arrays we read.
+    const SkData* fSharedData = nullptr;
+
     int fVersion = 0;
 
     sk_sp<SkTypeface>* fTFArray = nullptr;
@@ -29,6 +29,9 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
 
 using namespace skia_private;
 
@@ -86,13 +89,119 @@ namespace {
 class SkResourceCache::Hash :
     public THashTable<SkResourceCache::Rec*, SkResourceCache::Key, HashTraits> {};
 
+namespace {
+// Estimates how often keys were looked up recently, for Eviction::kFrequency (as in TinyLFU).
+// This is a count-min sketch of 4-bit counts which are all halved once enough accesses have
+// been recorded, so that old popularity fades.
+class FrequencySketch {
+public:
+    void increment(uint32_t hash) {
+        int minCount = this->frequency(hash);
+        if (minCount == kMaxCount) {
+            return;
+        }
+        // Only bump the smallest counters, which keeps collisions from inflating the estimate.
+        for (int i = 0; i < kHashes; ++i) {
+            uint8_t& count = fCounts[Index(hash, i)];
+            if (count == minCount) {
+                count += 1;
+            }
+        }
+        if (++fAccesses == kResetAccesses) {
+            for (uint8_t& count : fCounts) {
+                count >>= 1;
+            }
+            fAccesses = 0;
+        }
+    }
+
+    int frequency(uint32_t hash) const {
+        int minCount = kMaxCount;
+        for (int i = 0; i < kHashes; ++i) {
+            minCount = std::min<int>(minCount, fCounts[Index(hash, i)]);
+        }
+        return minCount;
+    }
+
+private:
+    static constexpr int kCounters = 4096;
+    static constexpr int kHashes = 4;
+    static constexpr int kMaxCount = 15;
+    static constexpr int kResetAccesses = 10 * kCounters;
+
+    static int Index(uint32_t hash, int i) {
+        return SkChecksum::Mix(hash + i * 0x9E3779B9) & (kCounters - 1);
+    }
+
+    uint8_t fCounts[kCounters] = {};
+    int     fAccesses = 0;
+};
+}  // namespace
+
+struct SkResourceCache::Namespace {
+    const void*      fID;
+    NamespaceOptions fOptions;
+    const char*      fCategory = nullptr;
+
+    Rec*    fHead = nullptr;
+    Rec*    fTail = nullptr;
+    size_t  fBytesUsed = 0;
+    int     fCount = 0;
+
+    uint64_t fHits = 0;
+    uint64_t fMisses = 0;
+    uint64_t fEvictions = 0;
+    uint64_t fDiscarded = 0;
+
+    std::unique_ptr<FrequencySketch> fSketch;  // only for Eviction::kFrequency
+
+    // In the global cache's stripes, a namespace with a byte limit also counts its bytes in
+    // totals shared with the other stripes, so that the limit can be kept across all of them.
+    std::atomic<size_t>* fAllStripesBytesUsed = nullptr;
+    std::atomic<size_t>* fStripeBytesUsed = nullptr;
+
+    void added(size_t bytes) {
+        fBytesUsed += bytes;
+        fCount += 1;
+        if (fAllStripesBytesUsed) {
+            fAllStripesBytesUsed->fetch_add(bytes, std::memory_order_relaxed);
+            fStripeBytesUsed->store(fBytesUsed, std::memory_order_relaxed);
+        }
+    }
+
+    void removed(size_t bytes) {
+        fBytesUsed -= bytes;
+        fCount -= 1;
+        if (fAllStripesBytesUsed) {
+            fAllStripesBytesUsed->fetch_sub(bytes, std::memory_order_relaxed);
+            fStripeBytesUsed->store(fBytesUsed, std::memory_order_relaxed);
+        }
+    }
+
+    void setOptions(const NamespaceOptions& options) {
+        fOptions = options;
+        if (options.fEviction == Eviction::kFrequency) {
+            if (!fSketch) {
+                fSketch = std::make_unique<FrequencySketch>();
+            }
+        } else {
+            fSketch.reset();
+        }
+    }
+
+    void recordAccess(const Key& key) {
+        if (fSketch) {
+            fSketch->increment(key.hash());
+        }
+    }
+};
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkResourceCache::init() {
-    fHead = nullptr;
-    fTail = nullptr;
     fHash = new Hash;
+    fLastNamespace = nullptr;
+    fUseCounter = 0;
     fTotalBytesUsed = 0;
     fCount = 0;
     fSingleAllocationByteLimit = 0;
@@ -115,15 +224,39 @@ SkResourceCache::SkResourceCache(size_t byteLimit)
 }
 
 SkResourceCache::~SkResourceCache() {
-    Rec* rec = fHead;
-    while (rec) {
-        Rec* next = rec->fNext;
-        delete rec;
-        rec = next;
+    for (const std::unique_ptr<Namespace>& ns : fNamespaces) {
+        Rec* rec = ns->fHead;
+        while (rec) {
+            Rec* next = rec->fNext;
+            delete rec;
+            rec = next;
+        }
     }
     delete fHash;
 }
 
+SkResourceCache::Namespace* SkResourceCache::findNamespace(const void* nameSpace, bool create) {
+    if (fLastNamespace && fLastNamespace->fID == nameSpace) {
+        return fLastNamespace;
+    }
+    for (const std::unique_ptr<Namespace>& ns : fNamespaces) {
+        if (ns->fID == nameSpace) {
+            return fLastNamespace = ns.get();
+        }
+    }
+    if (!create) {
+        return nullptr;
+    }
+    fNamespaces.push_back(std::make_unique<Namespace>());
+    fLastNamespace = fNamespaces.back().get();
+    fLastNamespace->fID = nameSpace;
+    return fLastNamespace;
+}
+
+void SkResourceCache::touch(Rec* rec) {
+    rec->fLastUse = ++fUseCounter;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 bool SkResourceCache::find(const Key& key, FindVisitor visitor, void* context) {
@@ -132,13 +265,21 @@ bool SkResourceCache::find(const Key& key, FindVisitor visitor, void* context) {
     if (auto found = fHash->find(key)) {
         Rec* rec = *found;
         if (visitor(*rec, context)) {
+            rec->fNamespace->fHits += 1;
+            rec->fNamespace->recordAccess(key);
             this->moveToHead(rec);  // for our LRU
+            this->touch(rec);
             return true;
         } else {
+            rec->fNamespace->fDiscarded += 1;
             this->remove(rec);  // stale
-            return false;
         }
     }
+    // Misses count towards the key's frequency too, so a key that keeps being asked for after
+    // it was purged is more likely to stay once it is added back.
+    Namespace* ns = this->findNamespace(key.getNamespace(), /*create=*/true);
+    ns->fMisses += 1;
+    ns->recordAccess(key);
     return false;
 }
 
@@ -172,7 +313,12 @@ void SkResourceCache::add(Rec* rec, void* payload) {
         }
     }
 
+    rec->fNamespace = this->findNamespace(rec->getKey().getNamespace(), /*create=*/true);
+    if (!rec->fNamespace->fCategory) {
+        rec->fNamespace->fCategory = rec->getCategory();
+    }
     this->addToHead(rec);
+    this->touch(rec);
     fHash->set(rec);
     rec->postAddInstall(payload);
 
@@ -192,12 +338,14 @@ void SkResourceCache::remove(Rec* rec) {
     SkASSERT(rec->canBePurged());
     size_t used = rec->bytesUsed();
     SkASSERT(used <= fTotalBytesUsed);
+    SkASSERT(used <= rec->fNamespace->fBytesUsed);
 
     this->release(rec);
     fHash->remove(rec->getKey());
 
     fTotalBytesUsed -= used;
     fCount -= 1;
+    rec->fNamespace->removed(used);
 
     //SkDebugf("-RC count [%3d] bytes %d\n", fCount, fTotalBytesUsed);
 
@@ -212,7 +360,73 @@ void SkResourceCache::remove(Rec* rec) {
     delete rec;
 }
 
+SkResourceCache::Rec* SkResourceCache::victim(Namespace* ns, Rec** cursor) {
+    // How many purgeable Recs from the LRU end are compared under Eviction::kFrequency.
+    static constexpr int kFrequencySamples = 4;
+
+    Rec* victim = nullptr;
+    int victimFrequency = 0;
+    int samples = 0;
+    for (Rec* rec = *cursor; rec; rec = rec->fPrev) {
+        if (!rec->canBePurged()) {
+            continue;
+        }
+        if (samples == 0) {
+            *cursor = rec;  // Everything after this can't be purged; don't look at it again.
+        }
+        if (!ns->fSketch) {
+            return rec;
+        }
+        // Ties go to the older Rec.
+        int frequency = ns->fSketch->frequency(rec->getHash());
+        if (!victim || frequency < victimFrequency) {
+            victim = rec;
+            victimFrequency = frequency;
+        }
+        if (++samples == kFrequencySamples) {
+            break;
+        }
+    }
+    if (!victim) {
+        *cursor = nullptr;
+    }
+    return victim;
+}
+
+void SkResourceCache::removeVictim(Rec* victim, Rec** cursor) {
+    if (*cursor == victim) {
+        *cursor = victim->fPrev;
+    }
+    victim->fNamespace->fEvictions += 1;
+    this->remove(victim);
+}
+
+void SkResourceCache::purgeNamespaceToLimit(Namespace* ns, size_t byteLimit) {
+    Rec* cursor = ns->fTail;
+    while (ns->fBytesUsed > byteLimit) {
+        Rec* rec = this->victim(ns, &cursor);
+        if (!rec) {
+            break;
+        }
+        this->removeVictim(rec, &cursor);
+    }
+}
+
 void SkResourceCache::purgeAsNeeded(bool forcePurge) {
+    if (forcePurge) {
+        for (const std::unique_ptr<Namespace>& ns : fNamespaces) {
+            Rec* rec = ns->fTail;
+            while (rec) {
+                Rec* prev = rec->fPrev;
+                if (rec->canBePurged()) {
+                    this->remove(rec);
+                }
+                rec = prev;
+            }
+        }
+        return;
+    }
+
     size_t byteLimit;
     int    countLimit;
 
@@ -223,18 +437,43 @@ void SkResourceCache::purgeAsNeeded(bool forcePurge) {
         countLimit = SK_MaxS32; // no limit based on count
         byteLimit = fTotalByteLimit;
     }
+    this->purgeToLimits(byteLimit, countLimit);
+}
 
-    Rec* rec = fTail;
-    while (rec) {
-        if (!forcePurge && fTotalBytesUsed < byteLimit && fCount < countLimit) {
-            break;
+void SkResourceCache::purgeToLimits(size_t byteLimit, int countLimit) {
+    // First keep each namespace within its own budget...
+    for (const std::unique_ptr<Namespace>& ns : fNamespaces) {
+        if (ns->fOptions.fByteLimit) {
+            this->purgeNamespaceToLimit(ns.get(), ns->fOptions.fByteLimit);
         }
+    }
 
-        Rec* prev = rec->fPrev;
-        if (rec->canBePurged()) {
-            this->remove(rec);
+    // ...then purge from the lowest priority namespaces, and between namespaces of the same
+    // priority, the least recently used victim. With default options this is a plain LRU.
+    STArray<8, Rec*> cursors;
+    for (const std::unique_ptr<Namespace>& ns : fNamespaces) {
+        cursors.push_back(ns->fTail);
+    }
+    while (fTotalBytesUsed >= byteLimit || fCount >= countLimit) {
+        Rec* best = nullptr;
+        int bestIndex = -1;
+        for (int i = 0; i < fNamespaces.size(); ++i) {
+            Namespace* ns = fNamespaces[i].get();
+            if (best && ns->fOptions.fPriority > best->fNamespace->fOptions.fPriority) {
+                continue;
+            }
+            Rec* rec = this->victim(ns, &cursors[i]);
+            if (rec && (!best ||
+                        ns->fOptions.fPriority < best->fNamespace->fOptions.fPriority ||
+                        rec->fLastUse < best->fLastUse)) {
+                best = rec;
+                bestIndex = i;
+            }
+        }
+        if (!best) {
+            break;
         }
-        rec = prev;
+        this->removeVictim(best, &cursors[bestIndex]);
     }
 }
 
@@ -256,20 +495,22 @@ void SkResourceCache::purgeSharedID(uint64_t sharedID) {
 #endif
     // go backwards, just like purgeAsNeeded, just to make the code similar.
     // could iterate either direction and still be correct.
-    Rec* rec = fTail;
-    while (rec) {
-        Rec* prev = rec->fPrev;
-        if (rec->getKey().getSharedID() == sharedID) {
-            // even though the "src" is now dead, caches could still be in-flight, so
-            // we have to check if it can be removed.
-            if (rec->canBePurged()) {
-                this->remove(rec);
-            }
+    for (const std::unique_ptr<Namespace>& ns : fNamespaces) {
+        Rec* rec = ns->fTail;
+        while (rec) {
+            Rec* prev = rec->fPrev;
+            if (rec->getKey().getSharedID() == sharedID) {
+                // even though the "src" is now dead, caches could still be in-flight, so
+                // we have to check if it can be removed.
+                if (rec->canBePurged()) {
+                    this->remove(rec);
+                }
 #ifdef SK_TRACK_PURGE_SHAREDID_HITRATE
-            found = true;
+                found = true;
 #endif
+            }
+            rec = prev;
         }
-        rec = prev;
     }
 
 #ifdef SK_TRACK_PURGE_SHAREDID_HITRATE
@@ -285,10 +526,25 @@ void SkResourceCache::purgeSharedID(uint64_t sharedID) {
 void SkResourceCache::visitAll(Visitor visitor, void* context) {
     // go backwards, just like purgeAsNeeded, just to make the code similar.
     // could iterate either direction and still be correct.
-    Rec* rec = fTail;
-    while (rec) {
-        visitor(*rec, context);
-        rec = rec->fPrev;
+    for (const std::unique_ptr<Namespace>& ns : fNamespaces) {
+        Rec* rec = ns->fTail;
+        while (rec) {
+            visitor(*rec, context);
+            rec = rec->fPrev;
+        }
+    }
+}
+
+void SkResourceCache::setNamespaceOptions(const void* nameSpace,
+                                          const NamespaceOptions& options) {
+    this->findNamespace(nameSpace, /*create=*/true)->setOptions(options);
+    this->purgeAsNeeded();
+}
+
+void SkResourceCache::getNamespaceStats(TArray<NamespaceStats>* stats) const {
+    for (const std::unique_ptr<Namespace>& ns : fNamespaces) {
+        stats->push_back({ns->fID, ns->fCategory, ns->fBytesUsed, ns->fCount,
+                          ns->fHits, ns->fMisses, ns->fEvictions, ns->fDiscarded});
     }
 }
 
@@ -303,32 +559,36 @@ size_t SkResourceCache::setTotalByteLimit(size_t newLimit) {
     return prevLimit;
 }
 
-SkCachedData* SkResourceCache::newCachedData(size_t bytes) {
-    this->checkMessages();
-
-    if (fDiscardableFactory) {
-        SkDiscardableMemory* dm = fDiscardableFactory(bytes);
+static SkCachedData* new_cached_data(SkResourceCache::DiscardableFactory factory, size_t bytes) {
+    if (factory) {
+        SkDiscardableMemory* dm = factory(bytes);
         return dm ? new SkCachedData(bytes, dm) : nullptr;
     } else {
         return new SkCachedData(sk_malloc_throw(bytes), bytes);
     }
 }
 
+SkCachedData* SkResourceCache::newCachedData(size_t bytes) {
+    this->checkMessages();
+    return new_cached_data(fDiscardableFactory, bytes);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void SkResourceCache::release(Rec* rec) {
+    Namespace* ns = rec->fNamespace;
     Rec* prev = rec->fPrev;
     Rec* next = rec->fNext;
 
     if (!prev) {
-        SkASSERT(fHead == rec);
-        fHead = next;
+        SkASSERT(ns->fHead == rec);
+        ns->fHead = next;
     } else {
         prev->fNext = next;
     }
 
     if (!next) {
-        fTail = prev;
+        ns->fTail = prev;
     } else {
         next->fPrev = prev;
     }
@@ -337,20 +597,21 @@ void SkResourceCache::release(Rec* rec) {
 }
 
 void SkResourceCache::moveToHead(Rec* rec) {
-    if (fHead == rec) {
+    Namespace* ns = rec->fNamespace;
+    if (ns->fHead == rec) {
         return;
     }
 
-    SkASSERT(fHead);
-    SkASSERT(fTail);
+    SkASSERT(ns->fHead);
+    SkASSERT(ns->fTail);
 
     this->validate();
 
     this->release(rec);
 
-    fHead->fPrev = rec;
-    rec->fNext = fHead;
-    fHead = rec;
+    ns->fHead->fPrev = rec;
+    rec->fNext = ns->fHead;
+    ns->fHead = rec;
 
     this->validate();
 }
@@ -358,17 +619,19 @@ void SkResourceCache::moveToHead(Rec* rec) {
 void SkResourceCache::addToHead(Rec* rec) {
     this->validate();
 
+    Namespace* ns = rec->fNamespace;
     rec->fPrev = nullptr;
-    rec->fNext = fHead;
-    if (fHead) {
-        fHead->fPrev = rec;
+    rec->fNext = ns->fHead;
+    if (ns->fHead) {
+        ns->fHead->fPrev = rec;
     }
-    fHead = rec;
-    if (!fTail) {
-        fTail = rec;
+    ns->fHead = rec;
+    if (!ns->fTail) {
+        ns->fTail = rec;
     }
     fTotalBytesUsed += rec->bytesUsed();
     fCount += 1;
+    ns->added(rec->bytesUsed());
 
     this->validate();
 }
@@ -377,46 +640,49 @@ void SkResourceCache::addToHead(Rec* rec) {
 
 #ifdef SK_DEBUG
 void SkResourceCache::validate() const {
-    if (nullptr == fHead) {
-        SkASSERT(nullptr == fTail);
-        SkASSERT(0 == fTotalBytesUsed);
-        return;
-    }
-
-    if (fHead == fTail) {
-        SkASSERT(nullptr == fHead->fPrev);
-        SkASSERT(nullptr == fHead->fNext);
-        SkASSERT(fHead->bytesUsed() == fTotalBytesUsed);
-        return;
-    }
+    size_t totalUsed = 0;
+    int totalCount = 0;
+    for (const std::unique_ptr<Namespace>& ns : fNamespaces) {
+        if (nullptr == ns->fHead) {
+            SkASSERT(nullptr == ns->fTail);
+            SkASSERT(0 == ns->fBytesUsed);
+            SkASSERT(0 == ns->fCount);
+            continue;
+        }
 
-    SkASSERT(nullptr == fHead->fPrev);
-    SkASSERT(fHead->fNext);
-    SkASSERT(nullptr == fTail->fNext);
-    SkASSERT(fTail->fPrev);
+        SkASSERT(nullptr == ns->fHead->fPrev);
+        SkASSERT(nullptr == ns->fTail->fNext);
+
+        size_t used = 0;
+        int count = 0;
+        const Rec* rec = ns->fHead;
+        while (rec) {
+            SkASSERT(rec->fNamespace == ns.get());
+            count += 1;
+            used += rec->bytesUsed();
+            SkASSERT(used <= ns->fBytesUsed);
+            rec = rec->fNext;
+        }
+        SkASSERT(ns->fCount == count);
+        SkASSERT(ns->fBytesUsed == used);
+
+        rec = ns->fTail;
+        while (rec) {
+            SkASSERT(count > 0);
+            count -= 1;
+            SkASSERT(used >= rec->bytesUsed());
+            used -= rec->bytesUsed();
+            rec = rec->fPrev;
+        }
 
-    size_t used = 0;
-    int count = 0;
-    const Rec* rec = fHead;
-    while (rec) {
-        count += 1;
-        used += rec->bytesUsed();
-        SkASSERT(used <= fTotalBytesUsed);
-        rec = rec->fNext;
-    }
-    SkASSERT(fCount == count);
+        SkASSERT(0 == count);
+        SkASSERT(0 == used);
 
-    rec = fTail;
-    while (rec) {
-        SkASSERT(count > 0);
-        count -= 1;
-        SkASSERT(used >= rec->bytesUsed());
-        used -= rec->bytesUsed();
-        rec = rec->fPrev;
+        totalUsed += ns->fBytesUsed;
+        totalCount += ns->fCount;
     }
-
-    SkASSERT(0 == count);
-    SkASSERT(0 == used);
+    SkASSERT(fTotalBytesUsed == totalUsed);
+    SkASSERT(fCount == totalCount);
 }
 #endif
 
@@ -425,6 +691,12 @@ void SkResourceCache::dump() const {
 
     SkDebugf("SkResourceCache: count=%d bytes=%zu %s\n",
              fCount, fTotalBytesUsed, fDiscardableFactory ? "discardable" : "malloc");
+    for (const std::unique_ptr<Namespace>& ns : fNamespaces) {
+        SkDebugf("    %s: count=%d bytes=%zu hits=%llu misses=%llu evictions=%llu discarded=%llu\n",
+                 ns->fCategory ? ns->fCategory : "(unused)", ns->fCount, ns->fBytesUsed,
+                 (unsigned long long)ns->fHits, (unsigned long long)ns->fMisses,
+                 (unsigned long long)ns->fEvictions, (unsigned long long)ns->fDiscarded);
+    }
 }
 
 size_t SkResourceCache::setSingleAllocationByteLimit(size_t newLimit) {
@@ -463,94 +735,356 @@ void SkResourceCache::checkMessages() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static SkResourceCache* gResourceCache = nullptr;
-static SkMutex& resource_cache_mutex() {
-    static SkMutex& mutex = *(new SkMutex);
-    return mutex;
-}
+// The global cache is split into stripes so that threads finding and adding different keys
+// rarely wait on each other. Each stripe's own limit is the whole budget, so one stripe may use
+// more than its share while the others are light; after an add pushes the sum over the limit,
+// the stripes using the most are purged, never holding more than one stripe's lock at a time.
+// Namespace byte limits are kept across the stripes the same way.
+class SkResourceCache::Stripes {
+public:
+    static constexpr int kCount = 8;
+    // Namespaces with a byte limit; past this many, a limit is only kept within each stripe.
+    static constexpr int kMaxBudgets = 16;
+
+    struct Stripe {
+        SkMutex                          fMutex;
+        std::unique_ptr<SkResourceCache> fCache;
+        // Mirrors of the cache's totals, which can be read without the lock.
+        std::atomic<size_t>              fBytesUsed{0};
+        std::atomic<int>                 fCount{0};
+    };
+
+    // Holds a stripe's lock, and on release adds whatever the stripe's totals changed by to the
+    // totals of all the stripes.
+    class Locked {
+    public:
+        Locked(Stripes* stripes, Stripe* stripe)
+                : fStripes(stripes)
+                , fStripe(stripe)
+                , fLock(stripe->fMutex)
+                , fBytesUsed(stripe->fCache->getTotalBytesUsed())
+                , fCount(stripe->fCache->getCount()) {}
+
+        ~Locked() {
+            const size_t bytesUsed = fStripe->fCache->getTotalBytesUsed();
+            const int count = fStripe->fCache->getCount();
+            fStripe->fBytesUsed.store(bytesUsed, std::memory_order_relaxed);
+            fStripe->fCount.store(count, std::memory_order_relaxed);
+            fStripes->fTotalBytesUsed.fetch_add(bytesUsed - fBytesUsed, std::memory_order_relaxed);
+            fStripes->fTotalCount.fetch_add(count - fCount, std::memory_order_relaxed);
+        }
+
+        SkResourceCache* get() const { return fStripe->fCache.get(); }
+        SkResourceCache* operator->() const { return this->get(); }
 
-/** Must hold resource_cache_mutex() when calling. */
-static SkResourceCache* get_cache() {
-    // resource_cache_mutex() is always held when this is called, so we don't need to be fancy in here.
-    resource_cache_mutex().assertHeld();
-    if (nullptr == gResourceCache) {
+    private:
+        Stripes*             fStripes;
+        Stripe*              fStripe;
+        SkAutoMutexExclusive fLock;
+        const size_t         fBytesUsed;
+        const int            fCount;
+    };
+
+    // What a namespace with a byte limit uses in each stripe, and in all of them.
+    struct Budget {
+        const void*         fID = nullptr;
+        std::atomic<size_t> fByteLimit{0};
+        std::atomic<size_t> fBytesUsed{0};
+        std::atomic<size_t> fStripeBytesUsed[kCount] = {};
+    };
+
+    Stripes() {
+        for (Stripe& stripe : fStripes) {
 #ifdef SK_USE_DISCARDABLE_SCALEDIMAGECACHE
-        gResourceCache = new SkResourceCache(SkDiscardableMemory::Create);
+            stripe.fCache = std::make_unique<SkResourceCache>(SkDiscardableMemory::Create);
 #else
-        gResourceCache = new SkResourceCache(SK_DEFAULT_IMAGE_CACHE_LIMIT);
+            stripe.fCache = std::make_unique<SkResourceCache>(SK_DEFAULT_IMAGE_CACHE_LIMIT);
 #endif
+        }
+        fDiscardableFactory = fStripes[0].fCache->discardableFactory();
+        fTotalByteLimit = fStripes[0].fCache->getTotalByteLimit();
     }
-    return gResourceCache;
+
+    size_t getTotalBytesUsed() const { return fTotalBytesUsed.load(std::memory_order_relaxed); }
+    size_t getTotalByteLimit() const { return fTotalByteLimit.load(std::memory_order_relaxed); }
+    DiscardableFactory discardableFactory() const { return fDiscardableFactory; }
+
+    size_t setTotalByteLimit(size_t newLimit) {
+        size_t prevLimit = fTotalByteLimit.exchange(newLimit);
+        for (Stripe& stripe : fStripes) {
+            Locked(this, &stripe)->setTotalByteLimit(newLimit);
+        }
+        if (newLimit < prevLimit) {
+            this->purgeAsNeeded();
+        }
+        return prevLimit;
+    }
+
+    bool find(const Key& key, FindVisitor visitor, void* context) {
+        return Locked(this, this->stripeFor(key))->find(key, visitor, context);
+    }
+
+    void add(Rec* rec, void* payload) {
+        Locked(this, this->stripeFor(rec->getKey()))->add(rec, payload);
+        this->purgeAsNeeded();
+    }
+
+    void setNamespaceOptions(const void* nameSpace, const NamespaceOptions& options) {
+        Budget* budget = options.fByteLimit ? this->findBudget(nameSpace) : nullptr;
+        if (budget) {
+            budget->fByteLimit.store(options.fByteLimit, std::memory_order_relaxed);
+        }
+        for (int i = 0; i < kCount; ++i) {
+            Locked cache(this, &fStripes[i]);
+            // Each stripe only purges the namespace on its own once it alone is over the limit.
+            cache->setNamespaceOptions(nameSpace, options);
+            Namespace* ns = cache->findNamespace(nameSpace, /*create=*/false);
+            if (budget && ns && !ns->fAllStripesBytesUsed) {
+                ns->fAllStripesBytesUsed = &budget->fBytesUsed;
+                ns->fStripeBytesUsed = &budget->fStripeBytesUsed[i];
+                budget->fBytesUsed.fetch_add(ns->fBytesUsed, std::memory_order_relaxed);
+                budget->fStripeBytesUsed[i].store(ns->fBytesUsed, std::memory_order_relaxed);
+            }
+        }
+        this->purgeAsNeeded();
+    }
+
+    // The single allocation limit is the same in every stripe, and so is kept in the first.
+    Locked first() { return Locked(this, &fStripes[0]); }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        for (Stripe& stripe : fStripes) {
+            Locked cache(this, &stripe);
+            fn(cache.get());
+        }
+    }
+
+private:
+    Stripe* stripeFor(const Key& key) {
+        // The low bits of the hash pick the slot in each stripe's hash table, so mix them first.
+        return &fStripes[SkChecksum::Mix(key.hash()) % kCount];
+    }
+
+    Budget* findBudget(const void* nameSpace) {
+        SkAutoMutexExclusive lock(fBudgetMutex);
+        const int count = fBudgetCount.load(std::memory_order_relaxed);
+        for (int i = 0; i < count; ++i) {
+            if (fBudgets[i].fID == nameSpace) {
+                return &fBudgets[i];
+            }
+        }
+        if (count == kMaxBudgets) {
+            return nullptr;
+        }
+        fBudgets[count].fID = nameSpace;
+        fBudgetCount.store(count + 1, std::memory_order_release);
+        return &fBudgets[count];
+    }
+
+    // Purges the namespace from the stripes where it uses the most until it is within its limit.
+    void purgeBudget(Budget* budget) {
+        bool exhausted[kCount] = {};
+        for (;;) {
+            const size_t byteLimit = budget->fByteLimit.load(std::memory_order_relaxed);
+            const size_t bytesUsed = budget->fBytesUsed.load(std::memory_order_relaxed);
+            if (!byteLimit || bytesUsed <= byteLimit) {
+                return;
+            }
+
+            int biggest = -1;
+            for (int i = 0; i < kCount; ++i) {
+                if (exhausted[i]) {
+                    continue;
+                }
+                const std::atomic<size_t>* used = budget->fStripeBytesUsed;
+                if (biggest < 0 || used[i].load(std::memory_order_relaxed) >
+                                   used[biggest].load(std::memory_order_relaxed)) {
+                    biggest = i;
+                }
+            }
+            if (biggest < 0) {
+                return;  // everything left is in use
+            }
+
+            Locked cache(this, &fStripes[biggest]);
+            Namespace* ns = cache->findNamespace(budget->fID, /*create=*/false);
+            const size_t stripeBytesUsed = ns ? ns->fBytesUsed : 0;
+            const size_t overBytes = bytesUsed - byteLimit;
+            if (ns) {
+                cache->purgeNamespaceToLimit(
+                        ns, stripeBytesUsed > overBytes ? stripeBytesUsed - overBytes : 0);
+            }
+            if (!ns || ns->fBytesUsed == stripeBytesUsed) {
+                exhausted[biggest] = true;
+            }
+        }
+    }
+
+    void purgeAsNeeded() {
+        const int budgets = fBudgetCount.load(std::memory_order_acquire);
+        for (int i = 0; i < budgets; ++i) {
+            this->purgeBudget(&fBudgets[i]);
+        }
+
+        size_t byteLimit;
+        int    countLimit;
+        if (fDiscardableFactory) {
+            countLimit = SK_DISCARDABLEMEMORY_SCALEDIMAGECACHE_COUNT_LIMIT;
+            byteLimit = UINT32_MAX;  // no limit based on bytes
+        } else {
+            countLimit = SK_MaxS32; // no limit based on count
+            byteLimit = fTotalByteLimit.load(std::memory_order_relaxed);
+        }
+
+        bool exhausted[kCount] = {};
+        for (;;) {
+            const size_t bytesUsed = fTotalBytesUsed.load(std::memory_order_relaxed);
+            const int count = fTotalCount.load(std::memory_order_relaxed);
+            if (bytesUsed < byteLimit && count < countLimit) {
+                return;
+            }
+
+            Stripe* biggest = nullptr;
+            for (int i = 0; i < kCount; ++i) {
+                Stripe* stripe = &fStripes[i];
+                if (exhausted[i]) {
+                    continue;
+                }
+                const bool bigger = !biggest ||
+                                    (fDiscardableFactory
+                                             ? stripe->fCount > biggest->fCount
+                                             : stripe->fBytesUsed > biggest->fBytesUsed);
+                if (bigger) {
+                    biggest = stripe;
+                }
+            }
+            if (!biggest) {
+                return;  // everything left is in use
+            }
+
+            Locked cache(this, biggest);
+            const size_t stripeBytesUsed = cache->getTotalBytesUsed();
+            const int stripeCount = cache->getCount();
+            // Free what puts all the stripes back under the limits. (The limits are exclusive.)
+            const size_t overBytes = bytesUsed >= byteLimit ? bytesUsed - byteLimit + 1 : 0;
+            const int overCount = count >= countLimit ? count - countLimit + 1 : 0;
+            cache->purgeToLimits(
+                    stripeBytesUsed >= overBytes ? stripeBytesUsed - overBytes + 1 : 0,
+                    stripeCount >= overCount ? stripeCount - overCount + 1 : 0);
+            if (cache->getTotalBytesUsed() == stripeBytesUsed && cache->getCount() == stripeCount) {
+                exhausted[biggest - fStripes] = true;
+            }
+        }
+    }
+
+    // Declared before the stripes, whose namespaces point into them until they are destroyed.
+    SkMutex             fBudgetMutex;  // Serializes adding to fBudgets, which never shrinks.
+    Budget              fBudgets[kMaxBudgets];
+    std::atomic<int>    fBudgetCount{0};
+
+    Stripe              fStripes[kCount];
+    DiscardableFactory  fDiscardableFactory;
+    std::atomic<size_t> fTotalByteLimit;
+    std::atomic<size_t> fTotalBytesUsed{0};
+    std::atomic<int>    fTotalCount{0};
+};
+
+SkResourceCache::Stripes* SkResourceCache::Global() {
+    static Stripes* stripes = new Stripes;
+    return stripes;
 }
 
 size_t SkResourceCache::GetTotalBytesUsed() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getTotalBytesUsed();
+    return Global()->getTotalBytesUsed();
 }
 
 size_t SkResourceCache::GetTotalByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getTotalByteLimit();
+    return Global()->getTotalByteLimit();
 }
 
 size_t SkResourceCache::SetTotalByteLimit(size_t newLimit) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->setTotalByteLimit(newLimit);
+    return Global()->setTotalByteLimit(newLimit);
 }
 
 SkResourceCache::DiscardableFactory SkResourceCache::GetDiscardableFactory() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->discardableFactory();
+    return Global()->discardableFactory();
 }
 
 SkCachedData* SkResourceCache::NewCachedData(size_t bytes) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->newCachedData(bytes);
+    return new_cached_data(Global()->discardableFactory(), bytes);
 }
 
 void SkResourceCache::Dump() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    get_cache()->dump();
+    Global()->forEach([](SkResourceCache* cache) { cache->dump(); });
 }
 
 size_t SkResourceCache::SetSingleAllocationByteLimit(size_t size) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->setSingleAllocationByteLimit(size);
+    size_t oldLimit = 0;
+    Global()->forEach([&](SkResourceCache* cache) {
+        oldLimit = cache->setSingleAllocationByteLimit(size);
+    });
+    return oldLimit;
 }
 
 size_t SkResourceCache::GetSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getSingleAllocationByteLimit();
+    return Global()->first()->getSingleAllocationByteLimit();
 }
 
 size_t SkResourceCache::GetEffectiveSingleAllocationByteLimit() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->getEffectiveSingleAllocationByteLimit();
+    return Global()->first()->getEffectiveSingleAllocationByteLimit();
 }
 
 void SkResourceCache::PurgeAll() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->purgeAll();
+    Global()->forEach([](SkResourceCache* cache) { cache->purgeAll(); });
 }
 
 void SkResourceCache::CheckMessages() {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->checkMessages();
+    Global()->forEach([](SkResourceCache* cache) { cache->checkMessages(); });
 }
 
 bool SkResourceCache::Find(const Key& key, FindVisitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    return get_cache()->find(key, visitor, context);
+    return Global()->find(key, visitor, context);
 }
 
 void SkResourceCache::Add(Rec* rec, void* payload) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    get_cache()->add(rec, payload);
+    Global()->add(rec, payload);
 }
 
 void SkResourceCache::VisitAll(Visitor visitor, void* context) {
-    SkAutoMutexExclusive am(resource_cache_mutex());
-    get_cache()->visitAll(visitor, context);
+    Global()->forEach([&](SkResourceCache* cache) { cache->visitAll(visitor, context); });
+}
+
+void SkResourceCache::SetNamespaceOptions(const void* nameSpace,
+                                          const NamespaceOptions& options) {
+    Global()->setNamespaceOptions(nameSpace, options);
+}
+
+void SkResourceCache::GetNamespaceStats(TArray<NamespaceStats>* stats) {
+    TArray<NamespaceStats> stripeStats;
+    Global()->forEach([&](SkResourceCache* cache) { cache->getNamespaceStats(&stripeStats); });
+
+    const int start = stats->size();
+    for (const NamespaceStats& s : stripeStats) {
+        NamespaceStats* merged = nullptr;
+        for (int i = start; i < stats->size(); ++i) {
+            if ((*stats)[i].fNamespace == s.fNamespace) {
+                merged = &(*stats)[i];
+                break;
+            }
+        }
+        if (!merged) {
+            stats->push_back(s);
+            continue;
+        }
+        merged->fCategory = merged->fCategory ? merged->fCategory : s.fCategory;
+        merged->fBytesUsed += s.fBytesUsed;
+        merged->fCount += s.fCount;
+        merged->fHits += s.fHits;
+        merged->fMisses += s.fMisses;
+        merged->fEvictions += s.fEvictions;
+        merged->fDiscarded += s.fDiscarded;
+    }
 }
 
 void SkResourceCache::PostPurgeSharedID(uint64_t sharedID) {
@@ -617,4 +1151,33 @@ void SkResourceCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
     // Since resource could be backed by malloc or discardable, the cache always dumps detailed
     // stats to be accurate.
     VisitAll(sk_trace_dump_visitor, dump);
+
+    // The sizes are already covered by the Recs above, so only the counts go in the categories.
+    // Namespaces can share a category, so merge them first.
+    TArray<NamespaceStats> stats, categories;
+    GetNamespaceStats(&stats);
+    for (const NamespaceStats& s : stats) {
+        if (!s.fCategory) {
+            continue;
+        }
+        auto same = [&](const NamespaceStats& c) { return !strcmp(c.fCategory, s.fCategory); };
+        auto merged = std::find_if(categories.begin(), categories.end(), same);
+        if (merged == categories.end()) {
+            categories.push_back(s);
+        } else {
+            merged->fCount += s.fCount;
+            merged->fHits += s.fHits;
+            merged->fMisses += s.fMisses;
+            merged->fEvictions += s.fEvictions;
+            merged->fDiscarded += s.fDiscarded;
+        }
+    }
+    for (const NamespaceStats& s : categories) {
+        SkString dumpName = SkStringPrintf("skia/sk_resource_cache/category/%s", s.fCategory);
+        dump->dumpNumericValue(dumpName.c_str(), "entries", "objects", s.fCount);
+        dump->dumpNumericValue(dumpName.c_str(), "hits", "objects", s.fHits);
+        dump->dumpNumericValue(dumpName.c_str(), "misses", "objects", s.fMisses);
+        dump->dumpNumericValue(dumpName.c_str(), "evictions", "objects", s.fEvictions);
+        dump->dumpNumericValue(dumpName.c_str(), "discarded", "objects", s.fDiscarded);
+    }
 }
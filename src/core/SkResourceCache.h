@@ -9,10 +9,12 @@
 #define SkResourceCache_DEFINED
 
 #include "include/private/base/SkDebug.h"
+#include "include/private/base/SkTArray.h"
 #include "src/core/SkMessageBus.h"
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 
 class SkCachedData;
 class SkDiscardableMemory;
@@ -26,9 +28,16 @@ class SkTraceMemoryDump;
  *  caller must manage the access itself (e.g. via a mutex).
  *
  *  As a convenience, a global instance is also defined, which can be safely
- *  access across threads via the static methods (e.g. FindAndLock, etc.).
+ *  access across threads via the static methods (e.g. FindAndLock, etc.). The global cache is
+ *  split into stripes by key hash, each with its own lock, that share the total budget.
+ *
+ *  Recs are kept in a list per key namespace. Each namespace can be given its own byte budget,
+ *  a priority, and an eviction policy (see NamespaceOptions); by default every namespace shares
+ *  the total budget and the cache behaves as a single LRU.
  */
 class SkResourceCache {
+    struct Namespace;
+
 public:
     struct Key {
         /** Key subclasses must call this after their own fields and data are initialized.
@@ -105,8 +114,10 @@ public:
         virtual SkDiscardableMemory* diagnostic_only_getDiscardable() const { return nullptr; }
 
     private:
-        Rec*    fNext;
-        Rec*    fPrev;
+        Rec*        fNext;
+        Rec*        fPrev;
+        Namespace*  fNamespace;
+        uint64_t    fLastUse;   // when this was last added or found, for LRU across namespaces
 
         friend class SkResourceCache;
     };
@@ -119,6 +130,30 @@ public:
 
     typedef const Rec* ID;
 
+    enum class Eviction {
+        kLRU,        // purge the least recently used Rec
+        kFrequency,  // purge the least frequently used of the few least recently used Recs
+    };
+
+    struct NamespaceOptions {
+        // The most bytes Recs in the namespace may use. 0 means only the total limit applies.
+        size_t   fByteLimit = 0;
+        // When over the total limit, namespaces with lower priorities are purged first.
+        int      fPriority = 0;
+        Eviction fEviction = Eviction::kLRU;
+    };
+
+    struct NamespaceStats {
+        const void* fNamespace;
+        const char* fCategory;  // from the namespace's Recs, or nullptr if none were ever added
+        size_t      fBytesUsed;
+        int         fCount;
+        uint64_t    fHits;
+        uint64_t    fMisses;
+        uint64_t    fEvictions;  // Recs purged to stay within a budget (not stale or shared ID)
+        uint64_t    fDiscarded;  // Recs found stale, e.g. as their discardable memory was purged
+    };
+
     /**
      *  Callback function for find(). If called, the cache will have found a match for the
      *  specified Key, and will pass in the corresponding Rec, along with a caller-specified
@@ -169,10 +204,17 @@ public:
     static void PurgeAll();
     static void CheckMessages();
 
+    /**
+     *  Sets the budget, priority and eviction policy for the namespace passed to Key::init().
+     *  In the global cache the byte limit is split evenly between the stripes.
+     */
+    static void SetNamespaceOptions(const void* nameSpace, const NamespaceOptions&);
+    static void GetNamespaceStats(skia_private::TArray<NamespaceStats>*);
+
     static void TestDumpMemoryStatistics();
 
-    /** Dump memory usage statistics of every Rec in the cache using the
-        SkTraceMemoryDump interface.
+    /** Dump memory usage statistics of every Rec in the cache, and hit, miss and eviction
+        counts for each category, using the SkTraceMemoryDump interface.
      */
     static void DumpMemoryStatistics(SkTraceMemoryDump* dump);
 
@@ -225,6 +267,7 @@ public:
 
     size_t getTotalBytesUsed() const { return fTotalBytesUsed; }
     size_t getTotalByteLimit() const { return fTotalByteLimit; }
+    int getCount() const { return fCount; }
 
     /**
      *  This is respected by SkBitmapProcState::possiblyScaleImage.
@@ -246,6 +289,10 @@ public:
 
     void purgeSharedID(uint64_t sharedID);
 
+    void setNamespaceOptions(const void* nameSpace, const NamespaceOptions&);
+    // Appends the stats of every namespace that has been used or configured.
+    void getNamespaceStats(skia_private::TArray<NamespaceStats>*) const;
+
     void purgeAll() {
         this->purgeAsNeeded(true);
     }
@@ -260,12 +307,13 @@ public:
     void dump() const;
 
 private:
-    Rec*    fHead;
-    Rec*    fTail;
-
     class Hash;
     Hash*   fHash;
 
+    skia_private::TArray<std::unique_ptr<Namespace>> fNamespaces;
+    Namespace*  fLastNamespace;  // the most recently looked up, since lookups come in runs
+    uint64_t    fUseCounter;
+
     DiscardableFactory  fDiscardableFactory;
 
     size_t  fTotalBytesUsed;
@@ -277,6 +325,19 @@ private:
 
     void checkMessages();
     void purgeAsNeeded(bool forcePurge = false);
+    // Purges until the cache is under both limits, or nothing else can be purged.
+    void purgeToLimits(size_t byteLimit, int countLimit);
+
+    Namespace* findNamespace(const void* nameSpace, bool create);
+    // Returns the next Rec to purge from the namespace, or nullptr if none can be purged.
+    // The search starts at *cursor, which is left at the first purgeable Rec it finds, so that
+    // a run of purges doesn't look at the Recs that can't be purged again and again.
+    Rec* victim(Namespace*, Rec** cursor);
+    // Removes a Rec returned by victim(), keeping the cursor valid.
+    void removeVictim(Rec*, Rec** cursor);
+    // Purges the namespace's Recs until they use at most byteLimit, or none can be purged.
+    void purgeNamespaceToLimit(Namespace*, size_t byteLimit);
+    void touch(Rec*);
 
     // linklist management
     void moveToHead(Rec*);
@@ -286,6 +347,9 @@ private:
 
     void init();    // called by constructors
 
+    class Stripes;  // the global cache
+    static Stripes* Global();
+
 #ifdef SK_DEBUG
     void validate() const;
 #else
@@ -14,6 +14,7 @@
 #include "include/private/base/SkFixed.h"
 
 class SkBlitter;
+class SkExecutor;
 class SkPath;
 class SkRasterClip;
 class SkRegion;
@@ -68,6 +69,13 @@ public:
     static void HairRoundPath(const SkPath&, const SkRasterClip&, SkBlitter*);
     static void AntiHairRoundPath(const SkPath&, const SkRasterClip&, SkBlitter*);
 
+    // An anti-aliased fill that accumulates coverage in sparse 4-row strips rather than walking
+    // an active edge list, so its cost tracks the length of the outline instead of the number of
+    // edges per scanline. Bands of rows are rasterized on executor if one is given; blitting
+    // always happens on the calling thread.
+    static void SparseStripFillPath(const SkPath&, const SkRasterClip&, SkBlitter*);
+    static void SparseStripFillPath(const SkPath&, const SkRasterClip&, SkBlitter*, SkExecutor*);
+
     // Needed by SkRegion::setPath
     static void FillPath(const SkPath&, const SkRegion& clip, SkBlitter*);
 
@@ -81,6 +89,8 @@ private:
     static void AntiFillRect(const SkRect&, const SkRegion* clip, SkBlitter*);
     static void AntiFillXRect(const SkXRect&, const SkRegion*, SkBlitter*);
     static void AntiFillPath(const SkPath&, const SkRegion& clip, SkBlitter*, bool forceRLE);
+    static void SparseStripFillPath(const SkPath&, const SkRegion& clip, SkBlitter*,
+                                    SkExecutor*);
     static void FillTriangle(const SkPoint pts[], const SkRegion*, SkBlitter*);
 
     static void AntiFrameRect(const SkRect&, const SkPoint& strokeSize,
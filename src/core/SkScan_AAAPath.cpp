@@ -17,12 +17,14 @@
 #include "include/private/base/SkSafe32.h"
 #include "include/private/base/SkTo.h"
 #include "src/base/SkTSort.h"
+#include "src/base/SkVx.h"
 #include "src/core/SkAlphaRuns.h"
 #include "src/core/SkAnalyticEdge.h"
 #include "src/core/SkBlitter.h"
 #include "src/core/SkEdge.h"
 #include "src/core/SkEdgeBuilder.h"
 #include "src/core/SkMask.h"
+#include "src/core/SkMemset.h"
 #include "src/core/SkScan.h"
 #include "src/core/SkScanPriv.h"
 
@@ -97,6 +99,66 @@ static void safely_add_alpha(SkAlpha* alpha, SkAlpha delta) {
     *alpha = std::min(0xFF, *alpha + delta);
 }
 
+// The span versions below work on 16 alphas at a time and match the scalar versions above
+// exactly, finishing the last few alphas of a span one at a time.
+using A16 = skvx::Vec<16, uint8_t>;
+
+static void add_alphas(SkAlpha* alpha, const SkAlpha* delta, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        // Widen so that we can CatchOverflow() each sum the same way add_alpha does.
+        auto sum = skvx::cast<uint16_t>(A16::Load(alpha + i)) +
+                   skvx::cast<uint16_t>(A16::Load(delta + i));
+        skvx::cast<uint8_t>(sum - (sum >> 8)).store(alpha + i);
+    }
+    for (; i < n; ++i) {
+        add_alpha(&alpha[i], delta[i]);
+    }
+}
+
+static void add_alphas(SkAlpha* alpha, SkAlpha delta, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        auto sum = skvx::cast<uint16_t>(A16::Load(alpha + i)) + delta;
+        skvx::cast<uint8_t>(sum - (sum >> 8)).store(alpha + i);
+    }
+    for (; i < n; ++i) {
+        add_alpha(&alpha[i], delta);
+    }
+}
+
+static void safely_add_alphas(SkAlpha* alpha, const SkAlpha* delta, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        skvx::saturated_add(A16::Load(alpha + i), A16::Load(delta + i)).store(alpha + i);
+    }
+    for (; i < n; ++i) {
+        safely_add_alpha(&alpha[i], delta[i]);
+    }
+}
+
+static void safely_add_alphas(SkAlpha* alpha, SkAlpha delta, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        skvx::saturated_add(A16::Load(alpha + i), A16(delta)).store(alpha + i);
+    }
+    for (; i < n; ++i) {
+        safely_add_alpha(&alpha[i], delta);
+    }
+}
+
+// alpha[i] = max(alpha[i] - delta[i], 0)
+static void subtract_alphas(SkAlpha* alpha, const SkAlpha* delta, int n) {
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        A16 a = A16::Load(alpha + i);
+        (a - min(a, A16::Load(delta + i))).store(alpha + i);
+    }
+    for (; i < n; ++i) {
+        alpha[i] = alpha[i] > delta[i] ? alpha[i] - delta[i] : 0;
+    }
+}
+
 class AdditiveBlitter : public SkBlitter {
 public:
     ~AdditiveBlitter() override {}
@@ -237,10 +299,7 @@ void MaskAdditiveBlitter::blitAntiH(int x, int y, const SkAlpha alpha) {
 
 void MaskAdditiveBlitter::blitAntiH(int x, int y, int width, const SkAlpha alpha) {
     SkASSERT(x >= fMask.fBounds.fLeft - 1);
-    uint8_t* row = this->getRow(y);
-    for (int i = 0; i < width; ++i) {
-        add_alpha(&row[x + i], alpha);
-    }
+    add_alphas(this->getRow(y) + x, alpha, width);
 }
 
 void MaskAdditiveBlitter::blitV(int x, int y, int height, SkAlpha alpha) {
@@ -424,9 +483,7 @@ void RunBasedAdditiveBlitter::blitAntiH(int x, int y, const SkAlpha antialias[],
         }
         fRuns.fRuns[x + i] = 1;
     }
-    for (int i = 0; i < len; ++i) {
-        add_alpha(&fRuns.fAlpha[x + i], antialias[i]);
-    }
+    add_alphas(fRuns.fAlpha + x, antialias, len);
 }
 
 void RunBasedAdditiveBlitter::blitAntiH(int x, int y, const SkAlpha alpha) {
@@ -494,9 +551,7 @@ void SafeRLEAdditiveBlitter::blitAntiH(int x, int y, const SkAlpha antialias[],
         }
         fRuns.fRuns[x + i] = 1;
     }
-    for (int i = 0; i < len; ++i) {
-        safely_add_alpha(&fRuns.fAlpha[x + i], antialias[i]);
-    }
+    safely_add_alphas(fRuns.fAlpha + x, antialias, len);
 }
 
 void SafeRLEAdditiveBlitter::blitAntiH(int x, int y, const SkAlpha alpha) {
@@ -586,6 +641,42 @@ static SkFixed approximate_intersection(SkFixed l1, SkFixed r1, SkFixed l2, SkFi
     return (std::max(l1, l2) + std::min(r1, r2)) / 2;
 }
 
+// Steps across the n pixels that an edge crosses within a row, writing the low byte of
+// alpha16 >> 8 for alpha16 = start, start + dY, start + 2 * dY, ... (saturating like Sk32_sat_add)
+// to alphas[0], alphas[1], ..., or to alphas[n - 1], alphas[n - 2], ... if kReverse is set.
+template <bool kReverse>
+static void step_edge_alphas(SkAlpha* alphas, int n, SkFixed start, SkFixed dY) {
+    // Both are non-negative, so an unsigned sum never wraps and min() does the saturation.
+    SkASSERT(start >= 0 && dY >= 0);
+    using U32 = skvx::Vec<8, uint32_t>;
+    auto sat_add = [](U32 a, U32 b) { return min(a + b, U32(SK_MaxS32)); };
+
+    SkFixed alpha16 = start;
+    int     i       = 0;
+    if (n >= 8) {
+        U32 v;
+        for (int k = 0; k < 8; ++k) {
+            v[k]    = alpha16;
+            alpha16 = Sk32_sat_add(alpha16, dY);
+        }
+        const U32 dY8 = SkTo<uint32_t>(std::min<int64_t>(SK_MaxS32, int64_t(dY) * 8));
+        for (; i + 8 <= n; i += 8) {
+            auto a = skvx::cast<uint8_t>(v >> 8);
+            if constexpr (kReverse) {
+                skvx::shuffle<7, 6, 5, 4, 3, 2, 1, 0>(a).store(alphas + n - 8 - i);
+            } else {
+                a.store(alphas + i);
+            }
+            v = sat_add(v, dY8);
+        }
+        alpha16 = v[0];
+    }
+    for (; i < n; ++i) {
+        alphas[kReverse ? n - 1 - i : i] = (alpha16 >> 8) & 0xFF;
+        alpha16 = Sk32_sat_add(alpha16, dY);
+    }
+}
+
 // Here we always send in l < SK_Fixed1, and the first alpha we want to compute is alphas[0]
 static void compute_alpha_above_line(SkAlpha* alphas,
                                      SkFixed  l,
@@ -605,10 +696,7 @@ static void compute_alpha_above_line(SkAlpha* alphas,
         SkFixed firstH  = SkFixedMul(first, dY);  // vertical edge of the left-most triangle
         alphas[0]       = SkFixedMul(first, firstH) >> 9;  // triangle alpha
         SkFixed alpha16 = Sk32_sat_add(firstH, dY >> 1);                // rectangle plus triangle
-        for (int i = 1; i < R - 1; ++i) {
-            alphas[i] = alpha16 >> 8;
-            alpha16 = Sk32_sat_add(alpha16, dY);
-        }
+        step_edge_alphas</*kReverse=*/false>(alphas + 1, R - 2, alpha16, dY);
         alphas[R - 1] = fullAlpha - partial_triangle_to_alpha(last, dY);
     }
 }
@@ -632,10 +720,7 @@ static void compute_alpha_below_line(SkAlpha* alphas,
         SkFixed lastH   = SkFixedMul(last, dY);          // vertical edge of the right-most triangle
         alphas[R - 1]   = SkFixedMul(last, lastH) >> 9;  // triangle alpha
         SkFixed alpha16 = Sk32_sat_add(lastH, dY >> 1);             // rectangle plus triangle
-        for (int i = R - 2; i > 0; i--) {
-            alphas[i] = (alpha16 >> 8) & 0xFF;
-            alpha16 = Sk32_sat_add(alpha16, dY);
-        }
+        step_edge_alphas</*kReverse=*/true>(alphas + 1, R - 2, alpha16, dY);
         alphas[0] = fullAlpha - partial_triangle_to_alpha(first, dY);
     }
 }
@@ -692,9 +777,7 @@ static void blit_full_alpha(AdditiveBlitter* blitter,
                             SkAlpha* maskRow,
                             bool noRealBlitter) {
     if (maskRow) {
-        for (int i = 0; i < len; ++i) {
-            safely_add_alpha(&maskRow[x + i], fullAlpha);
-        }
+        safely_add_alphas(maskRow + x, fullAlpha, len);
     } else {
         if (fullAlpha == 0xFF && !noRealBlitter) {
             blitter->getRealBlitter()->blitH(x, y, len);
@@ -737,10 +820,8 @@ static void blit_aaa_trapezoid_row(AdditiveBlitter* blitter,
     SkAlpha* tempAlphas = alphas + len + 1;
     int16_t* runs       = (int16_t*)(alphas + (len + 1) * 2);
 
-    for (int i = 0; i < len; ++i) {
-        runs[i]   = 1;
-        alphas[i] = fullAlpha;
-    }
+    SkOpts::memset16(reinterpret_cast<uint16_t*>(runs), 1, len);
+    memset(alphas, fullAlpha, len);
     runs[len] = 0;
 
     int uL = SkFixedFloorToInt(ul);
@@ -755,13 +836,7 @@ static void blit_aaa_trapezoid_row(AdditiveBlitter* blitter,
     } else {
         compute_alpha_below_line(
                 tempAlphas + uL - L, ul - SkIntToFixed(uL), ll - SkIntToFixed(uL), lDY, fullAlpha);
-        for (int i = uL; i < lL; ++i) {
-            if (alphas[i - L] > tempAlphas[i - L]) {
-                alphas[i - L] -= tempAlphas[i - L];
-            } else {
-                alphas[i - L] = 0;
-            }
-        }
+        subtract_alphas(alphas + uL - L, tempAlphas + uL - L, lL - uL);
     }
 
     int uR = SkFixedFloorToInt(ur);
@@ -776,19 +851,11 @@ static void blit_aaa_trapezoid_row(AdditiveBlitter* blitter,
     } else {
         compute_alpha_above_line(
                 tempAlphas + uR - L, ur - SkIntToFixed(uR), lr - SkIntToFixed(uR), rDY, fullAlpha);
-        for (int i = uR; i < lR; ++i) {
-            if (alphas[i - L] > tempAlphas[i - L]) {
-                alphas[i - L] -= tempAlphas[i - L];
-            } else {
-                alphas[i - L] = 0;
-            }
-        }
+        subtract_alphas(alphas + uR - L, tempAlphas + uR - L, lR - uR);
     }
 
     if (maskRow) {
-        for (int i = 0; i < len; ++i) {
-            safely_add_alpha(&maskRow[L + i], alphas[i]);
-        }
+        safely_add_alphas(maskRow + L, alphas, len);
     } else {
         if (fullAlpha == 0xFF && !noRealBlitter) {
             // Real blitter is faster than RunBasedAdditiveBlitter
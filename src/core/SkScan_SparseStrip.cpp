@@ -0,0 +1,565 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkExecutor.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPathTypes.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRegion.h"
+#include "include/private/base/SkAssert.h"
+#include "include/private/base/SkFloatingPoint.h"
+#include "include/private/base/SkTDArray.h"
+#include "include/private/base/SkTPin.h"
+#include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
+#include "src/base/SkTSort.h"
+#include "src/core/SkAAClip.h"
+#include "src/core/SkBlitter.h"
+#include "src/core/SkGeometry.h"
+#include "src/core/SkRasterClip.h"
+#include "src/core/SkScan.h"
+#include "src/core/SkScanPriv.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/*
+
+A sparse-strip coverage rasterizer.
+
+The path is flattened to lines in device space. Each line deposits its signed area into an
+accumulation buffer, one pixel row at a time, such that a running sum along a row gives the
+winding-weighted coverage of every pixel in that row (the same scheme as font-rs and libart).
+The fill rule is applied to that sum, so a pixel where edges cross sees the average winding of
+its pieces; elsewhere the coverage is the exact area.
+
+Those deposits only ever land in the pixels a line passes through (and the pixel just right of
+them), so rather than a dense buffer the rows are grouped into bands kTileHeight rows tall, and
+each band only keeps the kTileHeight x kTileWidth tiles that something landed in. Between two
+touched tiles the running sum is constant, so those pixels become a single run with no per-pixel
+work. That makes the cost proportional to the length of the path's outline rather than to its
+area, and keeps it flat no matter how many edges overlap a scanline.
+
+Bands never look at each other, so they can be rasterized concurrently. Blitting always happens
+in order on the calling thread.
+
+*/
+
+namespace {
+
+constexpr int kTileHeight = 4;
+constexpr int kTileWidth  = 16;
+
+// Maximum distance, in pixels, between a curve and the lines that replace it.
+constexpr float kFlattenTolerance = 0.0625f;
+
+// How many bands are rasterized concurrently before they're blitted, when we have an executor.
+constexpr int kBandsPerBatch = 32;
+
+// A line with fY0 < fY1, relative to the draw bounds. fDir is +1 if it points down, -1 if up.
+struct Line {
+    float fX0, fY0, fX1, fY1;
+    float fDir;
+};
+
+// Flattens a path into Lines, clipped to [0, width] x [0, height]. Anything left of the bounds
+// is pushed onto the left edge, since it still contributes winding.
+class LineBuilder {
+public:
+    LineBuilder(float dx, float dy, int width, int height)
+            : fDX(dx), fDY(dy), fWidth(width), fHeight(height) {}
+
+    void addPath(const SkPath& path) {
+        SkPath::Iter iter(path, /*forceClose=*/true);
+        SkPoint pts[4];
+        SkPath::Verb verb;
+        while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+            switch (verb) {
+                case SkPath::kLine_Verb:
+                    this->addLine(pts[0], pts[1]);
+                    break;
+                case SkPath::kQuad_Verb:
+                    this->addQuad(pts);
+                    break;
+                case SkPath::kConic_Verb: {
+                    SkAutoConicToQuads quadder;
+                    const SkPoint* quads =
+                            quadder.computeQuads(pts, iter.conicWeight(), kFlattenTolerance);
+                    for (int i = 0; i < quadder.countQuads(); ++i) {
+                        this->addQuad(quads + 2 * i);
+                    }
+                    break;
+                }
+                case SkPath::kCubic_Verb:
+                    this->addCubic(pts);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    const SkTDArray<Line>& lines() const { return fLines; }
+
+private:
+    // The number of lines needed to keep a curve of the given degree within kFlattenTolerance,
+    // from Wang's formula. dd is the largest second difference of its control points.
+    static int segments_for(float dd, float degreeFactor) {
+        float n = std::ceil(std::sqrt(degreeFactor * dd / kFlattenTolerance));
+        return SkTPin(sk_float_saturate2int(n), 1, 256);
+    }
+
+    void addQuad(const SkPoint pts[3]) {
+        float dd = (pts[0] - pts[1] - pts[1] + pts[2]).length();
+        int n = segments_for(dd, 2.0f / 8);
+        SkPoint prev = pts[0];
+        for (int i = 1; i < n; ++i) {
+            SkPoint next = SkEvalQuadAt(pts, (float)i / n);
+            this->addLine(prev, next);
+            prev = next;
+        }
+        this->addLine(prev, pts[2]);
+    }
+
+    void addCubic(const SkPoint pts[4]) {
+        float dd = std::max((pts[0] - pts[1] - pts[1] + pts[2]).length(),
+                            (pts[1] - pts[2] - pts[2] + pts[3]).length());
+        int n = segments_for(dd, 6.0f / 8);
+        SkPoint prev = pts[0];
+        for (int i = 1; i < n; ++i) {
+            SkPoint next;
+            SkEvalCubicAt(pts, (float)i / n, &next, nullptr, nullptr);
+            this->addLine(prev, next);
+            prev = next;
+        }
+        this->addLine(prev, pts[3]);
+    }
+
+    void addLine(SkPoint p0, SkPoint p1) {
+        p0.offset(fDX, fDY);
+        p1.offset(fDX, fDY);
+
+        float dir = 1;
+        if (p0.fY > p1.fY) {
+            std::swap(p0, p1);
+            dir = -1;
+        }
+        if (p0.fY == p1.fY || p1.fY <= 0 || p0.fY >= fHeight) {
+            return;
+        }
+
+        // Clip vertically; nothing above or below the bounds affects coverage inside them.
+        const float dxdy = (p1.fX - p0.fX) / (p1.fY - p0.fY);
+        if (p0.fY < 0) {
+            p0 = {p0.fX - p0.fY * dxdy, 0};
+        }
+        if (p1.fY > fHeight) {
+            p1 = {p1.fX - (p1.fY - fHeight) * dxdy, (float)fHeight};
+        }
+
+        // Split where the line crosses the left and right edges, then clamp each piece.
+        float ts[4] = {0, 0, 0, 1};
+        int count = 1;
+        const float dx = p1.fX - p0.fX;
+        for (float edge : {0.0f, (float)fWidth}) {
+            float t = dx != 0 ? (edge - p0.fX) / dx : -1;
+            if (t > 0 && t < 1) {
+                ts[count++] = t;
+            }
+        }
+        ts[count] = 1;
+        std::sort(ts + 1, ts + count);
+
+        for (int i = 0; i < count; ++i) {
+            const float t0 = ts[i], t1 = ts[i + 1];
+            const float y0 = p0.fY + t0 * (p1.fY - p0.fY),
+                        y1 = t1 == 1 ? p1.fY : p0.fY + t1 * (p1.fY - p0.fY);
+            const float x0 = p0.fX + t0 * dx,
+                        x1 = t1 == 1 ? p1.fX : p0.fX + t1 * dx;
+            if (y0 >= y1 || 0.5f * (x0 + x1) >= fWidth) {
+                // Empty, or right of the bounds where it can't affect anything we draw.
+                continue;
+            }
+            fLines.push_back({SkTPin(x0, 0.0f, (float)fWidth), y0,
+                              SkTPin(x1, 0.0f, (float)fWidth), y1,
+                              dir});
+        }
+    }
+
+    const float fDX, fDY;
+    const int   fWidth, fHeight;
+    SkTDArray<Line> fLines;
+};
+
+// A run of pixels with the same alpha.
+struct Span {
+    int     fLen;
+    SkAlpha fAlpha;
+};
+
+// The output of one band: the spans of each of its rows, back to back.
+struct Band {
+    std::vector<Span> fSpans;
+    int fRowEnd[kTileHeight];
+};
+
+// Per-thread storage for accumulating one band at a time.
+class BandRasterizer {
+public:
+    BandRasterizer(int width, SkPathFillType fillType)
+            : fWidth(width)
+            , fEvenOdd(SkPathFillType_IsEvenOdd(fillType))
+            , fInverse(SkPathFillType_IsInverse(fillType))
+            , fTileOfColumn((width + kTileWidth) / kTileWidth) {
+        std::fill_n(fTileOfColumn.get(), (width + kTileWidth) / kTileWidth, -1);
+    }
+
+    // Rasterizes rows [y, y + rows) of the given lines into band.
+    void rasterize(const Line* lines, const int* indices, int count, int y, int rows, Band* band) {
+        for (int i = 0; i < count; ++i) {
+            this->accumulate(lines[indices[i]], y, rows);
+        }
+
+        // Walk the touched tiles from left to right.
+        const int tileCount = SkToInt(fTouched.size());
+        SkTQSort(fTouched.data(), fTouched.data() + tileCount,
+                 [](const Touched& a, const Touched& b) { return a.fColumn < b.fColumn; });
+
+        band->fSpans.clear();
+        for (int row = 0; row < rows; ++row) {
+            const int rowBegin = SkToInt(band->fSpans.size());
+            float winding = 0;
+            int   x       = 0;
+            for (int t = 0; t < tileCount; ++t) {
+                const int start = fTouched[t].fColumn * kTileWidth;
+                if (start > x) {
+                    push_span(band, rowBegin, start - x, this->toAlpha(winding));
+                }
+                const float* cells = this->cells(fTouched[t].fTile) + row * kTileWidth;
+                const int n = std::min(kTileWidth, fWidth - start);
+                for (int i = 0; i < n; ++i) {
+                    winding += cells[i];
+                    push_span(band, rowBegin, 1, this->toAlpha(winding));
+                }
+                x = start + n;
+            }
+            if (x < fWidth) {
+                push_span(band, rowBegin, fWidth - x, this->toAlpha(winding));
+            }
+            band->fRowEnd[row] = SkToInt(band->fSpans.size());
+        }
+
+        for (int t = 0; t < tileCount; ++t) {
+            fTileOfColumn[fTouched[t].fColumn] = -1;
+        }
+        fTouched.clear();
+        fCells.clear();
+    }
+
+private:
+    struct Touched {
+        int fColumn;
+        int fTile;
+    };
+
+    float* cells(int tile) { return fCells.data() + tile * kTileHeight * kTileWidth; }
+
+    void add(int row, int x, float value) {
+        if (x >= fWidth) {
+            return;  // Only ever affects pixels right of the bounds.
+        }
+        const int column = x / kTileWidth;
+        int tile = fTileOfColumn[column];
+        if (tile < 0) {
+            tile = SkToInt(fTouched.size());
+            fTileOfColumn[column] = tile;
+            fTouched.push_back({column, tile});
+            fCells.resize(fCells.size() + kTileHeight * kTileWidth, 0.0f);
+        }
+        this->cells(tile)[row * kTileWidth + x % kTileWidth] += value;
+    }
+
+    // Deposits the signed area of line within rows [y, y + rows), so that summing deposits from
+    // left to right gives the coverage of each pixel.
+    void accumulate(const Line& line, int y, int rows) {
+        const float dxdy = (line.fX1 - line.fX0) / (line.fY1 - line.fY0);
+        const int   top  = std::max(y, (int)std::floor(line.fY0));
+        const int   bot  = std::min(y + rows, (int)std::ceil(line.fY1));
+        for (int py = top; py < bot; ++py) {
+            const float ya = std::max((float)py, line.fY0),
+                        yb = std::min((float)(py + 1), line.fY1);
+            if (ya >= yb) {
+                continue;
+            }
+            const int   row = py - y;
+            const float d   = (yb - ya) * line.fDir;
+            const float xa  = SkTPin(line.fX0 + (ya - line.fY0) * dxdy, 0.0f, (float)fWidth),
+                        xb  = SkTPin(line.fX0 + (yb - line.fY0) * dxdy, 0.0f, (float)fWidth);
+            const float x0  = std::min(xa, xb),
+                        x1  = std::max(xa, xb);
+
+            const float x0floor = std::floor(x0);
+            const int   x0i     = (int)x0floor;
+            const float x1ceil  = std::ceil(x1);
+            const int   x1i     = (int)x1ceil;
+            if (x1i <= x0i + 1) {
+                // Within a single pixel: split d by how far across it the line sits.
+                const float xmf = 0.5f * (xa + xb) - x0floor;
+                this->add(row, x0i, d - d * xmf);
+                this->add(row, x0i + 1, d * xmf);
+            } else {
+                // Crosses several pixels: triangles at either end, and a ramp in between.
+                const float s   = 1 / (x1 - x0);
+                const float x0f = x0 - x0floor;
+                const float a0  = 0.5f * s * (1 - x0f) * (1 - x0f);
+                const float x1f = x1 - x1ceil + 1;
+                const float am  = 0.5f * s * x1f * x1f;
+                this->add(row, x0i, d * a0);
+                if (x1i == x0i + 2) {
+                    this->add(row, x0i + 1, d * (1 - a0 - am));
+                } else {
+                    const float a1 = s * (1.5f - x0f);
+                    this->add(row, x0i + 1, d * (a1 - a0));
+                    for (int x = x0i + 2; x < x1i - 1; ++x) {
+                        this->add(row, x, d * s);
+                    }
+                    const float a2 = a1 + (x1i - x0i - 3) * s;
+                    this->add(row, x1i - 1, d * (1 - a2 - am));
+                }
+                this->add(row, x1i, d * am);
+            }
+        }
+    }
+
+    SkAlpha toAlpha(float winding) const {
+        float coverage = std::abs(winding);
+        if (fEvenOdd) {
+            coverage -= 2 * std::floor(coverage * 0.5f);
+            coverage = coverage > 1 ? 2 - coverage : coverage;
+        } else {
+            coverage = std::min(coverage, 1.0f);
+        }
+        SkAlpha alpha = (SkAlpha)(coverage * 255 + 0.5f);
+        return fInverse ? 255 - alpha : alpha;
+    }
+
+    static void push_span(Band* band, int rowBegin, int len, SkAlpha alpha) {
+        if (SkToInt(band->fSpans.size()) > rowBegin && band->fSpans.back().fAlpha == alpha) {
+            band->fSpans.back().fLen += len;
+        } else {
+            band->fSpans.push_back({len, alpha});
+        }
+    }
+
+    const int  fWidth;
+    const bool fEvenOdd;
+    const bool fInverse;
+
+    skia_private::AutoTMalloc<int> fTileOfColumn;
+    std::vector<Touched>           fTouched;
+    std::vector<float>             fCells;
+};
+
+// Hands each row of a band to the blitter as SkAlphaRuns-style runs.
+class BandBlitter {
+public:
+    BandBlitter(SkBlitter* blitter, int left, int width)
+            : fBlitter(blitter)
+            , fLeft(left)
+            , fRuns(width + 1)
+            , fAlphas(width + 1) {}
+
+    void blit(const Band& band, int y, int rows) {
+        int begin = 0;
+        for (int row = 0; row < rows; ++row) {
+            const int end = band.fRowEnd[row];
+            this->blitRow(band.fSpans.data() + begin, end - begin, y + row);
+            begin = end;
+        }
+    }
+
+private:
+    void blitRow(const Span* spans, int count, int y) {
+        // Skip empty spans at either end; an empty row isn't blitted at all.
+        int x = 0;
+        while (count > 0 && spans[0].fAlpha == 0) {
+            x += spans[0].fLen;
+            ++spans;
+            --count;
+        }
+        while (count > 0 && spans[count - 1].fAlpha == 0) {
+            --count;
+        }
+        if (count == 0) {
+            return;
+        }
+
+        int16_t* runs   = fRuns.get();
+        SkAlpha* alphas = fAlphas.get();
+        int offset = 0;
+        for (int i = 0; i < count; ++i) {
+            const int len = spans[i].fLen;
+            runs[offset]   = SkToS16(len);
+            alphas[offset] = spans[i].fAlpha;
+            offset += len;
+        }
+        runs[offset] = 0;
+        fBlitter->blitAntiH(fLeft + x, y, alphas, runs);
+    }
+
+    SkBlitter* fBlitter;
+    int        fLeft;
+    skia_private::AutoTMalloc<int16_t> fRuns;
+    skia_private::AutoTMalloc<SkAlpha> fAlphas;
+};
+
+void sparse_strip_fill(const SkPath& path,
+                       const SkIRect& bounds,
+                       SkBlitter* blitter,
+                       SkExecutor* executor) {
+    const int width  = bounds.width(),
+              height = bounds.height();
+
+    LineBuilder builder(-bounds.fLeft, -bounds.fTop, width, height);
+    builder.addPath(path);
+    const SkTDArray<Line>& lines = builder.lines();
+
+    // Bin the lines into bands, stored back to back.
+    const int bandCount = (height + kTileHeight - 1) / kTileHeight;
+    std::vector<int> bandStart(bandCount + 1, 0);
+    auto band_range = [&](const Line& line, int* first, int* last) {
+        *first = (int)line.fY0 / kTileHeight;
+        *last  = std::min(bandCount - 1, ((int)std::ceil(line.fY1) - 1) / kTileHeight);
+    };
+    for (const Line& line : lines) {
+        int first, last;
+        band_range(line, &first, &last);
+        for (int b = first; b <= last; ++b) {
+            bandStart[b + 1]++;
+        }
+    }
+    for (int b = 0; b < bandCount; ++b) {
+        bandStart[b + 1] += bandStart[b];
+    }
+    std::vector<int> bandLines(bandStart[bandCount]);
+    {
+        std::vector<int> cursor(bandStart.begin(), bandStart.end() - 1);
+        for (int i = 0; i < lines.size(); ++i) {
+            int first, last;
+            band_range(lines[i], &first, &last);
+            for (int b = first; b <= last; ++b) {
+                bandLines[cursor[b]++] = i;
+            }
+        }
+    }
+
+    auto rasterize = [&](BandRasterizer* rasterizer, int b, Band* band) {
+        const int y = b * kTileHeight;
+        rasterizer->rasterize(lines.begin(), bandLines.data() + bandStart[b],
+                              bandStart[b + 1] - bandStart[b],
+                              y, std::min(kTileHeight, height - y), band);
+    };
+
+    BandBlitter bandBlitter(blitter, bounds.fLeft, width);
+    if (!executor || bandCount == 1) {
+        BandRasterizer rasterizer(width, path.getFillType());
+        Band band;
+        for (int b = 0; b < bandCount; ++b) {
+            rasterize(&rasterizer, b, &band);
+            const int y = b * kTileHeight;
+            bandBlitter.blit(band, bounds.fTop + y, std::min(kTileHeight, height - y));
+        }
+        return;
+    }
+
+    // Rasterize the next batch of bands while blitting the previous one.
+    std::vector<Band> batches[2] = {std::vector<Band>(kBandsPerBatch),
+                                    std::vector<Band>(kBandsPerBatch)};
+    SkTaskGroup       groups[2]  = {SkTaskGroup(*executor), SkTaskGroup(*executor)};
+    auto launch = [&](int b0) {
+        std::vector<Band>& batch = batches[(b0 / kBandsPerBatch) & 1];
+        const int n = std::min(kBandsPerBatch, bandCount - b0);
+        groups[(b0 / kBandsPerBatch) & 1].batch(n, [&, b0](int i) {
+            BandRasterizer rasterizer(width, path.getFillType());
+            rasterize(&rasterizer, b0 + i, &batch[i]);
+        });
+    };
+
+    launch(0);
+    for (int b0 = 0; b0 < bandCount; b0 += kBandsPerBatch) {
+        groups[(b0 / kBandsPerBatch) & 1].wait();
+        if (b0 + kBandsPerBatch < bandCount) {
+            launch(b0 + kBandsPerBatch);
+        }
+        const std::vector<Band>& batch = batches[(b0 / kBandsPerBatch) & 1];
+        const int n = std::min(kBandsPerBatch, bandCount - b0);
+        for (int i = 0; i < n; ++i) {
+            const int y = (b0 + i) * kTileHeight;
+            bandBlitter.blit(batch[i], bounds.fTop + y, std::min(kTileHeight, height - y));
+        }
+    }
+}
+
+}  // namespace
+
+void SkScan::SparseStripFillPath(const SkPath& path, const SkRegion& origClip,
+                                 SkBlitter* blitter, SkExecutor* executor) {
+    if (origClip.isEmpty()) {
+        return;
+    }
+
+    const bool isInverse = path.isInverseFillType();
+    SkIRect ir = path.getBounds().roundOut();
+
+    // Inverse fills cover the whole clip; other fills only where the clip and path meet.
+    SkIRect bounds = origClip.getBounds();
+    if (!isInverse && !bounds.intersect(ir)) {
+        return;
+    }
+
+    // Runs are int16_t, and coordinates need to stay well within float precision.
+    static constexpr int32_t kMaxCoord = 32767;
+    if (bounds.width() > kMaxCoord || bounds.height() > kMaxCoord ||
+        !SkIRect::MakeLTRB(-kMaxCoord, -kMaxCoord, kMaxCoord, kMaxCoord).contains(bounds)) {
+        SkScan::AntiFillPath(path, origClip, blitter, false);
+        return;
+    }
+
+    SkScanClipper clipper(blitter, &origClip, bounds);
+    if (clipper.getBlitter() == nullptr) {
+        return;
+    }
+    sparse_strip_fill(path, bounds, clipper.getBlitter(), executor);
+}
+
+void SkScan::SparseStripFillPath(const SkPath& path, const SkRasterClip& clip,
+                                 SkBlitter* blitter, SkExecutor* executor) {
+    if (clip.isEmpty() || !path.isFinite()) {
+        return;
+    }
+
+    if (clip.isBW()) {
+        SparseStripFillPath(path, clip.bwRgn(), blitter, executor);
+    } else {
+        SkRegion        tmp;
+        SkAAClipBlitter aaBlitter;
+
+        tmp.setRect(clip.getBounds());
+        aaBlitter.init(blitter, &clip.aaRgn());
+        SparseStripFillPath(path, tmp, &aaBlitter, executor);
+    }
+}
+
+void SkScan::SparseStripFillPath(const SkPath& path, const SkRasterClip& clip,
+                                 SkBlitter* blitter) {
+    SparseStripFillPath(path, clip, blitter, nullptr);
+}
@@ -8,6 +8,7 @@
 #include "src/core/SkStrike.h"
 
 #include "include/core/SkDrawable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkMatrix.h"
 #include "include/core/SkPath.h"
@@ -21,13 +22,16 @@
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrikeCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkWriteBuffer.h"
 #include "src/text/StrikeForGPU.h"
 
+#include <algorithm>
 #include <cctype>
 #include <new>
 #include <optional>
 #include <utility>
+#include <vector>
 
 using namespace skglyph;
 
@@ -114,6 +118,38 @@ SkStrike::FlattenGlyphsByType(SkWriteBuffer& buffer,
     }
 }
 
+void SkStrike::flattenGlyphs(SkBinaryWriteBuffer& buffer,
+                             std::vector<FlattenedGlyph>* images,
+                             std::vector<FlattenedGlyph>* paths) const {
+    std::vector<SkGlyph*> withImages, withPaths;
+    SkAutoMutexExclusive lock{fStrikeLock};
+    for (SkGlyph* glyph : fGlyphForIndex) {
+        if (glyph->setImageHasBeenCalled()) {
+            withImages.push_back(glyph);
+        }
+        if (glyph->setPathHasBeenCalled()) {
+            withPaths.push_back(glyph);
+        }
+    }
+
+    // As FlattenGlyphsByType() writes them, noting where each glyph starts.
+    buffer.writeInt(SkToInt(withImages.size()));
+    for (SkGlyph* glyph : withImages) {
+        SkASSERT(SkMask::IsValidFormat(glyph->maskFormat()));
+        images->push_back({glyph->getPackedID(), buffer.bytesWritten()});
+        glyph->flattenMetrics(buffer);
+        glyph->flattenImage(buffer);
+    }
+    buffer.writeInt(SkToInt(withPaths.size()));
+    for (SkGlyph* glyph : withPaths) {
+        SkASSERT(SkMask::IsValidFormat(glyph->maskFormat()));
+        paths->push_back({glyph->getPackedID(), buffer.bytesWritten()});
+        glyph->flattenMetrics(buffer);
+        glyph->flattenPath(buffer);
+    }
+    buffer.writeInt(0);  // no drawables
+}
+
 bool SkStrike::mergeFromBuffer(SkReadBuffer& buffer) {
     // Read glyphs with images for the current strike.
     const int imagesCount = buffer.readInt();
@@ -161,6 +197,39 @@ bool SkStrike::mergeFromBuffer(SkReadBuffer& buffer) {
     return true;
 }
 
+void SkStrike::setPersistedGlyphs(sk_sp<SkPersistentGlyphCache> persistentCache,
+                                  const SkPersistentGlyphCache::Strike& persisted) {
+    SkAutoMutexExclusive lock{fStrikeLock};
+    fPersistentCache = std::move(persistentCache);
+    fPersisted = persisted;
+}
+
+SkGlyphDigest* SkStrike::mergePersistedGlyph(SkPackedGlyphID packedGlyphID) {
+    if (!fPersistentCache) {
+        return nullptr;
+    }
+    const SkPersistentGlyphCache::Glyph* saved = fPersisted.findGlyph(packedGlyphID.value());
+    if (!saved) {
+        return nullptr;
+    }
+    auto merge = [&](uint32_t offset, bool (SkStrike::*mergeFrom)(SkReadBuffer&)) {
+        if (offset == SkPersistentGlyphCache::Glyph::kNone) {
+            return true;
+        }
+        if (offset >= fPersisted.fGlyphsSize) {
+            return false;
+        }
+        SkReadBuffer buffer{static_cast<const char*>(fPersisted.fGlyphs) + offset,
+                            fPersisted.fGlyphsSize - offset};
+        return (this->*mergeFrom)(buffer);
+    };
+    // A glyph merged before an error is still good, and anything it lacks is made as needed.
+    if (merge(saved->fImageOffset, &SkStrike::mergeGlyphAndImageFromBuffer)) {
+        (void)merge(saved->fPathOffset, &SkStrike::mergeGlyphAndPathFromBuffer);
+    }
+    return fDigestForPackedGlyphID.find(packedGlyphID);
+}
+
 SkGlyph* SkStrike::mergeGlyphAndImage(SkPackedGlyphID toID, const SkGlyph& fromGlyph) {
     Monitor m{this};
     // TODO(herb): remove finding the glyph when setting the metrics and image are separated
@@ -255,6 +324,113 @@ SkSpan<const SkGlyph*> SkStrike::prepareDrawables(
     return {results, glyphIDs.size()};
 }
 
+void SkStrike::prerasterizeImages(SkSpan<const SkPackedGlyphID> glyphIDs, SkExecutor* executor) {
+    this->prerasterize(glyphIDs, Prerasterize::kImage, executor);
+}
+
+void SkStrike::prerasterizePaths(SkSpan<const SkGlyphID> glyphIDs, SkExecutor* executor) {
+    std::vector<SkPackedGlyphID> packedIDs;
+    packedIDs.reserve(glyphIDs.size());
+    for (SkGlyphID glyphID : glyphIDs) {
+        packedIDs.push_back(SkPackedGlyphID{glyphID});
+    }
+    this->prerasterize(packedIDs, Prerasterize::kPath, executor);
+}
+
+void SkStrike::prerasterize(SkSpan<const SkPackedGlyphID> glyphIDs,
+                            Prerasterize what,
+                            SkExecutor* executor) {
+    auto done = [what](const SkGlyph& glyph) {
+        return what == Prerasterize::kImage ? glyph.setImageHasBeenCalled()
+                                            : glyph.setPathHasBeenCalled();
+    };
+
+    std::vector<SkPackedGlyphID> unique{glyphIDs.begin(), glyphIDs.end()};
+    std::sort(unique.begin(), unique.end());
+    unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+    std::vector<SkPackedGlyphID> missing;
+    {
+        Monitor m{this};
+        for (SkPackedGlyphID packedID : unique) {
+            const SkGlyphDigest* digest = fDigestForPackedGlyphID.find(packedID);
+            if (digest == nullptr) {
+                digest = this->mergePersistedGlyph(packedID);
+            }
+            if (digest == nullptr || !done(*fGlyphForIndex[digest->index()])) {
+                missing.push_back(packedID);
+            }
+        }
+
+        // Without an executor there is nothing to gain from more scaler contexts.
+        if (executor == nullptr) {
+            for (SkPackedGlyphID packedID : missing) {
+                SkGlyph* glyph = this->glyph(packedID);
+                if (what == Prerasterize::kImage) {
+                    this->prepareForImage(glyph);
+                } else {
+                    this->prepareForPath(glyph);
+                }
+            }
+            return;
+        }
+    }
+    if (missing.empty()) {
+        return;
+    }
+
+    // Making a scaler context costs about as much as rasterizing a few glyphs, so don't give each
+    // task too few.
+    static constexpr size_t kGlyphsPerTask = 32;
+    const int taskCount = SkToInt((missing.size() + kGlyphsPerTask - 1) / kGlyphsPerTask);
+    struct Results {
+        SkArenaAlloc         fAlloc{kMinAllocAmount};
+        std::vector<SkGlyph> fGlyphs;
+    };
+    std::unique_ptr<Results[]> results{new Results[taskCount]};
+    SkTaskGroup(*executor).batch(taskCount, [&](int task) {
+        std::unique_ptr<SkScalerContext> context = fStrikeSpec.createScalerContext();
+        Results& taskResults = results[task];
+        const size_t end = std::min(missing.size(), (task + 1) * kGlyphsPerTask);
+        for (size_t i = task * kGlyphsPerTask; i < end; ++i) {
+            SkGlyph glyph = context->makeGlyph(missing[i], &taskResults.fAlloc);
+            if (what == Prerasterize::kImage) {
+                glyph.setImage(&taskResults.fAlloc, context.get());
+            } else {
+                glyph.setPath(&taskResults.fAlloc, context.get());
+            }
+            taskResults.fGlyphs.push_back(glyph);
+        }
+    });
+
+    Monitor m{this};
+    for (int task = 0; task < taskCount; ++task) {
+        for (const SkGlyph& glyph : results[task].fGlyphs) {
+            this->mergeGlyphFromOtherContext(glyph);
+        }
+    }
+}
+
+void SkStrike::mergeGlyphFromOtherContext(const SkGlyph& from) {
+    SkGlyph* glyph;
+    if (SkGlyphDigest* digest = fDigestForPackedGlyphID.find(from.getPackedID())) {
+        glyph = fGlyphForIndex[digest->index()];
+        // Another thread may have drawn the glyph meanwhile.
+        if (from.setImageHasBeenCalled() && !glyph->setImageHasBeenCalled()) {
+            fMemoryIncrease += glyph->setMetricsAndImage(&fAlloc, from);
+        }
+    } else {
+        glyph = fAlloc.make<SkGlyph>(from.getPackedID());
+        fMemoryIncrease += glyph->setMetricsAndImage(&fAlloc, from) + sizeof(SkGlyph);
+        this->addGlyphAndDigest(glyph);
+    }
+
+    if (from.setPathHasBeenCalled() && !glyph->setPathHasBeenCalled() &&
+        glyph->setPath(&fAlloc, from.path(), from.pathIsHairline(), from.pathIsModified())) {
+        fMemoryIncrease += glyph->path()->approximateBytesUsed();
+    }
+}
+
 void SkStrike::glyphIDsToPaths(SkSpan<sktext::IDOrPath> idsOrPaths) {
     Monitor m{this};
     for (sktext::IDOrPath& idOrPath : idsOrPaths) {
@@ -337,6 +513,8 @@ SkGlyphDigest SkStrike::digestFor(ActionType actionType, SkPackedGlyphID packedG
     SkGlyph* glyph;
     if (digestPtr != nullptr) {
         glyph = fGlyphForIndex[digestPtr->index()];
+    } else if ((digestPtr = this->mergePersistedGlyph(packedGlyphID)) != nullptr) {
+        glyph = fGlyphForIndex[digestPtr->index()];
     } else {
         glyph = fAlloc.make<SkGlyph>(fScalerContext->makeGlyph(packedGlyphID, &fAlloc));
         fMemoryIncrease += sizeof(SkGlyph);
@@ -445,12 +623,8 @@ SkSpan<const SkGlyph*> SkStrike::internalPrepare(
 
 void SkStrike::updateMemoryUsage(size_t increase) {
     if (increase > 0) {
-        // fRemoved and the cache's total memory are managed under the cache's lock. This allows
-        // them to be accessed under LRU operation.
-        SkAutoMutexExclusive lock{fStrikeCache->fLock};
-        fMemoryUsed += increase;
-        if (!fRemoved) {
-            fStrikeCache->fTotalMemoryUsed += increase;
-        }
+        // fMemoryUsed, fRemoved and the cache's total memory are managed under the lock of this
+        // strike's shard of the cache. This allows them to be accessed under LRU operation.
+        fStrikeCache->strikeMemoryIncreased(this, increase);
     }
 }
@@ -16,20 +16,25 @@
 #include "include/private/base/SkThreadAnnotations.h"
 #include "src/base/SkArenaAlloc.h"
 #include "src/core/SkGlyph.h"
+#include "src/core/SkPersistentGlyphCache.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrikeSpec.h"
 #include "src/core/SkTHash.h"
 #include "src/text/StrikeForGPU.h"
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
 class SkDescriptor;
 class SkDrawable;
+class SkExecutor;
 class SkPath;
 class SkReadBuffer;
 class SkStrikeCache;
+class SkBinaryWriteBuffer;
 class SkTraceMemoryDump;
 class SkWriteBuffer;
 
@@ -57,6 +62,16 @@ public:
     bool prepareForDrawable(SkGlyph*) override SK_REQUIRES(fStrikeLock);
 
     bool mergeFromBuffer(SkReadBuffer& buffer) SK_EXCLUDES(fStrikeLock);
+    // Where flattenGlyphs() wrote a glyph: the offset of its metrics, followed by its image or
+    // path, in the buffer.
+    struct FlattenedGlyph {
+        SkPackedGlyphID fPackedID;
+        size_t          fOffset;
+    };
+    // Writes every glyph with an image or a path, in the format mergeFromBuffer() reads.
+    void flattenGlyphs(SkBinaryWriteBuffer& buffer,
+                       std::vector<FlattenedGlyph>* images,
+                       std::vector<FlattenedGlyph>* paths) const SK_EXCLUDES(fStrikeLock);
     static void FlattenGlyphsByType(SkWriteBuffer& buffer,
                                     SkSpan<SkGlyph> images,
                                     SkSpan<SkGlyph> paths,
@@ -99,6 +114,17 @@ public:
     SkSpan<const SkGlyph*> prepareDrawables(
             SkSpan<const SkGlyphID> glyphIDs, const SkGlyph* results[]) SK_EXCLUDES(fStrikeLock);
 
+    // Generate the images of those glyphs which don't have them yet, spread over the executor,
+    // and add them to the strike. Each task rasterizes with its own scaler context, so the strike
+    // is only locked while finding the missing glyphs and while adding the results, and other
+    // threads can keep drawing from it. Without an executor, this is like prepareImages().
+    void prerasterizeImages(SkSpan<const SkPackedGlyphID> glyphIDs,
+                            SkExecutor* executor) SK_EXCLUDES(fStrikeLock);
+
+    // The same for the paths of the glyphs.
+    void prerasterizePaths(SkSpan<const SkGlyphID> glyphIDs,
+                           SkExecutor* executor) SK_EXCLUDES(fStrikeLock);
+
     // SkStrikeForGPU APIs
     const SkDescriptor& getDescriptor() const override {
         return fStrikeSpec.descriptor();
@@ -145,11 +171,27 @@ private:
     // Generate the glyph digest information and update structures to add the glyph.
     SkGlyphDigest* addGlyphAndDigest(SkGlyph* glyph) SK_REQUIRES(fStrikeLock);
 
+    // Glyphs that haven't been made yet are taken from these saved ones when they are.
+    void setPersistedGlyphs(sk_sp<SkPersistentGlyphCache>, const SkPersistentGlyphCache::Strike&)
+            SK_EXCLUDES(fStrikeLock);
+    // Merges the glyph from the saved ones, returning nullptr if it wasn't saved or can't be read.
+    SkGlyphDigest* mergePersistedGlyph(SkPackedGlyphID) SK_REQUIRES(fStrikeLock);
     SkGlyph* mergeGlyphFromBuffer(SkReadBuffer& buffer) SK_REQUIRES(fStrikeLock);
     bool mergeGlyphAndImageFromBuffer(SkReadBuffer& buffer) SK_REQUIRES(fStrikeLock);
     bool mergeGlyphAndPathFromBuffer(SkReadBuffer& buffer) SK_REQUIRES(fStrikeLock);
     bool mergeGlyphAndDrawableFromBuffer(SkReadBuffer& buffer) SK_REQUIRES(fStrikeLock);
 
+    enum class Prerasterize {
+        kImage,
+        kPath
+    };
+    void prerasterize(SkSpan<const SkPackedGlyphID> glyphIDs,
+                      Prerasterize what,
+                      SkExecutor* executor) SK_EXCLUDES(fStrikeLock);
+    // Copy the metrics, and any image or path, of a glyph made by another scaler context into
+    // the glyph with its ID, unless that already has them.
+    void mergeGlyphFromOtherContext(const SkGlyph& from) SK_REQUIRES(fStrikeLock);
+
     // Maintain memory use statistics.
     void updateMemoryUsage(size_t increase) SK_EXCLUDES(fStrikeLock);
 
@@ -190,6 +232,11 @@ private:
     // Used while changing the strike to track memory increase.
     size_t fMemoryIncrease SK_GUARDED_BY(fStrikeLock) {0};
 
+    // Saved glyphs to take in place of making them with fScalerContext. The cache keeps the data
+    // that fPersisted points into alive.
+    sk_sp<SkPersistentGlyphCache>  fPersistentCache SK_GUARDED_BY(fStrikeLock);
+    SkPersistentGlyphCache::Strike fPersisted SK_GUARDED_BY(fStrikeLock) {};
+
     // So, we don't grow our arrays a lot.
     inline static constexpr size_t kMinGlyphCount = 8;
     inline static constexpr size_t kMinGlyphImageSize = 16 /* height */ * 8 /* width */;
@@ -197,12 +244,18 @@ private:
 
     SkArenaAlloc            fAlloc SK_GUARDED_BY(fStrikeLock) {kMinAllocAmount};
 
-    // The following are protected by the SkStrikeCache's mutex.
+    // The following are protected by the mutex of the SkStrikeCache's shard for this strike.
     SkStrike*                       fNext{nullptr};
     SkStrike*                       fPrev{nullptr};
     std::unique_ptr<SkStrikePinner> fPinner;
     size_t                          fMemoryUsed{sizeof(SkStrike)};
     bool                            fRemoved{false};
+
+    // Set without that mutex when a thread finds the strike in its list of recent strikes. Such
+    // finds set fRecentlyUsed instead of moving the strike in the LRU list, and purging gives a
+    // strike with it set another chance.
+    std::atomic<bool>               fRecentlyUsed{false};
+    std::atomic<uint64_t>           fLockFreeHits{0};
 };
 
 #endif  // SkStrike_DEFINED
@@ -9,16 +9,22 @@
 
 #include "include/core/SkGraphics.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkString.h"
 #include "include/core/SkTraceMemoryDump.h"
 #include "include/private/base/SkAssert.h"
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkMutex.h"
+#include "src/core/SkChecksum.h"
 #include "src/core/SkDescriptor.h"
+#include "src/core/SkPersistentGlyphCache.h"
 #include "src/core/SkStrike.h"
 #include "src/core/SkStrikeSpec.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <utility>
+#include <vector>
 
 class SkScalerContext;
 struct SkFontMetrics;
@@ -36,13 +42,116 @@ SkStrikeCache* SkStrikeCache::GlobalStrikeCache() {
     return cache;
 }
 
+SkStrikeCache::SkStrikeCache(int shardCount)
+        : fShardCount{std::max(shardCount, 1)}
+        , fShards{new Shard[fShardCount]} {}
+
+SkStrikeCache::~SkStrikeCache() = default;
+
+auto SkStrikeCache::shardFor(const SkDescriptor& desc) const -> Shard& {
+    // The shard's hash table uses the low bits of the checksum, so pick the shard with others.
+    return fShards[(SkChecksum::Mix(desc.getChecksum()) >> 8) % fShardCount];
+}
+
+namespace {
+// Generations are unique across caches, so a recent strike of a deleted cache never matches a
+// shard of a new one. Zero is never used.
+uint64_t next_generation() {
+    static std::atomic<uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+// The strikes this thread found most recently, from any SkStrikeCache. They aren't refs: a strike
+// is only looked at while its shard's generation shows it's still in the cache.
+struct RecentStrikes {
+    static constexpr int kCount = 4;
+    struct Entry {
+        SkStrike* fStrike = nullptr;
+        uint64_t  fGeneration = 0;
+    };
+    Entry fEntries[kCount];
+    int fNext = 0;
+};
+
+RecentStrikes& recent_strikes() {
+    static thread_local RecentStrikes recent;
+    return recent;
+}
+}  // namespace
+
+SkStrikeCache::Shard::Shard() : fGeneration{next_generation()} {}
+
+sk_sp<SkStrike> SkStrikeCache::findRecentStrike(const SkDescriptor& desc, Shard& shard) {
+    if (fNeedsPurge.load(std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    // Announce the lookup before reading the generation, so that a thread removing strikes
+    // either sees the lookup and waits for it, or changed the generation first.
+    shard.fRecentLookups.fetch_add(1, std::memory_order_seq_cst);
+    const uint64_t generation = shard.fGeneration.load(std::memory_order_seq_cst);
+    sk_sp<SkStrike> found;
+    for (const RecentStrikes::Entry& entry : recent_strikes().fEntries) {
+        if (entry.fGeneration != generation || entry.fStrike->getDescriptor() != desc) {
+            continue;
+        }
+        found = sk_ref_sp(entry.fStrike);
+        // Avoid writing to the strike if this thread or another already has.
+        if (!found->fRecentlyUsed.load(std::memory_order_relaxed)) {
+            found->fRecentlyUsed.store(true, std::memory_order_relaxed);
+        }
+        found->fLockFreeHits.fetch_add(1, std::memory_order_relaxed);
+        break;
+    }
+    shard.fRecentLookups.fetch_sub(1, std::memory_order_release);
+    return found;
+}
+
+void SkStrikeCache::RememberRecentStrike(const Shard& shard, SkStrike* strike) {
+    const uint64_t generation = shard.fGeneration.load(std::memory_order_relaxed);
+    RecentStrikes& recent = recent_strikes();
+    for (const RecentStrikes::Entry& entry : recent.fEntries) {
+        if (entry.fStrike == strike && entry.fGeneration == generation) {
+            return;
+        }
+    }
+    recent.fEntries[recent.fNext] = {strike, generation};
+    recent.fNext = (recent.fNext + 1) % RecentStrikes::kCount;
+}
+
+void SkStrikeCache::RetireRecentStrikes(Shard& shard) {
+    shard.fGeneration.store(next_generation(), std::memory_order_seq_cst);
+    // Lookups that read the old generation are short, and never wait on anything.
+    while (shard.fRecentLookups.load(std::memory_order_seq_cst) != 0) { /*spin*/ }
+}
+
 auto SkStrikeCache::findOrCreateStrike(const SkStrikeSpec& strikeSpec) -> sk_sp<SkStrike> {
-    SkAutoMutexExclusive ac(fLock);
-    sk_sp<SkStrike> strike = this->internalFindStrikeOrNull(strikeSpec.descriptor());
+    Shard& shard = this->shardFor(strikeSpec.descriptor());
+    if (sk_sp<SkStrike> strike = this->findRecentStrike(strikeSpec.descriptor(), shard)) {
+        return strike;
+    }
+
+    sk_sp<SkStrike> strike;
+    {
+        SkAutoMutexExclusive ac(shard.fLock);
+        strike = this->internalFindStrikeOrNull(shard, strikeSpec.descriptor());
+        if (strike != nullptr) {
+            RememberRecentStrike(shard, strike.get());
+        }
+    }
     if (strike == nullptr) {
-        strike = this->internalCreateStrike(strikeSpec);
+        // Finding saved glyphs may read the whole font, so it's done without the shard's lock,
+        // and another thread may have made the strike meanwhile.
+        const Persisted persisted = this->findPersisted(strikeSpec);
+        SkAutoMutexExclusive ac(shard.fLock);
+        strike = this->internalFindStrikeOrNull(shard, strikeSpec.descriptor());
+        if (strike == nullptr) {
+            strike = this->internalCreateStrike(shard, strikeSpec, persisted);
+        }
+        RememberRecentStrike(shard, strike.get());
+    }
+    if (fNeedsPurge.load(std::memory_order_relaxed)) {
+        this->purge();
     }
-    this->internalPurge();
     return strike;
 }
 
@@ -50,6 +159,27 @@ sk_sp<StrikeForGPU> SkStrikeCache::findOrCreateScopedStrike(const SkStrikeSpec&
     return this->findOrCreateStrike(strikeSpec);
 }
 
+sk_sp<SkStrike> SkStrikeCache::prerasterizeImages(const SkStrikeSpec& strikeSpec,
+                                                  SkSpan<const SkGlyphID> glyphIDs,
+                                                  SkExecutor* executor) {
+    sk_sp<SkStrike> strike = this->findOrCreateStrike(strikeSpec);
+    const SkIPoint usedFields = strike->roundingSpec().ignorePositionFieldMask;
+    const uint32_t xCount = usedFields.x() != 0 ? 1u << SkPackedGlyphID::kSubPixelPosLen : 1u,
+                   yCount = usedFields.y() != 0 ? 1u << SkPackedGlyphID::kSubPixelPosLen : 1u;
+
+    std::vector<SkPackedGlyphID> packedIDs;
+    packedIDs.reserve(glyphIDs.size() * xCount * yCount);
+    for (SkGlyphID glyphID : glyphIDs) {
+        for (uint32_t y = 0; y < yCount; ++y) {
+            for (uint32_t x = 0; x < xCount; ++x) {
+                packedIDs.push_back(SkPackedGlyphID{glyphID, x, y});
+            }
+        }
+    }
+    strike->prerasterizeImages(packedIDs, executor);
+    return strike;
+}
+
 void SkStrikeCache::PurgeAll() {
     GlobalStrikeCache()->purgeAll();
 }
@@ -61,11 +191,19 @@ void SkStrikeCache::Dump() {
     SkDebugf("    count  [ %8d  %8d ]\n",
              SkGraphics::GetFontCacheCountUsed(), SkGraphics::GetFontCacheCountLimit());
 
+    SkStrikeCache* cache = GlobalStrikeCache();
+    SkDebugf("    shard  [     hits    misses    purged ]\n");
+    for (int i = 0; i < cache->shardCount(); i++) {
+        const ShardStats stats = cache->shardStats(i);
+        SkDebugf("    %5d  [ %8llu  %8llu  %8llu ]\n", i, (unsigned long long)stats.fHits,
+                 (unsigned long long)stats.fMisses, (unsigned long long)stats.fPurged);
+    }
+
     auto visitor = [](const SkStrike& strike) {
         strike.dump();
     };
 
-    GlobalStrikeCache()->forEachStrike(visitor);
+    cache->forEachStrike(visitor);
 }
 
 void SkStrikeCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
@@ -77,6 +215,27 @@ void SkStrikeCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
     dump->dumpNumericValue(kGlyphCacheDumpName, "budget_glyph_count", "objects",
                            SkGraphics::GetFontCacheCountLimit());
 
+    SkStrikeCache* cache = GlobalStrikeCache();
+    ShardStats total;
+    for (int i = 0; i < cache->shardCount(); i++) {
+        const ShardStats stats = cache->shardStats(i);
+        total.fHits   += stats.fHits;
+        total.fMisses += stats.fMisses;
+        total.fPurged += stats.fPurged;
+        if (dump->getRequestedDetails() != SkTraceMemoryDump::kLight_LevelOfDetail) {
+            SkString shardName;
+            shardName.printf("%s/shard_%d", kGlyphCacheDumpName, i);
+            dump->dumpNumericValue(shardName.c_str(), "size", "bytes", stats.fBytes);
+            dump->dumpNumericValue(shardName.c_str(), "glyph_count", "objects", stats.fCount);
+            dump->dumpNumericValue(shardName.c_str(), "hits", "objects", stats.fHits);
+            dump->dumpNumericValue(shardName.c_str(), "misses", "objects", stats.fMisses);
+            dump->dumpNumericValue(shardName.c_str(), "purged", "objects", stats.fPurged);
+        }
+    }
+    dump->dumpNumericValue(kGlyphCacheDumpName, "hits", "objects", total.fHits);
+    dump->dumpNumericValue(kGlyphCacheDumpName, "misses", "objects", total.fMisses);
+    dump->dumpNumericValue(kGlyphCacheDumpName, "purged", "objects", total.fPurged);
+
     if (dump->getRequestedDetails() == SkTraceMemoryDump::kLight_LevelOfDetail) {
         dump->setMemoryBacking(kGlyphCacheDumpName, "malloc", nullptr);
         return;
@@ -86,39 +245,48 @@ void SkStrikeCache::DumpMemoryStatistics(SkTraceMemoryDump* dump) {
         strike.dumpMemoryStatistics(dump);
     };
 
-    GlobalStrikeCache()->forEachStrike(visitor);
+    cache->forEachStrike(visitor);
 }
 
 sk_sp<SkStrike> SkStrikeCache::findStrike(const SkDescriptor& desc) {
-    SkAutoMutexExclusive ac(fLock);
-    sk_sp<SkStrike> result = this->internalFindStrikeOrNull(desc);
-    this->internalPurge();
+    Shard& shard = this->shardFor(desc);
+    if (sk_sp<SkStrike> strike = this->findRecentStrike(desc, shard)) {
+        return strike;
+    }
+
+    sk_sp<SkStrike> result;
+    {
+        SkAutoMutexExclusive ac(shard.fLock);
+        result = this->internalFindStrikeOrNull(shard, desc);
+        if (result) {
+            RememberRecentStrike(shard, result.get());
+        }
+    }
+    if (fNeedsPurge.load(std::memory_order_relaxed)) {
+        this->purge();
+    }
     return result;
 }
 
-auto SkStrikeCache::internalFindStrikeOrNull(const SkDescriptor& desc) -> sk_sp<SkStrike> {
+auto SkStrikeCache::internalFindStrikeOrNull(Shard& shard, const SkDescriptor& desc)
+        -> sk_sp<SkStrike> {
 
     // Check head because it is likely the strike we are looking for.
-    if (fHead != nullptr && fHead->getDescriptor() == desc) { return sk_ref_sp(fHead); }
+    if (shard.fHead != nullptr && shard.fHead->getDescriptor() == desc) {
+        shard.fHits += 1;
+        return sk_ref_sp(shard.fHead);
+    }
 
     // Do the heavy search looking for the strike.
-    sk_sp<SkStrike>* strikeHandle = fStrikeLookup.find(desc);
-    if (strikeHandle == nullptr) { return nullptr; }
+    sk_sp<SkStrike>* strikeHandle = shard.fStrikeLookup.find(desc);
+    if (strikeHandle == nullptr) {
+        shard.fMisses += 1;
+        return nullptr;
+    }
+    shard.fHits += 1;
     SkStrike* strikePtr = strikeHandle->get();
     SkASSERT(strikePtr != nullptr);
-    if (fHead != strikePtr) {
-        // Make most recently used
-        strikePtr->fPrev->fNext = strikePtr->fNext;
-        if (strikePtr->fNext != nullptr) {
-            strikePtr->fNext->fPrev = strikePtr->fPrev;
-        } else {
-            fTail = strikePtr->fPrev;
-        }
-        fHead->fPrev = strikePtr;
-        strikePtr->fNext = fHead;
-        strikePtr->fPrev = nullptr;
-        fHead = strikePtr;
-    }
+    this->internalMoveToHead(shard, strikePtr);
     return sk_ref_sp(strikePtr);
 }
 
@@ -126,58 +294,93 @@ sk_sp<SkStrike> SkStrikeCache::createStrike(
         const SkStrikeSpec& strikeSpec,
         SkFontMetrics* maybeMetrics,
         std::unique_ptr<SkStrikePinner> pinner) {
-    SkAutoMutexExclusive ac(fLock);
-    return this->internalCreateStrike(strikeSpec, maybeMetrics, std::move(pinner));
+    Shard& shard = this->shardFor(strikeSpec.descriptor());
+    const Persisted persisted = this->findPersisted(strikeSpec);
+    SkAutoMutexExclusive ac(shard.fLock);
+    return this->internalCreateStrike(
+            shard, strikeSpec, persisted, maybeMetrics, std::move(pinner));
+}
+
+auto SkStrikeCache::findPersisted(const SkStrikeSpec& strikeSpec) const -> Persisted {
+    Persisted persisted;
+    persisted.fCache = this->persistentGlyphCache();
+    if (persisted.fCache &&
+        !persisted.fCache->find(strikeSpec.descriptor(), strikeSpec.typeface(),
+                                &persisted.fStrike)) {
+        persisted.fCache = nullptr;
+    }
+    return persisted;
 }
 
 auto SkStrikeCache::internalCreateStrike(
+        Shard& shard,
         const SkStrikeSpec& strikeSpec,
+        const Persisted& persisted,
         SkFontMetrics* maybeMetrics,
         std::unique_ptr<SkStrikePinner> pinner) -> sk_sp<SkStrike> {
     std::unique_ptr<SkScalerContext> scaler = strikeSpec.createScalerContext();
+
+    SkFontMetrics persistedMetrics;
+    if (persisted.fCache && maybeMetrics == nullptr) {
+        persistedMetrics = *persisted.fStrike.fFontMetrics;
+        maybeMetrics = &persistedMetrics;
+    }
+
     auto strike =
         sk_make_sp<SkStrike>(this, strikeSpec, std::move(scaler), maybeMetrics, std::move(pinner));
-    this->internalAttachToHead(strike);
+    if (persisted.fCache) {
+        strike->setPersistedGlyphs(persisted.fCache, persisted.fStrike);
+    }
+    this->internalAttachToHead(shard, strike);
     return strike;
 }
 
+void SkStrikeCache::setPersistentGlyphCache(sk_sp<SkPersistentGlyphCache> persistentCache) {
+    SkAutoMutexExclusive lock{fPersistentGlyphCacheLock};
+    fPersistentGlyphCache = std::move(persistentCache);
+}
+
+sk_sp<SkPersistentGlyphCache> SkStrikeCache::persistentGlyphCache() const {
+    SkAutoMutexExclusive lock{fPersistentGlyphCacheLock};
+    return fPersistentGlyphCache;
+}
+
 void SkStrikeCache::purgePinned(size_t minBytesNeeded) {
-    SkAutoMutexExclusive ac(fLock);
-    this->internalPurge(minBytesNeeded, /* checkPinners= */ true);
+    this->purge(minBytesNeeded, /* checkPinners= */ true);
 }
 
 void SkStrikeCache::purgeAll() {
-    SkAutoMutexExclusive ac(fLock);
-    this->internalPurge(fTotalMemoryUsed, /* checkPinners= */ true);
+    SkAutoMutexExclusive purgeLock(fPurgeLock);
+    fNeedsPurge.store(false, std::memory_order_relaxed);
+    Freed freed;
+    for (int i = 0; i < fShardCount; i++) {
+        Shard& shard = fShards[i];
+        SkAutoMutexExclusive ac(shard.fLock);
+        this->internalPurge(shard, shard.fTotalMemoryUsed, shard.fCacheCount,
+                            /* checkPinners= */ true, &freed);
+    }
 }
 
 size_t SkStrikeCache::getTotalMemoryUsed() const {
-    SkAutoMutexExclusive ac(fLock);
-    return fTotalMemoryUsed;
+    return fTotalMemoryUsed.load(std::memory_order_relaxed);
 }
 
 int SkStrikeCache::getCacheCountUsed() const {
-    SkAutoMutexExclusive ac(fLock);
-    return fCacheCount;
+    return fCacheCount.load(std::memory_order_relaxed);
 }
 
 int SkStrikeCache::getCacheCountLimit() const {
-    SkAutoMutexExclusive ac(fLock);
-    return fCacheCountLimit;
+    return fCacheCountLimit.load(std::memory_order_relaxed);
 }
 
 size_t SkStrikeCache::setCacheSizeLimit(size_t newLimit) {
-    SkAutoMutexExclusive ac(fLock);
-
-    size_t prevLimit = fCacheSizeLimit;
-    fCacheSizeLimit = newLimit;
-    this->internalPurge();
+    size_t prevLimit = fCacheSizeLimit.exchange(newLimit);
+    this->purge();
     return prevLimit;
 }
 
 size_t  SkStrikeCache::getCacheSizeLimit() const {
-    SkAutoMutexExclusive ac(fLock);
-    return fCacheSizeLimit;
+    return fCacheSizeLimit.load(std::memory_order_relaxed);
 }
 
 int SkStrikeCache::setCacheCountLimit(int newCount) {
@@ -185,48 +388,77 @@ int SkStrikeCache::setCacheCountLimit(int newCount) {
         newCount = 0;
     }
 
-    SkAutoMutexExclusive ac(fLock);
-
-    int prevCount = fCacheCountLimit;
-    fCacheCountLimit = newCount;
-    this->internalPurge();
+    int prevCount = fCacheCountLimit.exchange(newCount);
+    this->purge();
     return prevCount;
 }
 
+void SkStrikeCache::noteGrowth() {
+    if (fTotalMemoryUsed.load(std::memory_order_relaxed) > this->getCacheSizeLimit() ||
+        fCacheCount.load(std::memory_order_relaxed) > this->getCacheCountLimit()) {
+        fNeedsPurge.store(true, std::memory_order_relaxed);
+    }
+}
+
+auto SkStrikeCache::shardStats(int i) const -> ShardStats {
+    SkASSERT(0 <= i && i < fShardCount);
+    const Shard& shard = fShards[i];
+    SkAutoMutexExclusive ac(shard.fLock);
+    ShardStats stats;
+    stats.fHits   = shard.fHits;
+    stats.fMisses = shard.fMisses;
+    stats.fPurged = shard.fPurged;
+    stats.fBytes  = shard.fTotalMemoryUsed;
+    stats.fCount  = shard.fCacheCount;
+    for (SkStrike* strike = shard.fHead; strike != nullptr; strike = strike->fNext) {
+        stats.fHits += strike->fLockFreeHits.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
 void SkStrikeCache::forEachStrike(std::function<void(const SkStrike&)> visitor) const {
-    SkAutoMutexExclusive ac(fLock);
+    for (int i = 0; i < fShardCount; i++) {
+        const Shard& shard = fShards[i];
+        SkAutoMutexExclusive ac(shard.fLock);
 
-    this->validate();
+        this->validate(shard);
 
-    for (SkStrike* strike = fHead; strike != nullptr; strike = strike->fNext) {
-        visitor(*strike);
+        for (SkStrike* strike = shard.fHead; strike != nullptr; strike = strike->fNext) {
+            visitor(*strike);
+        }
     }
 }
 
-size_t SkStrikeCache::internalPurge(size_t minBytesNeeded, bool checkPinners) {
+size_t SkStrikeCache::purge(size_t minBytesNeeded, bool checkPinners) {
+    SkAutoMutexExclusive purgeLock(fPurgeLock);
+    // Whatever we can't purge now will be over budget until more memory is used.
+    fNeedsPurge.store(false, std::memory_order_relaxed);
+
 #ifndef SK_STRIKE_CACHE_DOESNT_AUTO_CHECK_PINNERS
     // Temporarily default to checking pinners, for staging.
     checkPinners = true;
 #endif
 
-    if (fPinnerCount == fCacheCount && !checkPinners)
-        return 0;
+    const size_t  sizeLimit  = this->getCacheSizeLimit();
+    const int32_t countLimit = this->getCacheCountLimit();
+    const size_t  totalMemoryUsed = fTotalMemoryUsed.load(std::memory_order_relaxed);
+    const int32_t cacheCount = fCacheCount.load(std::memory_order_relaxed);
 
     size_t bytesNeeded = 0;
-    if (fTotalMemoryUsed > fCacheSizeLimit) {
-        bytesNeeded = fTotalMemoryUsed - fCacheSizeLimit;
+    if (totalMemoryUsed > sizeLimit) {
+        bytesNeeded = totalMemoryUsed - sizeLimit;
     }
     bytesNeeded = std::max(bytesNeeded, minBytesNeeded);
     if (bytesNeeded) {
         // no small purges!
-        bytesNeeded = std::max(bytesNeeded, fTotalMemoryUsed >> 2);
+        bytesNeeded = std::max(bytesNeeded, totalMemoryUsed >> 2);
     }
 
     int countNeeded = 0;
-    if (fCacheCount > fCacheCountLimit) {
-        countNeeded = fCacheCount - fCacheCountLimit;
+    if (cacheCount > countLimit) {
+        countNeeded = cacheCount - countLimit;
         // no small purges!
-        countNeeded = std::max(countNeeded, fCacheCount >> 2);
+        countNeeded = std::max(countNeeded, cacheCount >> 2);
     }
 
     // early exit
@@ -234,99 +466,179 @@ size_t SkStrikeCache::internalPurge(size_t minBytesNeeded, bool checkPinners) {
         return 0;
     }
 
+    // First take from each shard a part of what's needed by its part of the cache, which keeps
+    // roughly to the LRU order of the whole cache. Then take whatever pinned or recently used
+    // strikes held back from any shard that has it.
+    Freed freed;
+    auto enough = [&] { return freed.fBytes >= bytesNeeded && freed.fCount >= countNeeded; };
+    for (int i = 0; i < fShardCount && !enough(); i++) {
+        Shard& shard = fShards[i];
+        SkAutoMutexExclusive ac(shard.fLock);
+        const size_t shardBytes = totalMemoryUsed == 0 ? 0 :
+                (uint64_t)bytesNeeded * shard.fTotalMemoryUsed / totalMemoryUsed;
+        const int shardCount = cacheCount == 0 ? 0 :
+                (int64_t)countNeeded * shard.fCacheCount / cacheCount;
+        this->internalPurge(shard, shardBytes, shardCount, checkPinners, &freed);
+    }
+    for (int i = 0; i < fShardCount && !enough(); i++) {
+        Shard& shard = fShards[i];
+        SkAutoMutexExclusive ac(shard.fLock);
+        this->internalPurge(shard,
+                            bytesNeeded - std::min(freed.fBytes, bytesNeeded),
+                            countNeeded - std::min(freed.fCount, countNeeded),
+                            checkPinners, &freed);
+    }
+
+#ifdef SPEW_PURGE_STATUS
+    if (freed.fCount) {
+        SkDebugf("purging %dK from font cache [%d entries]\n",
+                 (int)(freed.fBytes >> 10), freed.fCount);
+    }
+#endif
+
+    return freed.fBytes;
+}
+
+void SkStrikeCache::internalPurge(Shard& shard, size_t bytesNeeded, int countNeeded,
+                                  bool checkPinners, Freed* freed) {
+    if ((!bytesNeeded && !countNeeded) ||
+        (shard.fPinnerCount == shard.fCacheCount && !checkPinners)) {
+        return;
+    }
+    RetireRecentStrikes(shard);
+
     size_t  bytesFreed = 0;
     int     countFreed = 0;
 
     // Start at the tail and proceed backwards deleting; the list is in LRU
-    // order, with unimportant entries at the tail.
-    SkStrike* strike = fTail;
+    // order, with unimportant entries at the tail. Strikes found without the lock since they
+    // were last moved get a second chance at the head, and may be reached again from there.
+    SkStrike* strike = shard.fTail;
     while (strike != nullptr && (bytesFreed < bytesNeeded || countFreed < countNeeded)) {
         SkStrike* prev = strike->fPrev;
 
-        // Only delete if the strike is not pinned.
-        if (strike->fPinner == nullptr || (checkPinners && strike->fPinner->canDelete())) {
+        if (strike->fRecentlyUsed.load(std::memory_order_relaxed)) {
+            const bool wasHead = strike == shard.fHead;
+            this->internalMoveToHead(shard, strike);
+            if (wasHead) {
+                // Nothing is before it to reach it from again, so look at it again now.
+                continue;
+            }
+        } else if (strike->fPinner == nullptr ||
+                   (checkPinners && strike->fPinner->canDelete())) {
+            // Only delete if the strike is not pinned.
             bytesFreed += strike->fMemoryUsed;
             countFreed += 1;
-            this->internalRemoveStrike(strike);
+            this->internalRemoveStrike(shard, strike);
         }
         strike = prev;
     }
+    shard.fPurged += countFreed;
+    freed->fBytes += bytesFreed;
+    freed->fCount += countFreed;
 
-    this->validate();
-
-#ifdef SPEW_PURGE_STATUS
-    if (countFreed) {
-        SkDebugf("purging %dK from font cache [%d entries]\n",
-                 (int)(bytesFreed >> 10), countFreed);
-    }
-#endif
-
-    return bytesFreed;
+    this->validate(shard);
 }
 
-void SkStrikeCache::internalAttachToHead(sk_sp<SkStrike> strike) {
-    SkASSERT(fStrikeLookup.find(strike->getDescriptor()) == nullptr);
+void SkStrikeCache::internalAttachToHead(Shard& shard, sk_sp<SkStrike> strike) {
+    SkASSERT(shard.fStrikeLookup.find(strike->getDescriptor()) == nullptr);
     SkStrike* strikePtr = strike.get();
-    fStrikeLookup.set(std::move(strike));
+    shard.fStrikeLookup.set(std::move(strike));
     SkASSERT(nullptr == strikePtr->fPrev && nullptr == strikePtr->fNext);
 
-    fCacheCount += 1;
-    fPinnerCount += strikePtr->fPinner != nullptr ? 1 : 0;
-    fTotalMemoryUsed += strikePtr->fMemoryUsed;
+    shard.fCacheCount += 1;
+    shard.fPinnerCount += strikePtr->fPinner != nullptr ? 1 : 0;
+    shard.fTotalMemoryUsed += strikePtr->fMemoryUsed;
+    fCacheCount.fetch_add(1, std::memory_order_relaxed);
+    fTotalMemoryUsed.fetch_add(strikePtr->fMemoryUsed, std::memory_order_relaxed);
+    this->noteGrowth();
 
-    if (fHead != nullptr) {
-        fHead->fPrev = strikePtr;
-        strikePtr->fNext = fHead;
+    if (shard.fHead != nullptr) {
+        shard.fHead->fPrev = strikePtr;
+        strikePtr->fNext = shard.fHead;
     }
 
-    if (fTail == nullptr) {
-        fTail = strikePtr;
+    if (shard.fTail == nullptr) {
+        shard.fTail = strikePtr;
     }
 
-    fHead = strikePtr; // Transfer ownership of strike to the cache list.
+    shard.fHead = strikePtr; // Transfer ownership of strike to the cache list.
 }
 
-void SkStrikeCache::internalRemoveStrike(SkStrike* strike) {
-    SkASSERT(fCacheCount > 0);
-    fCacheCount -= 1;
-    fPinnerCount -= strike->fPinner != nullptr ? 1 : 0;
-    fTotalMemoryUsed -= strike->fMemoryUsed;
+void SkStrikeCache::internalMoveToHead(Shard& shard, SkStrike* strike) {
+    strike->fRecentlyUsed.store(false, std::memory_order_relaxed);
+    if (shard.fHead == strike) {
+        return;
+    }
+    // Make most recently used
+    strike->fPrev->fNext = strike->fNext;
+    if (strike->fNext != nullptr) {
+        strike->fNext->fPrev = strike->fPrev;
+    } else {
+        shard.fTail = strike->fPrev;
+    }
+    shard.fHead->fPrev = strike;
+    strike->fNext = shard.fHead;
+    strike->fPrev = nullptr;
+    shard.fHead = strike;
+}
+
+void SkStrikeCache::internalRemoveStrike(Shard& shard, SkStrike* strike) {
+    SkASSERT(shard.fCacheCount > 0);
+    shard.fCacheCount -= 1;
+    shard.fPinnerCount -= strike->fPinner != nullptr ? 1 : 0;
+    shard.fTotalMemoryUsed -= strike->fMemoryUsed;
+    fCacheCount.fetch_sub(1, std::memory_order_relaxed);
+    fTotalMemoryUsed.fetch_sub(strike->fMemoryUsed, std::memory_order_relaxed);
+    shard.fHits += strike->fLockFreeHits.load(std::memory_order_relaxed);
 
     if (strike->fPrev) {
         strike->fPrev->fNext = strike->fNext;
     } else {
-        fHead = strike->fNext;
+        shard.fHead = strike->fNext;
     }
     if (strike->fNext) {
         strike->fNext->fPrev = strike->fPrev;
     } else {
-        fTail = strike->fPrev;
+        shard.fTail = strike->fPrev;
     }
 
     strike->fPrev = strike->fNext = nullptr;
     strike->fRemoved = true;
-    fStrikeLookup.remove(strike->getDescriptor());
+    shard.fStrikeLookup.remove(strike->getDescriptor());
+}
+
+void SkStrikeCache::strikeMemoryIncreased(SkStrike* strike, size_t increase) {
+    Shard& shard = this->shardFor(strike->getDescriptor());
+    SkAutoMutexExclusive lock{shard.fLock};
+    strike->fMemoryUsed += increase;
+    if (!strike->fRemoved) {
+        shard.fTotalMemoryUsed += increase;
+        fTotalMemoryUsed.fetch_add(increase, std::memory_order_relaxed);
+        this->noteGrowth();
+    }
 }
 
-void SkStrikeCache::validate() const {
+void SkStrikeCache::validate(const Shard& shard) const {
 #ifdef SK_DEBUG
     size_t computedBytes = 0;
     int computedCount = 0;
 
-    const SkStrike* strike = fHead;
+    const SkStrike* strike = shard.fHead;
     while (strike != nullptr) {
         computedBytes += strike->fMemoryUsed;
         computedCount += 1;
-        SkASSERT(fStrikeLookup.findOrNull(strike->getDescriptor()) != nullptr);
+        SkASSERT(shard.fStrikeLookup.findOrNull(strike->getDescriptor()) != nullptr);
         strike = strike->fNext;
     }
 
-    if (fCacheCount != computedCount) {
-        SkDebugf("fCacheCount: %d, computedCount: %d", fCacheCount, computedCount);
+    if (shard.fCacheCount != computedCount) {
+        SkDebugf("fCacheCount: %d, computedCount: %d", shard.fCacheCount, computedCount);
         SK_ABORT("fCacheCount != computedCount");
     }
-    if (fTotalMemoryUsed != computedBytes) {
-        SkDebugf("fTotalMemoryUsed: %zu, computedBytes: %zu", fTotalMemoryUsed, computedBytes);
+    if (shard.fTotalMemoryUsed != computedBytes) {
+        SkDebugf("fTotalMemoryUsed: %zu, computedBytes: %zu",
+                 shard.fTotalMemoryUsed, computedBytes);
         SK_ABORT("fTotalMemoryUsed == computedBytes");
     }
 #endif
@@ -339,5 +651,3 @@ const SkDescriptor& SkStrikeCache::StrikeTraits::GetKey(const sk_sp<SkStrike>& s
 uint32_t SkStrikeCache::StrikeTraits::Hash(const SkDescriptor& descriptor) {
     return descriptor.getChecksum();
 }
-
-
@@ -11,17 +11,22 @@
 #include "include/core/SkRefCnt.h"
 #include "include/private/base/SkLoadUserConfig.h" // IWYU pragma: keep
 #include "include/private/base/SkMutex.h"
+#include "include/private/base/SkSpan_impl.h"
 #include "include/private/base/SkThreadAnnotations.h"
+#include "src/core/SkGlyph.h"
+#include "src/core/SkPersistentGlyphCache.h"
 #include "src/core/SkStrike.h"
 #include "src/core/SkTHash.h"
 #include "src/text/StrikeForGPU.h"
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
 
 class SkDescriptor;
+class SkExecutor;
 class SkStrikeSpec;
 class SkTraceMemoryDump;
 struct SkFontMetrics;
@@ -38,23 +43,38 @@ struct SkFontMetrics;
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// The strikes are spread over shards by a hash of their descriptors. Each shard has its own lock
+// and LRU list, so threads looking up different strikes rarely contend. The byte and count
+// budgets are the cache's: a busy shard can use the headroom of the others, and purging frees
+// strikes from every shard. Each thread also remembers the last few strikes it found, and finds
+// them again without taking any lock.
 class SkStrikeCache final : public sktext::StrikeForGPUCacheInterface {
 public:
-    SkStrikeCache() = default;
+    static constexpr int kDefaultShardCount = 8;
+
+    explicit SkStrikeCache(int shardCount = kDefaultShardCount);
+    ~SkStrikeCache() override;
 
     static SkStrikeCache* GlobalStrikeCache();
 
-    sk_sp<SkStrike> findStrike(const SkDescriptor& desc) SK_EXCLUDES(fLock);
+    sk_sp<SkStrike> findStrike(const SkDescriptor& desc);
 
     sk_sp<SkStrike> createStrike(
             const SkStrikeSpec& strikeSpec,
             SkFontMetrics* maybeMetrics = nullptr,
-            std::unique_ptr<SkStrikePinner> = nullptr) SK_EXCLUDES(fLock);
+            std::unique_ptr<SkStrikePinner> = nullptr);
 
-    sk_sp<SkStrike> findOrCreateStrike(const SkStrikeSpec& strikeSpec) SK_EXCLUDES(fLock);
+    sk_sp<SkStrike> findOrCreateStrike(const SkStrikeSpec& strikeSpec);
 
     sk_sp<sktext::StrikeForGPU> findOrCreateScopedStrike(
-            const SkStrikeSpec& strikeSpec) override SK_EXCLUDES(fLock);
+            const SkStrikeSpec& strikeSpec) override;
+
+    // Find or create the strike, and generate the images of the glyphs at every sub-pixel
+    // position it tells apart, spread over the executor. For example, to warm the glyphs of a
+    // page before drawing it. See SkStrike::prerasterizeImages().
+    sk_sp<SkStrike> prerasterizeImages(const SkStrikeSpec& strikeSpec,
+                                       SkSpan<const SkGlyphID> glyphIDs,
+                                       SkExecutor* executor);
 
     static void PurgeAll();
     static void Dump();
@@ -63,55 +83,138 @@ public:
     // SkTraceMemoryDump interface.
     static void DumpMemoryStatistics(SkTraceMemoryDump* dump);
 
-    void purgeAll() SK_EXCLUDES(fLock); // does not change budget
-    void purgePinned(size_t minBytesNeeded = 0) SK_EXCLUDES(fLock);
+    void purgeAll(); // does not change budget
+    void purgePinned(size_t minBytesNeeded = 0);
 
-    int getCacheCountLimit() const SK_EXCLUDES(fLock);
-    int setCacheCountLimit(int limit) SK_EXCLUDES(fLock);
-    int getCacheCountUsed() const SK_EXCLUDES(fLock);
+    int getCacheCountLimit() const;
+    int setCacheCountLimit(int limit);
+    int getCacheCountUsed() const;
 
-    size_t getCacheSizeLimit() const SK_EXCLUDES(fLock);
-    size_t setCacheSizeLimit(size_t limit) SK_EXCLUDES(fLock);
-    size_t getTotalMemoryUsed() const SK_EXCLUDES(fLock);
+    size_t getCacheSizeLimit() const;
+    size_t setCacheSizeLimit(size_t limit);
+    size_t getTotalMemoryUsed() const;
+
+    struct ShardStats {
+        uint64_t fHits   = 0;   // lookups that found a strike, with or without the lock
+        uint64_t fMisses = 0;   // lookups that didn't
+        uint64_t fPurged = 0;   // strikes removed to stay within budget, or by purgeAll()
+        size_t   fBytes  = 0;
+        int      fCount  = 0;
+    };
+    int shardCount() const { return fShardCount; }
+    ShardStats shardStats(int shard) const;
+
+    // New strikes take their font metrics and any glyphs they can from the persistent cache,
+    // rather than generating them. Pass nullptr to stop.
+    void setPersistentGlyphCache(sk_sp<SkPersistentGlyphCache>);
+    sk_sp<SkPersistentGlyphCache> persistentGlyphCache() const;
 
 private:
-    friend class SkStrike;  // for SkStrike::updateDelta
+    friend class SkPersistentGlyphCache;  // for forEachStrike
+    friend class SkStrike;  // for SkStrike::updateMemoryUsage
     static constexpr char kGlyphCacheDumpName[] = "skia/sk_glyph_cache";
-    sk_sp<SkStrike> internalFindStrikeOrNull(const SkDescriptor& desc) SK_REQUIRES(fLock);
+
+    struct StrikeTraits {
+        static const SkDescriptor& GetKey(const sk_sp<SkStrike>& strike);
+        static uint32_t Hash(const SkDescriptor& descriptor);
+    };
+
+    struct Shard {
+        Shard();
+
+        mutable SkMutex fLock;
+        SkStrike* fHead SK_GUARDED_BY(fLock) {nullptr};
+        SkStrike* fTail SK_GUARDED_BY(fLock) {nullptr};
+        skia_private::THashTable<sk_sp<SkStrike>, SkDescriptor, StrikeTraits> fStrikeLookup
+                SK_GUARDED_BY(fLock);
+
+        size_t  fTotalMemoryUsed SK_GUARDED_BY(fLock) {0};
+        int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
+        int32_t fPinnerCount SK_GUARDED_BY(fLock) {0};
+
+        // Threads' lists of recent strikes hold no refs. An entry is only good while its
+        // generation is the shard's, which changes before any strike is removed from the shard.
+        // Removal then waits for the lookups of recent strikes that started before the change.
+        std::atomic<uint64_t> fGeneration;
+        std::atomic<int32_t>  fRecentLookups{0};
+
+        // Hits without the lock are counted by each strike, and added in here when it's removed.
+        uint64_t fHits SK_GUARDED_BY(fLock) {0};
+        uint64_t fMisses SK_GUARDED_BY(fLock) {0};
+        uint64_t fPurged SK_GUARDED_BY(fLock) {0};
+    };
+
+    Shard& shardFor(const SkDescriptor& desc) const;
+
+    // Looks among the strikes this thread found most recently, without locking.
+    sk_sp<SkStrike> findRecentStrike(const SkDescriptor& desc, Shard& shard);
+    static void RememberRecentStrike(const Shard& shard, SkStrike* strike)
+            SK_REQUIRES(shard.fLock);
+    // Makes the shard's strikes in threads' lists of recent strikes stale, so they can be removed.
+    static void RetireRecentStrikes(Shard& shard) SK_REQUIRES(shard.fLock);
+
+    sk_sp<SkStrike> internalFindStrikeOrNull(Shard& shard, const SkDescriptor& desc)
+            SK_REQUIRES(shard.fLock);
+    // The persistent glyph cache and its glyphs for a strike, if it has any.
+    struct Persisted {
+        sk_sp<SkPersistentGlyphCache>  fCache;
+        SkPersistentGlyphCache::Strike fStrike{};
+    };
+    Persisted findPersisted(const SkStrikeSpec& strikeSpec) const;
     sk_sp<SkStrike> internalCreateStrike(
+            Shard& shard,
             const SkStrikeSpec& strikeSpec,
+            const Persisted& persisted,
             SkFontMetrics* maybeMetrics = nullptr,
-            std::unique_ptr<SkStrikePinner> = nullptr) SK_REQUIRES(fLock);
+            std::unique_ptr<SkStrikePinner> = nullptr) SK_REQUIRES(shard.fLock);
 
-    // The following methods can only be called when mutex is already held.
-    void internalRemoveStrike(SkStrike* strike) SK_REQUIRES(fLock);
-    void internalAttachToHead(sk_sp<SkStrike> strike) SK_REQUIRES(fLock);
+    // The following methods can only be called when the shard's mutex is already held.
+    void internalRemoveStrike(Shard& shard, SkStrike* strike) SK_REQUIRES(shard.fLock);
+    void internalAttachToHead(Shard& shard, sk_sp<SkStrike> strike) SK_REQUIRES(shard.fLock);
+    void internalMoveToHead(Shard& shard, SkStrike* strike) SK_REQUIRES(shard.fLock);
 
-    // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
-    // and attempt to purge caches to match.
+    // Checkout the cache's budgets, modulated by the specified min-bytes-needed-to-purge,
+    // and attempt to purge strikes from all the shards to match.
     // Returns number of bytes freed.
-    size_t internalPurge(size_t minBytesNeeded = 0, bool checkPinners = false) SK_REQUIRES(fLock);
+    size_t purge(size_t minBytesNeeded = 0, bool checkPinners = false) SK_EXCLUDES(fPurgeLock);
 
-    // A simple accounting of what each glyph cache reports and the strike cache total.
-    void validate() const SK_REQUIRES(fLock);
+    struct Freed {
+        size_t fBytes = 0;
+        int    fCount = 0;
+    };
+    // Purges strikes from the tail of the shard's LRU list, until it has freed the bytes and the
+    // count needed, or reached the head. Adds what it freed to 'freed'.
+    void internalPurge(Shard& shard, size_t bytesNeeded, int countNeeded, bool checkPinners,
+                       Freed* freed) SK_REQUIRES(shard.fLock);
 
-    void forEachStrike(std::function<void(const SkStrike&)> visitor) const SK_EXCLUDES(fLock);
+    // Called by SkStrike as it grows.
+    void strikeMemoryIncreased(SkStrike* strike, size_t increase);
 
-    mutable SkMutex fLock;
-    SkStrike* fHead SK_GUARDED_BY(fLock) {nullptr};
-    SkStrike* fTail SK_GUARDED_BY(fLock) {nullptr};
-    struct StrikeTraits {
-        static const SkDescriptor& GetKey(const sk_sp<SkStrike>& strike);
-        static uint32_t Hash(const SkDescriptor& descriptor);
-    };
-    skia_private::THashTable<sk_sp<SkStrike>, SkDescriptor, StrikeTraits> fStrikeLookup
-            SK_GUARDED_BY(fLock);
-
-    size_t  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
-    size_t  fTotalMemoryUsed SK_GUARDED_BY(fLock) {0};
-    int32_t fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
-    int32_t fCacheCount SK_GUARDED_BY(fLock) {0};
-    int32_t fPinnerCount SK_GUARDED_BY(fLock) {0};
+    // A simple accounting of what each glyph cache reports and the shard total.
+    void validate(const Shard& shard) const SK_REQUIRES(shard.fLock);
+
+    void forEachStrike(std::function<void(const SkStrike&)> visitor) const;
+
+    // Called with a shard's lock held, as it grows the cache's totals.
+    void noteGrowth();
+
+    const int                fShardCount;
+    std::unique_ptr<Shard[]> fShards;
+
+    // The totals of the shards, which are changed under their locks.
+    std::atomic<size_t>  fTotalMemoryUsed{0};
+    std::atomic<int32_t> fCacheCount{0};
+
+    // Set when the cache may be over budget, so lookups purge it and skip the lock-free path.
+    std::atomic<bool> fNeedsPurge{false};
+    // Only one thread purges at a time. It's taken before any shard's lock.
+    SkMutex           fPurgeLock;
+
+    mutable SkMutex                fPersistentGlyphCacheLock;
+    sk_sp<SkPersistentGlyphCache>  fPersistentGlyphCache SK_GUARDED_BY(fPersistentGlyphCacheLock);
+
+    std::atomic<size_t>  fCacheSizeLimit{SK_DEFAULT_FONT_CACHE_LIMIT};
+    std::atomic<int32_t> fCacheCountLimit{SK_DEFAULT_FONT_CACHE_COUNT_LIMIT};
 };
 
 #endif  // SkStrikeCache_DEFINED
@@ -64,6 +64,8 @@ private:
         return true;
     }
 
+    bool onDefersOutput() const override { return true; }
+
     sk_sp<SkColorFilter> fColorFilter;
 };
 
@@ -50,6 +50,8 @@ private:
 
     bool onAffectsTransparentBlack() const override { return fTileMode != SkTileMode::kDecal; }
 
+    bool onDefersOutput() const override { return true; }
+
     // Disable recursing in affectsTransparentBlack() if we hit a Crop.
     // TODO(skbug.com/14611): Automatically infer this from the output bounds being finite.
     bool ignoreInputsAffectsTransparentBlack() const override { return true; }
@@ -53,6 +53,8 @@ private:
 
     MatrixCapability onGetCTMCapability() const override { return MatrixCapability::kComplex; }
 
+    bool onDefersOutput() const override { return true; }
+
     skif::FilterResult onFilterImage(const skif::Context&) const override;
 
     skif::LayerSpace<SkIRect> onGetInputLayerBounds(
@@ -10,11 +10,13 @@
 #include "include/core/SkAlphaType.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkColorType.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFlattenable.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkM44.h"
+#include "include/core/SkPixmap.h"
 #include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
@@ -29,18 +31,25 @@
 #include "include/private/base/SkMath.h"
 #include "include/private/base/SkSpan_impl.h"
 #include "include/private/base/SkTArray.h"
+#include "include/private/base/SkTPin.h"
 #include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
 #include "src/base/SkSafeMath.h"
+#include "src/base/SkVx.h"
 #include "src/core/SkImageFilterTypes.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkKnownRuntimeEffects.h"
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkReadBuffer.h"
 #include "src/core/SkRectPriv.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkWriteBuffer.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <optional>
 #include <utility>
 
@@ -58,6 +67,9 @@ static_assert(kMaxUniformKernelSize % 4 == 0, "Must be a multiple of 4");
 SkBitmap create_kernel_bitmap(const SkISize& kernelSize, const float* kernel,
                               float* innerGain, float* innerBias);
 
+bool separate_kernel(const SkISize& kernelSize, const float* kernel,
+                     TArray<float>* row, TArray<float>* column);
+
 class SkMatrixConvolutionImageFilter final : public SkImageFilter_Base {
 public:
     SkMatrixConvolutionImageFilter(const SkISize& kernelSize, const SkScalar* kernel,
@@ -78,6 +90,7 @@ public:
 
         // Does nothing for small kernels, otherwise encodes kernel into an A8 image.
         fKernelBitmap = create_kernel_bitmap(kernelSize, kernel, &fInnerGain, &fInnerBias);
+        separate_kernel(kernelSize, kernel, &fKernelRow, &fKernelColumn);
     }
 
     SkRect computeFastBounds(const SkRect& bounds) const override;
@@ -123,6 +136,9 @@ private:
 
     sk_sp<SkShader> createShader(const skif::Context& ctx, sk_sp<SkShader> input) const;
 
+    // The same convolution on the CPU, for FilterResult::Builder::evalPixels().
+    void convolvePixels(const SkPixmap& src, const SkIPoint& srcOrigin, const SkPixmap& dst) const;
+
     // Original kernel data, preserved for serialization even if it was encoded into fKernelBitmap
     TArray<float> fKernel;
 
@@ -141,6 +157,11 @@ private:
     SkBitmap fKernelBitmap;
     float fInnerBias;
     float fInnerGain;
+
+    // Derived from fKernel when it's the outer product of a column and a row, so that the CPU can
+    // convolve with width + height taps per pixel instead of width * height. Empty otherwise.
+    TArray<float> fKernelRow;
+    TArray<float> fKernelColumn;
 };
 
 // LayerSpace doesn't have a clean type to represent 4 separate edge deltas, but the result
@@ -223,6 +244,47 @@ SkBitmap create_kernel_bitmap(const SkISize& kernelSize, const float* kernel,
     return kernelBM;
 }
 
+bool separate_kernel(const SkISize& kernelSize, const float* kernel,
+                     TArray<float>* row, TArray<float>* column) {
+    const int width = kernelSize.width(),
+              height = kernelSize.height();
+    if (width == 1 || height == 1) {
+        return false; // Already a single pass
+    }
+
+    // If the kernel is separable, the row and column through its largest coefficient are the row
+    // and (scaled) column whose product reproduces it.
+    int pivot = 0;
+    for (int i = 1; i < width * height; ++i) {
+        if (std::abs(kernel[i]) > std::abs(kernel[pivot])) {
+            pivot = i;
+        }
+    }
+    const float maxCoefficient = std::abs(kernel[pivot]);
+    if (maxCoefficient == 0.f) {
+        return false;
+    }
+    const int pivotX = pivot % width,
+              pivotY = pivot / width;
+    row->reset(kernel + pivotY * width, width);
+    column->reset(height);
+    for (int y = 0; y < height; ++y) {
+        (*column)[y] = kernel[y * width + pivotX] / kernel[pivot];
+    }
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (std::abs(kernel[y * width + x] - (*column)[y] * (*row)[x]) >
+                1e-6f * maxCoefficient) {
+                row->clear();
+                column->clear();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 } // anonymous namespace
 
 sk_sp<SkImageFilter> SkImageFilters::MatrixConvolution(const SkISize& kernelSize,
@@ -388,6 +450,124 @@ sk_sp<SkShader> SkMatrixConvolutionImageFilter::createShader(const skif::Context
     return builder.makeShader();
 }
 
+void SkMatrixConvolutionImageFilter::convolvePixels(const SkPixmap& src,
+                                                    const SkIPoint& srcOrigin,
+                                                    const SkPixmap& dst) const {
+    // Enough rows per task to amortize the setup.
+    static constexpr int kRowsPerTask = 16;
+
+    const int kernelWidth = fKernelSize.width(),
+              kernelHeight = fKernelSize.height(),
+              width = dst.width(),
+              height = dst.height();
+    // The input pixels that the kernel reads, in float, unpremultiplied if the alpha channel isn't
+    // convolved. The pixel at (x + kx, y + ky) is multiplied by the kernel coefficient at (kx, ky)
+    // for the output pixel at (x, y).
+    const int inputWidth = width + kernelWidth - 1,
+              inputHeight = height + kernelHeight - 1;
+    const SkIPoint inputOrigin = {srcOrigin.x() + fKernelOffset.x(),
+                                  srcOrigin.y() + fKernelOffset.y()};
+    const SkImageInfo floatInfo = SkImageInfo::Make(inputWidth, 1, kRGBA_F32_SkColorType,
+                                                    fConvolveAlpha ? kPremul_SkAlphaType
+                                                                   : kUnpremul_SkAlphaType,
+                                                    dst.refColorSpace());
+    std::unique_ptr<skvx::float4[]> input{
+            new skvx::float4[SkToSizeT(inputWidth) * inputHeight]};
+    auto inputRow = [&](int y) { return input.get() + SkToSizeT(y) * inputWidth; };
+
+    // The range of each input row that comes from 'src'.
+    const int srcStart = SkTPin(inputOrigin.x(), 0, inputWidth),
+              srcEnd = SkTPin(inputOrigin.x() + src.width(), 0, inputWidth);
+    SkTaskGroup tasks{SkExecutor::GetDefault()};
+    tasks.batch((inputHeight + kRowsPerTask - 1) / kRowsPerTask, [&](int task) {
+        const int rowEnd = std::min(inputHeight, (task + 1) * kRowsPerTask);
+        for (int y = task * kRowsPerTask; y < rowEnd; ++y) {
+            skvx::float4* row = inputRow(y);
+            const int srcY = y - inputOrigin.y();
+            if (srcStart >= srcEnd || srcY < 0 || srcY >= src.height()) {
+                std::fill_n(row, inputWidth, skvx::float4(0.f));
+                continue;
+            }
+            std::fill_n(row, srcStart, skvx::float4(0.f));
+            std::fill_n(row + srcEnd, inputWidth - srcEnd, skvx::float4(0.f));
+            SkAssertResult(src.readPixels(floatInfo.makeWH(srcEnd - srcStart, 1),
+                                          row + srcStart,
+                                          floatInfo.minRowBytes(),
+                                          srcStart - inputOrigin.x(),
+                                          srcY));
+        }
+    });
+    tasks.wait();
+
+    // Accumulates 'coefficient' * 'from' into 'to', row by row.
+    auto accumulate = [width](float coefficient, const skvx::float4* from, skvx::float4* to) {
+        if (coefficient != 0.f) {
+            for (int x = 0; x < width; ++x) {
+                to[x] += coefficient * from[x];
+            }
+        }
+    };
+
+    // A separable kernel first convolves every input row with the kernel's row, so that the output
+    // rows only have to sum the kernel's column of those.
+    std::unique_ptr<skvx::float4[]> rowPass;
+    if (!fKernelRow.empty()) {
+        rowPass.reset(new skvx::float4[SkToSizeT(width) * inputHeight]);
+        tasks.batch((inputHeight + kRowsPerTask - 1) / kRowsPerTask, [&](int task) {
+            const int rowEnd = std::min(inputHeight, (task + 1) * kRowsPerTask);
+            for (int y = task * kRowsPerTask; y < rowEnd; ++y) {
+                skvx::float4* row = rowPass.get() + SkToSizeT(y) * width;
+                std::fill_n(row, width, skvx::float4(0.f));
+                for (int kx = 0; kx < kernelWidth; ++kx) {
+                    accumulate(fKernelRow[kx], inputRow(y) + kx, row);
+                }
+            }
+        });
+        tasks.wait();
+    }
+
+    const float bias = fBias / 255.f;
+    tasks.batch((height + kRowsPerTask - 1) / kRowsPerTask, [&](int task) {
+        std::unique_ptr<skvx::float4[]> sum{new skvx::float4[width]};
+        const SkPixmap sumPixmap{floatInfo.makeWH(width, 1).makeAlphaType(kPremul_SkAlphaType),
+                                 sum.get(),
+                                 width * sizeof(skvx::float4)};
+        const int rowEnd = std::min(height, (task + 1) * kRowsPerTask);
+        for (int y = task * kRowsPerTask; y < rowEnd; ++y) {
+            std::fill_n(sum.get(), width, skvx::float4(0.f));
+            for (int ky = 0; ky < kernelHeight; ++ky) {
+                if (rowPass) {
+                    accumulate(fKernelColumn[ky], rowPass.get() + SkToSizeT(y + ky) * width,
+                               sum.get());
+                } else {
+                    for (int kx = 0; kx < kernelWidth; ++kx) {
+                        accumulate(fKernel[ky * kernelWidth + kx], inputRow(y + ky) + kx,
+                                   sum.get());
+                    }
+                }
+            }
+
+            // Apply the gain and bias, and produce premultiplied colors as createShader() does.
+            const skvx::float4* center = inputRow(y + fKernelOffset.y()) + fKernelOffset.x();
+            for (int x = 0; x < width; ++x) {
+                skvx::float4 color = sum[x] * fGain + bias;
+                if (fConvolveAlpha) {
+                    color[3] = SkTPin(color[3], 0.f, 1.f);
+                } else {
+                    const float alpha = center[x][3];
+                    color = skvx::float4(color[0] * alpha, color[1] * alpha, color[2] * alpha,
+                                         alpha);
+                }
+                sum[x] = skvx::pin(color, skvx::float4(0.f), skvx::float4(color[3]));
+            }
+            SkAssertResult(sumPixmap.readPixels(dst.info().makeWH(width, 1),
+                                                dst.writable_addr(0, y),
+                                                dst.rowBytes()));
+        }
+    });
+    tasks.wait();
+}
+
 skif::FilterResult SkMatrixConvolutionImageFilter::onFilterImage(
         const skif::Context& context) const {
     using ShaderFlags = skif::FilterResult::ShaderFlags;
@@ -410,6 +590,18 @@ skif::FilterResult SkMatrixConvolutionImageFilter::onFilterImage(
     }
 
     skif::FilterResult::Builder builder{context};
+    if (context.backend()->supportsPixelKernels()) {
+        builder.add(childOutput);
+        const SkIRect kernelBounds = SkIRect::MakeLTRB(
+                -fKernelOffset.x(), -fKernelOffset.y(),
+                fKernelSize.width() - fKernelOffset.x(), fKernelSize.height() - fKernelOffset.y());
+        return builder.evalPixels(kernelBounds, [this](const SkPixmap& src,
+                                                       const SkIPoint& srcOrigin,
+                                                       const SkPixmap& dst) {
+            this->convolvePixels(src, srcOrigin, dst);
+        }, outputBounds);
+    }
+
     builder.add(childOutput,
                 this->boundsSampledByKernel(outputBounds),
                 ShaderFlags::kSampledRepeatedly);
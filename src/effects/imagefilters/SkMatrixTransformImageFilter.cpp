@@ -54,6 +54,8 @@ private:
 
     MatrixCapability onGetCTMCapability() const override { return MatrixCapability::kComplex; }
 
+    bool onDefersOutput() const override { return true; }
+
     skif::FilterResult onFilterImage(const skif::Context& context) const override;
 
     skif::LayerSpace<SkIRect> onGetInputLayerBounds(
@@ -7,9 +7,13 @@
 
 #include "include/effects/SkImageFilters.h"
 
+#include "include/core/SkColor.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFlattenable.h"
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkM44.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkScalar.h"
@@ -17,18 +21,26 @@
 #include "include/core/SkSize.h"
 #include "include/core/SkTypes.h"
 #include "include/effects/SkRuntimeEffect.h"
+#include "include/private/base/SkMalloc.h"
 #include "include/private/base/SkSpan_impl.h"
+#include "include/private/base/SkTPin.h"
+#include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
 #include "src/core/SkImageFilterTypes.h"
 #include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkKnownRuntimeEffects.h"
 #include "src/core/SkReadBuffer.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/core/SkWriteBuffer.h"
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <optional>
 #include <utility>
 
+using namespace skia_private;
+
 namespace {
 
 enum class MorphType {
@@ -168,10 +180,165 @@ sk_sp<SkShader> make_sparse_morphology(sk_sp<SkShader> input,
     return builder.makeShader();
 }
 
+// Applies the morphology to each byte of 'a' and 'b', and writes the results to 'dst'.
+template <MorphType kType>
+void morph_bytes(const uint8_t* a, const uint8_t* b, uint8_t* dst, int count) {
+    for (int i = 0; i < count; ++i) {
+        dst[i] = kType == MorphType::kDilate ? std::max(a[i], b[i]) : std::min(a[i], b[i]);
+    }
+}
+
+// The van Herk/Gil-Werman algorithm, which finds the minimum or maximum of every window of
+// 2*radius+1 elements in three comparisons per element for any radius. The elements are split into
+// blocks as long as the window, so that each window covers the end of one block and the start of
+// the next, and its aggregate combines a running aggregate backward from the end of the first
+// block with one forward from the start of the second.
+//
+// 'element(j)' returns the bytes of element j of the length + 2*radius elements, and the aggregate
+// of elements i to i+2*radius is written to 'output(i)' for each i < length. 'backward' has room
+// for 'length' elements and 'forward' for one.
+template <MorphType kType, typename ElementFn, typename OutputFn>
+void van_herk(int length, int radius, int elementBytes, uint8_t* backward, uint8_t* forward,
+              ElementFn&& element, OutputFn&& output) {
+    const int window = 2 * radius + 1,
+              extended = length + 2 * radius;
+    const uint8_t* previous = nullptr;
+    for (int j = extended - 1; j >= 0; --j) {
+        // Only the backward aggregates of the first 'length' elements are read again.
+        uint8_t* aggregate = j < length ? backward + SkToSizeT(j) * elementBytes : forward;
+        if (j % window == window - 1 || j == extended - 1) {
+            memcpy(aggregate, element(j), elementBytes);
+        } else {
+            morph_bytes<kType>(previous, element(j), aggregate, elementBytes);
+        }
+        previous = aggregate;
+    }
+    for (int j = 0; j < extended; ++j) {
+        if (j % window == 0) {
+            memcpy(forward, element(j), elementBytes);
+        } else {
+            morph_bytes<kType>(forward, element(j), forward, elementBytes);
+        }
+        if (j >= window - 1) {
+            const int i = j - (window - 1);
+            morph_bytes<kType>(backward + SkToSizeT(i) * elementBytes, forward, output(i),
+                               elementBytes);
+        }
+    }
+}
+
+// Morphology of N32 pixels along one axis on the CPU, for FilterResult::Builder::evalPixels(). The
+// X pass runs van Herk on each row with pixels as elements. The Y pass runs it on blocks of rows
+// with whole rows as elements, so each comparison covers a row. Rows and blocks run as tasks on
+// the default SkExecutor.
+template <MorphType kType>
+void morphology_pixels(MorphDirection dir, int radius,
+                       const SkPixmap& src, const SkIPoint& srcOrigin, const SkPixmap& dst) {
+    static constexpr int kBpp = 4;
+    // The range of 'dst' that overlaps 'src' along each axis; the rest only reads transparent
+    // black in the direction of the pass, which stays transparent black.
+    const SkIRect overlap = SkIRect::MakeXYWH(srcOrigin.x(), srcOrigin.y(),
+                                              src.width(), src.height());
+    SkIRect dstOverlap = SkIRect::MakeSize(dst.dimensions());
+    if (dir == MorphDirection::kX) {
+        dstOverlap.fTop = std::max(dstOverlap.fTop, overlap.fTop);
+        dstOverlap.fBottom = std::min(dstOverlap.fBottom, overlap.fBottom);
+    } else {
+        dstOverlap.fLeft = std::max(dstOverlap.fLeft, overlap.fLeft);
+        dstOverlap.fRight = std::min(dstOverlap.fRight, overlap.fRight);
+    }
+    if (dstOverlap.isEmpty()) {
+        dst.erase(SK_ColorTRANSPARENT);
+        return;
+    }
+    dst.erase(SK_ColorTRANSPARENT, SkIRect::MakeLTRB(0, 0, dst.width(), dstOverlap.fTop));
+    dst.erase(SK_ColorTRANSPARENT,
+              SkIRect::MakeLTRB(0, dstOverlap.fBottom, dst.width(), dst.height()));
+    dst.erase(SK_ColorTRANSPARENT, SkIRect::MakeLTRB(0, dstOverlap.fTop,
+                                                     dstOverlap.fLeft, dstOverlap.fBottom));
+    dst.erase(SK_ColorTRANSPARENT, SkIRect::MakeLTRB(dstOverlap.fRight, dstOverlap.fTop,
+                                                     dst.width(), dstOverlap.fBottom));
+
+    SkTaskGroup tasks{SkExecutor::GetDefault()};
+    if (dir == MorphDirection::kX) {
+        static constexpr int kRowsPerTask = 32;
+        const int width = dst.width(),
+                  extendedWidth = width + 2 * radius,
+                  // The range of the extended row that comes from 'src'.
+                  srcStart = SkTPin(srcOrigin.x() + radius, 0, extendedWidth),
+                  srcEnd = SkTPin(srcOrigin.x() + radius + src.width(), 0, extendedWidth);
+        tasks.batch((dstOverlap.height() + kRowsPerTask - 1) / kRowsPerTask, [&](int task) {
+            AutoTMalloc<uint8_t> extended(SkToSizeT(extendedWidth) * kBpp),
+                                 backward(SkToSizeT(width) * kBpp),
+                                 forward(kBpp);
+            sk_bzero(extended.get(), srcStart * kBpp);
+            sk_bzero(extended.get() + srcEnd * kBpp, (extendedWidth - srcEnd) * kBpp);
+            const int rowEnd = std::min(dstOverlap.fBottom,
+                                        dstOverlap.fTop + (task + 1) * kRowsPerTask);
+            for (int y = dstOverlap.fTop + task * kRowsPerTask; y < rowEnd; ++y) {
+                if (srcStart < srcEnd) {
+                    memcpy(extended.get() + srcStart * kBpp,
+                           src.addr32(srcStart - radius - srcOrigin.x(), y - srcOrigin.y()),
+                           (srcEnd - srcStart) * kBpp);
+                }
+                uint8_t* dstRow = static_cast<uint8_t*>(dst.writable_addr(0, y));
+                van_herk<kType>(width, radius, kBpp, backward.get(), forward.get(),
+                                [&](int j) { return extended.get() + j * kBpp; },
+                                [&](int i) { return dstRow + i * kBpp; });
+            }
+        });
+    } else {
+        // Large enough blocks that the 2*radius extra rows each one reads stay a small part.
+        const int blockHeight = std::max(64, 4 * radius),
+                  rowBytes = dstOverlap.width() * kBpp;
+        AutoTMalloc<uint8_t> zeros(rowBytes);
+        sk_bzero(zeros.get(), rowBytes);
+        tasks.batch((dst.height() + blockHeight - 1) / blockHeight, [&](int task) {
+            const int top = task * blockHeight,
+                      height = std::min(dst.height() - top, blockHeight);
+            AutoTMalloc<uint8_t> backward(SkToSizeT(height) * rowBytes),
+                                 forward(rowBytes);
+            van_herk<kType>(height, radius, rowBytes, backward.get(), forward.get(),
+                            [&](int j) {
+                                const int srcY = top + j - radius - srcOrigin.y();
+                                return 0 <= srcY && srcY < src.height()
+                                        ? static_cast<const uint8_t*>(src.addr(
+                                                  dstOverlap.fLeft - srcOrigin.x(), srcY))
+                                        : zeros.get();
+                            },
+                            [&](int i) {
+                                return static_cast<uint8_t*>(
+                                        dst.writable_addr(dstOverlap.fLeft, top + i));
+                            });
+        });
+    }
+    tasks.wait();
+}
+
 skif::FilterResult morphology_pass(const skif::Context& ctx, const skif::FilterResult& input,
                                    MorphType type, MorphDirection dir, int radius) {
     using ShaderFlags = skif::FilterResult::ShaderFlags;
 
+    if (radius > 0 && ctx.backend()->supportsPixelKernels()) {
+        if (!input) {
+            return {}; // Eroded or dilated transparent black is still transparent black
+        }
+        const SkIRect kernelBounds = dir == MorphDirection::kX
+                                             ? SkIRect::MakeLTRB(-radius, 0, radius + 1, 1)
+                                             : SkIRect::MakeLTRB(0, -radius, 1, radius + 1);
+        skif::FilterResult::Builder builder{ctx};
+        builder.add(input);
+        return builder.evalPixels(kernelBounds, [&](const SkPixmap& src,
+                                                    const SkIPoint& srcOrigin,
+                                                    const SkPixmap& dst) {
+            if (type == MorphType::kDilate) {
+                morphology_pixels<MorphType::kDilate>(dir, radius, src, srcOrigin, dst);
+            } else {
+                morphology_pixels<MorphType::kErode>(dir, radius, src, srcOrigin, dst);
+            }
+        });
+    }
+
     auto axisDelta = [dir](int step) {
         return skif::LayerSpace<SkISize>({
                 dir == MorphDirection::kX ? step : 0,
@@ -27,3 +27,22 @@ bool SkEncoder::encodeRows(int numRows) {
 
     return true;
 }
+
+bool SkEncoder::encodeRows(const SkPixmap& rows) {
+    if (!this->onReadsSrcRows()) {
+        return false;
+    }
+    SkASSERT(rows.width() == fSrc.width() && rows.colorType() == fSrc.colorType() &&
+             rows.alphaType() == fSrc.alphaType());
+    if (!rows.addr() || rows.width() != fSrc.width() || rows.colorType() != fSrc.colorType() ||
+        rows.alphaType() != fSrc.alphaType() || rows.height() <= 0 ||
+        rows.height() > fSrc.height() - fCurrRow) {
+        return false;
+    }
+
+    fRows = rows;
+    fRowsTop = fCurrRow;
+    const bool result = this->encodeRows(rows.height());
+    fRows.reset();
+    return result;
+}
@@ -77,6 +77,7 @@ public:
 
 protected:
     bool onEncodeRows(int numRows) override;
+    bool onReadsSrcRows() const override { return !fSrcYUVA; }
 
 private:
     SkJpegEncoderImpl(std::unique_ptr<SkJpegEncoderMgr>, const SkPixmap& src);
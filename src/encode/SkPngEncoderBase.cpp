@@ -249,7 +249,7 @@ bool SkPngEncoderBase::onEncodeRows(int numRows) {
             return false;
         }
 
-        const void* srcRow = fSrc.addr(0, fCurrRow);
+        const void* srcRow = this->srcRowAddr(fCurrRow);
         sk_msan_assert_initialized(srcRow,
                                    (const uint8_t*)srcRow + (fSrc.width() << fSrc.shiftPerPixel()));
 
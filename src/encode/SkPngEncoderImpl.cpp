@@ -27,11 +27,13 @@
 #include "include/private/base/SkAssert.h"
 #include "include/private/base/SkDebug.h"
 #include "include/private/base/SkNoncopyable.h"
+#include "include/private/base/SkTo.h"
 #include "modules/skcms/skcms.h"
 #include "src/codec/SkPngPriv.h"
 #include "src/encode/SkImageEncoderFns.h"
 #include "src/encode/SkImageEncoderPriv.h"
 #include "src/encode/SkPngEncoderBase.h"
+#include "src/encode/SkPngParallelDeflate.h"
 #include "src/image/SkImage_Base.h"
 
 #include <algorithm>
@@ -87,6 +89,7 @@ public:
     bool setColorSpace(const SkImageInfo& info, const SkPngEncoder::Options& options);
     bool setV0Gainmap(const SkPngEncoder::Options& options);
     bool writeInfo(const SkImageInfo& srcInfo);
+    bool writeChunk(const char name[5], SkSpan<const uint8_t> data);
 
     png_structp pngPtr() { return fPngPtr; }
     png_infop infoPtr() { return fInfoPtr; }
@@ -369,14 +372,35 @@ bool SkPngEncoderMgr::writeInfo(const SkImageInfo& srcInfo) {
     return true;
 }
 
+bool SkPngEncoderMgr::writeChunk(const char name[5], SkSpan<const uint8_t> data) {
+    if (setjmp(png_jmpbuf(fPngPtr))) {
+        return false;
+    }
+
+    png_write_chunk(fPngPtr, reinterpret_cast<png_const_bytep>(name), data.data(), data.size());
+    return true;
+}
+
 SkPngEncoderImpl::SkPngEncoderImpl(TargetInfo targetInfo,
                                    std::unique_ptr<SkPngEncoderMgr> encoderMgr,
                                    const SkPixmap& src)
         : SkPngEncoderBase(std::move(targetInfo), src), fEncoderMgr(std::move(encoderMgr)) {}
 
+SkPngEncoderImpl::SkPngEncoderImpl(TargetInfo targetInfo,
+                                   std::unique_ptr<SkPngEncoderMgr> encoderMgr,
+                                   std::unique_ptr<SkPngParallelDeflate> parallelDeflate,
+                                   const SkPixmap& src)
+        : SkPngEncoderBase(std::move(targetInfo), src)
+        , fEncoderMgr(std::move(encoderMgr))
+        , fParallelDeflate(std::move(parallelDeflate)) {}
+
 SkPngEncoderImpl::~SkPngEncoderImpl() {}
 
 bool SkPngEncoderImpl::onEncodeRow(SkSpan<const uint8_t> row) {
+    if (fParallelDeflate) {
+        return fParallelDeflate->addRow(row);
+    }
+
     if (setjmp(png_jmpbuf(fEncoderMgr->pngPtr()))) {
         return false;
     }
@@ -389,6 +413,12 @@ bool SkPngEncoderImpl::onEncodeRow(SkSpan<const uint8_t> row) {
 }
 
 bool SkPngEncoderImpl::onFinishEncoding() {
+    if (fParallelDeflate) {
+        // libpng didn't write the IDAT chunks, so it won't end the PNG. Every other chunk was
+        // written before them.
+        return fParallelDeflate->finish() && fEncoderMgr->writeChunk("IEND", {});
+    }
+
     if (setjmp(png_jmpbuf(fEncoderMgr->pngPtr()))) {
         return false;
     }
@@ -430,6 +460,21 @@ std::unique_ptr<SkEncoder> Make(SkWStream* dst, const SkPixmap& src, const Optio
         return nullptr;
     }
 
+    if (options.fExecutor) {
+        SkPngEncoderMgr* mgr = encoderMgr.get();
+        auto parallelDeflate = std::make_unique<SkPngParallelDeflate>(
+                *options.fExecutor,
+                targetInfo->fDstRowSize,
+                SkToSizeT(targetInfo->fDstInfo.bitsPerPixel() / 8),
+                (int)options.fFilterFlags,
+                std::min(std::max(0, options.fZLibLevel), 9),
+                [mgr](SkSpan<const uint8_t> data) { return mgr->writeChunk("IDAT", data); });
+        return std::make_unique<SkPngEncoderImpl>(std::move(*targetInfo),
+                                                  std::move(encoderMgr),
+                                                  std::move(parallelDeflate),
+                                                  src);
+    }
+
     return std::make_unique<SkPngEncoderImpl>(std::move(*targetInfo), std::move(encoderMgr), src);
 }
 
@@ -16,6 +16,7 @@
 
 class SkPixmap;
 class SkPngEncoderMgr;
+class SkPngParallelDeflate;
 template <typename T> class SkSpan;
 
 class SkPngEncoderImpl final : public SkPngEncoderBase {
@@ -23,6 +24,11 @@ public:
     // public so it can be called from SkPngEncoder namespace. It should only be made
     // via SkPngEncoder::Make
     SkPngEncoderImpl(TargetInfo targetInfo, std::unique_ptr<SkPngEncoderMgr>, const SkPixmap& src);
+    // Encodes rows by filtering and compressing blocks of them concurrently.
+    SkPngEncoderImpl(TargetInfo targetInfo,
+                     std::unique_ptr<SkPngEncoderMgr>,
+                     std::unique_ptr<SkPngParallelDeflate>,
+                     const SkPixmap& src);
     ~SkPngEncoderImpl() override;
 
 protected:
@@ -30,5 +36,6 @@ protected:
     bool onFinishEncoding() override;
 
     std::unique_ptr<SkPngEncoderMgr> fEncoderMgr;
+    std::unique_ptr<SkPngParallelDeflate> fParallelDeflate;
 };
 #endif
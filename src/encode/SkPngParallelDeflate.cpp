@@ -0,0 +1,350 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/encode/SkPngParallelDeflate.h"
+
+#include "include/core/SkExecutor.h"
+#include "include/encode/SkPngEncoder.h"
+#include "include/private/base/SkAssert.h"
+#include "include/private/base/SkSemaphore.h"
+#include "include/private/base/SkTo.h"
+#include "src/base/SkUtils.h"
+#include "src/base/SkVx.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "zlib.h"  // NO_G3_REWRITE
+
+namespace {
+
+using U8x16  = skvx::Vec<16, uint8_t>;
+using U16x8  = skvx::Vec<8, uint16_t>;
+
+// Blocks are about this many bytes of filtered rows. Smaller blocks spread the work over more
+// threads; larger ones lose less to the flush at the end of each.
+constexpr size_t kBlockBytes = 128 * 1024;
+constexpr size_t kWindowBytes = 32 * 1024;
+// Bounds the rows and compressed data held while earlier blocks are still being compressed.
+constexpr size_t kMaxBlocksInFlight = 16;
+
+// The PNG filter types, predicting each byte x from the byte a before it (a pixel to the left),
+// the byte b above it, and the byte c above a. Each works on one byte or on 16 at a time.
+struct PredictNone {
+    template <typename T> T operator()(T, T, T) const { return T(0); }
+};
+struct PredictSub {
+    template <typename T> T operator()(T a, T, T) const { return a; }
+};
+struct PredictUp {
+    template <typename T> T operator()(T, T b, T) const { return b; }
+};
+struct PredictAvg {
+    // floor((a + b) / 2) without overflowing a byte
+    template <typename T> T operator()(T a, T b, T) const { return T((a & b) + ((a ^ b) >> 1)); }
+};
+struct PredictPaeth {
+    uint8_t operator()(uint8_t a, uint8_t b, uint8_t c) const {
+        const int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+        return pa <= pb && pa <= pc ? a : pb <= pc ? b : c;
+    }
+    U8x16 operator()(U8x16 a, U8x16 b, U8x16 c) const {
+        // Staying in bytes, |a + b - 2c| is pa + pb when b - c and a - c have the same sign, and
+        // |pa - pb| otherwise. The sum may saturate, since it's only compared with pa and pb.
+        const U8x16 pa = absdiff(b, c), pb = absdiff(a, c);
+        const U8x16 pc = skvx::if_then_else((b >= c) == (a >= c),
+                                            skvx::saturated_add(pa, pb),
+                                            absdiff(pa, pb));
+        return skvx::if_then_else((pa <= pb) & (pa <= pc), a, skvx::if_then_else(pb <= pc, b, c));
+    }
+
+private:
+    static U8x16 absdiff(U8x16 x, U8x16 y) { return skvx::max(x, y) - skvx::min(x, y); }
+};
+
+// The magnitude of a filtered byte, read as signed.
+int magnitude(uint8_t v) { return std::min<int>(v, 256 - v); }
+U8x16 magnitude(U8x16 v) { return skvx::min(v, U8x16(0) - v); }
+
+// Filters n bytes of row into dst, given the prior row, and returns the sum of their magnitudes.
+template <typename Predict>
+uint32_t filter(const uint8_t* row, const uint8_t* prior, uint8_t* dst, size_t n, size_t bpp,
+                Predict predict) {
+    uint32_t sum = 0;
+    size_t i = 0;
+    for (; i < std::min(bpp, n); ++i) {
+        dst[i] = static_cast<uint8_t>(row[i] - predict(uint8_t(0), prior[i], uint8_t(0)));
+        sum += magnitude(dst[i]);
+    }
+
+    // Each lane of sums grows by at most 256 per step, so add them up before they can overflow.
+    auto addSums = [&sum](U16x8 sums) {
+        uint16_t lanes[8];
+        sums.store(lanes);
+        for (uint16_t lane : lanes) {
+            sum += lane;
+        }
+    };
+    U16x8 sums = 0;
+    int steps = 0;
+    for (; i + 16 <= n; i += 16) {
+        const U8x16 f = U8x16::Load(row + i) - predict(U8x16::Load(row + i - bpp),
+                                                       U8x16::Load(prior + i),
+                                                       U8x16::Load(prior + i - bpp));
+        f.store(dst + i);
+        // Add pairs of bytes as 16-bit lanes.
+        const U16x8 pairs = sk_bit_cast<U16x8>(magnitude(f));
+        sums += (pairs & 0xFF) + (pairs >> 8);
+        if (++steps == 255) {
+            addSums(sums);
+            sums = 0;
+            steps = 0;
+        }
+    }
+    addSums(sums);
+
+    for (; i < n; ++i) {
+        dst[i] = static_cast<uint8_t>(row[i] - predict(row[i - bpp], prior[i], prior[i - bpp]));
+        sum += magnitude(dst[i]);
+    }
+    return sum;
+}
+
+// Writes the filter type and the filtered row to dst, returning the sum of their magnitudes.
+uint32_t filter_row(int type, const uint8_t* row, const uint8_t* prior, uint8_t* dst, size_t n,
+                    size_t bpp) {
+    dst[0] = SkToU8(type);
+    switch (type) {
+        case 0: return filter(row, prior, dst + 1, n, bpp, PredictNone());
+        case 1: return filter(row, prior, dst + 1, n, bpp, PredictSub());
+        case 2: return filter(row, prior, dst + 1, n, bpp, PredictUp());
+        case 3: return filter(row, prior, dst + 1, n, bpp, PredictAvg());
+        case 4: return filter(row, prior, dst + 1, n, bpp, PredictPaeth());
+    }
+    SkUNREACHABLE;
+}
+
+// Filters a row (n bytes) into dst (n + 1 bytes) with the allowed filter whose output has the
+// smallest sum of magnitudes. scratch is another n + 1 bytes to try filters in.
+void filter_adaptive(int filters, const uint8_t* row, const uint8_t* prior, uint8_t* dst,
+                     uint8_t* scratch, size_t n, size_t bpp) {
+    uint8_t* best = nullptr;
+    uint32_t bestSum = 0;
+    for (int type = 0; type <= 4; ++type) {
+        if (!(filters & ((int)SkPngEncoder::FilterFlag::kNone << type))) {
+            continue;
+        }
+        uint8_t* candidate = best == dst ? scratch : dst;
+        const uint32_t sum = filter_row(type, row, prior, candidate, n, bpp);
+        if (!best || sum < bestSum) {
+            best = candidate;
+            bestSum = sum;
+        }
+    }
+    if (!best) {
+        filter_row(0, row, prior, dst, n, bpp);
+    } else if (best != dst) {
+        memcpy(dst, best, n + 1);
+    }
+}
+
+// The two byte zlib header, advertising a 32K window and the compression level.
+void append_zlib_header(int zlibLevel, std::vector<uint8_t>* out) {
+    const int levelFlags = zlibLevel < 2 ? 0 : zlibLevel < 6 ? 1 : zlibLevel == 6 ? 2 : 3;
+    int header = (0x78 << 8) | (levelFlags << 6);
+    header += 31 - header % 31;
+    out->push_back(SkToU8(header >> 8));
+    out->push_back(SkToU8(header & 0xFF));
+}
+
+}  // namespace
+
+struct SkPngParallelDeflate::Block {
+    // A row before the first one to filter (zeros at the top of the image), the history rows,
+    // which are only filtered to prime the compressor, and then this block's own rows.
+    std::vector<uint8_t> fRows;
+    bool fZeroPrior = false;
+    int fHistoryRows = 0;
+    int fRowCount = 0;
+    bool fFirst = false;
+    bool fLast = false;
+
+    // Written by the task.
+    std::vector<uint8_t> fOutput;
+    uint32_t fAdler = 0;
+    size_t fFilteredBytes = 0;
+    bool fOk = false;
+    SkSemaphore fDone;
+
+    void compress(size_t rowBytes, size_t bpp, int filters, int zlibLevel);
+};
+
+void SkPngParallelDeflate::Block::compress(size_t rowBytes,
+                                           size_t bpp,
+                                           int filters,
+                                           int zlibLevel) {
+    const size_t filteredRowBytes = rowBytes + 1;
+    const int rows = fHistoryRows + fRowCount;
+    std::vector<uint8_t> filtered(rows * filteredRowBytes), scratch(filteredRowBytes);
+    for (int y = 0; y < rows; ++y) {
+        filter_adaptive(filters,
+                        fRows.data() + (y + 1) * rowBytes,
+                        fRows.data() + y * rowBytes,
+                        filtered.data() + y * filteredRowBytes,
+                        scratch.data(),
+                        rowBytes,
+                        bpp);
+    }
+    const uint8_t* history = filtered.data();
+    const size_t historyBytes = fHistoryRows * filteredRowBytes;
+    const uint8_t* own = history + historyBytes;
+    fFilteredBytes = fRowCount * filteredRowBytes;
+    fAdler = SkToU32(adler32(adler32(0, nullptr, 0), own, SkToUInt(fFilteredBytes)));
+
+    // Like libpng, which uses Z_FILTERED unless every row is unfiltered.
+    const bool unfiltered = filters == 0 || filters == (int)SkPngEncoder::FilterFlag::kNone;
+    z_stream zstream = {};
+    if (deflateInit2(&zstream, zlibLevel, Z_DEFLATED, -15, 8,
+                     unfiltered ? Z_DEFAULT_STRATEGY : Z_FILTERED) != Z_OK) {
+        return;
+    }
+    if (historyBytes > 0) {
+        const size_t dictionaryBytes = std::min(historyBytes, kWindowBytes);
+        deflateSetDictionary(&zstream, own - dictionaryBytes, SkToUInt(dictionaryBytes));
+    }
+
+    if (fFirst) {
+        append_zlib_header(zlibLevel, &fOutput);
+    }
+    zstream.next_in = const_cast<uint8_t*>(own);
+    zstream.avail_in = SkToUInt(fFilteredBytes);
+    const int flush = fLast ? Z_FINISH : Z_SYNC_FLUSH;
+    const size_t outputStep = deflateBound(&zstream, zstream.avail_in) + 16;
+    for (;;) {
+        const size_t written = fOutput.size();
+        fOutput.resize(written + outputStep);
+        zstream.next_out = fOutput.data() + written;
+        zstream.avail_out = SkToUInt(outputStep);
+        const int result = deflate(&zstream, flush);
+        fOutput.resize(fOutput.size() - zstream.avail_out);
+        if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+            break;
+        }
+        // A sync flush is done when it leaves room in the output; a finish when the stream ends.
+        if (fLast ? result == Z_STREAM_END : zstream.avail_in == 0 && zstream.avail_out != 0) {
+            fOk = true;
+            break;
+        }
+    }
+    deflateEnd(&zstream);
+
+    // The rows aren't needed anymore, only the output.
+    fRows = {};
+}
+
+SkPngParallelDeflate::SkPngParallelDeflate(SkExecutor& executor,
+                                           size_t rowBytes,
+                                           size_t bytesPerPixel,
+                                           int filters,
+                                           int zlibLevel,
+                                           WriteFn write)
+        : fRowBytes(rowBytes)
+        , fBytesPerPixel(bytesPerPixel)
+        , fFilters(filters)
+        , fZLibLevel(zlibLevel)
+        , fWrite(std::move(write))
+        , fRowsPerBlock(SkToInt(std::max<size_t>(1, kBlockBytes / (rowBytes + 1))))
+        , fHistoryRows(SkToInt((kWindowBytes + rowBytes) / (rowBytes + 1)))
+        , fAdler(SkToU32(adler32(0, nullptr, 0)))
+        , fTasks(executor) {
+    SkASSERT(rowBytes > 0 && bytesPerPixel > 0);
+}
+
+SkPngParallelDeflate::~SkPngParallelDeflate() { fTasks.wait(); }
+
+bool SkPngParallelDeflate::addRow(SkSpan<const uint8_t> row) {
+    SkASSERT(row.size() == fRowBytes);
+    if (!fNext) {
+        // Start the block with the rows before it.
+        fNext = std::make_unique<Block>();
+        fNext->fRows.reserve((fHistoryRows + 1 + fRowsPerBlock) * fRowBytes);
+        fNext->fZeroPrior = fRecentRowCount <= fHistoryRows;
+        if (fNext->fZeroPrior) {
+            fNext->fRows.resize(fRowBytes, 0);
+        }
+        fNext->fRows.insert(fNext->fRows.end(), fRecentRows.begin(), fRecentRows.end());
+        fNext->fHistoryRows = fNext->fZeroPrior ? fRecentRowCount : fRecentRowCount - 1;
+    }
+    fNext->fRows.insert(fNext->fRows.end(), row.begin(), row.end());
+    if (++fNext->fRowCount == fRowsPerBlock) {
+        return this->submit(/*last=*/false);
+    }
+    return true;
+}
+
+bool SkPngParallelDeflate::submit(bool last) {
+    if (!fNext) {
+        fNext = std::make_unique<Block>();
+        fNext->fRows.resize(fRowBytes, 0);
+        fNext->fZeroPrior = true;
+    }
+    std::unique_ptr<Block> block = std::move(fNext);
+    block->fFirst = fFirstBlock;
+    block->fLast = last;
+    fFirstBlock = false;
+
+    // The next block's history is the end of this one.
+    const size_t realRows = block->fRows.size() / fRowBytes - (block->fZeroPrior ? 1 : 0);
+    fRecentRowCount = SkToInt(std::min<size_t>(realRows, fHistoryRows + 1));
+    fRecentRows.assign(block->fRows.end() - fRecentRowCount * fRowBytes, block->fRows.end());
+
+    Block* b = block.get();
+    fInFlight.push_back(std::move(block));
+    fTasks.add([b, rowBytes = fRowBytes, bpp = fBytesPerPixel, filters = fFilters,
+                zlibLevel = fZLibLevel] {
+        b->compress(rowBytes, bpp, filters, zlibLevel);
+        b->fDone.signal();
+    });
+
+    while (fInFlight.size() > kMaxBlocksInFlight) {
+        if (!this->writeOldest()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SkPngParallelDeflate::writeOldest() {
+    std::unique_ptr<Block> block = std::move(fInFlight.front());
+    fInFlight.pop_front();
+    block->fDone.wait();
+    if (!block->fOk) {
+        return false;
+    }
+
+    fAdler = SkToU32(adler32_combine(fAdler, block->fAdler, (z_off_t)block->fFilteredBytes));
+    if (block->fLast) {
+        for (int shift : {24, 16, 8, 0}) {
+            block->fOutput.push_back(SkToU8((fAdler >> shift) & 0xFF));
+        }
+    }
+    return fWrite(block->fOutput);
+}
+
+bool SkPngParallelDeflate::finish() {
+    if (!this->submit(/*last=*/true)) {
+        return false;
+    }
+    while (!fInFlight.empty()) {
+        if (!this->writeOldest()) {
+            return false;
+        }
+    }
+    return true;
+}
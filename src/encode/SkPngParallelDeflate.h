@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPngParallelDeflate_DEFINED
+#define SkPngParallelDeflate_DEFINED
+
+#include "include/core/SkSpan.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class SkExecutor;
+
+// Builds the zlib stream of a PNG's IDAT chunks from its rows, filtering and compressing blocks of
+// rows concurrently, the way pigz compresses blocks of a file.
+//
+// Each block is compressed as raw deflate data, primed with the last 32K of the block before it,
+// and ends with a sync flush (or, for the last block, a final block), so concatenating them gives
+// a single deflate stream. The zlib header comes before the first block and the Adler-32 of the
+// filtered rows, combined from each block's, after the last one. Blocks are handed to the
+// caller's WriteFn, as IDAT chunk data, in order.
+//
+// Rows are filtered with the filter that gives the smallest sum of absolute (signed) bytes among
+// those allowed, like libpng's heuristic.
+class SkPngParallelDeflate {
+public:
+    using WriteFn = std::function<bool(SkSpan<const uint8_t>)>;
+
+    // `filters` is a mask of SkPngEncoder::FilterFlag. `bytesPerPixel` is the distance to the
+    // byte each byte is predicted from, as defined for PNG filters.
+    SkPngParallelDeflate(SkExecutor&,
+                         size_t rowBytes,
+                         size_t bytesPerPixel,
+                         int filters,
+                         int zlibLevel,
+                         WriteFn);
+    ~SkPngParallelDeflate();
+
+    // Adds the next row, which is already in the PNG's pixel format.
+    bool addRow(SkSpan<const uint8_t> row);
+
+    // Compresses any remaining rows and writes the end of the stream.
+    bool finish();
+
+private:
+    struct Block;
+
+    bool submit(bool last);
+    bool writeOldest();
+
+    const size_t fRowBytes;
+    const size_t fBytesPerPixel;
+    const int    fFilters;
+    const int    fZLibLevel;
+    const WriteFn fWrite;
+    const int    fRowsPerBlock;
+    const int    fHistoryRows;  // enough rows before a block to fill the deflate window
+
+    std::unique_ptr<Block> fNext;
+    std::vector<uint8_t> fRecentRows;  // up to fHistoryRows + 1 rows before fNext's first row
+    int fRecentRowCount = 0;
+    bool fFirstBlock = true;
+    uint32_t fAdler;
+
+    std::deque<std::unique_ptr<Block>> fInFlight;
+    SkTaskGroup fTasks;  // destroyed first, so no task outlives its block
+};
+
+#endif  // SkPngParallelDeflate_DEFINED
@@ -55,6 +55,7 @@ public:
         kGanesh,
         kGraphite,
         kRaster,
+        kRasterTiled,  // Rasterizes lazily; not an SkSurface_Raster.
     };
 
     // TODO(kjlubick) Android directly subclasses SkSurface_Base for tests, so we
@@ -149,6 +150,18 @@ public:
      */
     virtual void onRestoreBackingMutability() {}
 
+    /**
+     *  Surfaces that defer rasterizing their canvas's draws render them here. Called before the
+     *  surface's contents are snapshotted.
+     */
+    virtual void onResolvePendingDraws() {}
+
+    /**
+     *  Default implementations access the pixels through the surface's canvas.
+     */
+    virtual bool onPeekPixels(SkPixmap*);
+    virtual bool onReadPixels(const SkPixmap&, int srcX, int srcY);
+
     /**
      * Caused the current backend 3D API to wait on the passed in semaphores before executing new
      * commands on the gpu. Any previously submitting commands will not be blocked by these
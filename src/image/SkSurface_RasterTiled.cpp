@@ -0,0 +1,505 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/image/SkSurface_RasterTiled.h"
+
+#include "include/core/SkBBHFactory.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkCapabilities.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkM44.h"
+#include "include/core/SkMallocPixelRef.h"
+#include "include/core/SkPixelRef.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSurface.h"
+#include "include/private/base/SkAssert.h"
+#include "include/private/base/SkTemplates.h"
+#include "include/private/base/SkTo.h"
+#include "src/core/SkBigPicture.h"
+#include "src/core/SkBitmapDevice.h"
+#include "src/core/SkDevice.h"
+#include "src/core/SkImagePriv.h"
+#include "src/core/SkRecord.h"
+#include "src/core/SkRecordDraw.h"
+#include "src/core/SkRecorder.h"
+#include "src/core/SkRecords.h"
+#include "src/core/SkSurfacePriv.h"
+#include "src/core/SkTaskGroup.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Walks the record tracking the Save/Restore stack, to find out how much of it the serial raster
+// path would already have drawn, and whether the record can be dropped once that is rasterized.
+class StackTracker {
+public:
+    void setCurrentOp(int currentOp) { fCurrentOp = currentOp; }
+
+    template <typename T> void operator()(const T&) {}
+
+    void operator()(const SkRecords::Save&)       { fOpenSaves.push_back({fCurrentOp, false}); }
+    void operator()(const SkRecords::SaveLayer&)  { fOpenSaves.push_back({fCurrentOp, true}); }
+    void operator()(const SkRecords::SaveBehind&) { fOpenSaves.push_back({fCurrentOp, true}); }
+    void operator()(const SkRecords::Restore&) {
+        if (!fOpenSaves.empty()) {
+            fOpenSaves.pop_back();
+        }
+    }
+
+    void operator()(const SkRecords::ClipPath&)   { this->trackClip(); }
+    void operator()(const SkRecords::ClipRRect&)  { this->trackClip(); }
+    void operator()(const SkRecords::ClipRect&)   { this->trackClip(); }
+    void operator()(const SkRecords::ClipRegion&) { this->trackClip(); }
+    void operator()(const SkRecords::ClipShader&) { this->trackClip(); }
+    void operator()(const SkRecords::ResetClip&)  { this->trackClip(); }
+
+    // Ops inside a layer that has not been restored yet are not visible on a raster surface,
+    // so we stop at the outermost open layer.
+    int drawableOps(int count) const {
+        for (const OpenSave& save : fOpenSaves) {
+            if (save.isLayer) {
+                return save.index;
+            }
+        }
+        return count;
+    }
+
+    // The record can only be replaced by a simple matrix if nothing else carries over.
+    bool canReset() const { return fOpenSaves.empty() && !fHasTopLevelClip; }
+
+private:
+    void trackClip() {
+        if (fOpenSaves.empty()) {
+            fHasTopLevelClip = true;
+        }
+    }
+
+    struct OpenSave {
+        int  index;
+        bool isLayer;
+    };
+
+    std::vector<OpenSave> fOpenSaves;
+    bool fHasTopLevelClip = false;
+    int  fCurrentOp = 0;
+};
+
+// Whether an op is drawn tile by tile, or over the whole surface at once. Ops that don't draw are
+// replayed by every canvas, for their effect on the matrix and clip.
+enum class OpKind : uint8_t {
+    kState,
+    kTiles,
+    kWhole,
+};
+
+// Decides which ops can be drawn tile by tile. Every tile draws with the same matrix and clip as
+// the whole surface, and only restricts the pixels it writes to itself (see
+// SkBitmapDevice::setWriteBounds()), so any draw can be split across tiles and still match the
+// serial raster path exactly. A layer is drawn into pixels of its own, though, and its filters
+// may read across a seam, so a layer that crosses a tile boundary is drawn over the whole
+// surface instead, with everything in it.
+class SeamFinder {
+public:
+    SeamFinder(const SkISize& size, int tileSize, const SkRect bounds[], OpKind kinds[])
+        : fSurface(SkIRect::MakeSize(size))
+        , fTileSize(tileSize)
+        , fBounds(bounds)
+        , fKinds(kinds) {}
+
+    void setCurrentOp(int currentOp) { fCurrentOp = currentOp; }
+
+    template <typename T> void operator()(const T&) {
+        fKinds[fCurrentOp] = (T::kTags & SkRecords::kDraw_Tag) ? OpKind::kTiles : OpKind::kState;
+    }
+
+    void operator()(const SkRecords::Save&) {
+        fKinds[fCurrentOp] = OpKind::kState;
+        fSaves.push_back(/*isLayer=*/false);
+    }
+    void operator()(const SkRecords::SaveLayer&)  { this->saveLayer(); }
+    void operator()(const SkRecords::SaveBehind&) { this->saveLayer(); }
+    void operator()(const SkRecords::Restore&) {
+        fKinds[fCurrentOp] = OpKind::kState;
+        if (fSaves.empty()) {
+            return;
+        }
+        const bool isLayer = fSaves.back();
+        fSaves.pop_back();
+        if (isLayer && --fOpenLayers == 0 && fLayerIsWhole) {
+            // The layer's draws must all be in the same place as the layer itself.
+            std::fill(fKinds + fLayerStart, fKinds + fCurrentOp + 1, OpKind::kWhole);
+        }
+    }
+
+private:
+    void saveLayer() {
+        fKinds[fCurrentOp] = OpKind::kTiles;
+        fSaves.push_back(/*isLayer=*/true);
+        if (fOpenLayers++ == 0) {
+            fLayerStart = fCurrentOp;
+            fLayerIsWhole = this->crossesSeams(fBounds[fCurrentOp]);
+        }
+    }
+
+    bool crossesSeams(const SkRect& bounds) const {
+        // Outset, in case antialiasing touches the pixels just past the bounds.
+        SkIRect r = bounds.roundOut().makeOutset(1, 1);
+        if (!r.intersect(fSurface)) {
+            return false;
+        }
+        return r.fLeft / fTileSize != (r.fRight  - 1) / fTileSize ||
+               r.fTop  / fTileSize != (r.fBottom - 1) / fTileSize;
+    }
+
+    const SkIRect     fSurface;
+    const int         fTileSize;
+    const SkRect*     fBounds;
+    OpKind*           fKinds;
+    std::vector<bool> fSaves;  // Whether each open save is a layer.
+    int               fOpenLayers = 0;
+    int               fLayerStart = 0;
+    bool              fLayerIsWhole = false;
+    int               fCurrentOp = 0;
+};
+
+// Replays a record into a tile's canvas, or the whole surface's. Ops that were rasterized by a
+// previous resolve, or that are drawn by the other kind of canvas, are only replayed for their
+// effect on the matrix and clip.
+class TileDraw {
+public:
+    TileDraw(SkCanvas* canvas, SkPicture const* const drawablePicts[], int drawableCount,
+             int firstPendingOp, const OpKind kinds[], OpKind drawnKind)
+        : fDraw(canvas, drawablePicts, nullptr, drawableCount)
+        , fCanvas(canvas)
+        , fFirstPendingOp(firstPendingOp)
+        , fKinds(kinds)
+        , fDrawnKind(drawnKind) {}
+
+    void setCurrentOp(int currentOp) { fCurrentOp = currentOp; }
+
+    template <typename T> void operator()(const T& op) {
+        if (this->drawsCurrentOp() || !(T::kTags & SkRecords::kDraw_Tag)) {
+            fDraw(op);
+        }
+    }
+
+    // A layer that is drawn elsewhere must not be composited here, but its Restore still needs
+    // a matching save.
+    void operator()(const SkRecords::SaveLayer& op)  { this->saveOrDraw(op); }
+    void operator()(const SkRecords::SaveBehind& op) { this->saveOrDraw(op); }
+
+private:
+    bool drawsCurrentOp() const {
+        return fCurrentOp >= fFirstPendingOp && fKinds[fCurrentOp] == fDrawnKind;
+    }
+
+    template <typename T> void saveOrDraw(const T& op) {
+        if (this->drawsCurrentOp()) {
+            fDraw(op);
+        } else {
+            fCanvas->save();
+        }
+    }
+
+    SkRecords::Draw fDraw;
+    SkCanvas*       fCanvas;
+    const int       fFirstPendingOp;
+    const OpKind*   fKinds;
+    const OpKind    fDrawnKind;
+    int             fCurrentOp = 0;
+};
+
+// A canvas over the surface's pixels, and where it is in the record. A tile's canvas only
+// writes the pixels in its tile.
+struct Replay {
+    Replay(const SkBitmap& bitmap, const SkSurfaceProps& props, const SkIRect* tile,
+           SkPicture const* const drawablePicts[], int drawableCount, int firstPendingOp,
+           const OpKind kinds[], OpKind drawnKind)
+            : fCanvas(MakeDevice(bitmap, props, tile))
+            , fDraw(&fCanvas, drawablePicts, drawableCount, firstPendingOp, kinds, drawnKind) {}
+
+    static sk_sp<SkDevice> MakeDevice(const SkBitmap& bitmap, const SkSurfaceProps& props,
+                                      const SkIRect* tile) {
+        auto device = sk_make_sp<SkBitmapDevice>(bitmap, props);
+        if (tile) {
+            device->setWriteBounds(*tile);
+        }
+        return device;
+    }
+
+    SkCanvas fCanvas;
+    TileDraw fDraw;
+    size_t   fNext = 0;  // The next op to replay, as an index into the ops it replays.
+};
+
+}  // namespace
+
+SkSurface_RasterTiled::SkSurface_RasterTiled(const SkImageInfo& info, sk_sp<SkPixelRef> pr,
+                                             SkExecutor* executor, int tileSize,
+                                             const SkSurfaceProps* props)
+        : INHERITED(pr->width(), pr->height(), props)
+        , fExecutor(executor)
+        , fTileSize(tileSize)
+        , fRecord(sk_make_sp<SkRecord>()) {
+    fBitmap.setInfo(info, pr->rowBytes());
+    fBitmap.setPixelRef(std::move(pr), 0, 0);
+}
+
+SkSurface_RasterTiled::~SkSurface_RasterTiled() = default;
+
+SkCanvas* SkSurface_RasterTiled::onNewCanvas() {
+    SkASSERT(!fRecorder);
+    fRecorder = new SkRecorder(fRecord.get(), SkRect::Make(fBitmap.dimensions()));
+    return fRecorder;
+}
+
+sk_sp<SkSurface> SkSurface_RasterTiled::onNewSurface(const SkImageInfo& info) {
+    return SkSurfaces::RasterTiled(info, fExecutor, fTileSize, &this->props());
+}
+
+void SkSurface_RasterTiled::onResolvePendingDraws() {
+    this->resolve();
+}
+
+void SkSurface_RasterTiled::resolve() {
+    const int count = fRecord->count();
+    if (count == fResolvedOps) {
+        return;
+    }
+
+    StackTracker tracker;
+    for (int i = 0; i < count; i++) {
+        tracker.setCurrentOp(i);
+        fRecord->visit(i, tracker);
+    }
+    const int drawableOps = tracker.drawableOps(count);
+    if (drawableOps <= fResolvedOps) {
+        return;
+    }
+
+    // Fork our pixels from any outstanding snapshot before we write to them.
+    this->notifyContentWillChange(kRetain_ContentChangeMode);
+
+    // Drawables are snapped to pictures so that each tile can play them back independently.
+    std::unique_ptr<SkBigPicture::SnapshotArray> drawablePicts;
+    int drawableCount = 0;
+    if (fRecorder && fRecorder->getDrawableList()) {
+        drawablePicts.reset(fRecorder->getDrawableList()->newDrawableSnapshot());
+        drawableCount = drawablePicts->count();
+    }
+
+    skia_private::AutoTArray<SkRect> bounds(count);
+    skia_private::AutoTMalloc<SkBBoxHierarchy::Metadata> meta(count);
+    SkRecordFillBounds(SkRect::Make(fBitmap.dimensions()), *fRecord, bounds.get(), meta.get());
+
+    const SkPicture* const* picts = drawablePicts ? drawablePicts->begin() : nullptr;
+    skia_private::AutoTArray<OpKind> kinds(drawableOps);
+    {
+        SeamFinder seams(fBitmap.dimensions(), fTileSize, bounds.get(), kinds.get());
+        for (int i = 0; i < drawableOps; i++) {
+            seams.setCurrentOp(i);
+            fRecord->visit(i, seams);
+        }
+    }
+
+    const int tilesX = (fBitmap.width()  + fTileSize - 1) / fTileSize,
+              tilesY = (fBitmap.height() + fTileSize - 1) / fTileSize;
+
+    // Bin every op that may affect a tile. Ops are kept in record order.
+    std::vector<std::vector<int>> bins(tilesX * tilesY);
+    for (int i = 0; i < drawableOps; i++) {
+        SkIRect r = bounds[i].roundOut();
+        if (!r.intersect(SkIRect::MakeSize(fBitmap.dimensions()))) {
+            continue;
+        }
+        for (int y = r.fTop / fTileSize; y <= (r.fBottom - 1) / fTileSize; y++) {
+        for (int x = r.fLeft / fTileSize; x <= (r.fRight - 1) / fTileSize; x++) {
+            bins[y * tilesX + x].push_back(i);
+        }
+        }
+    }
+
+    // Split the pending ops into runs that are drawn all in tiles or all whole, so that every
+    // pixel sees the draws in record order. Ops that don't draw go with the run they're in.
+    struct Run {
+        int    fStart;
+        OpKind fKind;
+    };
+    std::vector<Run> runs;
+    for (int i = fResolvedOps; i < drawableOps; i++) {
+        if (kinds[i] != OpKind::kState && (runs.empty() || runs.back().fKind != kinds[i])) {
+            runs.push_back({i, kinds[i]});
+        }
+    }
+
+    // Each tile draws into the full surface with the serial path's matrix and clip, and never
+    // writes outside of itself. Tiles are only set up once something is drawn in them, and then
+    // keep their matrix and clip from one run to the next.
+    std::vector<std::unique_ptr<Replay>> tiles(bins.size());
+    auto drawTile = [&](int tile, int runStart, int runEnd) {
+        const std::vector<int>& ops = bins[tile];
+        const auto first = std::lower_bound(ops.begin(), ops.end(), runStart),
+                   last  = std::lower_bound(first, ops.end(), runEnd);
+        // Skip tiles where nothing is drawn in this run.
+        if (std::none_of(first, last, [&](int op) { return kinds[op] == OpKind::kTiles; })) {
+            return;
+        }
+        if (!tiles[tile]) {
+            const int x = tile % tilesX,
+                      y = tile / tilesX;
+            const SkIRect bounds = SkIRect::MakeXYWH(x * fTileSize, y * fTileSize,
+                                                     fTileSize, fTileSize);
+            tiles[tile] = std::make_unique<Replay>(fBitmap, this->props(), &bounds, picts,
+                                                   drawableCount, fResolvedOps, kinds.get(),
+                                                   OpKind::kTiles);
+        }
+        Replay& replay = *tiles[tile];
+        for (const size_t end = last - ops.begin(); replay.fNext < end; replay.fNext++) {
+            const int op = ops[replay.fNext];
+            replay.fDraw.setCurrentOp(op);
+            fRecord->visit(op, replay.fDraw);
+        }
+    };
+
+    // Layers that cross a seam are drawn on this thread, with every op replayed for the matrix
+    // and clip.
+    std::unique_ptr<Replay> whole;
+    for (size_t r = 0; r < runs.size(); r++) {
+        const int runStart = runs[r].fStart,
+                  runEnd   = r + 1 < runs.size() ? runs[r + 1].fStart : drawableOps;
+        if (runs[r].fKind == OpKind::kWhole) {
+            if (!whole) {
+                whole = std::make_unique<Replay>(fBitmap, this->props(), nullptr, picts,
+                                                 drawableCount, fResolvedOps, kinds.get(),
+                                                 OpKind::kWhole);
+            }
+            for (int op = SkToInt(whole->fNext); op < runEnd; op++) {
+                whole->fDraw.setCurrentOp(op);
+                fRecord->visit(op, whole->fDraw);
+            }
+            whole->fNext = runEnd;
+        } else if (fExecutor) {
+            SkTaskGroup(*fExecutor).batch(SkToInt(bins.size()), [&](int tile) {
+                drawTile(tile, runStart, runEnd);
+            });
+        } else {
+            for (int tile = 0; tile < SkToInt(bins.size()); tile++) {
+                drawTile(tile, runStart, runEnd);
+            }
+        }
+    }
+    fResolvedOps = drawableOps;
+
+    // If nothing but the matrix carries over into the ops still to come, start a fresh record.
+    if (fRecorder && drawableOps == count && tracker.canReset()) {
+        const SkM44 ctm = fRecorder->getLocalToDevice();
+        fRecord = sk_make_sp<SkRecord>();
+        fRecorder->reset(fRecord.get(), SkRect::Make(fBitmap.dimensions()));
+        if (ctm != SkM44()) {
+            fRecorder->setMatrix(ctm);
+        }
+        fResolvedOps = fRecord->count();
+    }
+}
+
+void SkSurface_RasterTiled::onDraw(SkCanvas* canvas, SkScalar x, SkScalar y,
+                                   const SkSamplingOptions& sampling, const SkPaint* paint) {
+    this->resolve();
+    canvas->drawImage(fBitmap.asImage().get(), x, y, sampling, paint);
+}
+
+sk_sp<SkImage> SkSurface_RasterTiled::onNewImageSnapshot(const SkIRect* subset) {
+    this->resolve();
+    if (subset) {
+        SkASSERT(SkIRect::MakeWH(fBitmap.width(), fBitmap.height()).contains(*subset));
+        SkBitmap dst;
+        dst.allocPixels(fBitmap.info().makeDimensions(subset->size()));
+        SkAssertResult(fBitmap.readPixels(dst.pixmap(), subset->left(), subset->top()));
+        dst.setImmutable(); // key, so MakeFromBitmap doesn't make a copy of the buffer
+        return dst.asImage();
+    }
+
+    // SkImage_raster requires these pixels are immutable for its full lifetime.
+    // We'll undo this via onRestoreBackingMutability() if we can avoid the COW.
+    if (SkPixelRef* pr = fBitmap.pixelRef()) {
+        pr->setTemporarilyImmutable();
+    }
+    return SkMakeImageFromRasterBitmap(fBitmap, kIfMutable_SkCopyPixelsMode);
+}
+
+void SkSurface_RasterTiled::onWritePixels(const SkPixmap& src, int x, int y) {
+    this->resolve();
+    fBitmap.writePixels(src, x, y);
+}
+
+bool SkSurface_RasterTiled::onPeekPixels(SkPixmap* pmap) {
+    this->resolve();
+    return fBitmap.peekPixels(pmap);
+}
+
+bool SkSurface_RasterTiled::onReadPixels(const SkPixmap& dst, int srcX, int srcY) {
+    this->resolve();
+    return dst.addr() && fBitmap.readPixels(dst, srcX, srcY);
+}
+
+void SkSurface_RasterTiled::onRestoreBackingMutability() {
+    SkASSERT(!this->hasCachedImage());  // Shouldn't be any snapshots out there.
+    if (SkPixelRef* pr = fBitmap.pixelRef()) {
+        pr->restoreMutability();
+    }
+}
+
+bool SkSurface_RasterTiled::onCopyOnWrite(ContentChangeMode mode) {
+    // are we sharing pixelrefs with the image?
+    sk_sp<SkImage> cached(this->refCachedImage());
+    SkASSERT(cached);
+    if (SkBitmapImageGetPixelRef(cached.get()) == fBitmap.pixelRef()) {
+        SkBitmap prev(fBitmap);
+        if (!fBitmap.tryAllocPixels()) {
+            return false;
+        }
+        if (kRetain_ContentChangeMode == mode) {
+            SkASSERT(prev.info() == fBitmap.info());
+            SkASSERT(prev.rowBytes() == fBitmap.rowBytes());
+            memcpy(fBitmap.getPixels(), prev.getPixels(), fBitmap.computeByteSize());
+        }
+    }
+    return true;
+}
+
+sk_sp<const SkCapabilities> SkSurface_RasterTiled::onCapabilities() {
+    return SkCapabilities::RasterBackend();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+namespace SkSurfaces {
+
+sk_sp<SkSurface> RasterTiled(const SkImageInfo& info,
+                             SkExecutor* executor,
+                             int tileSize,
+                             const SkSurfaceProps* props) {
+    if (!SkSurfaceValidateRasterInfo(info) || tileSize <= 0) {
+        return nullptr;
+    }
+
+    sk_sp<SkPixelRef> pr = SkMallocPixelRef::MakeAllocate(info, 0);
+    if (!pr) {
+        return nullptr;
+    }
+    return sk_make_sp<SkSurface_RasterTiled>(info, std::move(pr), executor, tileSize, props);
+}
+
+}  // namespace SkSurfaces
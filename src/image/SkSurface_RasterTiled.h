@@ -0,0 +1,87 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkSurface_RasterTiled_DEFINED
+#define SkSurface_RasterTiled_DEFINED
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkScalar.h"
+#include "src/image/SkSurface_Base.h"
+
+class SkCanvas;
+class SkCapabilities;
+class SkExecutor;
+class SkImage;
+class SkPaint;
+class SkPixelRef;
+class SkPixmap;
+class SkRecord;
+class SkRecorder;
+class SkSurface;
+class SkSurfaceProps;
+struct SkIRect;
+
+/**
+ *  A raster surface whose canvas records draws (into an SkRecord) instead of rasterizing them
+ *  immediately. When the pixels are needed (snapshot, draw, peek/read/writePixels) the pending
+ *  ops are binned by tile using SkRecordFillBounds, and each tile is replayed with its own
+ *  SkCanvas/SkRasterClip, on the SkExecutor if one was provided.
+ *
+ *  Clipping a path to a tile would change the coverage along the tile's edges, so each tile
+ *  instead draws with the same clip as the whole surface and only restricts the pixels it writes.
+ *  Layers that cross a tile boundary are drawn over the whole surface on the calling thread, in
+ *  order with the tiles. The result is the same as a raster surface's.
+ *
+ *  Tiles are disjoint, so the result does not depend on the executor or its thread count.
+ */
+class SkSurface_RasterTiled : public SkSurface_Base {
+public:
+    SkSurface_RasterTiled(const SkImageInfo&, sk_sp<SkPixelRef>, SkExecutor*, int tileSize,
+                          const SkSurfaceProps*);
+    ~SkSurface_RasterTiled() override;
+
+    // From SkSurface.h
+    SkImageInfo imageInfo() const override { return fBitmap.info(); }
+
+    // From SkSurface_Base.h
+    SkSurface_Base::Type type() const override { return SkSurface_Base::Type::kRasterTiled; }
+
+    SkCanvas* onNewCanvas() override;
+    sk_sp<SkSurface> onNewSurface(const SkImageInfo&) override;
+    sk_sp<SkImage> onNewImageSnapshot(const SkIRect* subset) override;
+    void onWritePixels(const SkPixmap&, int x, int y) override;
+    void onDraw(SkCanvas*, SkScalar, SkScalar, const SkSamplingOptions&, const SkPaint*) override;
+    bool onCopyOnWrite(ContentChangeMode) override;
+    void onRestoreBackingMutability() override;
+    void onResolvePendingDraws() override;
+    bool onPeekPixels(SkPixmap*) override;
+    bool onReadPixels(const SkPixmap&, int srcX, int srcY) override;
+    sk_sp<const SkCapabilities> onCapabilities() override;
+
+    int tileSize() const { return fTileSize; }
+
+private:
+    // Rasterizes every recorded op that the serial raster path would already have drawn.
+    void resolve();
+
+    SkBitmap        fBitmap;
+    SkExecutor*     fExecutor;   // Unowned, may be null (tiles are then drawn on this thread).
+    const int       fTileSize;
+
+    sk_sp<SkRecord> fRecord;
+    SkRecorder*     fRecorder = nullptr;  // Owned by SkSurface_Base as our cached canvas.
+    // Ops before this index have been rasterized. They are replayed only for their effect on
+    // the matrix and clip; their draws are skipped.
+    int             fResolvedOps = 0;
+
+    using INHERITED = SkSurface_Base;
+};
+
+#endif
@@ -11,6 +11,7 @@
 #include "include/private/chromium/SkDiscardableMemory.h"
 #include "src/base/SkTInternalLList.h"
 #include "src/lazy/SkDiscardableMemoryPool.h"
+#include "src/lazy/SkSharedDiscardableMemoryPool.h"
 
 using namespace skia_private;
 
@@ -43,6 +44,11 @@ public:
     /** purges all unlocked DMs */
     void dumpPool() override;
 
+    PurgeStats getPurgeStats() override {
+        SkAutoMutexExclusive autoMutexAcquire(fMutex);
+        return fPurgeStats;
+    }
+
     #if SK_LAZY_CACHE_STATS  // Defined in SkDiscardableMemoryPool.h
     int getCacheHits() override { return fCacheHits; }
     int getCacheMisses() override { return fCacheMisses; }
@@ -57,6 +63,7 @@ private:
     SkMutex      fMutex;
     size_t       fBudget;
     size_t       fUsed;
+    PurgeStats   fPurgeStats;
     SkTInternalLList<PoolDiscardableMemory> fList;
 
     /** Function called to free memory if needed */
@@ -154,6 +161,8 @@ void DiscardableMemoryPool::dumpDownTo(size_t budget) {
             dm->fPointer = nullptr;
             SkASSERT(fUsed >= dm->fBytes);
             fUsed -= dm->fBytes;
+            fPurgeStats.fPurges += 1;
+            fPurgeStats.fPurgedBytes += dm->fBytes;
             cur = iter.prev();
             // Purged DMs are taken out of the list.  This saves times
             // looking them up.  Purged DMs are NOT deleted.
@@ -236,7 +245,14 @@ sk_sp<SkDiscardableMemoryPool> SkDiscardableMemoryPool::Make(size_t size) {
 
 SkDiscardableMemoryPool* SkGetGlobalDiscardableMemoryPool() {
     // Intentionally leak this global pool.
-    static SkDiscardableMemoryPool* global =
-            new DiscardableMemoryPool(SK_DEFAULT_GLOBAL_DISCARDABLE_MEMORY_POOL_SIZE);
+    static SkDiscardableMemoryPool* global = []() -> SkDiscardableMemoryPool* {
+#if defined(SK_USE_SHARED_DISCARDABLE_MEMORY)
+        if (auto shared = SkSharedDiscardableMemoryPool::Make(
+                    SK_DEFAULT_GLOBAL_DISCARDABLE_MEMORY_POOL_SIZE)) {
+            return shared.release();
+        }
+#endif
+        return new DiscardableMemoryPool(SK_DEFAULT_GLOBAL_DISCARDABLE_MEMORY_POOL_SIZE);
+    }();
     return global;
 }
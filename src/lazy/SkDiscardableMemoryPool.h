@@ -11,6 +11,8 @@
 #include "include/private/base/SkMutex.h"
 #include "include/private/chromium/SkDiscardableMemory.h"
 
+#include <cstdint>
+
 #ifndef SK_LAZY_CACHE_STATS
     #ifdef SK_DEBUG
         #define SK_LAZY_CACHE_STATS 1
@@ -34,6 +36,13 @@ public:
     /** purges all unlocked DMs */
     virtual void dumpPool() = 0;
 
+    /** Counts of the unlocked DMs purged to stay within the budget or by dumpPool(). */
+    struct PurgeStats {
+        uint64_t fPurges = 0;
+        uint64_t fPurgedBytes = 0;
+    };
+    virtual PurgeStats getPurgeStats() = 0;
+
     #if SK_LAZY_CACHE_STATS
     /**
      * These two values are a count of the number of successful and
@@ -54,7 +63,8 @@ public:
 
 /**
  *  Returns (and creates if needed) a threadsafe global
- *  SkDiscardableMemoryPool.
+ *  SkDiscardableMemoryPool. If SK_USE_SHARED_DISCARDABLE_MEMORY is defined,
+ *  it's an SkSharedDiscardableMemoryPool where memfds are supported.
  */
 SkDiscardableMemoryPool* SkGetGlobalDiscardableMemoryPool();
 
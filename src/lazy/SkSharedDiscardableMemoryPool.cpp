@@ -0,0 +1,371 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "src/lazy/SkSharedDiscardableMemoryPool.h"
+
+#if defined(__linux__)
+
+#include "include/core/SkFourByteTag.h"
+#include "include/core/SkTypes.h"
+#include "include/private/base/SkMutex.h"
+#include "src/base/SkTInternalLList.h"
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// Shared with every process that maps the memory, at the start of the memfd or, for memory that
+// isn't shared, of its anonymous mapping.
+struct Header {
+    // The number of locks held on the memory in all processes, or kPurged.
+    std::atomic<uint32_t> fState;
+    uint32_t              fMagic;
+    uint64_t              fSize;  // of the data
+};
+
+constexpr uint32_t kPurged = 0xffffffff;
+constexpr uint32_t kMagic = SkSetFourByteTag('s', 'k', 'd', 'm');
+// The data starts a cache line in, so that it's as aligned as malloc's.
+constexpr size_t kDataOffset = 64;
+static_assert(sizeof(Header) <= kDataOffset);
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "fState must work across processes");
+
+int create_memfd(const char* name, unsigned int flags) {
+    return static_cast<int>(syscall(SYS_memfd_create, name, flags));
+}
+
+void* map(int fd, size_t mappedSize) {
+    void* base = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    return base == MAP_FAILED ? nullptr : base;
+}
+
+void* map_anonymous(size_t mappedSize) {
+    void* base = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return base == MAP_FAILED ? nullptr : base;
+}
+
+class SharedDiscardableMemory;
+
+class SharedDiscardableMemoryPool final : public SkSharedDiscardableMemoryPool {
+public:
+    explicit SharedDiscardableMemoryPool(size_t budget) : fBudget(budget) {}
+    ~SharedDiscardableMemoryPool() override {
+        // Each SharedDiscardableMemory has a ref to its pool.
+        SkASSERT(fList.isEmpty());
+    }
+
+    SkDiscardableMemory* create(size_t bytes) override;
+    std::unique_ptr<SkSharedDiscardableMemory> makeShared(size_t bytes) override;
+    std::unique_ptr<SkSharedDiscardableMemory> adopt(int fd) override;
+
+    size_t getRAMUsed() override { return fUsed; }
+    void setRAMBudget(size_t budget) override;
+    size_t getRAMBudget() override { return fBudget; }
+    void dumpPool() override;
+
+    PurgeStats getPurgeStats() override {
+        SkAutoMutexExclusive autoMutexAcquire(fMutex);
+        return fPurgeStats;
+    }
+
+    #if SK_LAZY_CACHE_STATS  // Defined in SkDiscardableMemoryPool.h
+    int getCacheHits() override { return fCacheHits; }
+    int getCacheMisses() override { return fCacheMisses; }
+    void resetCacheHitsAndMisses() override {
+        fCacheHits = fCacheMisses = 0;
+    }
+    int          fCacheHits = 0;
+    int          fCacheMisses = 0;
+    #endif  // SK_LAZY_CACHE_STATS
+
+private:
+    // Maps new locked memory, in a memfd if 'shared'. Memory that fails to get a memfd isn't
+    // shared, like that from create().
+    std::unique_ptr<SkSharedDiscardableMemory> make(size_t bytes, bool shared);
+    std::unique_ptr<SkSharedDiscardableMemory> add(int fd, void* base, size_t bytes, bool locked);
+    void dumpDownTo(size_t budget);
+    void release(SharedDiscardableMemory*);
+
+    /** called by SharedDiscardableMemory */
+    void remove(SharedDiscardableMemory*);
+    bool lock(SharedDiscardableMemory*);
+    void unlock(SharedDiscardableMemory*);
+    int dupFD(SharedDiscardableMemory*);
+
+    friend class SharedDiscardableMemory;
+
+    SkMutex      fMutex;
+    size_t       fBudget;
+    size_t       fUsed = 0;
+    PurgeStats   fPurgeStats;
+    SkTInternalLList<SharedDiscardableMemory> fList;
+};
+
+class SharedDiscardableMemory final : public SkSharedDiscardableMemory {
+public:
+    SharedDiscardableMemory(sk_sp<SharedDiscardableMemoryPool> pool,
+                            int fd,
+                            void* base,
+                            size_t bytes,
+                            bool locked)
+            : fPool(std::move(pool)), fFD(fd), fBase(base), fBytes(bytes), fLocked(locked) {}
+
+    ~SharedDiscardableMemory() override {
+        SkASSERT(!fLocked); // contract for SkDiscardableMemory
+        fPool->remove(this);
+    }
+
+    bool lock() override {
+        SkASSERT(!fLocked); // contract for SkDiscardableMemory
+        return fPool->lock(this);
+    }
+
+    void* data() override {
+        SkASSERT(fLocked); // contract for SkDiscardableMemory
+        return static_cast<char*>(fBase) + kDataOffset;
+    }
+
+    void unlock() override {
+        SkASSERT(fLocked); // contract for SkDiscardableMemory
+        fPool->unlock(this);
+    }
+
+    int dupFD() override { return fPool->dupFD(this); }
+    size_t size() const override { return fBytes; }
+
+private:
+    Header* header() const { return static_cast<Header*>(fBase); }
+    size_t mappedSize() const { return kDataOffset + fBytes; }
+
+    SK_DECLARE_INTERNAL_LLIST_INTERFACE(SharedDiscardableMemory);
+    sk_sp<SharedDiscardableMemoryPool> fPool;
+    // Both are released once the memory is purged, or found to be purged by another process.
+    // fFD is -1 for memory that isn't shared, which is an anonymous mapping.
+    int                                fFD;
+    void*                              fBase;
+    const size_t                       fBytes;
+    bool                               fLocked;
+
+    friend class SharedDiscardableMemoryPool;
+};
+
+SkDiscardableMemory* SharedDiscardableMemoryPool::create(size_t bytes) {
+    // Memory that no other process sees doesn't need a file descriptor, which the process may
+    // have too few of for every allocation in a cache.
+    return this->make(bytes, /*shared=*/false).release();
+}
+
+std::unique_ptr<SkSharedDiscardableMemory> SharedDiscardableMemoryPool::makeShared(size_t bytes) {
+    return this->make(bytes, /*shared=*/true);
+}
+
+std::unique_ptr<SkSharedDiscardableMemory> SharedDiscardableMemoryPool::make(size_t bytes,
+                                                                             bool shared) {
+    if (bytes == 0 || bytes > SIZE_MAX - kDataOffset) {
+        return nullptr;
+    }
+    const size_t mappedSize = kDataOffset + bytes;
+    int fd = shared ? create_memfd("skia-discardable", MFD_CLOEXEC | MFD_ALLOW_SEALING) : -1;
+    void* base = nullptr;
+    if (fd >= 0) {
+        // Seal the size, so that no process can make the others' mappings fault by shrinking it.
+        if (ftruncate(fd, mappedSize) != 0 ||
+            fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0 ||
+            !(base = map(fd, mappedSize))) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    // Without a memfd (e.g. the process is out of descriptors) the memory works, but dupFD()
+    // returns -1.
+    if (!base && !(base = map_anonymous(mappedSize))) {
+        return nullptr;
+    }
+    Header* header = new (base) Header;
+    header->fState.store(1, std::memory_order_relaxed);
+    header->fMagic = kMagic;
+    header->fSize = bytes;
+    return this->add(fd, base, bytes, /*locked=*/true);
+}
+
+std::unique_ptr<SkSharedDiscardableMemory> SharedDiscardableMemoryPool::adopt(int fd) {
+    struct stat st;
+    const int seals = fcntl(fd, F_GET_SEALS);
+    if (fstat(fd, &st) != 0 || seals < 0 || !(seals & F_SEAL_SHRINK) ||
+        st.st_size <= (off_t)kDataOffset) {
+        close(fd);
+        return nullptr;
+    }
+    const size_t mappedSize = static_cast<size_t>(st.st_size);
+    void* base = map(fd, mappedSize);
+    if (!base) {
+        close(fd);
+        return nullptr;
+    }
+    const Header* header = static_cast<const Header*>(base);
+    if (header->fMagic != kMagic || header->fSize != mappedSize - kDataOffset) {
+        munmap(base, mappedSize);
+        close(fd);
+        return nullptr;
+    }
+    return this->add(fd, base, mappedSize - kDataOffset, /*locked=*/false);
+}
+
+std::unique_ptr<SkSharedDiscardableMemory> SharedDiscardableMemoryPool::add(int fd,
+                                                                            void* base,
+                                                                            size_t bytes,
+                                                                            bool locked) {
+    auto dm = std::make_unique<SharedDiscardableMemory>(
+            sk_ref_sp(this), fd, base, bytes, locked);
+    SkAutoMutexExclusive autoMutexAcquire(fMutex);
+    fList.addToHead(dm.get());
+    fUsed += bytes;
+    this->dumpDownTo(fBudget);
+    return dm;
+}
+
+void SharedDiscardableMemoryPool::release(SharedDiscardableMemory* dm) {
+    fMutex.assertHeld();
+    SkASSERT(dm->fBase);
+    munmap(dm->fBase, dm->mappedSize());
+    if (dm->fFD >= 0) {
+        close(dm->fFD);
+    }
+    dm->fBase = nullptr;
+    dm->fFD = -1;
+    SkASSERT(fUsed >= dm->fBytes);
+    fUsed -= dm->fBytes;
+    // Released DMs are taken out of the list, but not deleted.
+    fList.remove(dm);
+}
+
+void SharedDiscardableMemoryPool::dumpDownTo(size_t budget) {
+    fMutex.assertHeld();
+    using Iter = SkTInternalLList<SharedDiscardableMemory>::Iter;
+    Iter iter;
+    SharedDiscardableMemory* cur = iter.init(fList, Iter::kTail_IterStart);
+    while (fUsed > budget && cur) {
+        SharedDiscardableMemory* dm = cur;
+        cur = iter.prev();
+        if (dm->fLocked) {
+            continue;
+        }
+        uint32_t state = 0;
+        if (dm->header()->fState.compare_exchange_strong(state, kPurged,
+                                                         std::memory_order_acquire)) {
+            // No process has it locked, so free its pages for all of them.
+            if (dm->fFD >= 0) {
+                fallocate(dm->fFD, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                          kDataOffset, dm->fBytes);
+            } else {
+                madvise(static_cast<char*>(dm->fBase) + kDataOffset, dm->fBytes, MADV_DONTNEED);
+            }
+            fPurgeStats.fPurges += 1;
+            fPurgeStats.fPurgedBytes += dm->fBytes;
+        } else if (state != kPurged) {
+            continue;  // locked by another process
+        }
+        this->release(dm);
+    }
+}
+
+void SharedDiscardableMemoryPool::remove(SharedDiscardableMemory* dm) {
+    SkAutoMutexExclusive autoMutexAcquire(fMutex);
+    // This is called by dm's destructor. Other processes may still use the memory, so only unmap
+    // it; the kernel frees it once the last process does.
+    if (dm->fBase) {
+        this->release(dm);
+    } else {
+        SkASSERT(!fList.isInList(dm));
+    }
+}
+
+bool SharedDiscardableMemoryPool::lock(SharedDiscardableMemory* dm) {
+    SkAutoMutexExclusive autoMutexAcquire(fMutex);
+    if (!dm->fBase) {
+        #if SK_LAZY_CACHE_STATS
+        ++fCacheMisses;
+        #endif  // SK_LAZY_CACHE_STATS
+        return false;
+    }
+    std::atomic<uint32_t>& state = dm->header()->fState;
+    uint32_t locks = state.load(std::memory_order_relaxed);
+    do {
+        if (locks == kPurged) {
+            // Purged by another process.
+            this->release(dm);
+            #if SK_LAZY_CACHE_STATS
+            ++fCacheMisses;
+            #endif  // SK_LAZY_CACHE_STATS
+            return false;
+        }
+    } while (!state.compare_exchange_weak(locks, locks + 1, std::memory_order_acquire));
+    dm->fLocked = true;
+    fList.remove(dm);
+    fList.addToHead(dm);
+    #if SK_LAZY_CACHE_STATS
+    ++fCacheHits;
+    #endif  // SK_LAZY_CACHE_STATS
+    return true;
+}
+
+void SharedDiscardableMemoryPool::unlock(SharedDiscardableMemory* dm) {
+    SkAutoMutexExclusive autoMutexAcquire(fMutex);
+    dm->fLocked = false;
+    if (dm->header()->fState.fetch_sub(1, std::memory_order_release) == 1) {
+#if defined(MADV_COLD)
+        // Until it's purged, let the kernel reclaim it first under memory pressure.
+        madvise(dm->fBase, dm->mappedSize(), MADV_COLD);
+#endif
+    }
+    this->dumpDownTo(fBudget);
+}
+
+int SharedDiscardableMemoryPool::dupFD(SharedDiscardableMemory* dm) {
+    SkAutoMutexExclusive autoMutexAcquire(fMutex);
+    return dm->fBase && dm->fFD >= 0 ? fcntl(dm->fFD, F_DUPFD_CLOEXEC, 0) : -1;
+}
+
+void SharedDiscardableMemoryPool::setRAMBudget(size_t budget) {
+    SkAutoMutexExclusive autoMutexAcquire(fMutex);
+    fBudget = budget;
+    this->dumpDownTo(fBudget);
+}
+
+void SharedDiscardableMemoryPool::dumpPool() {
+    SkAutoMutexExclusive autoMutexAcquire(fMutex);
+    this->dumpDownTo(0);
+}
+
+}  // namespace
+
+sk_sp<SkSharedDiscardableMemoryPool> SkSharedDiscardableMemoryPool::Make(size_t budget) {
+    // Check that the kernel has memfds.
+    const int fd = create_memfd("skia-discardable", MFD_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    close(fd);
+    return sk_make_sp<SharedDiscardableMemoryPool>(budget);
+}
+
+#else
+
+sk_sp<SkSharedDiscardableMemoryPool> SkSharedDiscardableMemoryPool::Make(size_t) {
+    return nullptr;
+}
+
+#endif
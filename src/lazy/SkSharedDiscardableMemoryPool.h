@@ -0,0 +1,67 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkSharedDiscardableMemoryPool_DEFINED
+#define SkSharedDiscardableMemoryPool_DEFINED
+
+#include "include/core/SkRefCnt.h"
+#include "include/private/chromium/SkDiscardableMemory.h"
+#include "src/lazy/SkDiscardableMemoryPool.h"
+
+#include <cstddef>
+#include <memory>
+
+/**
+ *  Discardable memory whose pages live in a Linux memfd, so that it can be mapped by other
+ *  processes without copying it, e.g. to hand a decoded image from one worker process to another.
+ */
+class SkSharedDiscardableMemory : public SkDiscardableMemory {
+public:
+    /**
+     *  Returns a new file descriptor for the memory, which the caller owns and can send to another
+     *  process (e.g. with SCM_RIGHTS) to adopt. Returns -1 if the memory has been purged, or
+     *  isn't shared.
+     */
+    virtual int dupFD() = 0;
+
+    /** The number of bytes returned by data(). */
+    virtual size_t size() const = 0;
+};
+
+/**
+ *  An SkDiscardableMemoryPool of memfd-backed memory. Unlocked memory is marked cold, so the
+ *  kernel reclaims it before other memory under pressure, and unlocked memory over the budget is
+ *  purged, freeing its pages in every process that maps it.
+ *
+ *  Only memory from makeShared() and adopt() holds a memfd. Memory from create() is never shared,
+ *  so it's an anonymous mapping, and a cache of it doesn't keep a descriptor open per entry. It's
+ *  an SkSharedDiscardableMemory whose dupFD() returns -1.
+ *
+ *  Whether memory is locked is shared between the processes that map it: lock() fails once any
+ *  of them has purged it, and a process only purges memory that no process has locked.
+ */
+class SkSharedDiscardableMemoryPool : public SkDiscardableMemoryPool {
+public:
+    /** Returns nullptr where memfds aren't supported. */
+    static sk_sp<SkSharedDiscardableMemoryPool> Make(size_t budget);
+
+    /**
+     *  Like create(), but returns the memory as shared memory. It's locked. If a memfd can't be
+     *  made (e.g. the process is out of descriptors), the memory isn't shared: dupFD() returns -1.
+     */
+    virtual std::unique_ptr<SkSharedDiscardableMemory> makeShared(size_t bytes) = 0;
+
+    /**
+     *  Maps the memory of a file descriptor returned by SkSharedDiscardableMemory::dupFD(),
+     *  possibly in another process, and takes ownership of the descriptor. The memory is unlocked,
+     *  and counts against this pool's budget while mapped. Returns nullptr, and closes the
+     *  descriptor, if it isn't shared discardable memory or can't be mapped.
+     */
+    virtual std::unique_ptr<SkSharedDiscardableMemory> adopt(int fd) = 0;
+};
+
+#endif  // SkSharedDiscardableMemoryPool_DEFINED
@@ -3389,7 +3389,18 @@ STAGE(matrix_perspective, const float* m) {
 SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         F* r, F* g, F* b, F* a) {
     F fr, br, fg, bg, fb, bb, fa, ba;
-#if defined(SKRP_CPU_HSW)
+#if defined(SKRP_CPU_SKX)
+    if (c->stopCount <= 16) {
+        fr = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->fs[0]));
+        br = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->bs[0]));
+        fg = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->fs[1]));
+        bg = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->bs[1]));
+        fb = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->fs[2]));
+        bb = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->bs[2]));
+        fa = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->fs[3]));
+        ba = _mm512_permutexvar_ps((__m512i)idx, _mm512_loadu_ps(c->bs[3]));
+    } else
+#elif defined(SKRP_CPU_HSW)
     if (c->stopCount <=8) {
         fr = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->fs[0]), (__m256i)idx);
         br = _mm256_permutevar8x32_ps(_mm256_loadu_ps(c->bs[0]), (__m256i)idx);
@@ -5095,7 +5106,10 @@ namespace lowp {
 
 #else  // We are compiling vector code with Clang... let's make some lowp stages!
 
-#if defined(SKRP_CPU_SKX) || defined(SKRP_CPU_HSW) || defined(SKRP_CPU_LASX)
+#if defined(SKRP_CPU_SKX)
+    // 32 pixels per stride, so 16-bit channels fill a 512-bit register.
+    template <typename T> using V = Vec<32, T>;
+#elif defined(SKRP_CPU_HSW) || defined(SKRP_CPU_LASX)
     template <typename T> using V = Vec<16, T>;
 #else
     template <typename T> using V = Vec<8, T>;
@@ -5430,8 +5444,13 @@ SI U32 trunc_(F x) { return (U32)cast<I32>(x); }
 // Use approximate instructions and one Newton-Raphson step to calculate 1/x.
 SI F rcp_precise(F x) {
 #if defined(SKRP_CPU_SKX)
-    F e = _mm512_rcp14_ps(x);
-    return _mm512_fnmadd_ps(x, e, _mm512_set1_ps(2.0f)) * e;
+    auto rcp = [](__m512 v) {
+        __m512 e = _mm512_rcp14_ps(v);
+        return _mm512_mul_ps(_mm512_fnmadd_ps(v, e, _mm512_set1_ps(2.0f)), e);
+    };
+    __m512 lo,hi;
+    split(x, &lo,&hi);
+    return join<F>(rcp(lo), rcp(hi));
 #elif defined(SKRP_CPU_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
@@ -5458,7 +5477,9 @@ SI F rcp_precise(F x) {
 }
 SI F sqrt_(F x) {
 #if defined(SKRP_CPU_SKX)
-    return _mm512_sqrt_ps(x);
+    __m512 lo,hi;
+    split(x, &lo,&hi);
+    return join<F>(_mm512_sqrt_ps(lo), _mm512_sqrt_ps(hi));
 #elif defined(SKRP_CPU_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
@@ -5503,7 +5524,9 @@ SI F floor_(F x) {
     split(x, &lo,&hi);
     return join<F>(vrndmq_f32(lo), vrndmq_f32(hi));
 #elif defined(SKRP_CPU_SKX)
-    return _mm512_floor_ps(x);
+    __m512 lo,hi;
+    split(x, &lo,&hi);
+    return join<F>(_mm512_floor_ps(lo), _mm512_floor_ps(hi));
 #elif defined(SKRP_CPU_HSW)
     __m256 lo,hi;
     split(x, &lo,&hi);
@@ -5533,7 +5556,7 @@ SI F floor_(F x) {
 // Note: on neon this is a saturating multiply while the others are not.
 SI I16 scaled_mult(I16 a, I16 b) {
 #if defined(SKRP_CPU_SKX)
-    return (I16)_mm256_mulhrs_epi16((__m256i)a, (__m256i)b);
+    return (I16)_mm512_mulhrs_epi16((__m512i)a, (__m512i)b);
 #elif defined(SKRP_CPU_HSW)
     return (I16)_mm256_mulhrs_epi16((__m256i)a, (__m256i)b);
 #elif defined(SKRP_CPU_SSE41) || defined(SKRP_CPU_AVX)
@@ -5598,6 +5621,8 @@ STAGE_GG(seed_shader, NoCtx) {
     static constexpr float iota[] = {
         0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f,
         8.5f, 9.5f,10.5f,11.5f,12.5f,13.5f,14.5f,15.5f,
+       16.5f,17.5f,18.5f,19.5f,20.5f,21.5f,22.5f,23.5f,
+       24.5f,25.5f,26.5f,27.5f,28.5f,29.5f,30.5f,31.5f,
     };
     static_assert(std::size(iota) >= SkRasterPipeline_kMaxStride);
 
@@ -5844,17 +5869,29 @@ SI void store(T* ptr, V v) {
         return V{ ptr[ix[ 0]], ptr[ix[ 1]], ptr[ix[ 2]], ptr[ix[ 3]],
                   ptr[ix[ 4]], ptr[ix[ 5]], ptr[ix[ 6]], ptr[ix[ 7]],
                   ptr[ix[ 8]], ptr[ix[ 9]], ptr[ix[10]], ptr[ix[11]],
-                  ptr[ix[12]], ptr[ix[13]], ptr[ix[14]], ptr[ix[15]], };
+                  ptr[ix[12]], ptr[ix[13]], ptr[ix[14]], ptr[ix[15]],
+                  ptr[ix[16]], ptr[ix[17]], ptr[ix[18]], ptr[ix[19]],
+                  ptr[ix[20]], ptr[ix[21]], ptr[ix[22]], ptr[ix[23]],
+                  ptr[ix[24]], ptr[ix[25]], ptr[ix[26]], ptr[ix[27]],
+                  ptr[ix[28]], ptr[ix[29]], ptr[ix[30]], ptr[ix[31]], };
     }
 
     template<>
     F gather(const float* ptr, U32 ix) {
-        return _mm512_i32gather_ps((__m512i)ix, ptr, 4);
+        __m512i lo, hi;
+        split(ix, &lo, &hi);
+
+        return join<F>(_mm512_i32gather_ps(lo, ptr, 4),
+                       _mm512_i32gather_ps(hi, ptr, 4));
     }
 
     template<>
     U32 gather(const uint32_t* ptr, U32 ix) {
-        return (U32)_mm512_i32gather_epi32((__m512i)ix, ptr, 4);
+        __m512i lo, hi;
+        split(ix, &lo, &hi);
+
+        return join<U32>(_mm512_i32gather_epi32(lo, ptr, 4),
+                         _mm512_i32gather_epi32(hi, ptr, 4));
     }
 
 #elif defined(SKRP_CPU_HSW)
@@ -5904,10 +5941,15 @@ SI void store(T* ptr, V v) {
 
 SI void from_8888(U32 rgba, U16* r, U16* g, U16* b, U16* a) {
 #if defined(SKRP_CPU_SKX)
-    rgba = (U32)_mm512_permutexvar_epi64(_mm512_setr_epi64(0,1,4,5,2,3,6,7), (__m512i)rgba);
+    // _mm512_packus_epi32() interleaves its arguments 128 bits at a time, so first gather the
+    // even 128-bit lanes (pixels 0-3, 8-11, ...) into one register and the odd ones into another.
     auto cast_U16 = [](U32 v) -> U16 {
-        return (U16)_mm256_packus_epi32(_mm512_castsi512_si256((__m512i)v),
-                    _mm512_extracti64x4_epi64((__m512i)v, 1));
+        __m512i _01,_23;
+        split(v, &_01,&_23);
+        const __m512i evens = _mm512_setr_epi64(0,1, 4, 5,  8, 9, 12,13),
+                      odds  = _mm512_setr_epi64(2,3, 6, 7, 10,11, 14,15);
+        return (U16)_mm512_packus_epi32(_mm512_permutex2var_epi64(_01, evens, _23),
+                                        _mm512_permutex2var_epi64(_01, odds , _23));
     };
 #elif defined(SKRP_CPU_HSW)
     // Swap the middle 128-bit lanes to make _mm256_packus_epi32() in cast_U16() work out nicely.
@@ -6405,7 +6447,25 @@ SI void gradient_lookup(const SkRasterPipeline_GradientCtx* c, U32 idx, F t,
                         U16* r, U16* g, U16* b, U16* a) {
 
     F fr, fg, fb, fa, br, bg, bb, ba;
-#if defined(SKRP_CPU_HSW)
+#if defined(SKRP_CPU_SKX)
+    if (c->stopCount <= 16) {
+        __m512i lo, hi;
+        split(idx, &lo, &hi);
+
+        auto lookup = [&](const float* table) {
+            __m512 t = _mm512_loadu_ps(table);
+            return join<F>(_mm512_permutexvar_ps(lo, t), _mm512_permutexvar_ps(hi, t));
+        };
+        fr = lookup(c->fs[0]);
+        br = lookup(c->bs[0]);
+        fg = lookup(c->fs[1]);
+        bg = lookup(c->bs[1]);
+        fb = lookup(c->fs[2]);
+        bb = lookup(c->bs[2]);
+        fa = lookup(c->fs[3]);
+        ba = lookup(c->bs[3]);
+    } else
+#elif defined(SKRP_CPU_HSW)
     if (c->stopCount <=8) {
         __m256i lo, hi;
         split(idx, &lo, &hi);
@@ -43,6 +43,7 @@
 #include "include/encode/SkJpegEncoder.h"
 #include "include/pathops/SkPathOps.h"
 #include "include/private/base/SkDebug.h"
+#include "include/private/base/SkMutex.h"
 #include "include/private/base/SkTemplates.h"
 #include "include/private/base/SkTo.h"
 #include "src/base/SkScopeExit.h"
@@ -279,7 +280,7 @@ sk_sp<SkDevice> SkPDFDevice::createDevice(const CreateInfo& cinfo, const SkPaint
         return SkBitmapDevice::Create(cinfo.fInfo,
                                       SkSurfaceProps());
     }
-    return sk_make_sp<SkPDFDevice>(cinfo.fInfo.dimensions(), fDocument);
+    return sk_make_sp<SkPDFDevice>(cinfo.fInfo.dimensions(), fDocument, SkMatrix::I(), fPage);
 }
 
 // A helper class to automatically finish a ContentEntry at the end of a
@@ -364,17 +365,24 @@ private:
 
 ////////////////////////////////////////////////////////////////////////////////
 
-SkPDFDevice::SkPDFDevice(SkISize pageSize, SkPDFDocument* doc, const SkMatrix& transform)
+SkPDFDevice::SkPDFDevice(SkISize pageSize, SkPDFDocument* doc, const SkMatrix& transform,
+                         SkPDFPage* page)
         : SkClipStackDevice(SkImageInfo::MakeUnknown(pageSize.width(), pageSize.height()),
                             SkSurfaceProps())
         , fInitialTransform(transform)
         , fMarkManager(doc, &fContent)
-        , fDocument(doc) {
+        , fDocument(doc)
+        , fPage(page ? page : doc->currentPage()) {
     SkASSERT(!pageSize.isEmpty());
 }
 
 SkPDFDevice::~SkPDFDevice() = default;
 
+const SkMatrix& SkPDFDevice::pageTransform() const {
+    // If not on a page (like when emitting a Type3 glyph) return identity.
+    return fPage ? fPage->fTransform : SkMatrix::I();
+}
+
 void SkPDFDevice::reset() {
     fGraphicStateResources.reset();
     fXObjectResources.reset();
@@ -385,13 +393,13 @@ void SkPDFDevice::reset() {
 }
 
 void SkPDFDevice::drawAnnotation(const SkRect& rect, const char key[], SkData* value) {
-    if (!value || !fDocument->hasCurrentPage()) {
+    if (!value || !fPage) {
         return;
     }
     // Annotations are specified in absolute coordinates, so the page xform maps from device space
     // to the global space, and applies the document transform.
     SkMatrix pageXform = this->deviceToGlobal().asM33();
-    pageXform.postConcat(fDocument->currentPageTransform());
+    pageXform.postConcat(this->pageTransform());
     if (rect.isEmpty()) {
         if (!strcmp(key, SkPDFGetElemIdKey())) {
             int elemId;
@@ -403,8 +411,8 @@ void SkPDFDevice::drawAnnotation(const SkRect& rect, const char key[], SkData* v
         if (!strcmp(SkAnnotationKeys::Define_Named_Dest_Key(), key)) {
             SkPoint p = this->localToDevice().mapXY(rect.x(), rect.y());
             pageXform.mapPoints(&p, 1);
-            auto pg = fDocument->currentPage();
-            fDocument->fNamedDestinations.push_back(SkPDFNamedDestination{sk_ref_sp(value), p, pg});
+            fPage->fNamedDestinations.push_back(
+                    SkPDFNamedDestination{sk_ref_sp(value), p, fPage->fRef});
         }
         return;
     }
@@ -429,7 +437,7 @@ void SkPDFDevice::drawAnnotation(const SkRect& rect, const char key[], SkData* v
     if (linkType != SkPDFLink::Type::kNone) {
         std::unique_ptr<SkPDFLink> link = std::make_unique<SkPDFLink>(
             linkType, value, transformedRect, fMarkManager.elemId());
-        fDocument->fCurrentPageLinks.push_back(std::move(link));
+        fPage->fLinks.push_back(std::move(link));
     }
 }
 
@@ -505,7 +513,7 @@ void SkPDFDevice::drawPoints(SkCanvas::PointMode mode,
     if (fMarkManager.hasActiveMark()) {
         // Destinations are in absolute coordinates.
         SkMatrix pageXform = this->deviceToGlobal().asM33();
-        pageXform.postConcat(fDocument->currentPageTransform());
+        pageXform.postConcat(this->pageTransform());
         // The points do not already have localToDevice applied.
         pageXform.preConcat(this->localToDevice());
 
@@ -615,11 +623,15 @@ void SkPDFDevice::setGraphicState(SkPDFIndirectReference gs, SkDynamicMemoryWStr
 
 void SkPDFDevice::clearMaskOnGraphicState(SkDynamicMemoryWStream* contentStream) {
     // The no-softmask graphic state is used to "turn off" the mask for later draw calls.
-    SkPDFIndirectReference& noSMaskGS = fDocument->fNoSmaskGraphicState;
-    if (!noSMaskGS) {
-        SkPDFDict tmp("ExtGState");
-        tmp.insertName("SMask", "None");
-        noSMaskGS = fDocument->emit(tmp);
+    SkPDFIndirectReference noSMaskGS;
+    {
+        SkAutoMutexExclusive lock(fDocument->fCanonMutex);
+        if (!fDocument->fNoSmaskGraphicState) {
+            SkPDFDict tmp("ExtGState");
+            tmp.insertName("SMask", "None");
+            fDocument->fNoSmaskGraphicState = fDocument->emit(tmp);
+        }
+        noSMaskGS = fDocument->fNoSmaskGraphicState;
     }
     this->setGraphicState(noSMaskGS, contentStream);
 }
@@ -687,7 +699,7 @@ void SkPDFDevice::internalDrawPath(const SkClipStack& clipStack,
     if (fMarkManager.hasActiveMark()) {
         // Destinations are in absolute coordinates.
         SkMatrix pageXform = this->deviceToGlobal().asM33();
-        pageXform.postConcat(fDocument->currentPageTransform());
+        pageXform.postConcat(this->pageTransform());
         // The path does not already have localToDevice / ctm / matrix applied.
         pageXform.preConcat(matrix);
 
@@ -904,22 +916,31 @@ void SkPDFDevice::internalDrawGlyphRun(
         return;
     }
 
-    sk_sp<SkPDFStrike> pdfStrike = SkPDFStrike::Make(fDocument, glyphRunFont, runPaint);
-    if (!pdfStrike) {
-        return;
-    }
-    const SkTypeface& typeface = pdfStrike->fPath.fStrikeSpec.typeface();
+    sk_sp<SkPDFStrike> pdfStrike;
+    const SkAdvancedTypefaceMetrics* metrics;
+    const std::vector<SkUnichar>* glyphToUnicode;
+    THashMap<SkGlyphID, SkString>* glyphToUnicodeEx;
+    SkAdvancedTypefaceMetrics::FontType initialFontType;
+    {
+        SkAutoMutexExclusive lock(fDocument->fCanonMutex);
+        pdfStrike = SkPDFStrike::Make(fDocument, glyphRunFont, runPaint);
+        if (!pdfStrike) {
+            return;
+        }
+        const SkTypeface& typeface = pdfStrike->fPath.fStrikeSpec.typeface();
 
-    const SkAdvancedTypefaceMetrics* metrics = SkPDFFont::GetMetrics(typeface, fDocument);
-    if (!metrics) {
-        return;
-    }
+        metrics = SkPDFFont::GetMetrics(typeface, fDocument);
+        if (!metrics) {
+            return;
+        }
 
-    const std::vector<SkUnichar>& glyphToUnicode = SkPDFFont::GetUnicodeMap(typeface, fDocument);
-    THashMap<SkGlyphID, SkString>& glyphToUnicodeEx=SkPDFFont::GetUnicodeMapEx(typeface, fDocument);
+        glyphToUnicode = &SkPDFFont::GetUnicodeMap(typeface, fDocument);
+        glyphToUnicodeEx = &SkPDFFont::GetUnicodeMapEx(typeface, fDocument);
 
-    // TODO: FontType should probably be on SkPDFStrike?
-    SkAdvancedTypefaceMetrics::FontType initialFontType = SkPDFFont::FontType(*pdfStrike, *metrics);
+        // TODO: FontType should probably be on SkPDFStrike?
+        initialFontType = SkPDFFont::FontType(*pdfStrike, *metrics);
+    }
+    const SkTypeface& typeface = pdfStrike->fPath.fStrikeSpec.typeface();
 
     SkClusterator clusterator(glyphRun);
 
@@ -950,7 +971,7 @@ void SkPDFDevice::internalDrawGlyphRun(
     // Destinations are in absolute coordinates.
     // The glyphs bounds go through the localToDevice separately for clipping.
     SkMatrix pageXform = this->deviceToGlobal().asM33();
-    pageXform.postConcat(fDocument->currentPageTransform());
+    pageXform.postConcat(this->pageTransform());
 
     fMarkManager.beginMark();
     if (!glyphRun.text().empty()) {
@@ -969,6 +990,10 @@ void SkPDFDevice::internalDrawGlyphRun(
     GlyphPositioner glyphPositioner(out, glyphRunFont.getSkewX(), offset);
     SkPDFFont* font = nullptr;
 
+    // Fonts are shared by pages drawn concurrently, so note their glyph usage once per run.
+    std::vector<std::pair<SkPDFFont*, SkGlyphID>> usedGlyphs;
+    usedGlyphs.reserve(glyphCount);
+
     SkBulkGlyphMetricsAndPaths paths{pdfStrike->fPath.fStrikeSpec};
     auto glyphs = paths.glyphs(glyphRun.glyphsIDs());
 
@@ -989,7 +1014,7 @@ void SkPDFDevice::internalDrawGlyphRun(
             // ToUnicode can only handle one glyph in a cluster.
             if (clusterUnichar >= 0 && c.fGlyphCount == 1) {
                 SkGlyphID gid = glyphIDs[glyphIndex];
-                SkUnichar fontUnichar = gid < glyphToUnicode.size() ? glyphToUnicode[gid] : 0;
+                SkUnichar fontUnichar = gid < glyphToUnicode->size() ? (*glyphToUnicode)[gid] : 0;
 
                 // The regular cmap can handle this if there is one glyph in the cluster,
                 // one code point in the cluster, and the glyph maps to the code point.
@@ -1001,9 +1026,10 @@ void SkPDFDevice::internalDrawGlyphRun(
                 // and the mapping matches or can be added.
                 // UTF-16 uses at most 2x space of UTF-8; 64 code points seems enough.
                 if (!toUnicode && fontUnichar <= 0 && c.fTextByteLength < 256) {
-                    SkString* unicodes = glyphToUnicodeEx.find(gid);
+                    SkAutoMutexExclusive lock(fDocument->fCanonMutex);
+                    SkString* unicodes = glyphToUnicodeEx->find(gid);
                     if (!unicodes) {
-                        glyphToUnicodeEx.set(gid, SkString(c.fUtf8Text, c.fTextByteLength));
+                        glyphToUnicodeEx->set(gid, SkString(c.fUtf8Text, c.fTextByteLength));
                         toUnicode = true;
                     } else if (unicodes->equals(c.fUtf8Text, c.fTextByteLength)) {
                         toUnicode = true;
@@ -1040,7 +1066,10 @@ void SkPDFDevice::internalDrawGlyphRun(
             }
             if (needs_new_font(font, glyphs[glyphIndex], initialFontType)) {
                 // Not yet specified font or need to switch font.
-                font = pdfStrike->getFontResource(glyphs[glyphIndex]);
+                {
+                    SkAutoMutexExclusive lock(fDocument->fCanonMutex);
+                    font = pdfStrike->getFontResource(glyphs[glyphIndex]);
+                }
                 SkASSERT(font);  // All preconditions for SkPDFFont::GetFontResource are met.
                 glyphPositioner.setFont(font);
                 SkPDFWriteResourceName(out, SkPDFResourceType::kFont,
@@ -1050,7 +1079,7 @@ void SkPDFDevice::internalDrawGlyphRun(
                 out->writeText(" Tf\n");
 
             }
-            font->noteGlyphUsage(gid);
+            usedGlyphs.emplace_back(font, gid);
             SkGlyphID encodedGlyph = font->glyphToPDFFontEncoding(gid);
             SkScalar advance = advanceScale * glyphs[glyphIndex]->advanceX();
             if (fMarkManager.hasActiveMark()) {
@@ -1060,6 +1089,11 @@ void SkPDFDevice::internalDrawGlyphRun(
             glyphPositioner.writeGlyph(encodedGlyph, advance, xy);
         }
     }
+
+    SkAutoMutexExclusive lock(fDocument->fCanonMutex);
+    for (auto [usedFont, gid] : usedGlyphs) {
+        usedFont->noteGlyphUsage(gid);
+    }
 }
 
 void SkPDFDevice::onDrawGlyphRunList(SkCanvas*,
@@ -1091,7 +1125,7 @@ void SkPDFDevice::drawFormXObject(SkPDFIndirectReference xObject, SkDynamicMemor
     if (fMarkManager.hasActiveMark() && shape) {
         // Destinations are in absolute coordinates.
         SkMatrix pageXform = this->deviceToGlobal().asM33();
-        pageXform.postConcat(fDocument->currentPageTransform());
+        pageXform.postConcat(this->pageTransform());
         // The shape already has localToDevice applied.
 
         SkRect shapeBounds = shape->computeTightBounds();
@@ -1789,14 +1823,19 @@ void SkPDFDevice::internalDrawImageRect(SkKeyedImage imageSubset,
     }
 
     SkBitmapKey key = imageSubset.key();
-    SkPDFIndirectReference* pdfimagePtr = fDocument->fPDFBitmapMap.find(key);
-    SkPDFIndirectReference pdfimage = pdfimagePtr ? *pdfimagePtr : SkPDFIndirectReference();
-    if (!pdfimagePtr) {
-        SkASSERT(imageSubset);
-        pdfimage = SkPDFSerializeImage(imageSubset.image().get(), fDocument,
-                                       fDocument->metadata().fEncodingQuality);
-        SkASSERT((key != SkBitmapKey{{0, 0, 0, 0}, 0}));
-        fDocument->fPDFBitmapMap.set(key, pdfimage);
+    SkPDFIndirectReference pdfimage;
+    {
+        // Serializing only reserves the image's reference when there is an executor.
+        SkAutoMutexExclusive lock(fDocument->fCanonMutex);
+        SkPDFIndirectReference* pdfimagePtr = fDocument->fPDFBitmapMap.find(key);
+        pdfimage = pdfimagePtr ? *pdfimagePtr : SkPDFIndirectReference();
+        if (!pdfimagePtr) {
+            SkASSERT(imageSubset);
+            pdfimage = SkPDFSerializeImage(imageSubset.image().get(), fDocument,
+                                           fDocument->metadata().fEncodingQuality);
+            SkASSERT((key != SkBitmapKey{{0, 0, 0, 0}, 0}));
+            fDocument->fPDFBitmapMap.set(key, pdfimage);
+        }
     }
     SkASSERT(pdfimage != SkPDFIndirectReference());
     this->drawFormXObject(pdfimage, content.stream(), &shape);
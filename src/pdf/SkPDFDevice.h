@@ -43,6 +43,7 @@ enum class SkBlendMode;
 struct SkIRect;
 struct SkISize;
 struct SkImageInfo;
+struct SkPDFPage;
 struct SkPoint;
 struct SkRect;
 
@@ -68,12 +69,15 @@ public:
      *         for early serializing of large immutable objects, such
      *         as images (via SkPDFDocument::serialize()).
      *  @param initialTransform Transform to be applied to the entire page.
+     *  @param page  The page whose links and destinations this draws. If
+     *         nullptr, the document's current page, if any.
      */
     SkPDFDevice(SkISize pageSize, SkPDFDocument* document,
-                const SkMatrix& initialTransform = SkMatrix::I());
+                const SkMatrix& initialTransform = SkMatrix::I(),
+                SkPDFPage* page = nullptr);
 
     sk_sp<SkPDFDevice> makeCongruentDevice() {
-        return sk_make_sp<SkPDFDevice>(this->size(), fDocument);
+        return sk_make_sp<SkPDFDevice>(this->size(), fDocument, SkMatrix::I(), fPage);
     }
 
     ~SkPDFDevice() override;
@@ -183,6 +187,7 @@ private:
     bool fNeedsExtraSave = false;
     SkPDFGraphicStackState fActiveStackState;
     SkPDFDocument* fDocument;
+    SkPDFPage* fPage;
 
     ////////////////////////////////////////////////////////////////////////////
 
@@ -240,6 +245,9 @@ private:
 
     bool hasEmptyClip() const { return this->cs().isEmpty(this->bounds()); }
 
+    // The transform from the page's device to PDF page space, or identity if not on a page.
+    const SkMatrix& pageTransform() const;
+
     void reset();
 };
 
@@ -9,8 +9,10 @@
 
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMatrix.h"
+#include "include/core/SkPicture.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkStream.h"
@@ -42,6 +44,7 @@
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <memory>
 #include <new>
 #include <utility>
 
@@ -236,6 +239,9 @@ SkPDFDocument::SkPDFDocument(SkWStream* stream, SkPDF::Metadata metadata)
     , fRasterScale(fMetadata.fRasterDPI / SK_ScalarDefaultRasterDPI)
     , fInverseRasterScale(SK_ScalarDefaultRasterDPI / fMetadata.fRasterDPI)
     , fExecutor(fMetadata.fExecutor)
+    // Marked content is numbered in the order it is drawn, so tagged pages are drawn in order.
+    , fDrawPagesConcurrently(fExecutor && fMetadata.fConcurrentPages &&
+                             !fMetadata.fStructureElementTreeRoot)
     , fStructTree(fMetadata.fStructureElementTreeRoot, fMetadata.fOutline)
 {}
 
@@ -265,7 +271,7 @@ static SkSize operator*(SkSize u, SkScalar s) { return SkSize{u.width() * s, u.h
 
 SkCanvas* SkPDFDocument::onBeginPage(SkScalar width, SkScalar height) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
-    if (fPages.empty()) {
+    if (fPageRefs.empty()) {
         // if this is the first page if the document.
         {
             SkAutoMutexExclusive autoMutexAcquire(fMutex);
@@ -294,10 +300,23 @@ SkCanvas* SkPDFDocument::onBeginPage(SkScalar width, SkScalar height) {
     // bottom left. This matrix corrects for that, as well as the raster scale.
     initialTransform.setScaleTranslate(fInverseRasterScale, -fInverseRasterScale,
                                        0, fInverseRasterScale * pageSize.height());
-    fPageDevice = sk_make_sp<SkPDFDevice>(pageSize, this, initialTransform);
+    fPageRefs.push_back(this->reserveRef());
+    if (fDrawPagesConcurrently) {
+        // Record the page at the scale of its device, so the client sees the same canvas.
+        auto page = std::make_unique<ConcurrentPage>();
+        page->fSize = pageSize;
+        page->fPage.fRef = fPageRefs.back();
+        page->fPage.fTransform = initialTransform;
+        fConcurrentPages.push_back(std::move(page));
+        SkCanvas* canvas = fPageRecorder.beginRecording(SkRect::Make(pageSize));
+        canvas->scale(fRasterScale, fRasterScale);
+        return canvas;
+    }
+    fCurrentPage.fRef = fPageRefs.back();
+    fCurrentPage.fTransform = initialTransform;
+    fPageDevice = sk_make_sp<SkPDFDevice>(pageSize, this, initialTransform, &fCurrentPage);
     reset_object(&fCanvas, fPageDevice);
     fCanvas.scale(fRasterScale, fRasterScale);
-    fPageRefs.push_back(this->reserveRef());
     return &fCanvas;
 }
 
@@ -329,15 +348,15 @@ static SkPDFIndirectReference append_destinations(
     return doc->emit(destinations);
 }
 
-std::unique_ptr<SkPDFArray> SkPDFDocument::getAnnotations() {
+std::unique_ptr<SkPDFArray> SkPDFDocument::getAnnotations(const SkPDFPage& page) {
     std::unique_ptr<SkPDFArray> array;
-    size_t count = fCurrentPageLinks.size();
+    size_t count = page.fLinks.size();
     if (0 == count) {
         return array;  // is nullptr
     }
     array = SkPDFMakeArray();
     array->reserve(count);
-    for (const auto& link : fCurrentPageLinks) {
+    for (const auto& link : page.fLinks) {
         SkPDFDict annotation("Annot");
         populate_link_annotation(&annotation, link->fRect);
         if (link->fType == SkPDFLink::Type::kUrl) {
@@ -366,35 +385,62 @@ std::unique_ptr<SkPDFArray> SkPDFDocument::getAnnotations() {
     return array;
 }
 
-void SkPDFDocument::onEndPage() {
-    SkASSERT(!fCanvas.imageInfo().dimensions().isZero());
-    reset_object(&fCanvas);
-    SkASSERT(fPageDevice);
-
+std::unique_ptr<SkPDFDict> SkPDFDocument::makePage(SkPDFDevice* device,
+                                                   const SkPDFPage& pageInfo,
+                                                   size_t pageIndex) {
     auto page = SkPDFMakeDict("Page");
 
-    SkSize mediaSize = fPageDevice->imageInfo().dimensions() * fInverseRasterScale;
-    std::unique_ptr<SkStreamAsset> pageContent = fPageDevice->content();
-    auto resourceDict = fPageDevice->makeResourceDict();
-    SkASSERT(!fPageRefs.empty());
+    SkSize mediaSize = device->imageInfo().dimensions() * fInverseRasterScale;
+    std::unique_ptr<SkStreamAsset> pageContent = device->content();
+    auto resourceDict = device->makeResourceDict();
 
     page->insertObject("Resources", std::move(resourceDict));
     page->insertObject("MediaBox", SkPDFUtils::RectToArray(SkRect::MakeSize(mediaSize)));
 
-    if (std::unique_ptr<SkPDFArray> annotations = getAnnotations()) {
+    if (std::unique_ptr<SkPDFArray> annotations = getAnnotations(pageInfo)) {
         page->insertObject("Annots", std::move(annotations));
-        fCurrentPageLinks.clear();
     }
 
     page->insertRef("Contents", SkPDFStreamOut(nullptr, std::move(pageContent), this));
     // The StructParents unique identifier for each page is just its
     // 0-based page index.
-    page->insertInt("StructParents", SkToInt(this->currentPageIndex()));
+    page->insertInt("StructParents", SkToInt(pageIndex));
 
     // Tabs is PDF 1.5, but setting it checks an accessibility box.
     page->insertName("Tabs", "S");
+    return page;
+}
 
-    fPages.emplace_back(std::move(page));
+void SkPDFDocument::onEndPage() {
+    SkASSERT(!fPageRefs.empty());
+    if (fDrawPagesConcurrently) {
+        SkASSERT(!fConcurrentPages.empty());
+        sk_sp<SkPicture> picture = fPageRecorder.finishRecordingAsPicture();
+        ConcurrentPage* page = fConcurrentPages.back().get();
+        size_t pageIndex = fConcurrentPages.size() - 1;
+        // Pages are added to the document in order by onClose().
+        this->incrementJobCount();
+        fExecutor->add([this, page, pageIndex, picture = std::move(picture)]() {
+            auto device = sk_make_sp<SkPDFDevice>(page->fSize, this, page->fPage.fTransform,
+                                                  &page->fPage);
+            {
+                SkCanvas canvas(device);
+                picture->playback(&canvas);
+            }
+            page->fDict = this->makePage(device.get(), page->fPage, pageIndex);
+            this->signalJobComplete();
+        });
+        return;
+    }
+    SkASSERT(!fCanvas.imageInfo().dimensions().isZero());
+    reset_object(&fCanvas);
+    SkASSERT(fPageDevice);
+
+    fPages.emplace_back(this->makePage(fPageDevice.get(), fCurrentPage, fPages.size()));
+    for (SkPDFNamedDestination& dest : fCurrentPage.fNamedDestinations) {
+        fNamedDestinations.push_back(std::move(dest));
+    }
+    fCurrentPage = SkPDFPage();
     fPageDevice = nullptr;
 }
 
@@ -542,15 +588,6 @@ SkPDFIndirectReference SkPDFDocument::getPage(size_t pageIndex) const {
     return fPageRefs[pageIndex];
 }
 
-const SkMatrix& SkPDFDocument::currentPageTransform() const {
-    static constexpr const SkMatrix gIdentity;
-    // If not on a page (like when emitting a Type3 glyph) return identity.
-    if (!this->hasCurrentPage()) {
-        return gIdentity;
-    }
-    return fPageDevice->initialTransform();
-}
-
 SkPDFStructTree::Mark SkPDFDocument::createMarkForElemId(int elemId) {
     // If the mark isn't on a page (like when emitting a Type3 glyph)
     // return a temporary mark not attached to the page or a structure element.
@@ -578,7 +615,7 @@ static std::vector<const SkPDFFont*> get_fonts(const SkPDFDocument& canon) {
     fonts.reserve(canon.fStrikes.count());
     canon.fStrikes.foreach([&fonts](const sk_sp<SkPDFStrike>& strike) {
         for (const auto& [unused, font] : strike->fFontMap) {
-            fonts.push_back(&font);
+            fonts.push_back(font.get());
         }
     });
     // Sort so the output PDF is reproducible.
@@ -607,6 +644,17 @@ SkString SkPDFDocument::nextFontSubsetTag() {
 
 void SkPDFDocument::onClose(SkWStream* stream) {
     SkASSERT(fCanvas.imageInfo().dimensions().isZero());
+    if (fDrawPagesConcurrently) {
+        this->waitForJobs();
+        for (const std::unique_ptr<ConcurrentPage>& page : fConcurrentPages) {
+            SkASSERT(page->fDict);
+            fPages.push_back(std::move(page->fDict));
+            for (SkPDFNamedDestination& dest : page->fPage.fNamedDestinations) {
+                fNamedDestinations.push_back(std::move(dest));
+            }
+        }
+        fConcurrentPages.clear();
+    }
     if (fPages.empty()) {
         this->waitForJobs();
         return;
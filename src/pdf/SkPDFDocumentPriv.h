@@ -10,16 +10,20 @@
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDocument.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPictureRecorder.h"
 #include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkScalar.h"
+#include "include/core/SkSize.h"
 #include "include/core/SkSpan.h"  // IWYU pragma: keep
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
 #include "include/core/SkTypes.h"
 #include "include/docs/SkPDFDocument.h"
 #include "include/private/base/SkMutex.h"
+#include "include/private/base/SkOnce.h"
 #include "include/private/base/SkSemaphore.h"
 #include "src/base/SkUTF.h"
 #include "src/core/SkTHash.h"
@@ -42,7 +46,6 @@ class SkExecutor;
 class SkPDFDevice;
 struct SkAdvancedTypefaceMetrics;
 struct SkBitmapKey;
-class SkMatrix;
 
 namespace SkPDFGradientShader {
 struct Key;
@@ -91,6 +94,16 @@ struct SkPDFLink {
 };
 
 
+// A page being drawn. The page's SkPDFDevice, and the layers it makes, add its links and
+// destinations here.
+struct SkPDFPage {
+    SkPDFIndirectReference fRef;
+    SkMatrix fTransform;
+    std::vector<std::unique_ptr<SkPDFLink>> fLinks;
+    std::vector<SkPDFNamedDestination> fNamedDestinations;
+};
+
+
 /** Concrete implementation of SkDocument that creates PDF files. This
     class does not produced linearized or optimized PDFs; instead it
     it attempts to use a minimum amount of RAM. */
@@ -130,9 +143,8 @@ public:
 
     SkPDFIndirectReference getPage(size_t pageIndex) const;
     bool hasCurrentPage() const { return bool(fPageDevice); }
-    SkPDFIndirectReference currentPage() const {
-        return SkASSERT(this->hasCurrentPage() && !fPageRefs.empty()), fPageRefs.back();
-    }
+    // The page being drawn on the canvas returned by onBeginPage(), if it draws into PDF.
+    SkPDFPage* currentPage() { return this->hasCurrentPage() ? &fCurrentPage : nullptr; }
 
     // Create a new marked-content identifier (MCID) to be used with a marked-content sequence
     // parented by the structure element (StructElem) with the given element identifier (elemId).
@@ -146,7 +158,7 @@ public:
 
     void addStructElemTitle(int elemId, SkSpan<const char>);
 
-    std::unique_ptr<SkPDFArray> getAnnotations();
+    std::unique_ptr<SkPDFArray> getAnnotations(const SkPDFPage&);
 
     SkPDFIndirectReference reserveRef() { return SkPDFIndirectReference{fNextObjectNumber++}; }
 
@@ -159,14 +171,23 @@ public:
     size_t currentPageIndex() { return fPages.size(); }
     size_t pageCount() { return fPageRefs.size(); }
 
-    const SkMatrix& currentPageTransform() const;
+    // Guards the canonicalized objects below, other than fICCProfileMap, and the glyph usage of
+    // their fonts, which pages drawn concurrently share. It is never held while drawing.
+    SkMutex fCanonMutex;
+
+    // A shader is made by the first page that looks it up, outside fCanonMutex. Pages that look it
+    // up meanwhile wait on fOnce, so that each shader is emitted once.
+    struct CanonShader {
+        SkOnce fOnce;
+        SkPDFIndirectReference fRef;
+    };
 
     // Canonicalized objects
     skia_private::THashMap<SkPDFImageShaderKey,
-                           SkPDFIndirectReference,
+                           std::unique_ptr<CanonShader>,
                            SkPDFImageShaderKey::Hash> fImageShaderMap;
     skia_private::THashMap<SkPDFGradientShader::Key,
-                           SkPDFIndirectReference,
+                           std::unique_ptr<CanonShader>,
                            SkPDFGradientShader::KeyHash> fGradientPatternMap;
     skia_private::THashMap<SkBitmapKey, SkPDFIndirectReference> fPDFBitmapMap;
     skia_private::THashMap<SkPDFIccProfileKey,
@@ -174,8 +195,10 @@ public:
                            SkPDFIccProfileKey::Hash> fICCProfileMap;
     skia_private::THashMap<uint32_t, std::unique_ptr<SkAdvancedTypefaceMetrics>> fTypefaceMetrics;
     skia_private::THashMap<uint32_t, std::vector<SkString>> fType1GlyphNames;
-    skia_private::THashMap<uint32_t, std::vector<SkUnichar>> fToUnicodeMap;
-    skia_private::THashMap<uint32_t, skia_private::THashMap<SkGlyphID, SkString>> fToUnicodeMapEx;
+    skia_private::THashMap<uint32_t, std::unique_ptr<std::vector<SkUnichar>>> fToUnicodeMap;
+    skia_private::THashMap<uint32_t,
+                           std::unique_ptr<skia_private::THashMap<SkGlyphID, SkString>>>
+            fToUnicodeMapEx;
     skia_private::THashMap<uint32_t, SkPDFIndirectReference> fFontDescriptors;
     skia_private::THashMap<uint32_t, SkPDFIndirectReference> fType3FontDescriptors;
     skia_private::THashTable<sk_sp<SkPDFStrike>, const SkDescriptor&, SkPDFStrike::Traits> fStrikes;
@@ -187,16 +210,25 @@ public:
                            SkPDFFillGraphicState::Hash> fFillGSMap;
     SkPDFIndirectReference fInvertFunction;
     SkPDFIndirectReference fNoSmaskGraphicState;
-    std::vector<std::unique_ptr<SkPDFLink>> fCurrentPageLinks;
-    std::vector<SkPDFNamedDestination> fNamedDestinations;
 
 private:
+    // A page recorded by onBeginPage(), drawn into PDF by fExecutor.
+    struct ConcurrentPage {
+        SkISize fSize;
+        SkPDFPage fPage;
+        std::unique_ptr<SkPDFDict> fDict;
+    };
+
     SkPDFOffsetMap fOffsetMap;
     SkCanvas fCanvas;
     std::vector<std::unique_ptr<SkPDFDict>> fPages;
     std::vector<SkPDFIndirectReference> fPageRefs;
 
     sk_sp<SkPDFDevice> fPageDevice;
+    SkPDFPage fCurrentPage;
+    std::vector<SkPDFNamedDestination> fNamedDestinations;
+    SkPictureRecorder fPageRecorder;
+    std::vector<std::unique_ptr<ConcurrentPage>> fConcurrentPages;
     std::atomic<int> fNextObjectNumber = {1};
     std::atomic<int> fJobCount = {0};
     uint32_t fNextFontSubsetTag = {0};
@@ -207,6 +239,7 @@ private:
     const SkScalar fRasterScale;
     const SkScalar fInverseRasterScale;
     SkExecutor *const fExecutor;
+    const bool fDrawPagesConcurrently;
 
     // For tagged PDFs.
     SkPDFStructTree fStructTree;
@@ -214,6 +247,7 @@ private:
     SkMutex fMutex;
     SkSemaphore fSemaphore;
 
+    std::unique_ptr<SkPDFDict> makePage(SkPDFDevice*, const SkPDFPage&, size_t pageIndex);
     void waitForJobs();
     SkWStream* beginObject(SkPDFIndirectReference);
     void endObject();
@@ -308,22 +308,22 @@ const std::vector<SkUnichar>& SkPDFFont::GetUnicodeMap(const SkTypeface& typefac
                                                        SkPDFDocument* canon) {
     SkASSERT(canon);
     SkTypefaceID id = typeface.uniqueID();
-    if (std::vector<SkUnichar>* ptr = canon->fToUnicodeMap.find(id)) {
-        return *ptr;
+    if (std::unique_ptr<std::vector<SkUnichar>>* ptr = canon->fToUnicodeMap.find(id)) {
+        return **ptr;
     }
-    std::vector<SkUnichar> buffer(typeface.countGlyphs());
-    typeface.getGlyphToUnicodeMap(buffer.data());
-    return *canon->fToUnicodeMap.set(id, std::move(buffer));
+    auto buffer = std::make_unique<std::vector<SkUnichar>>(typeface.countGlyphs());
+    typeface.getGlyphToUnicodeMap(buffer->data());
+    return **canon->fToUnicodeMap.set(id, std::move(buffer));
 }
 
 THashMap<SkGlyphID, SkString>& SkPDFFont::GetUnicodeMapEx(const SkTypeface& typeface,
                                                           SkPDFDocument* canon) {
     SkASSERT(canon);
     SkTypefaceID id = typeface.uniqueID();
-    if (THashMap<SkGlyphID, SkString>* ptr = canon->fToUnicodeMapEx.find(id)) {
-        return *ptr;
+    if (std::unique_ptr<THashMap<SkGlyphID, SkString>>* ptr = canon->fToUnicodeMapEx.find(id)) {
+        return **ptr;
     }
-    return *canon->fToUnicodeMapEx.set(id, THashMap<SkGlyphID, SkString>());
+    return **canon->fToUnicodeMapEx.set(id, std::make_unique<THashMap<SkGlyphID, SkString>>());
 }
 
 SkAdvancedTypefaceMetrics::FontType SkPDFFont::FontType(const SkPDFStrike& pdfStrike,
@@ -378,9 +378,9 @@ SkPDFFont* SkPDFStrike::getFontResource(const SkGlyph* glyph) {
     bool multibyte = SkPDFFont::IsMultiByte(type);
     SkGlyphID subsetCode =
             multibyte ? 0 : first_nonzero_glyph_for_single_byte_encoding(glyph->getGlyphID());
-    if (SkPDFFont* font = fFontMap.find(subsetCode)) {
-        SkASSERT(multibyte == font->multiByteGlyphs());
-        return font;
+    if (std::unique_ptr<SkPDFFont>* font = fFontMap.find(subsetCode)) {
+        SkASSERT(multibyte == (*font)->multiByteGlyphs());
+        return font->get();
     }
 
     SkGlyphID lastGlyph = SkToU16(typeface.countGlyphs() - 1);
@@ -394,7 +394,8 @@ SkPDFFont* SkPDFStrike::getFontResource(const SkGlyph* glyph) {
         lastGlyph = SkToU16(std::min<int>((int)lastGlyph, 254 + (int)subsetCode));
     }
     auto ref = fDoc->reserveRef();
-    return fFontMap.set(subsetCode, SkPDFFont(this, firstNonZeroGlyph, lastGlyph, type, ref));
+    std::unique_ptr<SkPDFFont> font(new SkPDFFont(this, firstNonZeroGlyph, lastGlyph, type, ref));
+    return fFontMap.set(subsetCode, std::move(font))->get();
 }
 
 SkPDFFont::SkPDFFont(const SkPDFStrike* strike,
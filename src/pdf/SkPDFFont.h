@@ -18,6 +18,7 @@
 #include "src/pdf/SkPDFTypes.h"
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 class SkDescriptor;
@@ -48,7 +49,8 @@ public:
     const SkPDFStrikeSpec fImage;
     const bool fHasMaskFilter;
     SkPDFDocument* fDoc;
-    skia_private::THashMap<SkGlyphID, SkPDFFont> fFontMap;
+    // The fonts are not moved, so pages drawn concurrently can hold them.
+    skia_private::THashMap<SkGlyphID, std::unique_ptr<SkPDFFont>> fFontMap;
 
     /** Get the font resource for the glyph.
      *  The returned SkPDFFont is owned by the SkPDFStrike.
@@ -12,6 +12,7 @@
 #include "include/core/SkSpan.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkTileMode.h"
+#include "include/private/base/SkMutex.h"
 #include "include/private/base/SkTemplates.h"
 #include "include/private/base/SkTo.h"
 #include "src/core/SkChecksum.h"
@@ -1021,17 +1022,22 @@ static SkPDFIndirectReference find_pdf_shader(SkPDFDocument* doc,
                                               bool keyHasAlpha) {
     SkASSERT(gradient_has_alpha(key) == keyHasAlpha);
     auto& gradientPatternMap = doc->fGradientPatternMap;
-    if (SkPDFIndirectReference* ptr = gradientPatternMap.find(key)) {
-        return *ptr;
-    }
-    SkPDFIndirectReference pdfShader;
-    if (keyHasAlpha) {
-        pdfShader = make_alpha_function_shader(doc, key);
-    } else {
-        pdfShader = make_function_shader(doc, key);
+    SkPDFDocument::CanonShader* entry;
+    {
+        SkAutoMutexExclusive lock(doc->fCanonMutex);
+        std::unique_ptr<SkPDFDocument::CanonShader>* entryPtr = gradientPatternMap.find(key);
+        if (!entryPtr) {
+            entryPtr = gradientPatternMap.set(clone_key(key),
+                                              std::make_unique<SkPDFDocument::CanonShader>());
+        }
+        entry = entryPtr->get();
     }
-    gradientPatternMap.set(std::move(key), pdfShader);
-    return pdfShader;
+    // The alpha shader makes more shaders, so do not hold the lock.
+    entry->fOnce([&] {
+        entry->fRef = keyHasAlpha ? make_alpha_function_shader(doc, key)
+                                  : make_function_shader(doc, key);
+    });
+    return entry->fRef;
 }
 
 SkPDFIndirectReference SkPDFGradientShader::Make(SkPDFDocument* doc,
@@ -13,6 +13,7 @@
 #include "include/core/SkPaint.h"
 #include "include/core/SkStream.h"
 #include "include/private/base/SkAssert.h"
+#include "include/private/base/SkMutex.h"
 #include "include/private/base/SkTo.h"
 #include "src/core/SkTHash.h"
 #include "src/pdf/SkPDFDocumentPriv.h"
@@ -64,6 +65,7 @@ SkPDFIndirectReference SkPDFGraphicState::GetGraphicStateForPaint(SkPDFDocument*
     SkASSERT(doc);
     const SkBlendMode mode = p.getBlendMode_or(SkBlendMode::kSrcOver);
 
+    SkAutoMutexExclusive lock(doc->fCanonMutex);
     if (SkPaint::kFill_Style == p.getStyle()) {
         SkPDFFillGraphicState fillKey = {p.getColor4f().fA, pdf_blend_mode(mode)};
         auto& fillMap = doc->fFillGSMap;
@@ -137,6 +139,7 @@ SkPDFIndirectReference SkPDFGraphicState::GetSMaskGraphicState(SkPDFIndirectRefe
     sMaskDict->insertRef("G", sMask);
     if (invert) {
         // let the doc deduplicate this object.
+        SkAutoMutexExclusive lock(doc->fCanonMutex);
         if (doc->fInvertFunction == SkPDFIndirectReference()) {
             doc->fInvertFunction = make_invert_function(doc);
         }
@@ -20,6 +20,7 @@
 #include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
 #include "include/core/SkTileMode.h"
+#include "include/private/base/SkMutex.h"
 #include "include/private/base/SkTPin.h"
 #include "src/core/SkDevice.h"
 #include "src/core/SkTHash.h"
@@ -357,20 +358,27 @@ SkPDFIndirectReference SkPDFMakeShader(SkPDFDocument* doc,
             SkBitmapKeyFromImage(skimg),
             {imageTileModes[0], imageTileModes[1]},
             paintColor};
-        SkPDFIndirectReference* shaderPtr = doc->fImageShaderMap.find(key);
-        if (shaderPtr) {
-            return *shaderPtr;
+        SkPDFDocument::CanonShader* entry;
+        {
+            SkAutoMutexExclusive lock(doc->fCanonMutex);
+            std::unique_ptr<SkPDFDocument::CanonShader>* entryPtr = doc->fImageShaderMap.find(key);
+            if (!entryPtr) {
+                entryPtr = doc->fImageShaderMap.set(std::move(key),
+                                                    std::make_unique<SkPDFDocument::CanonShader>());
+            }
+            entry = entryPtr->get();
         }
-        SkPDFIndirectReference pdfShader =
-                make_image_shader(doc,
-                                  finalMatrix,
-                                  imageTileModes[0],
-                                  imageTileModes[1],
-                                  SkRect::Make(surfaceBBox),
-                                  skimg,
-                                  paintColor);
-        doc->fImageShaderMap.set(std::move(key), pdfShader);
-        return pdfShader;
+        // Drawing the image may use the canonicalized objects, so do not hold the lock.
+        entry->fOnce([&] {
+            entry->fRef = make_image_shader(doc,
+                                            finalMatrix,
+                                            imageTileModes[0],
+                                            imageTileModes[1],
+                                            SkRect::Make(surfaceBBox),
+                                            skimg,
+                                            paintColor);
+        });
+        return entry->fRef;
     }
     // Don't bother to de-dup fallback shader.
     return make_fallback_shader(doc, shader, canvasTransform, surfaceBBox, paintColor);
@@ -8,15 +8,18 @@
 #include "include/codec/SkAndroidCodec.h"
 #include "include/codec/SkCodec.h"
 #include "include/codec/SkEncodedImageFormat.h"
+#include "include/core/SkBitmap.h"
 #include "include/core/SkColorSpace.h"
 #include "include/core/SkData.h"
 #include "include/core/SkImageInfo.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSize.h"
 #include "include/core/SkString.h"
 #include "include/core/SkTypes.h"
 #include "include/private/SkGainmapInfo.h"  // IWYU pragma: keep
 #include "modules/skcms/skcms.h"
+#include "tests/FakeStreams.h"
 #include "tests/Test.h"
 #include "tools/Resources.h"
 
@@ -272,3 +275,144 @@ DEF_TEST(AndroidCodec_PQ, r) {
     static constexpr skcms_Matrix3x3 kExpected = SkNamedGamut::kRec2020;
     REPORTER_ASSERT(r, 0 == memcmp(&matrix, &kExpected, sizeof(skcms_Matrix3x3)));
 }
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    if (a.dimensions() != b.dimensions()) {
+        return false;
+    }
+    for (int y = 0; y < a.height(); ++y) {
+        if (memcmp(a.getAddr(0, y), b.getAddr(0, y), a.info().minRowBytes())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool decode_region(SkAndroidCodec* codec, const SkIRect& subset, int sampleSize,
+                          SkBitmap* dst) {
+    SkAndroidCodec::AndroidOptions options;
+    options.fSubset = &subset;
+    options.fSampleSize = sampleSize;
+    dst->allocPixels(codec->getInfo().makeDimensions(
+            codec->getSampledSubsetDimensions(sampleSize, subset)));
+    return codec->getAndroidPixels(dst->info(), dst->getPixels(), dst->rowBytes(), &options) ==
+           SkCodec::kSuccess;
+}
+
+// Decoding regions of a JPEG in memory repeatedly, which may start from restart markers (which
+// a JPEG without them gets by being re-encoded), gives the same pixels as decoding them from a
+// stream that isn't in memory.
+DEF_TEST(AndroidCodec_jpegRegions, r) {
+    if (GetResourcePath().isEmpty()) {
+        return;
+    }
+    for (const char* file : { "images/icc-v2-gbr.jpg",        // restart markers
+                              "images/mandrill_cmyk.jpg",     // restart markers, CMYK
+                              "images/mandrill_512_q075.jpg", // no restart markers
+                              "images/mandrill_h2v1.jpg",
+                              "images/brickwork-texture.jpg", // progressive
+                              }) {
+        auto data = GetResourceAsData(file);
+        if (!data) {
+            ERRORF(r, "Could not get %s", file);
+            continue;
+        }
+        auto codec = SkAndroidCodec::MakeFromData(data);
+        auto reference = SkAndroidCodec::MakeFromStream(std::make_unique<NotAssetMemStream>(data));
+        if (!codec || !reference) {
+            ERRORF(r, "Failed to create codecs for %s", file);
+            continue;
+        }
+
+        const SkISize dims = codec->getInfo().dimensions();
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            for (int sampleSize : {1, 2, 3, 4}) {
+                for (SkIRect subset : {SkIRect::MakeXYWH(0, dims.height() / 2, dims.width(), 40),
+                                       SkIRect::MakeXYWH(dims.width() / 3, dims.height() - 70,
+                                                         dims.width() / 2, 70),
+                                       SkIRect::MakeXYWH(10, 150, 64, 32)}) {
+                    if (!codec->getSupportedSubset(&subset)) {
+                        continue;
+                    }
+                    SkBitmap actual, expected;
+                    REPORTER_ASSERT(r, decode_region(reference.get(), subset, sampleSize,
+                                                     &expected));
+                    REPORTER_ASSERT(r, decode_region(codec.get(), subset, sampleSize, &actual));
+                    REPORTER_ASSERT(r, same_pixels(expected, actual),
+                                    "%s: subset (%d, %d, %d, %d), sample size %d, repeat %d",
+                                    file, subset.x(), subset.y(), subset.width(),
+                                    subset.height(), sampleSize, repeat);
+                }
+            }
+        }
+    }
+}
+
+DEF_TEST(AndroidCodec_thumbnail, r) {
+    if (GetResourcePath().isEmpty()) {
+        return;
+    }
+    for (const char* file : { "images/dog.jpg",
+                              "images/mandrill_512_q075.jpg",
+                              "images/ship.png",
+                              "images/mandrill.wbmp",
+                              }) {
+        auto data = GetResourceAsData(file);
+        if (!data) {
+            ERRORF(r, "Could not get %s", file);
+            continue;
+        }
+        auto codec = SkAndroidCodec::MakeFromData(data);
+        if (!codec) {
+            ERRORF(r, "Failed to create codec from %s", file);
+            continue;
+        }
+        const bool isJpeg = codec->getEncodedFormat() == SkEncodedImageFormat::kJPEG;
+
+        const SkISize dims = codec->getInfo().dimensions();
+        for (SkISize minSize : {SkISize{1, 1}, SkISize{37, 20}, times(dims, 0.3f),
+                                times(dims, 0.5f), plus(dims, -1), plus(dims, 1)}) {
+            const SkISize thumbnail = codec->getThumbnailDimensions(minSize);
+            if (minSize.width() >= dims.width() || minSize.height() >= dims.height()) {
+                REPORTER_ASSERT(r, thumbnail == dims, "%s", file);
+            } else {
+                REPORTER_ASSERT(r, thumbnail.width() >= minSize.width() &&
+                                   thumbnail.height() >= minSize.height() &&
+                                   thumbnail.width() <= dims.width() &&
+                                   thumbnail.height() <= dims.height(),
+                                "%s: %d x %d for at least %d x %d", file, thumbnail.width(),
+                                thumbnail.height(), minSize.width(), minSize.height());
+            }
+
+            SkBitmap actual;
+            actual.allocPixels(codec->getInfo().makeDimensions(thumbnail));
+            REPORTER_ASSERT(r, codec->getThumbnailPixels(actual.info(), actual.getPixels(),
+                                                         actual.rowBytes()) == SkCodec::kSuccess,
+                            "%s: %d x %d", file, thumbnail.width(), thumbnail.height());
+
+            auto scalingCodec = SkCodec::MakeFromData(data);
+            SkBitmap expected;
+            expected.allocPixels(actual.info());
+            const SkCodec::Result result = scalingCodec->getPixels(
+                    expected.info(), expected.getPixels(), expected.rowBytes());
+            if (result == SkCodec::kSuccess) {
+                // Scaled as it is decoded, rather than sampled.
+                REPORTER_ASSERT(r, same_pixels(expected, actual), "%s", file);
+            } else {
+                // JPEGs are only sampled to get smaller than 1/8.
+                REPORTER_ASSERT(r, result == SkCodec::kInvalidScale &&
+                                   (!isJpeg || thumbnail.width() <= (dims.width() + 7) / 8),
+                                "%s: %d x %d", file, thumbnail.width(), thumbnail.height());
+            }
+        }
+
+        SkAndroidCodec::AndroidOptions options;
+        const SkIRect subset = SkIRect::MakeWH(1, 1);
+        options.fSubset = &subset;
+        SkBitmap bm;
+        bm.allocPixels(codec->getInfo());
+        REPORTER_ASSERT(r, codec->getThumbnailPixels(bm.info(), bm.getPixels(), bm.rowBytes(),
+                                                     &options) ==
+                           SkCodec::kInvalidParameters);
+    }
+}
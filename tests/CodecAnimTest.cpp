@@ -585,6 +585,8 @@ DEF_TEST(EncodedOriginToMatrixTest, r) {
 
 #if defined(SK_ENABLE_SKOTTIE)
 
+#include "include/core/SkExecutor.h"
+#include "include/private/base/SkTo.h"
 #include "modules/skresources/src/SkAnimCodecPlayer.h"
 
 DEF_TEST(AnimCodecPlayer, r) {
@@ -630,4 +632,62 @@ DEF_TEST(AnimCodecPlayer, r) {
     }
 }
 
+// Decoding frames ahead of playback gives the same frames as decoding them on demand, however
+// playback seeks, and however few frames are kept.
+DEF_TEST(AnimCodecPlayer_prefetch, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (const char* file : {"images/required.gif",
+                             "images/alphabetAnim.gif",
+                             "images/randPixelsAnim.gif",
+                             "images/blendBG.webp",
+                             "images/required.webp",
+                             "images/stoplight_h.webp"}) {
+        sk_sp<SkData> data = GetResourceAsData(file);
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+        if (!codec) {
+            continue;
+        }
+        // The time at which each frame starts.
+        std::vector<uint32_t> starts;
+        uint32_t time = 0;
+        for (const SkCodec::FrameInfo& info : codec->getFrameInfo()) {
+            starts.push_back(time);
+            time += info.fDuration;
+        }
+        const int frameCount = SkToInt(starts.size());
+
+        // Play through twice, then backwards, then skip around.
+        std::vector<int> frames;
+        for (int i = 0; i < 2 * frameCount; ++i) {
+            frames.push_back(i % frameCount);
+        }
+        for (int i = frameCount - 1; i >= 0; --i) {
+            frames.push_back(i);
+        }
+        for (int i = 0; i < frameCount; ++i) {
+            frames.push_back(i * 5 % frameCount);
+        }
+
+        SkAnimCodecPlayer expected(std::move(codec));
+        for (auto [framesAhead, maxCachedFrames] : {std::pair<int, int>{1, 1},
+                                                    std::pair<int, int>{2, 4},
+                                                    std::pair<int, int>{8, 16}}) {
+            SkAnimCodecPlayer::PrefetchOptions options;
+            options.fExecutor = executor.get();
+            options.fFramesAhead = framesAhead;
+            options.fMaxCachedFrames = maxCachedFrames;
+            SkAnimCodecPlayer actual(SkCodec::MakeFromData(data), options);
+            for (int frame : frames) {
+                expected.seek(starts[frame]);
+                actual.seek(starts[frame]);
+                sk_sp<SkImage> expectedImage = expected.getFrame(),
+                               actualImage = actual.getFrame();
+                REPORTER_ASSERT(r, expectedImage && actualImage &&
+                                   ToolUtils::equal_pixels(expectedImage.get(), actualImage.get()),
+                                "%s: frame %d, %d frames ahead", file, frame, framesAhead);
+            }
+        }
+    }
+}
+
 #endif
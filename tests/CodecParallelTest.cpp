@@ -0,0 +1,149 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/codec/SkCodec.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkColorType.h"
+#include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkRefCnt.h"
+#include "src/codec/SkJpegRestartBands.h"
+#include "tests/Test.h"
+#include "tools/Resources.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+static bool decode(sk_sp<SkData> data, SkColorType colorType, SkExecutor* executor,
+                   SkBitmap* dst) {
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(std::move(data));
+    if (!codec) {
+        return false;
+    }
+    dst->allocPixels(codec->getInfo().makeColorType(colorType));
+    SkCodec::Options options;
+    options.fExecutor = executor;
+    return codec->getPixels(dst->info(), dst->getPixels(), dst->rowBytes(), &options) ==
+           SkCodec::kSuccess;
+}
+
+static bool same_rows(const SkBitmap& a, const SkBitmap& b, int top, int rows) {
+    for (int y = top; y < top + rows; ++y) {
+        if (memcmp(a.getAddr(0, y), b.getAddr(0, y), a.info().minRowBytes())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Each band, decoded on its own, gives the same rows as decoding the whole image, including those
+// next to the other bands, whose chroma is upsampled from both.
+DEF_TEST(Codec_JpegRestartBands, r) {
+    const struct {
+        const char* fPath;
+        bool        fHasRestarts;
+    } sources[] = {
+        {"images/icc-v2-gbr.jpg",        true},   // 4:2:0, a restart interval per row of MCUs
+        {"images/mandrill_cmyk.jpg",     true},   // CMYK
+        {"images/iphone_13_pro.jpeg",    true},   // intervals of 3/4 of a row of MCUs
+        {"images/mandrill_512_q075.jpg", false},  // no restart markers
+        {"images/mandrill_h2v1.jpg",     false},
+        {"images/brickwork-texture.jpg", false},  // progressive
+        {"images/grayscale.jpg",         false},  // progressive, grayscale
+    };
+    for (const auto& source : sources) {
+        sk_sp<SkData> data = GetResourceAsData(source.fPath);
+        if (!data) {
+            continue;
+        }
+        // Bands have no ICC profile, so compare them without color correction.
+        SkBitmap expected;
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+        expected.allocPixels(codec->getInfo().makeColorSpace(nullptr));
+        REPORTER_ASSERT(r, codec->getPixels(expected.pixmap()) == SkCodec::kSuccess, "%s",
+                        source.fPath);
+
+        std::unique_ptr<SkJpegRestartBands> restartBands = SkJpegRestartBands::Make(data);
+        REPORTER_ASSERT(r, !!restartBands == source.fHasRestarts, "%s", source.fPath);
+        if (!restartBands) {
+            // Re-encoding adds restart markers, without changing the pixels.
+            restartBands = SkJpegRestartBands::MakeReencoded(*data);
+            if (!restartBands) {
+                ERRORF(r, "%s: can't re-encode", source.fPath);
+                continue;
+            }
+        }
+        REPORTER_ASSERT(r, restartBands->height() == expected.height());
+
+        auto check = [&](SkJpegBand band, const char* what) {
+            std::unique_ptr<SkCodec> codec = SkCodec::MakeFromStream(std::move(band.fStream));
+            if (!codec) {
+                ERRORF(r, "%s: can't decode %s at row %d", source.fPath, what, band.fTop);
+                return;
+            }
+            REPORTER_ASSERT(r, codec->dimensions().width() == expected.width() &&
+                               codec->dimensions().height() >= band.fSkipRows + band.fHeight);
+            SkBitmap actual;
+            actual.allocPixels(expected.info());
+            REPORTER_ASSERT(r, codec->startScanlineDecode(
+                                    expected.info().makeDimensions(codec->dimensions())) ==
+                               SkCodec::kSuccess);
+            REPORTER_ASSERT(r, codec->skipScanlines(band.fSkipRows));
+            REPORTER_ASSERT(r, codec->getScanlines(actual.getAddr(0, band.fTop), band.fHeight,
+                                                   actual.rowBytes()) == band.fHeight);
+            REPORTER_ASSERT(r, same_rows(expected, actual, band.fTop, band.fHeight),
+                            "%s: %s at row %d", source.fPath, what, band.fTop);
+        };
+
+        for (int maxBands : {2, 3, 7}) {
+            std::vector<SkJpegBand> bands = restartBands->split(maxBands);
+            REPORTER_ASSERT(r, bands.size() >= 2 && bands.size() <= (size_t)maxBands,
+                            "%s: %zu bands", source.fPath, bands.size());
+            int top = 0;
+            for (SkJpegBand& band : bands) {
+                REPORTER_ASSERT(r, band.fTop == top && band.fHeight > 0, "%s", source.fPath);
+                top += band.fHeight;
+                check(std::move(band), "band");
+            }
+            REPORTER_ASSERT(r, top == expected.height(), "%s", source.fPath);
+        }
+
+        // Bands of any rows, which needn't start or end at a row of MCUs.
+        const int height = expected.height();
+        for (int top : {0, 1, height / 3, height / 2 + 5, height - 1}) {
+            for (int bottom : {top + 1, top + 9, height}) {
+                if (bottom <= height) {
+                    check(restartBands->band(top, bottom), "region");
+                }
+            }
+        }
+    }
+}
+
+// Decoding on an executor gives the same pixels as decoding serially, whether or not the image is
+// decoded in bands.
+DEF_TEST(Codec_JpegParallel, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (const char* path : {"images/iphone_15.jpeg", "images/mandrill_512_q075.jpg"}) {
+        sk_sp<SkData> data = GetResourceAsData(path);
+        if (!data) {
+            continue;
+        }
+        for (SkColorType colorType : {kRGBA_8888_SkColorType,
+                                      kBGRA_8888_SkColorType,
+                                      kRGB_565_SkColorType,
+                                      kRGBA_F16_SkColorType}) {
+            SkBitmap expected, actual;
+            REPORTER_ASSERT(r, decode(data, colorType, nullptr, &expected));
+            REPORTER_ASSERT(r, decode(data, colorType, executor.get(), &actual));
+            REPORTER_ASSERT(r, same_rows(expected, actual, 0, expected.height()),
+                            "%s, color type %d", path, colorType);
+        }
+    }
+}
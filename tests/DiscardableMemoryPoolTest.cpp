@@ -8,8 +8,10 @@
 #include "include/core/SkRefCnt.h"
 #include "include/private/chromium/SkDiscardableMemory.h"
 #include "src/lazy/SkDiscardableMemoryPool.h"
+#include "src/lazy/SkSharedDiscardableMemoryPool.h"
 #include "tests/Test.h"
 
+#include <cstring>
 #include <memory>
 
 DEF_TEST(DiscardableMemoryPool, reporter) {
@@ -35,4 +37,72 @@ DEF_TEST(DiscardableMemoryPool, reporter) {
     pool->dumpPool();
     REPORTER_ASSERT(reporter, !dm2->lock());
     REPORTER_ASSERT(reporter, 0 == pool->getRAMUsed());
+    REPORTER_ASSERT(reporter, 2 == pool->getPurgeStats().fPurges);
+    REPORTER_ASSERT(reporter, 300 == pool->getPurgeStats().fPurgedBytes);
+}
+
+// The second pool stands in for another process, which would receive the descriptor over a socket.
+DEF_TEST(SharedDiscardableMemoryPool, reporter) {
+    sk_sp<SkSharedDiscardableMemoryPool> pool(SkSharedDiscardableMemoryPool::Make(1000));
+    sk_sp<SkSharedDiscardableMemoryPool> other(SkSharedDiscardableMemoryPool::Make(1000));
+    if (!pool || !other) {
+        return;  // no memfds
+    }
+
+    std::unique_ptr<SkSharedDiscardableMemory> dm(pool->makeShared(100));
+    REPORTER_ASSERT(reporter, dm && dm->size() == 100);
+    memset(dm->data(), 0x42, 100);
+    std::unique_ptr<SkSharedDiscardableMemory> adopted(other->adopt(dm->dupFD()));
+    REPORTER_ASSERT(reporter, adopted && adopted->size() == 100);
+    REPORTER_ASSERT(reporter, 100 == other->getRAMUsed());
+    REPORTER_ASSERT(reporter, adopted->lock());
+    REPORTER_ASSERT(reporter, static_cast<const char*>(adopted->data())[99] == 0x42);
+    static_cast<char*>(adopted->data())[0] = 0x17;
+    REPORTER_ASSERT(reporter, static_cast<const char*>(dm->data())[0] == 0x17);
+
+    // Memory locked by another process isn't purged.
+    dm->unlock();
+    pool->dumpPool();
+    REPORTER_ASSERT(reporter, 100 == pool->getRAMUsed());
+    REPORTER_ASSERT(reporter, 0 == pool->getPurgeStats().fPurges);
+    REPORTER_ASSERT(reporter, dm->lock());
+    dm->unlock();
+
+    // Once no process has it locked, purging it in one discards it in all of them.
+    adopted->unlock();
+    other->dumpPool();
+    REPORTER_ASSERT(reporter, 0 == other->getRAMUsed());
+    REPORTER_ASSERT(reporter, 1 == other->getPurgeStats().fPurges);
+    REPORTER_ASSERT(reporter, 100 == other->getPurgeStats().fPurgedBytes);
+    REPORTER_ASSERT(reporter, !dm->lock());
+    REPORTER_ASSERT(reporter, 0 == pool->getRAMUsed());
+    REPORTER_ASSERT(reporter, -1 == dm->dupFD());
+
+    REPORTER_ASSERT(reporter, !other->adopt(-1));
+}
+
+// Memory from create() isn't shared, so it holds no descriptor, but is otherwise the same.
+DEF_TEST(SharedDiscardableMemoryPool_create, reporter) {
+    sk_sp<SkSharedDiscardableMemoryPool> pool(SkSharedDiscardableMemoryPool::Make(1000));
+    if (!pool) {
+        return;  // no memfds
+    }
+
+    std::unique_ptr<SkDiscardableMemory> dm(pool->create(100));
+    REPORTER_ASSERT(reporter, dm);
+    auto shared = static_cast<SkSharedDiscardableMemory*>(dm.get());
+    REPORTER_ASSERT(reporter, -1 == shared->dupFD());
+    REPORTER_ASSERT(reporter, 100 == shared->size());
+    REPORTER_ASSERT(reporter, 100 == pool->getRAMUsed());
+    memset(dm->data(), 0x42, 100);
+    dm->unlock();
+    REPORTER_ASSERT(reporter, dm->lock());
+    REPORTER_ASSERT(reporter, static_cast<const char*>(dm->data())[99] == 0x42);
+    dm->unlock();
+
+    pool->dumpPool();
+    REPORTER_ASSERT(reporter, 0 == pool->getRAMUsed());
+    REPORTER_ASSERT(reporter, 1 == pool->getPurgeStats().fPurges);
+    REPORTER_ASSERT(reporter, 100 == pool->getPurgeStats().fPurgedBytes);
+    REPORTER_ASSERT(reporter, !dm->lock());
 }
@@ -15,13 +15,18 @@
 #include "include/core/SkColorType.h"
 #include "include/core/SkData.h"
 #include "include/core/SkDataTable.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkImage.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSize.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkSurface.h"
 #include "include/core/SkTypes.h"
+#include "include/core/SkYUVAInfo.h"
+#include "include/core/SkYUVAPixmaps.h"
 #include "include/encode/SkEncoder.h"
 #include "include/encode/SkJpegEncoder.h"
 #include "include/encode/SkPngEncoder.h"
@@ -39,6 +44,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <initializer_list>
 #include <memory>
 #include <string>
@@ -81,7 +87,7 @@ static void test_encode(skiatest::Reporter* r, SkEncodedImageFormat format) {
         return;
     }
 
-    SkDynamicMemoryWStream dst0, dst1, dst2, dst3;
+    SkDynamicMemoryWStream dst0, dst1, dst2, dst3, dst4;
     success = encode(format, &dst0, src);
     REPORTER_ASSERT(r, success);
 
@@ -101,13 +107,31 @@ static void test_encode(skiatest::Reporter* r, SkEncodedImageFormat format) {
     success = encoder3->encodeRows(200);
     REPORTER_ASSERT(r, success);
 
+    // Rows passed in a separate strip, with only the strip's memory behind the src.
+    SkBitmap strip;
+    strip.allocPixels(src.info().makeWH(src.width(), 5));
+    const SkPixmap image(src.info(), strip.getPixels(), strip.rowBytes());
+    auto encoder4 = make(format, &dst4, image);
+    for (int top = 0; top < src.height(); top += strip.height()) {
+        SkPixmap rows;
+        SkAssertResult(src.extractSubset(&rows, SkIRect::MakeXYWH(0, top, src.width(),
+                                                                  strip.height())));
+        SkAssertResult(strip.writePixels(rows));
+        SkAssertResult(strip.pixmap().extractSubset(&rows, SkIRect::MakeWH(src.width(),
+                                                                           rows.height())));
+        success = encoder4->encodeRows(rows);
+        REPORTER_ASSERT(r, success);
+    }
+
     sk_sp<SkData> data0 = dst0.detachAsData();
     sk_sp<SkData> data1 = dst1.detachAsData();
     sk_sp<SkData> data2 = dst2.detachAsData();
     sk_sp<SkData> data3 = dst3.detachAsData();
+    sk_sp<SkData> data4 = dst4.detachAsData();
     REPORTER_ASSERT(r, data0->equals(data1.get()));
     REPORTER_ASSERT(r, data0->equals(data2.get()));
     REPORTER_ASSERT(r, data0->equals(data3.get()));
+    REPORTER_ASSERT(r, data0->equals(data4.get()));
 }
 
 DEF_TEST(Encode, r) {
@@ -378,6 +402,36 @@ DEF_TEST(Encode_JPG, r) {
     }
 }
 
+DEF_TEST(Encode_JPG_YUVARowsFromPixmap, r) {
+    const SkYUVAInfo yuvaInfo({16, 16},
+                              SkYUVAInfo::PlaneConfig::kY_U_V,
+                              SkYUVAInfo::Subsampling::k420,
+                              kJPEG_Full_SkYUVColorSpace);
+    const SkYUVAPixmapInfo pixmapInfo(yuvaInfo, SkYUVAPixmapInfo::DataType::kUnorm8, nullptr);
+    SkYUVAPixmaps planes = SkYUVAPixmaps::Allocate(pixmapInfo);
+    REPORTER_ASSERT(r, planes.isValid());
+    for (int i = 0; i < planes.numPlanes(); ++i) {
+        planes.plane(i).erase(SkColors::kGray);
+    }
+
+    SkDynamicMemoryWStream dst;
+    auto encoder = SkJpegEncoder::Make(&dst, planes, nullptr, SkJpegEncoder::Options());
+    REPORTER_ASSERT(r, encoder);
+    if (!encoder) {
+        return;
+    }
+
+    // A YUVA encoder reads its own planes, so it can't take rows from a separate pixmap.
+    SkBitmap rows;
+    rows.allocPixels(planes.plane(0).info().makeWH(16, 4));
+    rows.eraseColor(SK_ColorGRAY);
+    REPORTER_ASSERT(r, !encoder->encodeRows(rows.pixmap()));
+
+    // It still encodes its planes.
+    REPORTER_ASSERT(r, encoder->encodeRows(16));
+    REPORTER_ASSERT(r, dst.bytesWritten() > 0);
+}
+
 DEF_TEST(Encode_JpegDownsample, r) {
     SkBitmap bitmap;
     bool success = ToolUtils::GetResourceAsBitmap("images/mandrill_128.png", &bitmap);
@@ -534,6 +588,88 @@ DEF_TEST(Encode_PngOptions, r) {
 }
 
 #ifndef SK_BUILD_FOR_GOOGLE3
+// Decodes a PNG to the info its codec reports, so two encodings of the same pixels compare equal.
+static bool decode_png(sk_sp<SkData> data, SkBitmap* dst) {
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(std::move(data));
+    return codec && dst->tryAllocPixels(codec->getInfo()) &&
+           codec->getPixels(dst->pixmap()) == SkCodec::kSuccess;
+}
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    if (a.info() != b.info()) {
+        return false;
+    }
+    for (int y = 0; y < a.height(); ++y) {
+        if (memcmp(a.getAddr(0, y), b.getAddr(0, y), a.info().minRowBytes())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+DEF_TEST(Encode_PngParallel, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(3);
+
+    SkBitmap mandrill;
+    if (!ToolUtils::GetResourceAsBitmap("images/mandrill_512.png", &mandrill)) {
+        return;
+    }
+    // Enough rows for several blocks, and rows narrower than a vector of filtered bytes.
+    std::vector<SkBitmap> sources;
+    for (SkISize size : {SkISize{333, 700}, SkISize{3, 50}, SkISize{1, 1}}) {
+        for (SkColorType ct : {kRGBA_8888_SkColorType, kBGRA_8888_SkColorType,
+                               kGray_8_SkColorType, kRGBA_F16_SkColorType}) {
+            SkBitmap scaled, bm;
+            scaled.allocN32Pixels(size.width(), size.height());
+            SkCanvas(scaled).drawImageRect(mandrill.asImage(), SkRect::Make(size), {});
+            bm.allocPixels(SkImageInfo::Make(size, ct, kUnpremul_SkAlphaType));
+            SkAssertResult(scaled.readPixels(bm.pixmap()));
+            sources.push_back(bm);
+        }
+    }
+
+    const SkPngEncoder::FilterFlag filters[] = {
+        SkPngEncoder::FilterFlag::kZero, SkPngEncoder::FilterFlag::kNone,
+        SkPngEncoder::FilterFlag::kSub,  SkPngEncoder::FilterFlag::kUp,
+        SkPngEncoder::FilterFlag::kAvg,  SkPngEncoder::FilterFlag::kPaeth,
+        SkPngEncoder::FilterFlag::kAll,
+    };
+    for (const SkBitmap& src : sources) {
+        for (SkPngEncoder::FilterFlag filter : filters) {
+            for (int zlibLevel : {0, 6}) {
+                SkPngEncoder::Options options;
+                options.fFilterFlags = filter;
+                options.fZLibLevel = zlibLevel;
+                SkDynamicMemoryWStream serial, parallel, parallelRows;
+                REPORTER_ASSERT(r, SkPngEncoder::Encode(&serial, src.pixmap(), options));
+
+                options.fExecutor = executor.get();
+                REPORTER_ASSERT(r, SkPngEncoder::Encode(&parallel, src.pixmap(), options));
+
+                // Blocks don't depend on how rows are passed to the encoder.
+                std::unique_ptr<SkEncoder> encoder =
+                        SkPngEncoder::Make(&parallelRows, src.pixmap(), options);
+                for (int y = 0; encoder && y < src.height(); y += 37) {
+                    REPORTER_ASSERT(r, encoder->encodeRows(37));
+                }
+
+                sk_sp<SkData> serialData = serial.detachAsData(),
+                              parallelData = parallel.detachAsData(),
+                              parallelRowsData = parallelRows.detachAsData();
+                REPORTER_ASSERT(r, parallelData->equals(parallelRowsData.get()));
+
+                SkBitmap expected, actual;
+                REPORTER_ASSERT(r, decode_png(serialData, &expected));
+                REPORTER_ASSERT(r, decode_png(parallelData, &actual));
+                REPORTER_ASSERT(r, same_pixels(expected, actual),
+                                "%dx%d color type %d, filters 0x%x, zlib level %d",
+                                src.width(), src.height(), src.colorType(), (int)filter,
+                                zlibLevel);
+            }
+        }
+    }
+}
+
 DEF_TEST(Encode_WebpQuality, r) {
     SkBitmap bm;
     bm.allocN32Pixels(100, 100);
@@ -604,7 +740,7 @@ DEF_TEST(Encode_WebpOptions, r) {
         return;
     }
 
-    SkDynamicMemoryWStream dst0, dst1, dst2, dst3;
+    SkDynamicMemoryWStream dst0, dst1, dst2, dst3, dst4;
     SkWebpEncoder::Options options;
     options.fCompression = SkWebpEncoder::Compression::kLossless;
     options.fQuality = 0.0f;
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkClipOp.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRegion.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkSurface.h"
+#include "include/effects/SkGradientShader.h"
+#include "src/base/SkRandom.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+extern bool gSkDisableFillBlitterCache;
+extern bool gSkForceRasterPipelineBlitter;
+
+static constexpr int kW = 160, kH = 120;
+
+// Draws runs of rects, rrects and edge-AA quads that repeat paints, mixed with changes to the
+// paint, matrix and clip that should each be picked up by the next fill.
+static void draw(SkCanvas* canvas) {
+    SkRandom rand(7);
+    auto rect = [&] {
+        float x = rand.nextRangeF(-20, kW), y = rand.nextRangeF(-20, kH);
+        return SkRect::MakeXYWH(x, y, rand.nextRangeF(0.2f, 60), rand.nextRangeF(0.2f, 60));
+    };
+
+    const SkColor4f colors[] = {{0.2f, 0.4f, 0.6f, 1}, {1, 0, 0, 0.5f}, {0, 0, 0, 1}};
+    const SkBlendMode modes[] = {SkBlendMode::kSrcOver, SkBlendMode::kSrc,
+                                 SkBlendMode::kMultiply, SkBlendMode::kClear};
+    for (int i = 0; i < 240; ++i) {
+        if (i % 40 == 0) {
+            canvas->restoreToCount(1);
+            canvas->save();
+            switch (i / 40) {
+                case 1: canvas->translate(10.5f, 3.25f); canvas->scale(1.5f, 0.75f); break;
+                case 2: canvas->clipRRect(SkRRect::MakeRectXY(SkRect::MakeLTRB(10, 10, 150, 110),
+                                                              30, 20), /*doAntiAlias=*/true);
+                        break;
+                case 3: {
+                    SkRegion rgn;
+                    rgn.op(SkIRect::MakeLTRB(0, 0, 60, 120), SkRegion::kUnion_Op);
+                    rgn.op(SkIRect::MakeLTRB(40, 30, 160, 90), SkRegion::kUnion_Op);
+                    canvas->clipRegion(rgn);
+                    break;
+                }
+                case 4: {
+                    const SkPoint pts[] = {{0, 0}, {kW, kH}};
+                    const SkColor clip[] = {SK_ColorBLACK, SK_ColorTRANSPARENT};
+                    canvas->clipShader(SkGradientShader::MakeLinear(pts, clip, nullptr, 2,
+                                                                    SkTileMode::kClamp));
+                    break;
+                }
+                case 5: canvas->rotate(20); break;
+            }
+        }
+
+        SkPaint paint;
+        paint.setColor4f(colors[(i / 7) % 3]);
+        paint.setBlendMode(modes[(i / 11) % 4]);
+        paint.setAntiAlias((i / 5) % 2);
+        paint.setDither(i % 13 == 0);
+        switch (i % 4) {
+            case 0:
+            case 1: canvas->drawRect(rect(), paint); break;
+            case 2: canvas->drawRRect(SkRRect::MakeRectXY(rect(), 6, 9), paint); break;
+            case 3: canvas->experimental_DrawEdgeAAQuad(rect(), nullptr,
+                                                        SkCanvas::kAll_QuadAAFlags,
+                                                        paint.getColor4f(),
+                                                        paint.getBlendMode_or(
+                                                                SkBlendMode::kSrcOver));
+                    break;
+        }
+    }
+    canvas->restoreToCount(1);
+}
+
+DEF_TEST(FillBlitterCache_MatchesUncached, r) {
+    const SkImageInfo infos[] = {
+        SkImageInfo::MakeN32Premul(kW, kH),
+        SkImageInfo::MakeN32Premul(kW, kH, SkColorSpace::MakeSRGBLinear()),
+        SkImageInfo::Make(kW, kH, kRGBA_F16_SkColorType, kPremul_SkAlphaType),
+        SkImageInfo::Make(kW, kH, kRGB_565_SkColorType, kOpaque_SkAlphaType),
+        SkImageInfo::MakeA8(kW, kH),
+    };
+
+    const bool wasDisabled = gSkDisableFillBlitterCache;
+    for (const SkImageInfo& info : infos) {
+        for (bool forceRasterPipeline : {false, true}) {
+            SkBitmap bitmaps[2];
+            for (bool cached : {false, true}) {
+                SkBitmap& bm = bitmaps[cached];
+                bm.allocPixels(info);
+                bm.eraseColor(SK_ColorWHITE);
+                gSkDisableFillBlitterCache = !cached;
+                gSkForceRasterPipelineBlitter = forceRasterPipeline;
+                SkCanvas canvas(bm);
+                draw(&canvas);
+            }
+            REPORTER_ASSERT(r, ToolUtils::equal_pixels(bitmaps[0], bitmaps[1]),
+                            "color type %d, raster pipeline %d",
+                            info.colorType(), forceRasterPipeline);
+        }
+    }
+    gSkDisableFillBlitterCache = wasDisabled;
+    gSkForceRasterPipelineBlitter = false;
+}
+
+DEF_TEST(FillBlitterCache_SurfaceCopyOnWrite, r) {
+    sk_sp<SkSurface> surface = SkSurfaces::Raster(SkImageInfo::MakeN32Premul(kW, kH));
+    SkCanvas* canvas = surface->getCanvas();
+    SkPaint paint;
+    paint.setColor(SK_ColorRED);
+    canvas->clear(SK_ColorWHITE);
+    canvas->drawRect(SkRect::MakeWH(10, 10), paint);
+
+    // The snapshot shares pixels until the next draw, which should copy them first and then fill
+    // the new pixels, even with a blitter left over from the draw before.
+    sk_sp<SkImage> snapshot = surface->makeImageSnapshot();
+    canvas->drawRect(SkRect::MakeXYWH(20, 20, 10, 10), paint);
+
+    SkBitmap before, after;
+    REPORTER_ASSERT(r, snapshot->asLegacyBitmap(&before));
+    after.allocPixels(surface->imageInfo());
+    REPORTER_ASSERT(r, surface->readPixels(after, 0, 0));
+    REPORTER_ASSERT(r, before.getColor(25, 25) == SK_ColorWHITE);
+    REPORTER_ASSERT(r, after.getColor(25, 25) == SK_ColorRED);
+    REPORTER_ASSERT(r, after.getColor(5, 5) == SK_ColorRED);
+}
@@ -5,23 +5,30 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkExecutor.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkTraceMemoryDump.h"
 #include "include/core/SkTypes.h"
+#include "include/private/base/SkTArray.h"
 #include "include/private/chromium/SkDiscardableMemory.h"
 #include "src/core/SkResourceCache.h"
+#include "src/core/SkTaskGroup.h"
 #include "src/lazy/SkDiscardableMemoryPool.h"
 #include "tests/Test.h"
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 
 namespace {
 static void* gGlobalAddress;
 struct TestingKey : public SkResourceCache::Key {
     intptr_t    fValue;
 
-    TestingKey(intptr_t value, uint64_t sharedID = 0) : fValue(value) {
-        this->init(&gGlobalAddress, sharedID, sizeof(fValue));
+    TestingKey(intptr_t value, uint64_t sharedID = 0, void* nameSpace = &gGlobalAddress)
+            : fValue(value) {
+        this->init(nameSpace, sharedID, sizeof(fValue));
     }
 };
 struct TestingRec : public SkResourceCache::Rec {
@@ -154,3 +161,210 @@ DEF_TEST(ImageCache_doubleAdd, r) {
     REPORTER_ASSERT(r, cache.find(key, TestingRec::Visitor, &value));
     REPORTER_ASSERT(r, 2 == value || 3 == value);
 }
+
+static void* gOtherAddress;
+static constexpr size_t kRecBytes = sizeof(TestingKey) + sizeof(intptr_t);
+
+static bool has(SkResourceCache& cache, const TestingKey& key) {
+    intptr_t value;
+    return cache.find(key, TestingRec::Visitor, &value);
+}
+
+static SkResourceCache::NamespaceStats stats_for(SkResourceCache& cache, const void* nameSpace) {
+    skia_private::TArray<SkResourceCache::NamespaceStats> stats;
+    cache.getNamespaceStats(&stats);
+    for (const SkResourceCache::NamespaceStats& s : stats) {
+        if (s.fNamespace == nameSpace) {
+            return s;
+        }
+    }
+    return {};
+}
+
+DEF_TEST(ImageCache_namespaceBudget, r) {
+    SkResourceCache cache(100 * kRecBytes);
+    cache.setNamespaceOptions(&gOtherAddress, {4 * kRecBytes});
+
+    for (int i = 0; i < 10; ++i) {
+        cache.add(new TestingRec(TestingKey(i), i));
+        cache.add(new TestingRec(TestingKey(i, 0, &gOtherAddress), i));
+    }
+    // Only the namespace with a budget was purged, and only its oldest Recs.
+    for (int i = 0; i < 10; ++i) {
+        REPORTER_ASSERT(r, has(cache, TestingKey(i)));
+        REPORTER_ASSERT(r, has(cache, TestingKey(i, 0, &gOtherAddress)) == (i >= 6), "%d", i);
+    }
+
+    SkResourceCache::NamespaceStats stats = stats_for(cache, &gOtherAddress);
+    REPORTER_ASSERT(r, stats.fCount == 4);
+    REPORTER_ASSERT(r, stats.fBytesUsed == 4 * kRecBytes);
+    REPORTER_ASSERT(r, stats.fEvictions == 6);
+    REPORTER_ASSERT(r, stats.fHits == 4);
+    REPORTER_ASSERT(r, stats.fMisses == 6);
+    REPORTER_ASSERT(r, !strcmp(stats.fCategory, "test_cache"));
+    REPORTER_ASSERT(r, cache.getTotalBytesUsed() == 14 * kRecBytes);
+}
+
+DEF_TEST(ImageCache_namespaceDiscarded, r) {
+    SkResourceCache cache(100 * kRecBytes);
+    cache.add(new TestingRec(TestingKey(1, 0, &gOtherAddress), 1));
+    cache.add(new TestingRec(TestingKey(2, 0, &gOtherAddress), 2));
+
+    // As when a Rec's discardable memory was purged and can't be locked.
+    auto stale = [](const SkResourceCache::Rec&, void*) { return false; };
+    REPORTER_ASSERT(r, !cache.find(TestingKey(1, 0, &gOtherAddress), stale, nullptr));
+    REPORTER_ASSERT(r, !has(cache, TestingKey(1, 0, &gOtherAddress)));
+    REPORTER_ASSERT(r, has(cache, TestingKey(2, 0, &gOtherAddress)));
+
+    SkResourceCache::NamespaceStats stats = stats_for(cache, &gOtherAddress);
+    REPORTER_ASSERT(r, stats.fDiscarded == 1);
+    REPORTER_ASSERT(r, stats.fEvictions == 0);
+    REPORTER_ASSERT(r, stats.fCount == 1);
+}
+
+DEF_TEST(ImageCache_namespacePriority, r) {
+    // Room for 10 Recs; the limit itself is over budget.
+    SkResourceCache cache(10 * kRecBytes + 1);
+    SkResourceCache::NamespaceOptions options;
+    options.fPriority = 1;
+    cache.setNamespaceOptions(&gOtherAddress, options);
+
+    for (int i = 0; i < 8; ++i) {
+        cache.add(new TestingRec(TestingKey(i, 0, &gOtherAddress), i));
+    }
+    for (int i = 0; i < 8; ++i) {
+        cache.add(new TestingRec(TestingKey(i), i));
+    }
+    // The newer Recs are purged, since their namespace has the lower priority.
+    for (int i = 0; i < 8; ++i) {
+        REPORTER_ASSERT(r, has(cache, TestingKey(i, 0, &gOtherAddress)));
+        REPORTER_ASSERT(r, has(cache, TestingKey(i)) == (i >= 6), "%d", i);
+    }
+
+    // With equal priorities, the cache is a single LRU across namespaces.
+    options.fPriority = 0;
+    cache.setNamespaceOptions(&gOtherAddress, options);
+    cache.add(new TestingRec(TestingKey(100), 100));
+    REPORTER_ASSERT(r, !has(cache, TestingKey(0, 0, &gOtherAddress)));
+    REPORTER_ASSERT(r, has(cache, TestingKey(1, 0, &gOtherAddress)));
+}
+
+DEF_TEST(ImageCache_frequencyEviction, r) {
+    for (auto eviction : {SkResourceCache::Eviction::kLRU, SkResourceCache::Eviction::kFrequency}) {
+        SkResourceCache cache(100 * kRecBytes);
+        cache.setNamespaceOptions(&gGlobalAddress, {4 * kRecBytes, 0, eviction});
+
+        for (int i = 0; i < 4; ++i) {
+            cache.add(new TestingRec(TestingKey(i), i));
+        }
+        // Key 0 is the most popular, but the least recently used.
+        for (int i = 0; i < 5; ++i) {
+            REPORTER_ASSERT(r, has(cache, TestingKey(0)));
+        }
+        for (int i = 1; i < 4; ++i) {
+            REPORTER_ASSERT(r, has(cache, TestingKey(i)));
+        }
+
+        cache.add(new TestingRec(TestingKey(4), 4));
+        const bool frequency = eviction == SkResourceCache::Eviction::kFrequency;
+        REPORTER_ASSERT(r, has(cache, TestingKey(0)) == frequency);
+        REPORTER_ASSERT(r, has(cache, TestingKey(1)) == !frequency);
+        REPORTER_ASSERT(r, has(cache, TestingKey(4)));
+    }
+}
+
+namespace {
+class CategoryDump : public SkTraceMemoryDump {
+public:
+    void dumpNumericValue(const char* dumpName, const char* valueName, const char*,
+                          uint64_t value) override {
+        if (!strcmp(dumpName, "skia/sk_resource_cache/category/test_cache_mt")) {
+            if (!strcmp(valueName, "hits"))   { fHits = value; }
+            if (!strcmp(valueName, "misses")) { fMisses = value; }
+        }
+    }
+    void setMemoryBacking(const char*, const char*, const char*) override {}
+    void setDiscardableMemoryBacking(const char*, const SkDiscardableMemory&) override {}
+    LevelOfDetail getRequestedDetails() const override { return kObjectsBreakdowns_LevelOfDetail; }
+
+    uint64_t fHits = 0, fMisses = 0;
+};
+
+static void* gThreadedAddress;
+struct ThreadedRec : public TestingRec {
+    using TestingRec::TestingRec;
+    const char* getCategory() const override { return "test_cache_mt"; }
+};
+}  // namespace
+
+DEF_TEST(ImageCache_globalThreaded, r) {
+    static constexpr int kThreads = 4, kKeys = 64, kRounds = 8;
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(kThreads);
+
+    // Every thread finds and adds the same keys, so they race on the same Recs and stripes.
+    SkTaskGroup(*executor).batch(kThreads, [](int) {
+        for (int round = 0; round < kRounds; ++round) {
+            for (int i = 0; i < kKeys; ++i) {
+                TestingKey key(i, 0, &gThreadedAddress);
+                intptr_t value = -1;
+                if (!SkResourceCache::Find(key, TestingRec::Visitor, &value)) {
+                    SkResourceCache::Add(new ThreadedRec(key, i));
+                }
+            }
+        }
+    });
+
+    skia_private::TArray<SkResourceCache::NamespaceStats> stats;
+    SkResourceCache::GetNamespaceStats(&stats);
+    const SkResourceCache::NamespaceStats* threaded = nullptr;
+    for (const SkResourceCache::NamespaceStats& s : stats) {
+        if (s.fNamespace == &gThreadedAddress) {
+            threaded = &s;
+        }
+    }
+    if (!threaded) {
+        ERRORF(r, "no stats for the threaded namespace");
+        return;
+    }
+    REPORTER_ASSERT(r, threaded->fHits + threaded->fMisses == kThreads * kKeys * kRounds);
+    REPORTER_ASSERT(r, threaded->fMisses >= (uint64_t)kKeys);
+    REPORTER_ASSERT(r, threaded->fBytesUsed == threaded->fCount * kRecBytes);
+
+    CategoryDump dump;
+    SkResourceCache::DumpMemoryStatistics(&dump);
+    REPORTER_ASSERT(r, dump.fHits >= threaded->fHits);
+    REPORTER_ASSERT(r, dump.fMisses >= threaded->fMisses);
+}
+
+namespace {
+static void* gStripedAddress;
+struct HeavyRec : public TestingRec {
+    using TestingRec::TestingRec;
+    size_t bytesUsed() const override { return 4 * kRecBytes; }
+};
+}  // namespace
+
+DEF_TEST(ImageCache_globalNamespaceBudget, r) {
+    SkResourceCache::SetNamespaceOptions(&gStripedAddress, {8 * kRecBytes});
+
+    // More than an even share of the limit in any one stripe is fine while the total fits.
+    TestingKey heavy(-1, 0, &gStripedAddress);
+    SkResourceCache::Add(new HeavyRec(heavy, 0));
+    intptr_t value;
+    REPORTER_ASSERT(r, SkResourceCache::Find(heavy, TestingRec::Visitor, &value));
+
+    // The limit holds for the sum over all the stripes.
+    for (int i = 0; i < 64; ++i) {
+        SkResourceCache::Add(new TestingRec(TestingKey(i, 0, &gStripedAddress), i));
+    }
+    skia_private::TArray<SkResourceCache::NamespaceStats> stats;
+    SkResourceCache::GetNamespaceStats(&stats);
+    for (const SkResourceCache::NamespaceStats& s : stats) {
+        if (s.fNamespace == &gStripedAddress) {
+            REPORTER_ASSERT(r, s.fBytesUsed <= 8 * kRecBytes, "%zu", s.fBytesUsed);
+            REPORTER_ASSERT(r, s.fEvictions > 0);
+        }
+    }
+    REPORTER_ASSERT(r, SkResourceCache::Find(TestingKey(63, 0, &gStripedAddress),
+                                             TestingRec::Visitor, &value));
+}
@@ -8,6 +8,7 @@
 #include "include/core/SkAlphaType.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkColorFilter.h"
 #include "include/core/SkColorSpace.h"
@@ -17,6 +18,8 @@
 #include "include/core/SkImageFilter.h"
 #include "include/core/SkImageInfo.h"
 #include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPictureRecorder.h"
 #include "include/core/SkPoint.h"
 #include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
@@ -29,8 +32,11 @@
 #include "include/gpu/ganesh/SkImageGanesh.h"
 #include "include/private/base/SkDebug.h"
 #include "include/private/gpu/ganesh/GrTypesPriv.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkDevice.h"
 #include "src/core/SkImageFilterCache.h"
 #include "src/core/SkImageFilterTypes.h"
+#include "src/core/SkImageFilter_Base.h"
 #include "src/core/SkSpecialImage.h"
 #include "src/gpu/ganesh/GrColorInfo.h" // IWYU pragma: keep
 #include "src/gpu/ganesh/GrDirectContextPriv.h"
@@ -41,6 +47,7 @@
 #include "src/gpu/ganesh/image/SkSpecialImage_Ganesh.h"
 #include "tests/CtsEnforcement.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 
 #include <cstddef>
 #include <tuple>
@@ -49,6 +56,8 @@
 class GrRecordingContext;
 struct GrContextOptions;
 
+extern bool gSkDisableImageFilterTiles;
+
 static const int kSmallerSize = 10;
 static const int kPad = 3;
 static const int kFullSize = kSmallerSize + 2 * kPad;
@@ -239,6 +248,173 @@ DEF_TEST(ImageFilterCache_ImageBackedRaster, reporter) {
     test_image_backed(reporter, nullptr, srcImage);
 }
 
+// The raster backend with a cache of its own, so that the hits counted don't depend on what else
+// is in the global cache or on its budget.
+class PrivateCacheBackend final : public skif::Backend {
+public:
+    PrivateCacheBackend(sk_sp<skif::Backend> raster, size_t cacheSize)
+            : Backend(SkImageFilterCache::Create(cacheSize),
+                      raster->surfaceProps(),
+                      raster->colorType())
+            , fRaster(std::move(raster)) {}
+
+    sk_sp<SkDevice> makeDevice(SkISize size,
+                               sk_sp<SkColorSpace> colorSpace,
+                               const SkSurfaceProps* props) const override {
+        return fRaster->makeDevice(size, std::move(colorSpace), props);
+    }
+    sk_sp<SkSpecialImage> makeImage(const SkIRect& subset, sk_sp<SkImage> image) const override {
+        return fRaster->makeImage(subset, std::move(image));
+    }
+    sk_sp<SkImage> getCachedBitmap(const SkBitmap& data) const override {
+        return fRaster->getCachedBitmap(data);
+    }
+    const SkBlurEngine* getBlurEngine() const override { return fRaster->getBlurEngine(); }
+    bool useLegacyFilterResultBlur() const override {
+        return fRaster->useLegacyFilterResultBlur();
+    }
+    SkExecutor* tileExecutor() const override { return fRaster->tileExecutor(); }
+
+private:
+    sk_sp<skif::Backend> fRaster;
+};
+
+// Filters a picture with a small DAG under a scrolling layer matrix, checking that the output
+// matches filtering it whole and that the tiles already filtered are found in the cache.
+DEF_TEST(ImageFilterCache_Tiles, reporter) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(2000, 2000));
+    SkRandom rand;
+    // Pixel-aligned rects, so that the pixels drawn don't depend on which tile they're drawn in.
+    for (int i = 0; i < 200; ++i) {
+        SkPaint paint;
+        paint.setColor(rand.nextU() | 0xff000000);
+        canvas->drawRect(SkRect::Make(SkIRect::MakeXYWH(rand.nextULessThan(2000),
+                                                        rand.nextULessThan(2000),
+                                                        rand.nextRangeU(5, 150),
+                                                        rand.nextRangeU(5, 150))), paint);
+    }
+    sk_sp<SkImageFilter> blur = SkImageFilters::Blur(
+            6, 6, SkImageFilters::Picture(recorder.finishRecordingAsPicture()));
+    sk_sp<SkImageFilter> dag = SkImageFilters::Merge(
+            SkImageFilters::Offset(20, 30, blur),
+            SkImageFilters::ColorFilter(SkColorFilters::Blend(0x80336699, SkBlendMode::kSrcIn),
+                                        blur));
+
+    auto raster = skif::MakeRasterBackend(SkSurfaceProps(), kN32_SkColorType);
+    auto backend = sk_make_sp<PrivateCacheBackend>(raster, 256 * 1024 * 1024);
+    const skif::LayerSpace<SkIRect> viewport{SkIRect::MakeWH(1200, 1000)};
+    auto filter = [&](SkVector scroll, skif::Stats* stats, SkBitmap* bitmap, SkIPoint* offset) {
+        const skif::Context ctx{gSkDisableImageFilterTiles ? raster : backend,
+                                skif::Mapping(SkMatrix::Translate(scroll)), viewport,
+                                skif::FilterResult{}, /*colorSpace=*/nullptr, stats};
+        REPORTER_ASSERT(reporter, ctx.shouldEvaluateInTiles() == !gSkDisableImageFilterTiles);
+        sk_sp<SkSpecialImage> image = as_IFB(dag)->filterImage(ctx).imageAndOffset(ctx, offset);
+        REPORTER_ASSERT(reporter, image && SkSpecialImages::AsBitmap(image.get(), bitmap));
+    };
+
+    // The 512x512 tiles overlapped by the viewport move with the scroll. Those inside it are
+    // cached whole and found again when they are on its edge; edge tiles are cropped to it.
+    struct {
+        SkVector fScroll;
+        int      fHits;  // tiles filtered before, or 1 if the whole output was
+        bool     fWhole; // the whole output was filtered before
+    } scrolls[] = {
+        {{   0,    0}, 0, false},  // 6 tiles, 2 inside
+        {{-100, -100}, 2, false},  // 9 tiles, 1 inside, 2 found from the first scroll
+        {{-600,    0}, 2, false},  // 6 tiles, 1 inside, 1 found from each earlier scroll
+        {{-600, -500}, 3, false},  // 9 tiles, 1 inside, 3 found from the earlier scrolls
+        {{   0,    0}, 1, true},
+        {{-0.5f,  -3}, 0, false},  // a different fractional translation needs new tiles
+    };
+    for (const auto& scroll : scrolls) {
+        skif::Stats stats;
+        SkBitmap tiled, whole;
+        SkIPoint tiledOffset, wholeOffset;
+        filter(scroll.fScroll, &stats, &tiled, &tiledOffset);
+        REPORTER_ASSERT(reporter, stats.fNumCacheHits == scroll.fHits,
+                        "%d hits, expected %d", stats.fNumCacheHits, scroll.fHits);
+        if (scroll.fWhole) {
+            // Only the root was visited.
+            REPORTER_ASSERT(reporter, stats.fNumVisitedImageFilters == 1);
+        }
+
+        gSkDisableImageFilterTiles = true;
+        filter(scroll.fScroll, nullptr, &whole, &wholeOffset);
+        gSkDisableImageFilterTiles = false;
+
+        REPORTER_ASSERT(reporter, tiledOffset == wholeOffset);
+        REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(tiled, whole),
+                        "scroll %g, %g", scroll.fScroll.fX, scroll.fScroll.fY);
+    }
+}
+
+// Filters content that straddles the tile seams with a chain of filters that each read past their
+// output, so that every tile needs pixels from its neighbors, and checks that the output matches
+// filtering it whole.
+DEF_TEST(ImageFilterCache_TileSeams, reporter) {
+    SkPictureRecorder recorder;
+    SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(1600, 1600));
+    SkRandom rand;
+    for (int seam = 512; seam < 1600; seam += 512) {
+        for (int i = 0; i < 20; ++i) {
+            SkPaint paint;
+            paint.setColor(rand.nextU() | 0xff000000);
+            const int along = rand.nextULessThan(1600);
+            const int across = seam - rand.nextRangeU(1, 40);
+            const int length = rand.nextRangeU(5, 100),
+                      width = rand.nextRangeU(2, 80);
+            canvas->drawRect(SkRect::Make(SkIRect::MakeXYWH(across, along, width, length)), paint);
+            canvas->drawRect(SkRect::Make(SkIRect::MakeXYWH(along, across, length, width)), paint);
+        }
+    }
+    sk_sp<SkImageFilter> chain = SkImageFilters::Picture(recorder.finishRecordingAsPicture());
+    chain = SkImageFilters::Dilate(4, 4, std::move(chain));
+    chain = SkImageFilters::Blur(5, 5, std::move(chain));
+    chain = SkImageFilters::Offset(13, -9, std::move(chain));
+    chain = SkImageFilters::Blur(3, 1, std::move(chain));
+    chain = SkImageFilters::ColorFilter(
+            SkColorFilters::Blend(0x80336699, SkBlendMode::kSrcATop), std::move(chain));
+
+    auto raster = skif::MakeRasterBackend(SkSurfaceProps(), kN32_SkColorType);
+    auto backend = sk_make_sp<PrivateCacheBackend>(raster, 256 * 1024 * 1024);
+    auto filter = [&](const skif::LayerSpace<SkIRect>& output, SkVector scroll, bool tiled,
+                      SkBitmap* bitmap, SkIPoint* offset) {
+        const skif::Context ctx{tiled ? backend : raster,
+                                skif::Mapping(SkMatrix::Translate(scroll)), output,
+                                skif::FilterResult{}, /*colorSpace=*/nullptr, nullptr};
+        REPORTER_ASSERT(reporter, ctx.shouldEvaluateInTiles() == tiled);
+        sk_sp<SkSpecialImage> image = as_IFB(chain)->filterImage(ctx).imageAndOffset(ctx, offset);
+        REPORTER_ASSERT(reporter, image && SkSpecialImages::AsBitmap(image.get(), bitmap));
+    };
+
+    const skif::LayerSpace<SkIRect> outputs[] = {
+        skif::LayerSpace<SkIRect>{SkIRect::MakeWH(1100, 1100)},
+        skif::LayerSpace<SkIRect>{SkIRect::MakeXYWH(300, 490, 1200, 500)},
+    };
+    const SkVector scrolls[] = {{0, 0}, {-7, -500}, {-0.5f, -3}};
+    for (const auto& output : outputs) {
+        for (SkVector scroll : scrolls) {
+            SkBitmap tiled, whole;
+            SkIPoint tiledOffset, wholeOffset;
+            filter(output, scroll, /*tiled=*/true, &tiled, &tiledOffset);
+            filter(output, scroll, /*tiled=*/false, &whole, &wholeOffset);
+            REPORTER_ASSERT(reporter, tiledOffset == wholeOffset);
+            REPORTER_ASSERT(reporter, ToolUtils::equal_pixels(tiled, whole),
+                            "scroll %g, %g", scroll.fX, scroll.fY);
+        }
+    }
+
+    // Outputs that would need too many tiles are evaluated whole, however far they reach.
+    for (const SkIRect& output : {SkIRect::MakeWH(8192, 8192),
+                                  SkIRect::MakeWH(1 << 27, 1 << 27),
+                                  SkIRect::MakeLTRB(-(1 << 30), -(1 << 30), 1 << 30, 1 << 30)}) {
+        const skif::Context ctx{backend, skif::Mapping(), skif::LayerSpace<SkIRect>{output},
+                                skif::FilterResult{}, /*colorSpace=*/nullptr, nullptr};
+        REPORTER_ASSERT(reporter, !ctx.shouldEvaluateInTiles());
+    }
+}
+
 static GrSurfaceProxyView create_proxy_view(GrRecordingContext* rContext) {
     SkBitmap srcBM = create_bm();
     return std::get<0>(GrMakeUncachedBitmapProxyView(rContext, srcBM));
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkColorPriv.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageFilter.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSize.h"
+#include "include/core/SkTileMode.h"
+#include "include/effects/SkImageFilters.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkImageFilterCache.h"
+#include "tests/Test.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+extern bool gSkDisablePixelKernels;
+
+static constexpr int kW = 70, kH = 50;
+
+static sk_sp<SkImage> make_source() {
+    SkBitmap bitmap;
+    bitmap.allocPixels(SkImageInfo::MakeN32Premul(kW, kH));
+    SkRandom rand;
+    for (int y = 0; y < kH; ++y) {
+        for (int x = 0; x < kW; ++x) {
+            // Leave some pixels transparent to exercise unpremultiplying.
+            const U8CPU a = rand.nextULessThan(4) == 0 ? 0 : rand.nextULessThan(256);
+            *bitmap.getAddr32(x, y) = SkPackARGB32(a,
+                                                   rand.nextULessThan(a + 1),
+                                                   rand.nextULessThan(a + 1),
+                                                   rand.nextULessThan(a + 1));
+        }
+    }
+    return bitmap.asImage();
+}
+
+// Draws 'source' with 'filter', offset into a surface larger than the source. Returns the largest
+// difference in any channel between drawing with the pixel kernels and with shaders. The input is
+// pixel-aligned, since with a fractional transform the shaders sample it directly, while the pixel
+// kernels read it resolved to 8 bits.
+static int max_difference(const sk_sp<SkImage>& source, sk_sp<SkImageFilter> filter) {
+    SkBitmap results[2];
+    for (bool pixelKernels : {false, true}) {
+        gSkDisablePixelKernels = !pixelKernels;
+        // Otherwise the second draw would find the first's output in the cache.
+        SkImageFilterCache::Get()->purge();
+        SkBitmap& result = results[pixelKernels];
+        result.allocPixels(SkImageInfo::MakeN32Premul(kW * 2 + 20, kH * 2 + 20));
+        result.eraseColor(SK_ColorTRANSPARENT);
+        SkCanvas canvas{result};
+        canvas.translate(10, 10);
+        SkPaint paint;
+        paint.setImageFilter(filter);
+        canvas.drawImage(source, 3, 2, SkSamplingOptions{}, &paint);
+    }
+    gSkDisablePixelKernels = false;
+
+    int maxDifference = 0;
+    for (int y = 0; y < results[0].height(); ++y) {
+        for (int x = 0; x < results[0].width(); ++x) {
+            const uint32_t a = *results[0].getAddr32(x, y), b = *results[1].getAddr32(x, y);
+            for (int shift = 0; shift < 32; shift += 8) {
+                maxDifference = std::max(maxDifference, std::abs(int((a >> shift) & 0xff) -
+                                                                 int((b >> shift) & 0xff)));
+            }
+        }
+    }
+    return maxDifference;
+}
+
+// The minimum and maximum are taken of the same 8-bit values either way, so they match exactly,
+// including past the shaders' linear radius where they double the radius each pass.
+DEF_TEST(ImageFilterPixelKernels_Morphology, r) {
+    const sk_sp<SkImage> source = make_source();
+    const SkSize radii[] = {{1, 1}, {3, 0}, {0, 2}, {5, 9}, {20, 17}};
+    const SkIRect crop = SkIRect::MakeXYWH(8, 5, 40, 30);
+    for (SkSize radius : radii) {
+        for (bool dilate : {false, true}) {
+            auto make = [&](sk_sp<SkImageFilter> input,
+                            const SkImageFilters::CropRect& cropRect) {
+                return dilate ? SkImageFilters::Dilate(radius.width(), radius.height(),
+                                                       std::move(input), cropRect)
+                              : SkImageFilters::Erode(radius.width(), radius.height(),
+                                                      std::move(input), cropRect);
+            };
+            const sk_sp<SkImageFilter> filters[] = {
+                make(nullptr, {}),
+                make(nullptr, SkRect::Make(crop)),
+                make(SkImageFilters::Crop(SkRect::Make(crop), SkTileMode::kMirror, nullptr),
+                     {}),
+            };
+            for (const sk_sp<SkImageFilter>& filter : filters) {
+                const int difference = max_difference(source, filter);
+                REPORTER_ASSERT(r, difference == 0,
+                                "%s %g x %g: difference %d",
+                                dilate ? "dilate" : "erode", radius.width(), radius.height(),
+                                difference);
+            }
+        }
+    }
+}
+
+// The pixel kernels sum in a different order, and the separable ones in two passes, so allow them
+// to round differently.
+DEF_TEST(ImageFilterPixelKernels_MatrixConvolution, r) {
+    const sk_sp<SkImage> source = make_source();
+    struct Kernel {
+        SkISize            fSize;
+        std::vector<float> fCoefficients;
+        SkIPoint           fOffset;
+    };
+    const Kernel kernels[] = {
+        // Not separable
+        {{3, 3}, {-1, -1, -1, -1, 9, -1, -1, -1, -1}, {1, 1}},
+        // Separable: the outer product of {1, 2, 1} and {1, 0, -1, 2}
+        {{4, 3}, {1, 0, -1, 2, 2, 0, -2, 4, 1, 0, -1, 2}, {3, 0}},
+        // Separable 1D
+        {{5, 1}, {0.2f, 0.2f, 0.2f, 0.2f, 0.2f}, {2, 0}},
+    };
+    const SkTileMode tileModes[] = {SkTileMode::kDecal, SkTileMode::kClamp, SkTileMode::kRepeat};
+    for (const Kernel& kernel : kernels) {
+        for (bool convolveAlpha : {false, true}) {
+            for (SkTileMode tileMode : tileModes) {
+                for (float bias : {0.f, 12.f}) {
+                    sk_sp<SkImageFilter> filter = SkImageFilters::MatrixConvolution(
+                            kernel.fSize, kernel.fCoefficients.data(), 0.5f, bias, kernel.fOffset,
+                            tileMode, convolveAlpha, nullptr, SkRect::MakeXYWH(4, 3, 50, 40));
+                    const int difference = max_difference(source, filter);
+                    REPORTER_ASSERT(r, difference <= 1,
+                                    "kernel %dx%d, convolve alpha %d, tile mode %d, bias %g: "
+                                    "difference %d",
+                                    kernel.fSize.width(), kernel.fSize.height(), convolveAlpha,
+                                    (int)tileMode, bias, difference);
+                }
+            }
+        }
+    }
+}
@@ -4,6 +4,7 @@
  * Use of this source code is governed by a BSD-style license that can be
  * found in the LICENSE file.
  */
+#include "include/core/SkAnnotation.h"
 #include "include/core/SkBitmap.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkColor.h"
@@ -13,10 +14,16 @@
 #include "include/core/SkFont.h"
 #include "include/core/SkImage.h" // IWYU pragma: keep
 #include "include/core/SkPaint.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
 #include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkShader.h"
 #include "include/core/SkStream.h"
 #include "include/core/SkString.h"
+#include "include/core/SkTileMode.h"
 #include "include/docs/SkPDFDocument.h"
+#include "include/effects/SkGradientShader.h"
 #include "src/utils/SkOSPath.h"
 #include "tests/Test.h"
 #include "tools/fonts/FontToolUtils.h"
@@ -25,6 +32,7 @@
 #include <cstdio>
 #include <cstring>
 #include <memory>
+#include <string_view>
 
 static void test_empty(skiatest::Reporter* reporter) {
     SkDynamicMemoryWStream stream;
@@ -267,3 +275,79 @@ DEF_TEST(SkPDF_abort_jobs, rep) {
     doc->abort();
 }
 
+
+static int count_occurrences(std::string_view pdf, const char* needle) {
+    int count = 0;
+    for (size_t i = pdf.find(needle); i != std::string_view::npos; i = pdf.find(needle, i + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+// Pages drawn concurrently should share their resources, keep their annotations, and be written
+// in order.
+DEF_TEST(SkPDF_concurrent_pages, r) {
+    REQUIRE_PDF_DOCUMENT(SkPDF_concurrent_pages, r);
+    constexpr int kPageCount = 40;
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(64, 64);
+    bitmap.eraseColor(0xFF9643A0);
+    sk_sp<SkImage> image = bitmap.asImage();
+    SkFont font = ToolUtils::DefaultPortableFont();
+    SkPaint imageShaderPaint;
+    imageShaderPaint.setShader(image->makeShader(SkTileMode::kRepeat, SkTileMode::kRepeat,
+                                                 SkSamplingOptions()));
+    SkPaint gradientPaint;
+    const SkPoint points[2] = {{72, 432}, {200, 560}};
+    const SkColor colors[2] = {SK_ColorRED, 0x800000FF};
+    gradientPaint.setShader(SkGradientShader::MakeLinear(points, colors, nullptr, 2,
+                                                         SkTileMode::kClamp));
+
+    auto makePDF = [&](bool concurrentPages) {
+        std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+        SkPDF::Metadata metadata;
+        metadata.fExecutor = executor.get();
+        metadata.fConcurrentPages = concurrentPages;
+        SkDynamicMemoryWStream stream;
+        auto doc = SkPDF::MakeDocument(&stream, metadata);
+        for (int i = 0; i < kPageCount; ++i) {
+            // Give each page its own width, to find it in the document.
+            SkCanvas* canvas = doc->beginPage(500 + i, 792);
+            canvas->drawString(SkStringPrintf("Page %d", i), 72, 72, font, SkPaint());
+            canvas->drawImage(image, 72, 144);
+            // Every page uses the same shaders, which should each be emitted once.
+            canvas->drawRect(SkRect::MakeXYWH(72, 288, 128, 128), imageShaderPaint);
+            canvas->drawRect(SkRect::MakeXYWH(72, 432, 128, 128), gradientPaint);
+            SkString url = SkStringPrintf("https://skia.org/%d", i);
+            SkAnnotateRectWithURL(canvas, SkRect::MakeXYWH(72, 144, 64, 64),
+                                  SkData::MakeWithCopy(url.c_str(), url.size() + 1).get());
+            doc->endPage();
+        }
+        doc->close();
+        return stream.detachAsData();
+    };
+    sk_sp<SkData> serial = makePDF(false);
+    sk_sp<SkData> concurrent = makePDF(true);
+    std::string_view serialPDF(static_cast<const char*>(serial->data()), serial->size());
+    std::string_view concurrentPDF(static_cast<const char*>(concurrent->data()),
+                                   concurrent->size());
+
+    for (const char* expectation : {"/Subtype /Image", "/Type /Font", "/Subtype /Link", "/URI",
+                                    "/PatternType"}) {
+        int expected = count_occurrences(serialPDF, expectation);
+        int actual = count_occurrences(concurrentPDF, expectation);
+        REPORTER_ASSERT(r, expected == actual, "'%s' %d times, expected %d",
+                        expectation, actual, expected);
+    }
+    REPORTER_ASSERT(r, count_occurrences(concurrentPDF, "/Subtype /Image") == 1);
+    REPORTER_ASSERT(r, count_occurrences(concurrentPDF, "/Subtype /Link") == kPageCount);
+
+    size_t previous = 0;
+    for (int i = 0; i < kPageCount; ++i) {
+        SkString mediaBox = SkStringPrintf("/MediaBox [0 0 %d 792]", 500 + i);
+        size_t offset = concurrentPDF.find(mediaBox.c_str());
+        REPORTER_ASSERT(r, offset != std::string_view::npos && offset >= previous,
+                        "page %d is missing or out of order", i);
+        previous = offset;
+    }
+}
@@ -11,6 +11,7 @@
 #include "include/core/SkClipOp.h"
 #include "include/core/SkColor.h"
 #include "include/core/SkData.h"
+#include "include/core/SkExecutor.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkImage.h" // IWYU pragma: keep
@@ -26,18 +27,26 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSamplingOptions.h"
 #include "include/core/SkScalar.h"
+#include "include/core/SkSerialProcs.h"
 #include "include/core/SkStream.h"
+#include "include/core/SkSurface.h"
 #include "include/core/SkTypeface.h"
 #include "include/core/SkTypes.h"
+#include "include/encode/SkPngEncoder.h"
 #include "src/base/SkRandom.h"
 #include "src/core/SkBigPicture.h"
 #include "src/core/SkPicturePriv.h"
 #include "src/core/SkRectPriv.h"
 #include "tests/Test.h"
+#include "tools/ToolUtils.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <atomic>
+#include <cmath>
 #include <cstddef>
+#include <cstring>
 #include <memory>
+#include <optional>
 #include <vector>
 
 class SkRRect;
@@ -924,3 +933,176 @@ DEF_TEST(Picture_nested_op_count, r) {
     check(make_pic(10, leaf1),  10,  10);
     check(make_pic(10, leaf10), 10, 100);
 }
+
+DEF_TEST(Picture_playbackParallel, r) {
+    const SkRect cull = {10, 20, 210, 170};
+
+    SkRTreeFactory factory;
+    SkPictureRecorder rec;
+    SkCanvas* c = rec.beginRecording(cull, &factory);
+    SkRandom rand;
+    SkPaint paint;
+    for (int i = 0; i < 200; i++) {
+        // Pixel-aligned, so clipping to a band doesn't change any pixel's coverage.
+        const float x = (float)rand.nextRangeU(0, 200),
+                    y = (float)rand.nextRangeU(10, 180);
+        paint.setColor(rand.nextU() | 0xFF000000);
+        paint.setAlphaf(0.5f);
+        c->drawRect(SkRect::MakeXYWH(x, y, 24, 16), paint);
+    }
+    sk_sp<SkPicture> pic = rec.finishRecordingAsPicture();
+
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(200, 150);
+    SkBitmap expected;
+    expected.allocPixels(info);
+    expected.eraseColor(SK_ColorWHITE);
+    {
+        SkCanvas canvas(expected);
+        canvas.translate(-cull.fLeft, -cull.fTop);
+        pic->playback(&canvas);
+    }
+
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    for (SkExecutor* exec : {executor.get(), (SkExecutor*)nullptr}) {
+        for (int bandCount : {1, 3, 8, 1000}) {
+            SkBitmap actual;
+            actual.allocPixels(info);
+            actual.eraseColor(SK_ColorWHITE);
+
+            // Each band draws through its own canvas into its own rows of actual.
+            std::atomic<int> rows{0};
+            pic->playbackParallel([&](const SkIRect& band) {
+                rows += band.height();
+                REPORTER_ASSERT(r, band.fLeft == 10 && band.fRight == 210);
+                std::unique_ptr<SkCanvas> canvas = SkCanvas::MakeRasterDirect(
+                        info.makeWH(info.width(), band.height()),
+                        actual.getAddr(0, band.fTop - SkScalarRoundToInt(cull.fTop)),
+                        actual.rowBytes());
+                canvas->translate(-cull.fLeft, -(float)band.fTop);
+                return canvas;
+            }, exec, bandCount);
+
+            REPORTER_ASSERT(r, rows == info.height());
+            REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual),
+                            "bandCount %d", bandCount);
+        }
+    }
+}
+
+// A picture with paths, text, an encoded image and a nested picture, for serializing.
+static sk_sp<SkPicture> make_picture_for_mapping() {
+    SkBitmap bm;
+    make_bm(&bm, 16, 16, SK_ColorBLUE, /*immutable=*/false);
+    bm.eraseArea(SkIRect::MakeWH(8, 8), SK_ColorYELLOW);
+    sk_sp<SkImage> image = bm.asImage();
+
+    SkPictureRecorder nestedRec;
+    SkCanvas* c = nestedRec.beginRecording({0, 0, 50, 50});
+    for (int i = 0; i < 6; i++) {
+        c->drawCircle(25, 25, 25 - 4 * i, SkPaint(i % 2 ? SkColors::kRed : SkColors::kGreen));
+    }
+    sk_sp<SkPicture> nested = nestedRec.finishRecordingAsPicture();
+
+    SkPictureRecorder rec;
+    c = rec.beginRecording({0, 0, 120, 100});
+    SkRandom rand;
+    for (int i = 0; i < 20; i++) {
+        rand_op(c, rand);
+    }
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setColor(0xFF336699);
+    SkPath star;
+    for (int i = 0; i < 5; i++) {
+        const float a = i * 4 * SK_ScalarPI / 5;
+        const SkPoint p = {60 + 30 * std::sin(a), 50 - 30 * std::cos(a)};
+        i == 0 ? star.moveTo(p) : star.lineTo(p);
+    }
+    c->drawPath(star, paint);
+    c->drawString("mapped", 10, 90, ToolUtils::DefaultPortableFont(), paint);
+    c->drawImageRect(image, SkRect::MakeXYWH(70, 5, 40, 40), SkSamplingOptions());
+    c->translate(5, 40);
+    c->drawPicture(nested);
+    c->translate(60, 0);
+    c->drawPicture(nested);
+    return rec.finishRecordingAsPicture();
+}
+
+static SkBitmap draw_picture(const sk_sp<SkPicture>& pic) {
+    SkBitmap bm;
+    bm.allocN32Pixels(120, 100);
+    bm.eraseColor(SK_ColorWHITE);
+    SkCanvas canvas(bm);
+    canvas.drawPicture(pic);
+    return bm;
+}
+
+DEF_TEST(Picture_MappedData, r) {
+    SkSerialProcs procs;
+    procs.fImageProc = [](SkImage* img, void*) -> sk_sp<SkData> {
+        return SkPngEncoder::Encode(nullptr, img, {});
+    };
+    // Notes where each encoded image was when it was read.
+    struct Images {
+        std::vector<const void*> fData;
+    } images;
+    SkDeserialProcs dprocs;
+    dprocs.fImageDataProc = [](sk_sp<SkData> data, std::optional<SkAlphaType> alphaType,
+                               void* ctx) {
+        static_cast<Images*>(ctx)->fData.push_back(data->data());
+        return SkImages::DeferredFromEncodedData(std::move(data), alphaType);
+    };
+    dprocs.fImageCtx = &images;
+
+    sk_sp<SkPicture> pic = make_picture_for_mapping();
+    sk_sp<SkData> serialized = pic->serialize(&procs),
+                  mappable   = pic->serializeForMapping(&procs);
+    const SkBitmap expected = draw_picture(SkPicture::MakeFromData(serialized.get(), &dprocs));
+
+    auto inside = [](const void* ptr, const SkData* data) {
+        return data->bytes() <= ptr && ptr < data->bytes() + data->size();
+    };
+
+    // The ops and images should be used in place, and both keep the data alive.
+    images.fData.clear();
+    sk_sp<SkPicture> mapped = SkPicture::MakeFromMappedData(mappable, &dprocs);
+    REPORTER_ASSERT(r, mapped);
+    REPORTER_ASSERT(r, !mappable->unique());
+    REPORTER_ASSERT(r, images.fData.size() == 1 && inside(images.fData[0], mappable.get()));
+    REPORTER_ASSERT(r, mapped->cullRect() == pic->cullRect());
+    // The serialized ops don't match the recorded ones exactly, e.g. in their saves and restores.
+    REPORTER_ASSERT(r, mapped->approximateOpCount() >= pic->approximateOpCount(),
+                    "%d ops, recorded %d", mapped->approximateOpCount(), pic->approximateOpCount());
+    REPORTER_ASSERT(r, mapped->approximateOpCount(true) > mapped->approximateOpCount());
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, draw_picture(mapped)));
+
+    // The mappable format can be read like any other, and the regular format can be mapped,
+    // both by copying.
+    for (const sk_sp<SkData>& data : {mappable, serialized}) {
+        sk_sp<SkData> copy = SkData::MakeWithCopy(data->data(), data->size());
+        images.fData.clear();
+        sk_sp<SkPicture> copied = data == mappable
+                                        ? SkPicture::MakeFromData(copy.get(), &dprocs)
+                                        : SkPicture::MakeFromMappedData(copy, &dprocs);
+        REPORTER_ASSERT(r, copied);
+        REPORTER_ASSERT(r, copy->unique());
+        REPORTER_ASSERT(r, images.fData.size() == 1 && !inside(images.fData[0], copy.get()));
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, draw_picture(copied)));
+    }
+
+    // If the data isn't 4-byte aligned in memory, it can't be used in place.
+    sk_sp<SkData> storage = SkData::MakeUninitialized(mappable->size() + 1);
+    memcpy((char*)storage->writable_data() + 1, mappable->data(), mappable->size());
+    sk_sp<SkData> misaligned = SkData::MakeSubset(storage.get(), 1, mappable->size());
+    images.fData.clear();
+    sk_sp<SkPicture> unaligned = SkPicture::MakeFromMappedData(misaligned, &dprocs);
+    REPORTER_ASSERT(r, unaligned);
+    REPORTER_ASSERT(r, images.fData.size() == 1 && !inside(images.fData[0], storage.get()));
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, draw_picture(unaligned)));
+
+    // Truncated data fails cleanly.
+    for (size_t size : {mappable->size() / 3, mappable->size() - 4}) {
+        REPORTER_ASSERT(r, !SkPicture::MakeFromMappedData(SkData::MakeSubset(mappable.get(), 0,
+                                                                             size)));
+    }
+}
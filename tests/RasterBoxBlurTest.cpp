@@ -0,0 +1,250 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkColorPriv.h"
+#include "include/core/SkColorType.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSize.h"
+#include "include/core/SkSurfaceProps.h"
+#include "include/core/SkTileMode.h"
+#include "include/private/base/SkTPin.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkBlurEngine.h"
+#include "src/core/SkSpecialImage.h"
+#include "tests/Test.h"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include <vector>
+
+extern bool gSkDisableRasterBoxBlur;
+
+namespace {
+
+using Pixel = std::array<double, 4>;
+
+// A straightforward successive box blur, as specified for feGaussianBlur, of the tiled source.
+class ReferenceBlur {
+public:
+    ReferenceBlur(const SkBitmap& src, const SkIRect& srcRect, SkTileMode tileMode)
+            : fSrcRect(srcRect), fTileMode(tileMode) {
+        SkBitmap f32;
+        f32.allocPixels(src.info().makeColorType(kRGBA_F32_SkColorType));
+        SkAssertResult(src.readPixels(f32.pixmap()));
+        fPixels.resize(src.width() * src.height());
+        for (int y = 0; y < src.height(); ++y) {
+            const float* row = static_cast<const float*>(f32.getAddr(0, y));
+            for (int x = 0; x < src.width(); ++x) {
+                fPixels[y * src.width() + x] = {row[4*x], row[4*x + 1], row[4*x + 2], row[4*x + 3]};
+            }
+        }
+        fWidth = src.width();
+    }
+
+    std::vector<Pixel> blur(SkSize sigma, const SkIRect& dstRect) const {
+        const int windowX = SkBlurEngine::BoxBlurWindow(sigma.width()),
+                  windowY = SkBlurEngine::BoxBlurWindow(sigma.height());
+        const int rx = radius(windowX), ry = radius(windowY);
+
+        // Blur rows of the tiled source along X, then the results along Y.
+        const SkIRect mid = dstRect.makeOutset(0, ry);
+        std::vector<Pixel> xBlurred(mid.width() * mid.height());
+        for (int y = mid.top(); y < mid.bottom(); ++y) {
+            std::vector<Pixel> line;
+            for (int x = mid.left() - rx; x < mid.right() + rx; ++x) {
+                line.push_back(this->tiled(x, y));
+            }
+            line = box_blur(line, windowX);
+            std::copy(line.begin(), line.end(), xBlurred.begin() + (y - mid.top()) * mid.width());
+        }
+        std::vector<Pixel> result(dstRect.width() * dstRect.height());
+        for (int x = 0; x < dstRect.width(); ++x) {
+            std::vector<Pixel> line;
+            for (int y = 0; y < mid.height(); ++y) {
+                line.push_back(xBlurred[y * mid.width() + x]);
+            }
+            line = box_blur(line, windowY);
+            for (int y = 0; y < dstRect.height(); ++y) {
+                result[y * dstRect.width() + x] = line[y];
+            }
+        }
+        return result;
+    }
+
+private:
+    static int tile(int v, int lo, int hi, SkTileMode tileMode) {
+        const int n = hi - lo;
+        int i = v - lo;
+        switch (tileMode) {
+            case SkTileMode::kDecal:  return 0 <= i && i < n ? v : INT_MIN;
+            case SkTileMode::kClamp:  return lo + SkTPin(i, 0, n - 1);
+            case SkTileMode::kRepeat: i %= n; return lo + (i < 0 ? i + n : i);
+            case SkTileMode::kMirror:
+                i %= 2 * n;
+                i = i < 0 ? i + 2 * n : i;
+                return lo + (i < n ? i : 2 * n - 1 - i);
+        }
+        SkUNREACHABLE;
+    }
+
+    Pixel tiled(int x, int y) const {
+        x = tile(x, fSrcRect.left(), fSrcRect.right(), fTileMode);
+        y = tile(y, fSrcRect.top(), fSrcRect.bottom(), fTileMode);
+        return x == INT_MIN || y == INT_MIN ? Pixel{0, 0, 0, 0} : fPixels[y * fWidth + x];
+    }
+
+    static int radius(int window) {
+        if (window <= 1) {
+            return 0;
+        }
+        return window & 1 ? 3 * (window / 2) : 3 * (window / 2) - 1;
+    }
+
+    // Returns the line less radius(window) pixels from either end.
+    static std::vector<Pixel> box_blur(std::vector<Pixel> line, int window) {
+        if (window <= 1) {
+            return line;
+        }
+        const int h = window / 2;
+        const int boxes[3][2] = {{-h, (window & 1) ? h : h - 1},
+                                 {(window & 1) ? -h : -h + 1, h},
+                                 {-h, h}};
+        for (const auto& box : boxes) {
+            std::vector<Pixel> next;
+            for (int i = -box[0]; i + box[1] < (int)line.size(); ++i) {
+                Pixel sum = {0, 0, 0, 0};
+                for (int k = box[0]; k <= box[1]; ++k) {
+                    for (int c = 0; c < 4; ++c) {
+                        sum[c] += line[i + k][c];
+                    }
+                }
+                for (int c = 0; c < 4; ++c) {
+                    sum[c] /= box[1] - box[0] + 1;
+                }
+                next.push_back(sum);
+            }
+            line = std::move(next);
+        }
+        return line;
+    }
+
+    SkIRect            fSrcRect;
+    SkTileMode         fTileMode;
+    std::vector<Pixel> fPixels;
+    int                fWidth;
+};
+
+SkBitmap make_source() {
+    SkBitmap bitmap;
+    bitmap.allocPixels(SkImageInfo::MakeN32Premul(45, 37));
+    SkRandom rand;
+    for (int y = 0; y < bitmap.height(); ++y) {
+        for (int x = 0; x < bitmap.width(); ++x) {
+            const U8CPU a = rand.nextULessThan(256);
+            *bitmap.getAddr32(x, y) = SkPackARGB32(a,
+                                                   rand.nextULessThan(a + 1),
+                                                   rand.nextULessThan(a + 1),
+                                                   rand.nextULessThan(a + 1));
+        }
+    }
+    return bitmap;
+}
+
+} // anonymous namespace
+
+// Raster special images are always N32, so that's the only color type the raster blur engine sees.
+DEF_TEST(RasterBoxBlur_MatchesReference, r) {
+    const SkBlurEngine* engine = SkBlurEngine::GetRasterBlurEngine();
+    const SkSize sigmas[] = {{2.5f, 2.5f}, {6.f, 0.5f}, {0.5f, 4.f}, {3.f, 11.f}};
+    const SkTileMode tileModes[] = {SkTileMode::kDecal, SkTileMode::kClamp,
+                                    SkTileMode::kRepeat, SkTileMode::kMirror};
+    // Blurs of part of the source into a larger area, and into an area partly outside of it.
+    const SkIRect srcRect = SkIRect::MakeLTRB(3, 2, 41, 34);
+    const SkIRect dstRects[] = {SkIRect::MakeLTRB(-12, -9, 57, 49),
+                                SkIRect::MakeLTRB(20, 15, 70, 30)};
+
+    const SkBitmap src = make_source();
+    sk_sp<SkSpecialImage> input = SkSpecialImages::MakeFromRaster(
+            SkIRect::MakeSize(src.dimensions()), src, SkSurfaceProps{});
+    for (SkTileMode tileMode : tileModes) {
+        const ReferenceBlur reference{src, srcRect, tileMode};
+        for (SkSize sigma : sigmas) {
+            const SkBlurEngine::Algorithm* algorithm =
+                    engine->findAlgorithm(sigma, kN32_SkColorType);
+            REPORTER_ASSERT(r, !algorithm->supportsOnlyDecalTiling());
+            for (const SkIRect& dstRect : dstRects) {
+                sk_sp<SkSpecialImage> blurred =
+                        algorithm->blur(sigma, input, srcRect, tileMode, dstRect);
+                SkBitmap result, f32;
+                if (!blurred || !SkSpecialImages::AsBitmap(blurred.get(), &result)) {
+                    ERRORF(r, "blur failed");
+                    continue;
+                }
+                REPORTER_ASSERT(r, result.dimensions() == dstRect.size());
+                f32.allocPixels(result.info().makeColorType(kRGBA_F32_SkColorType));
+                SkAssertResult(result.readPixels(f32.pixmap()));
+
+                const std::vector<Pixel> expected = reference.blur(sigma, dstRect);
+                double maxError = 0;
+                for (int y = 0; y < f32.height(); ++y) {
+                    const float* row = static_cast<const float*>(f32.getAddr(0, y));
+                    for (int x = 0; x < f32.width(); ++x) {
+                        for (int c = 0; c < 4; ++c) {
+                            maxError = std::max(maxError, std::abs(
+                                    row[4*x + c] - expected[y * f32.width() + x][c]));
+                        }
+                    }
+                }
+                // Only the final rounding to 8 bits, and the rounding of the X-blurred rows to half
+                // floats, at most 2^-12, should differ.
+                REPORTER_ASSERT(r, maxError * 255 <= 0.57,
+                                "tile mode %d, sigma %g x %g: error %g",
+                                (int)tileMode, sigma.width(), sigma.height(), maxError * 255);
+            }
+        }
+    }
+}
+
+// The 8888 blur that the engine used before should give nearly the same results with decal tiling.
+DEF_TEST(RasterBoxBlur_MatchesLegacy8888, r) {
+    const SkBitmap src = make_source();
+    sk_sp<SkSpecialImage> input = SkSpecialImages::MakeFromRaster(
+            SkIRect::MakeSize(src.dimensions()), src, SkSurfaceProps{});
+    const SkIRect dstRect = SkIRect::MakeLTRB(-10, -10, 55, 47);
+    for (SkSize sigma : {SkSize{2.f, 2.f}, SkSize{5.f, 3.f}, SkSize{20.f, 40.f}}) {
+        SkBitmap results[2];
+        for (bool legacy : {false, true}) {
+            gSkDisableRasterBoxBlur = legacy;
+            const SkBlurEngine::Algorithm* algorithm =
+                    SkBlurEngine::GetRasterBlurEngine()->findAlgorithm(sigma, kN32_SkColorType);
+            REPORTER_ASSERT(r, algorithm->supportsOnlyDecalTiling() == legacy);
+            sk_sp<SkSpecialImage> blurred = algorithm->blur(
+                    sigma, input, SkIRect::MakeSize(src.dimensions()), SkTileMode::kDecal, dstRect);
+            REPORTER_ASSERT(r, blurred &&
+                               SkSpecialImages::AsBitmap(blurred.get(), &results[legacy]));
+        }
+        gSkDisableRasterBoxBlur = false;
+
+        int maxError = 0;
+        for (int y = 0; y < dstRect.height(); ++y) {
+            for (int x = 0; x < dstRect.width(); ++x) {
+                const uint32_t a = *results[0].getAddr32(x, y), b = *results[1].getAddr32(x, y);
+                for (int shift = 0; shift < 32; shift += 8) {
+                    maxError = std::max(maxError, std::abs(int((a >> shift) & 0xff) -
+                                                           int((b >> shift) & 0xff)));
+                }
+            }
+        }
+        REPORTER_ASSERT(r, maxError <= 1, "sigma %g x %g: error %d",
+                        sigma.width(), sigma.height(), maxError);
+    }
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkBlurTypes.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMaskFilter.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkTileMode.h"
+#include "include/effects/SkGradientShader.h"
+#include "src/core/SkCoreBlitters.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+extern bool gSkDisableBlitPipelineCache;
+
+static void draw_gradient(SkCanvas* canvas) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    const SkPoint pts[] = {{0, 0}, {100, 60}};
+    const SkColor colors[] = {SK_ColorRED, 0x8000FF00};
+    paint.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 2, SkTileMode::kMirror));
+    canvas->drawRect(SkRect::MakeXYWH(3, 4, 50, 30), paint);
+    canvas->drawCircle(60, 30, 25.5f, paint);
+}
+
+static void draw_solid_shapes(SkCanvas* canvas, SkColor4f color) {
+    SkPaint paint(color);
+    paint.setAntiAlias(true);
+    canvas->drawRect(SkRect::MakeXYWH(3, 4, 50, 30), paint);
+
+    for (SkBlendMode mode : {SkBlendMode::kSrcOver, SkBlendMode::kMultiply,
+                             SkBlendMode::kPlus, SkBlendMode::kDstOver}) {
+        paint.setBlendMode(mode);
+        SkPath path;
+        path.moveTo(10, 50).cubicTo(90, 0, 0, 0, 95, 55).close();
+        canvas->drawPath(path, paint);
+        canvas->translate(1.5f, 1);
+    }
+
+    // A8 masks.
+    paint.setBlendMode(SkBlendMode::kSrcOver);
+    paint.setMaskFilter(SkMaskFilter::MakeBlur(kNormal_SkBlurStyle, 2));
+    canvas->drawOval(SkRect::MakeXYWH(20, 10, 40, 30), paint);
+}
+
+DEF_TEST(RasterPipelineBlitter_ShapeCache, r) {
+    // F16 always draws with the raster pipeline blitter.
+    const SkImageInfo infos[] = {
+        SkImageInfo::Make(100, 60, kRGBA_F16_SkColorType, kPremul_SkAlphaType),
+        SkImageInfo::Make(100, 60, kRGBA_F16_SkColorType, kPremul_SkAlphaType,
+                          SkColorSpace::MakeSRGBLinear()),
+    };
+    const SkColor4f firstColor  = {0.2f, 0.4f, 0.8f, 0.75f},
+                    secondColor = {0.9f, 0.1f, 0.3f, 0.5f};
+    for (const SkImageInfo& info : infos) {
+        SkBitmap expected, actual;
+        expected.allocPixels(info);
+        actual.allocPixels(info);
+        SkCanvas expectedCanvas(expected), actualCanvas(actual);
+        expectedCanvas.clear(SK_ColorWHITE);
+        actualCanvas.clear(SK_ColorWHITE);
+
+        gSkDisableBlitPipelineCache = true;
+        draw_gradient(&expectedCanvas);
+        draw_solid_shapes(&expectedCanvas, firstColor);
+        draw_solid_shapes(&expectedCanvas, secondColor);
+        gSkDisableBlitPipelineCache = false;
+
+        // Shaders compile their own pipelines and never touch the cache.
+        SkRasterPipelineBlitterShapeCacheStats before =
+                SkRasterPipelineBlitterShapeCacheStatsForThisThread();
+        draw_gradient(&actualCanvas);
+        SkRasterPipelineBlitterShapeCacheStats after =
+                SkRasterPipelineBlitterShapeCacheStatsForThisThread();
+        REPORTER_ASSERT(r, after.fHits == before.fHits);
+        REPORTER_ASSERT(r, after.fMisses == before.fMisses);
+
+        // The second color shares the pipelines the first one compiled.
+        draw_solid_shapes(&actualCanvas, firstColor);
+        before = SkRasterPipelineBlitterShapeCacheStatsForThisThread();
+        draw_solid_shapes(&actualCanvas, secondColor);
+        after = SkRasterPipelineBlitterShapeCacheStatsForThisThread();
+        REPORTER_ASSERT(r, after.fHits > before.fHits);
+        REPORTER_ASSERT(r, after.fMisses == before.fMisses);
+
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, actual));
+    }
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkFont.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkPoint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSamplingOptions.h"
+#include "include/core/SkShader.h"
+#include "include/core/SkSurface.h"
+#include "include/core/SkTileMode.h"
+#include "include/effects/SkGradientShader.h"
+#include "include/effects/SkImageFilters.h"
+#include "src/image/SkSurface_Base.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+#include "tools/fonts/FontToolUtils.h"
+
+#include <memory>
+
+static constexpr int kW = 300, kH = 200;
+
+// Lots of overlapping AA geometry, crossing tile boundaries, with clips, layers and filters.
+static void draw_scene(SkCanvas* canvas) {
+    canvas->clear(SK_ColorWHITE);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    const SkPoint pts[] = {{0, 0}, {kW, kH}};
+    const SkColor colors[] = {SK_ColorRED, SK_ColorBLUE};
+    paint.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 2, SkTileMode::kClamp));
+    canvas->drawCircle(kW/2, kH/2, 90, paint);
+    paint.setShader(nullptr);
+
+    canvas->save();
+        canvas->translate(20.5f, 10.25f);
+        canvas->rotate(15);
+        canvas->clipRect(SkRect::MakeWH(200, 120), true);
+        paint.setColor(0x8000FF00);
+        canvas->drawRect(SkRect::MakeXYWH(-10, 30, 250, 40), paint);
+        SkPath path;
+        path.moveTo(0, 0).cubicTo(150, 10, 10, 150, 190, 110).close();
+        paint.setColor(0xC0202080);
+        canvas->drawPath(path, paint);
+    canvas->restore();
+
+    SkPaint layerPaint;
+    layerPaint.setImageFilter(SkImageFilters::Blur(3, 3, nullptr));
+    canvas->saveLayer(nullptr, &layerPaint);
+        paint.setColor(SK_ColorBLACK);
+        paint.setStyle(SkPaint::kStroke_Style);
+        paint.setStrokeWidth(5);
+        canvas->drawOval(SkRect::MakeXYWH(40, 40, 220, 120), paint);
+    canvas->restore();
+
+    paint.setStyle(SkPaint::kFill_Style);
+    paint.setBlendMode(SkBlendMode::kMultiply);
+    canvas->drawImage(ToolUtils::create_checkerboard_image(64, 64, SK_ColorCYAN, SK_ColorYELLOW, 8),
+                      130, 70, SkSamplingOptions(), &paint);
+}
+
+static SkBitmap snap(SkSurface* surface) {
+    SkBitmap bm;
+    bm.allocPixels(surface->imageInfo());
+    SkAssertResult(surface->readPixels(bm, 0, 0));
+    return bm;
+}
+
+DEF_TEST(RasterTiledSurface_ThreadCountDoesNotChangeResult, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(kW, kH);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    for (int tileSize : {16, 37, 64, 256}) {
+        sk_sp<SkSurface> serial = SkSurfaces::RasterTiled(info, nullptr, tileSize),
+                         threaded = SkSurfaces::RasterTiled(info, executor.get(), tileSize);
+        REPORTER_ASSERT(r, serial && threaded);
+
+        draw_scene(serial->getCanvas());
+        draw_scene(threaded->getCanvas());
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(snap(serial.get()), snap(threaded.get())),
+                        "tile size %d", tileSize);
+    }
+}
+
+DEF_TEST(RasterTiledSurface_MatchesRaster, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(kW, kH);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    // Pixel-aligned geometry is never clipped mid-pixel by the tiles, so it matches exactly.
+    auto draw = [](SkCanvas* canvas) {
+        canvas->clear(SK_ColorWHITE);
+        SkPaint paint;
+        for (int i = 0; i < 50; i++) {
+            paint.setColor(0x80000000 | (i * 0x050301));
+            canvas->drawRect(SkRect::MakeXYWH((i * 37) % kW, (i * 23) % kH, 70, 45), paint);
+        }
+        canvas->drawImage(ToolUtils::create_checkerboard_image(80, 80, SK_ColorRED,
+                                                               SK_ColorGREEN, 10),
+                          100, 60);
+    };
+
+    sk_sp<SkSurface> raster = SkSurfaces::Raster(info),
+                     tiled = SkSurfaces::RasterTiled(info, executor.get(), 32);
+    draw(raster->getCanvas());
+    draw(tiled->getCanvas());
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(snap(raster.get()), snap(tiled.get())));
+}
+
+// Antialiased geometry, strokes, text and clips that cross the tile boundaries, with some that
+// doesn't, at sizes where the boundaries fall mid-pixel in the geometry.
+static void draw_across_seams(SkCanvas* canvas) {
+    canvas->clear(SK_ColorWHITE);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    for (int i = 0; i < 12; i++) {
+        paint.setColor(0xC0000000 | (i * 0x15A3D1));
+        canvas->drawCircle(13.3f + i * 23.7f, 17.1f + i * 14.9f, 9.6f + i, paint);
+    }
+
+    SkPath path;
+    path.moveTo(3.5f, 190.25f)
+        .cubicTo(80.1f, -40, 220.7f, 260, 296.3f, 11.9f)
+        .quadTo(150.4f, 120.6f, 3.5f, 190.25f);
+    paint.setColor(0x9020A040);
+    canvas->drawPath(path, paint);
+
+    paint.setStyle(SkPaint::kStroke_Style);
+    paint.setColor(0xFF3050C0);
+    for (float width : {0.f, 1.f, 3.3f}) {
+        paint.setStrokeWidth(width);
+        canvas->drawLine(1.7f, 5.2f + 30 * width, 298.4f, 180.6f - 40 * width, paint);
+        canvas->drawOval(SkRect::MakeLTRB(30.5f + 10 * width, 20.25f, 270.75f, 170.5f), paint);
+    }
+    paint.setStyle(SkPaint::kFill_Style);
+
+    SkFont font = ToolUtils::DefaultPortableFont();
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    paint.setColor(SK_ColorBLACK);
+    for (float size : {11.f, 24.f, 90.f}) {
+        font.setSize(size);
+        canvas->drawString("Seams?", 5.3f, 40 + size, font, paint);
+    }
+
+    canvas->save();
+        canvas->rotate(7);
+        canvas->clipRRect(SkRRect::MakeRectXY(SkRect::MakeLTRB(60.2f, 30.7f, 250.6f, 150.3f),
+                                              20, 30), true);
+        paint.setColor(0x80FF8000);
+        canvas->drawPaint(paint);
+        canvas->drawRect(SkRect::MakeXYWH(50, 50, 200, 60), paint);
+    canvas->restore();
+
+    SkPaint layerPaint;
+    layerPaint.setAlphaf(0.75f);
+    canvas->saveLayer(SkRect::MakeLTRB(100, 60, 260, 190), &layerPaint);
+        paint.setColor(SK_ColorMAGENTA);
+        canvas->drawCircle(180.5f, 125.5f, 50.3f, paint);
+    canvas->restore();
+
+    // Small enough to fit in one of the larger tiles.
+    paint.setColor(SK_ColorBLUE);
+    canvas->drawCircle(8.5f, 8.5f, 5.2f, paint);
+    canvas->drawCircle(291.5f, 191.5f, 5.2f, paint);
+}
+
+DEF_TEST(RasterTiledSurface_MatchesRasterAcrossSeams, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(kW, kH);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    for (auto draw : {draw_scene, draw_across_seams}) {
+        sk_sp<SkSurface> raster = SkSurfaces::Raster(info);
+        draw(raster->getCanvas());
+        const SkBitmap expected = snap(raster.get());
+
+        for (int tileSize : {16, 37, 64, 256}) {
+            sk_sp<SkSurface> tiled = SkSurfaces::RasterTiled(info, executor.get(), tileSize);
+            // It isn't an SkSurface_Raster, so must not claim to be one.
+            REPORTER_ASSERT(r, !asSB(tiled.get())->isRasterBacked());
+            draw(tiled->getCanvas());
+            REPORTER_ASSERT(r, ToolUtils::equal_pixels(expected, snap(tiled.get())),
+                            "tile size %d", tileSize);
+        }
+    }
+}
+
+DEF_TEST(RasterTiledSurface_Snapshots, r) {
+    const SkImageInfo info = SkImageInfo::MakeN32Premul(kW, kH);
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(2);
+
+    sk_sp<SkSurface> raster = SkSurfaces::Raster(info),
+                     tiled = SkSurfaces::RasterTiled(info, executor.get(), 64);
+
+    // Interleave drawing with everything that makes the tiled surface rasterize, keeping some
+    // matrix and clip state live across each of those points.
+    for (SkSurface* surface : {raster.get(), tiled.get()}) {
+        SkCanvas* canvas = surface->getCanvas();
+        canvas->clear(SK_ColorWHITE);
+        canvas->translate(10, 10);
+        canvas->drawRect(SkRect::MakeWH(100, 100), SkPaint(SkColors::kRed));
+        sk_sp<SkImage> before = surface->makeImageSnapshot();
+        const SkBitmap beforePixels = snap(surface);
+
+        canvas->save();
+        canvas->clipRect(SkRect::MakeWH(150, 50));
+        canvas->drawRect(SkRect::MakeWH(200, 200), SkPaint(SkColors::kBlue));
+        sk_sp<SkImage> after = surface->makeImageSnapshot();
+        REPORTER_ASSERT(r, !ToolUtils::equal_pixels(before.get(), after.get()));
+
+        // Earlier snapshots are not affected by later draws.
+        SkPixmap beforePM;
+        REPORTER_ASSERT(r, before->peekPixels(&beforePM));
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(beforePM, beforePixels.pixmap()));
+
+        // Drawing into an open layer isn't visible until the layer is restored.
+        canvas->saveLayerAlphaf(nullptr, 0.5f);
+        canvas->drawRect(SkRect::MakeWH(40, 40), SkPaint(SkColors::kGreen));
+        SkPixmap pm;
+        REPORTER_ASSERT(r, surface->peekPixels(&pm));
+        REPORTER_ASSERT(r, pm.getColor(20, 20) == SK_ColorBLUE);
+        canvas->restore();
+        REPORTER_ASSERT(r, surface->peekPixels(&pm));
+        REPORTER_ASSERT(r, pm.getColor(20, 20) != SK_ColorBLUE);
+
+        canvas->restore();
+        SkBitmap patch;
+        patch.allocN32Pixels(20, 20);
+        patch.eraseColor(SK_ColorMAGENTA);
+        surface->writePixels(patch, 250, 150);
+        canvas->drawRect(SkRect::MakeXYWH(240, 140, 20, 20), SkPaint(SkColors::kBlack));
+    }
+
+    REPORTER_ASSERT(r, ToolUtils::equal_pixels(snap(raster.get()), snap(tiled.get())));
+}
@@ -7,10 +7,12 @@
 
 #include "include/private/base/SkTo.h"
 #include "src/base/SkHalf.h"
+#include "src/base/SkRandom.h"
 #include "src/base/SkUtils.h"
 #include "src/core/SkOpts.h"
 #include "src/core/SkRasterPipeline.h"
 #include "src/core/SkRasterPipelineContextUtils.h"
+#include "src/core/SkRasterPipelineJIT.h"
 #include "src/gpu/Swizzle.h"
 #include "src/sksl/tracing/SkSLTraceHook.h"
 #include "tests/Test.h"
@@ -3269,6 +3271,86 @@ DEF_TEST(SkRasterPipeline_lowp, r) {
     }
 }
 
+DEF_TEST(SkRasterPipeline_lowp_tail, r) {
+    // Exercise every tail length of the widest (32 pixel) lowp stride, and a few full strides.
+    auto pixel = [](int i, int rShift, int bShift) -> uint32_t {
+        return (uint32_t)((4*i+0) & 0xff) << rShift
+             | (uint32_t)((4*i+1) & 0xff) << 8
+             | (uint32_t)((4*i+2) & 0xff) << bShift
+             | (uint32_t)((4*i+3) & 0xff) << 24;
+    };
+    for (int width = 1; width <= 70; width++) {
+        uint32_t rgba[72];
+        for (int i = 0; i < 72; i++) {
+            rgba[i] = pixel(i, 0, 16);
+        }
+
+        SkRasterPipeline_MemoryCtx ptr = { rgba, 0 };
+
+        SkRasterPipeline_<256> p;
+        p.append(SkRasterPipelineOp::load_8888,  &ptr);
+        p.append(SkRasterPipelineOp::swap_rb);
+        p.append(SkRasterPipelineOp::store_8888, &ptr);
+        p.run(0,0,width,1);
+
+        for (int i = 0; i < 72; i++) {
+            uint32_t want = i < width ? pixel(i, 16, 0) : pixel(i, 0, 16);
+            if (rgba[i] != want) {
+                ERRORF(r, "width %d, pixel %d: got %08x, want %08x\n", width, i, rgba[i], want);
+            }
+        }
+    }
+}
+
+DEF_TEST(SkRasterPipeline_lowp_gradient, r) {
+    // Small stop counts take the in-register table lookup on some CPUs; larger ones gather.
+    for (size_t stopCount : {2, 5, 8, 9, 16, 17, 24}) {
+        constexpr int kWidth = 67;
+        float fs[4][32], bs[4][32], ts[32];
+        SkRasterPipeline_GradientCtx ctx;
+        ctx.stopCount = stopCount;
+        for (int c = 0; c < 4; c++) {
+            for (size_t i = 0; i < 32; i++) {
+                fs[c][i] = 0.25f;
+                bs[c][i] = ((i * 37 + c * 11) % 17) / 24.0f;
+            }
+            ctx.fs[c] = fs[c];
+            ctx.bs[c] = bs[c];
+        }
+        for (size_t i = 0; i < stopCount; i++) {
+            ts[i] = (float)i / stopCount;
+        }
+        ctx.ts = ts;
+
+        uint32_t rgba[kWidth];
+        SkRasterPipeline_MemoryCtx dst = { rgba, 0 };
+        const float scale[] = { 1.0f / kWidth, 1, 0, 0 };
+
+        SkRasterPipeline_<256> p;
+        p.append(SkRasterPipelineOp::seed_shader);
+        p.append(SkRasterPipelineOp::matrix_scale_translate, scale);
+        p.append(SkRasterPipelineOp::gradient, &ctx);
+        p.append(SkRasterPipelineOp::store_8888, &dst);
+        p.run(0,0,kWidth,1);
+
+        for (int x = 0; x < kWidth; x++) {
+            const float t = (x + 0.5f) / kWidth;
+            size_t idx = 0;
+            for (size_t i = 1; i < stopCount; i++) {
+                idx += t >= ts[i] ? 1 : 0;
+            }
+            for (int c = 0; c < 4; c++) {
+                const int want = (int)((fs[c][idx] * t + bs[c][idx]) * 255 + 0.5f),
+                          got  = (rgba[x] >> (8 * c)) & 0xFF;
+                if (std::abs(want - got) > 1) {
+                    ERRORF(r, "stops %zu, x %d, channel %d: got %d, want %d\n",
+                           stopCount, x, c, got, want);
+                }
+            }
+        }
+    }
+}
+
 DEF_TEST(SkRasterPipeline_swizzle, r) {
     // This takes the lowp code path
     {
@@ -3450,3 +3532,130 @@ DEF_TEST(SkRasterPipeline_stack_rewind, r) {
         stack.validate(r);
     }
 }
+
+extern bool gUseRasterPipelineJIT;
+
+DEF_TEST(SkRasterPipeline_JITMatchesInterpreter, r) {
+    // Every pipeline the JIT might compile must match the interpreter exactly, including the
+    // interpreted tail of each row.
+    constexpr int kX = 2, kW = 70, kH = 3, kStride = 72;
+
+    struct Buffers {
+        uint32_t src[kH * kStride];
+        uint32_t dst[kH * kStride];
+        uint8_t  cov[kH * kStride];
+        uint8_t  a8 [kH * kStride];
+    };
+    Buffers init;
+    SkRandom rand;
+    for (int i = 0; i < kH * kStride; i++) {
+        init.src[i] = rand.nextU();
+        init.dst[i] = rand.nextU();
+        init.cov[i] = (uint8_t)rand.nextU();
+        init.a8 [i] = (uint8_t)rand.nextU();
+    }
+    // Premultiply, so blends stay in range as they would in real use.
+    for (uint32_t* px : {init.src, init.dst}) {
+        for (int i = 0; i < kH * kStride; i++) {
+            uint32_t a = px[i] >> 24;
+            px[i] = (a << 24) | ((px[i] >> 16 & 0xff) * a / 255) << 16
+                              | ((px[i] >>  8 & 0xff) * a / 255) <<  8
+                              | ((px[i] >>  0 & 0xff) * a / 255) <<  0;
+        }
+    }
+
+    struct Contexts {
+        SkRasterPipeline_MemoryCtx src, dst, cov, a8;
+        SkRasterPipeline_UniformColorCtx color;
+        float coverage;
+    };
+    auto make_contexts = [](Buffers* b) {
+        Contexts c;
+        c.src = {b->src, kStride};
+        c.dst = {b->dst, kStride};
+        c.cov = {b->cov, kStride};
+        c.a8  = {b->a8,  kStride};
+        c.color.r = 0.2f; c.color.g = 0.4f; c.color.b = 0.6f; c.color.a = 0.8f;
+        c.color.rgba[0] = 51; c.color.rgba[1] = 102; c.color.rgba[2] = 153; c.color.rgba[3] = 204;
+        c.coverage = 0.625f;
+        return c;
+    };
+
+    using Op = SkRasterPipelineOp;
+    using Build = void (*)(SkRasterPipeline*, SkArenaAlloc*, Contexts*);
+    const Build pipelines[] = {
+        [](SkRasterPipeline* p, SkArenaAlloc* alloc, Contexts* c) {
+            p->append(Op::load_8888, &c->src);
+            p->append(Op::swap_rb);
+            p->append(Op::store_8888, &c->dst);
+        },
+        [](SkRasterPipeline* p, SkArenaAlloc* alloc, Contexts* c) {
+            p->appendConstantColor(alloc, &c->color.r);
+            p->append(Op::scale_u8, &c->cov);
+            p->append(Op::srcover_rgba_8888, &c->dst);
+        },
+        [](SkRasterPipeline* p, SkArenaAlloc* alloc, Contexts* c) {
+            p->append(Op::load_8888, &c->src);
+            p->append(Op::scale_1_float, &c->coverage);
+            p->append(Op::load_8888_dst, &c->dst);
+            p->append(Op::srcover);
+            p->append(Op::lerp_u8, &c->cov);
+            p->append(Op::store_8888, &c->dst);
+        },
+        [](SkRasterPipeline* p, SkArenaAlloc* alloc, Contexts* c) {
+            p->append(Op::load_8888, &c->src);
+            p->append(Op::load_8888_dst, &c->dst);
+            p->append(Op::dstover);
+            p->append(Op::lerp_1_float, &c->coverage);
+            p->append(Op::swap_rb_dst);
+            p->append(Op::modulate);
+            p->append(Op::store_8888, &c->src);
+        },
+        [](SkRasterPipeline* p, SkArenaAlloc* alloc, Contexts* c) {
+            p->append(Op::load_a8, &c->a8);
+            p->append(Op::uniform_color_dst, &c->color);
+            p->append(Op::plus_);
+            p->append(Op::clamp_01);
+            p->append(Op::store_a8, &c->a8);
+        },
+        [](SkRasterPipeline* p, SkArenaAlloc* alloc, Contexts* c) {
+            p->append(Op::white_color);
+            p->append(Op::move_src_dst);
+            p->append(Op::black_color);
+            p->append(Op::force_opaque_dst);
+            p->append(Op::load_8888, &c->src);
+            p->append(Op::force_opaque);
+            p->append(Op::modulate);
+            p->append(Op::move_dst_src);
+            p->append(Op::clear);
+            p->append(Op::swap_rb);
+            p->append(Op::move_src_dst);
+            p->append(Op::load_8888, &c->src);
+            p->append(Op::srcover);
+            p->append(Op::store_8888, &c->dst);
+        },
+    };
+
+    for (size_t i = 0; i < std::size(pipelines); i++) {
+        for (int width = 1; width <= kW; width++) {
+            Buffers want = init, got = init;
+            Contexts wantCtx = make_contexts(&want), gotCtx = make_contexts(&got);
+
+            SkArenaAlloc alloc(/*firstHeapAllocation=*/256);
+            SkRasterPipeline_<256> interpreted;
+            pipelines[i](&interpreted, &alloc, &wantCtx);
+            interpreted.run(kX,0,width,kH);
+
+            SkRasterPipeline_<256> jitted;
+            pipelines[i](&jitted, &alloc, &gotCtx);
+            gUseRasterPipelineJIT = true;
+            auto fn = jitted.compile();
+            gUseRasterPipelineJIT = false;
+            fn(kX,0,width,kH);
+
+            if (0 != memcmp(&want, &got, sizeof(Buffers))) {
+                ERRORF(r, "pipeline %zu, width %d: JIT does not match interpreter", i, width);
+            }
+        }
+    }
+}
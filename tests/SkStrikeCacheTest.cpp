@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "include/core/SkData.h"
 #include "include/core/SkFont.h"
 #include "include/core/SkFontStyle.h"
 #include "include/core/SkMatrix.h"
@@ -12,14 +13,22 @@
 #include "include/core/SkRefCnt.h"
 #include "include/core/SkSurfaceProps.h"
 #include "include/core/SkTypeface.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkGlyph.h"
+#include "src/core/SkPersistentGlyphCache.h"
 #include "src/core/SkScalerContext.h"
 #include "src/core/SkStrike.h"  // IWYU pragma: keep
 #include "src/core/SkStrikeCache.h"
 #include "src/core/SkStrikeSpec.h"
+#include "src/core/SkTaskGroup.h"
 #include "tests/Test.h"
 #include "tools/ToolUtils.h"
 #include "tools/fonts/FontToolUtils.h"
 
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
 DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
     SkStrikeCache cache;
 
@@ -58,6 +67,202 @@ DEF_TEST(SkStrikeCache_CachePurge, Reporter) {
         REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() == 0);
     }
     REPORTER_ASSERT(Reporter, cache.getTotalMemoryUsed() == 0);
+}
+
+static SkStrikeSpec make_spec(SkScalar size) {
+    SkFont font(ToolUtils::CreatePortableTypeface("serif", SkFontStyle::Normal()), size);
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    return SkStrikeSpec::MakeMask(font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                                  SkScalerContextFlags::kNone, SkMatrix::I());
+}
+
+static SkStrikeCache::ShardStats total_stats(const SkStrikeCache& cache) {
+    SkStrikeCache::ShardStats total;
+    for (int i = 0; i < cache.shardCount(); i++) {
+        SkStrikeCache::ShardStats stats = cache.shardStats(i);
+        total.fHits   += stats.fHits;
+        total.fMisses += stats.fMisses;
+        total.fPurged += stats.fPurged;
+        total.fBytes  += stats.fBytes;
+        total.fCount  += stats.fCount;
+    }
+    return total;
+}
+
+DEF_TEST(SkStrikeCache_ShardStats, r) {
+    SkStrikeCache cache(4);
+    REPORTER_ASSERT(r, cache.shardCount() == 4);
+
+    std::vector<SkStrikeSpec> specs;
+    for (int i = 0; i < 20; i++) {
+        specs.push_back(make_spec(8 + i));
+    }
+
+    // A miss for each new strike, and then hits, with or without the lock.
+    for (int pass = 0; pass < 3; pass++) {
+        for (const SkStrikeSpec& spec : specs) {
+            sk_sp<SkStrike> strike = spec.findOrCreateStrike(&cache);
+            REPORTER_ASSERT(r, strike == cache.findStrike(spec.descriptor()));
+        }
+    }
+    SkStrikeCache::ShardStats total = total_stats(cache);
+    REPORTER_ASSERT(r, total.fMisses == 20, "%llu misses", (unsigned long long)total.fMisses);
+    REPORTER_ASSERT(r, total.fHits == 100, "%llu hits", (unsigned long long)total.fHits);
+    REPORTER_ASSERT(r, total.fCount == 20 && total.fCount == cache.getCacheCountUsed());
+    REPORTER_ASSERT(r, total.fBytes == cache.getTotalMemoryUsed());
+
+    // The strikes should be spread over the shards.
+    int usedShards = 0;
+    for (int i = 0; i < cache.shardCount(); i++) {
+        usedShards += cache.shardStats(i).fCount > 0 ? 1 : 0;
+    }
+    REPORTER_ASSERT(r, usedShards > 1);
+
+    // Purged strikes aren't found again, even by a thread that found them recently.
+    sk_sp<SkStrike> before = specs[0].findOrCreateStrike(&cache);
+    cache.purgeAll();
+    total = total_stats(cache);
+    REPORTER_ASSERT(r, total.fPurged == 20 && total.fCount == 0 && total.fBytes == 0);
+    REPORTER_ASSERT(r, !cache.findStrike(specs[0].descriptor()));
+    sk_sp<SkStrike> after = specs[0].findOrCreateStrike(&cache);
+    REPORTER_ASSERT(r, after && after != before);
+}
+
+DEF_TEST(SkStrikeCache_ShardBudgets, r) {
+    SkStrikeCache cache(4);
+    cache.setCacheCountLimit(8);
+
+    SkRandom rand;
+    for (int i = 0; i < 200; i++) {
+        sk_sp<SkStrike> strike = make_spec(8 + rand.nextULessThan(40)).findOrCreateStrike(&cache);
+        // The whole cache keeps to the budget, however the strikes fall in the shards.
+        REPORTER_ASSERT(r, cache.getCacheCountUsed() <= 8);
+        REPORTER_ASSERT(r, total_stats(cache).fCount == cache.getCacheCountUsed());
+    }
+    REPORTER_ASSERT(r, total_stats(cache).fPurged > 0);
+
+    // As many strikes as the budget fit, even if some shards get more than others.
+    cache.purgeAll();
+    const uint64_t purged = total_stats(cache).fPurged;
+    for (int i = 0; i < 8; i++) {
+        sk_sp<SkStrike> strike = make_spec(60 + i).findOrCreateStrike(&cache);
+    }
+    REPORTER_ASSERT(r, cache.getCacheCountUsed() == 8);
+    REPORTER_ASSERT(r, total_stats(cache).fPurged == purged);
+}
+
+DEF_TEST(SkStrikeCache_RecentStrikesHoldNoRefs, r) {
+    SkStrikeCache cache(4);
+    const SkStrikeSpec spec = make_spec(12);
+
+    sk_sp<SkStrike> strike = spec.findOrCreateStrike(&cache);
+    REPORTER_ASSERT(r, strike == spec.findOrCreateStrike(&cache));
+
+    // Only the cache and this test hold the strike, so purging leaves this test the only owner.
+    cache.purgeAll();
+    REPORTER_ASSERT(r, strike->unique());
+    REPORTER_ASSERT(r, cache.getCacheCountUsed() == 0 && cache.getTotalMemoryUsed() == 0);
+    REPORTER_ASSERT(r, !cache.findStrike(spec.descriptor()));
+}
+
+DEF_TEST(SkStrikeCache_Threaded, r) {
+    SkStrikeCache cache;
+    cache.setCacheSizeLimit(64 * 1024);
+
+    std::vector<SkStrikeSpec> specs;
+    for (int i = 0; i < 24; i++) {
+        specs.push_back(make_spec(6 + 2 * i));
+    }
+
+    SkTaskGroup().batch(16, [&](int t) {
+        SkRandom rand(t);
+        for (int i = 0; i < 200; i++) {
+            // Mostly a few hot strikes, so lookups go both with and without the locks.
+            const SkStrikeSpec& spec = specs[rand.nextBool() ? t % 3
+                                                             : rand.nextULessThan(specs.size())];
+            SkBulkGlyphMetricsAndImages images{spec.findOrCreateStrike(&cache)};
+            const SkGlyphID id = 1 + i % 30;
+            const SkGlyph* glyph = images.glyph(SkPackedGlyphID{id});
+            REPORTER_ASSERT(r, glyph && glyph->getGlyphID() == id);
+        }
+    });
+
+    const SkStrikeCache::ShardStats total = total_stats(cache);
+    REPORTER_ASSERT(r, total.fHits + total.fMisses == 16 * 200);
+    REPORTER_ASSERT(r, total.fBytes == cache.getTotalMemoryUsed());
+    cache.purgeAll();
+    REPORTER_ASSERT(r, cache.getTotalMemoryUsed() == 0 && cache.getCacheCountUsed() == 0);
+}
+
+DEF_TEST(SkStrikeCache_PersistentGlyphs, r) {
+    static constexpr char kFont[] = "fonts/Roboto-Regular.ttf";
+    sk_sp<SkTypeface> typeface = ToolUtils::CreateTypefaceFromResource(kFont);
+    if (!typeface) {
+        return;
+    }
+    auto specFor = [](sk_sp<SkTypeface> tf) {
+        SkFont font(std::move(tf), 24);
+        font.setEdging(SkFont::Edging::kAntiAlias);
+        return SkStrikeSpec::MakeMask(font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+                                      SkScalerContextFlags::kNone, SkMatrix::I());
+    };
+    const SkPackedGlyphID ids[] = {SkPackedGlyphID{SkGlyphID{3}}, SkPackedGlyphID{SkGlyphID{40}},
+                                   SkPackedGlyphID{SkGlyphID{72}}};
+    const SkGlyph* glyphs[std::size(ids)];
+    const SkGlyph* persistedGlyphs[std::size(ids)];
+
+    SkStrikeCache writer;
+    sk_sp<SkStrike> strike = specFor(typeface).findOrCreateStrike(&writer);
+    strike->prepareImages(ids, glyphs);
+    sk_sp<SkData> data = SkPersistentGlyphCache::Serialize(&writer);
+    sk_sp<SkPersistentGlyphCache> persistent = SkPersistentGlyphCache::Make(data);
+    if (!persistent) {
+        ERRORF(r, "could not read back the glyph cache");
+        return;
+    }
+    REPORTER_ASSERT(r, persistent->count() == 1);
+
+    // Another instance of the font, as another process would have, has a different typeface ID.
+    sk_sp<SkTypeface> reloaded = ToolUtils::CreateTypefaceFromResource(kFont);
+    REPORTER_ASSERT(r, reloaded->uniqueID() != typeface->uniqueID());
+    SkStrikeCache reader;
+    reader.setPersistentGlyphCache(persistent);
+    sk_sp<SkStrike> persistedStrike = specFor(reloaded).findOrCreateStrike(&reader);
+    REPORTER_ASSERT(r, persistent->hits() == 1);
+
+    // Nothing is read from the saved glyphs until they are asked for.
+    REPORTER_ASSERT(r, reader.getTotalMemoryUsed() == sizeof(SkStrike));
+    persistedStrike->prepareImages(ids, persistedGlyphs);
+    REPORTER_ASSERT(r, reader.getTotalMemoryUsed() > sizeof(SkStrike));
+    for (size_t i = 0; i < std::size(ids); ++i) {
+        const SkGlyph* expected = glyphs[i];
+        const SkGlyph* actual = persistedGlyphs[i];
+        REPORTER_ASSERT(r, actual->iRect() == expected->iRect());
+        REPORTER_ASSERT(r, actual->advanceX() == expected->advanceX());
+        REPORTER_ASSERT(r, expected->isEmpty() ||
+                           !memcmp(actual->image(), expected->image(), expected->imageSize()));
+    }
+    REPORTER_ASSERT(r, !memcmp(&persistedStrike->getFontMetrics(), &strike->getFontMetrics(),
+                               sizeof(SkFontMetrics)));
+
+    // Glyphs that weren't saved are made as usual.
+    const SkPackedGlyphID unsaved[] = {SkPackedGlyphID{SkGlyphID{50}}};
+    const SkGlyph* unsavedGlyph[1];
+    persistedStrike->prepareImages(unsaved, unsavedGlyph);
+    REPORTER_ASSERT(r, unsavedGlyph[0]->getPackedID() == unsaved[0]);
+    REPORTER_ASSERT(r, unsavedGlyph[0]->setImageHasBeenCalled());
 
+    // Other strikes of the font miss.
+    SkFont bigger(reloaded, 48);
+    sk_sp<SkStrike> missed = SkStrikeSpec::MakeWithNoDevice(bigger).findOrCreateStrike(&reader);
+    REPORTER_ASSERT(r, persistent->misses() == 1);
 
+    // Damaged data is not used.
+    sk_sp<SkData> copy = SkData::MakeWithCopy(data->data(), data->size());
+    static_cast<char*>(copy->writable_data())[data->size() / 2] ^= 1;
+    REPORTER_ASSERT(r, !SkPersistentGlyphCache::Make(copy));
+    REPORTER_ASSERT(r, !SkPersistentGlyphCache::Make(SkData::MakeSubset(data.get(), 0, 100)));
+    copy = SkData::MakeWithCopy(data->data(), data->size());
+    static_cast<uint32_t*>(copy->writable_data())[1] += 1;  // the version
+    REPORTER_ASSERT(r, !SkPersistentGlyphCache::Make(copy));
 }
@@ -43,6 +43,7 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <initializer_list>
 #include <memory>
@@ -292,3 +293,97 @@ DEF_TEST(SkStrike_FlattenByType, reporter) {
     REPORTER_ASSERT(reporter, dstDrawableGlyph->setDrawableHasBeenCalled());
     REPORTER_ASSERT(reporter, dstDrawableGlyph->drawable() != nullptr);
 }
+
+DEF_TEST(SkStrike_Prerasterize, reporter) {
+    SkFont font{ToolUtils::CreatePortableTypeface("serif", SkFontStyle()), 24};
+    font.setEdging(SkFont::Edging::kAntiAlias);
+    font.setSubpixel(true);
+
+    // Repeat some glyphs, as text does.
+    std::vector<SkGlyphID> glyphIDs;
+    for (SkUnichar c = ' '; c < 'z'; c++) {
+        glyphIDs.push_back(font.unicharToGlyph(c));
+    }
+    for (SkUnichar c : {'e', 't', 'a', 'e'}) {
+        glyphIDs.push_back(font.unicharToGlyph(c));
+    }
+    std::vector<SkPackedGlyphID> packedIDs;
+    for (SkGlyphID glyphID : glyphIDs) {
+        for (uint32_t x = 0; x < 4; x++) {
+            packedIDs.push_back(SkPackedGlyphID{glyphID, x, 0u});
+        }
+    }
+
+    SkStrikeSpec strikeSpec = SkStrikeSpec::MakeMask(
+            font, SkPaint(), SkSurfaceProps(0, kUnknown_SkPixelGeometry),
+            SkScalerContextFlags::kNone, SkMatrix::I());
+    auto executor = SkExecutor::MakeFIFOThreadPool(4);
+
+    // Glyphs made the usual way, one at a time.
+    SkStrikeCache expectedCache;
+    sk_sp<SkStrike> expected = strikeSpec.findOrCreateStrike(&expectedCache);
+
+    auto check = [&](SkStrike* strike, SkStrikeCache* cache, bool withPaths) {
+        const size_t memoryUsed = cache->getTotalMemoryUsed();
+        std::vector<const SkGlyph*> glyphs(packedIDs.size()), expectedGlyphs(packedIDs.size());
+        strike->prepareImages(packedIDs, glyphs.data());
+        expected->prepareImages(packedIDs, expectedGlyphs.data());
+        for (size_t i = 0; i < glyphs.size(); i++) {
+            const SkGlyph* glyph = glyphs[i];
+            const SkGlyph* expectedGlyph = expectedGlyphs[i];
+            REPORTER_ASSERT(reporter, glyph->rect() == expectedGlyph->rect());
+            REPORTER_ASSERT(reporter, glyph->maskFormat() == expectedGlyph->maskFormat());
+            REPORTER_ASSERT(reporter, (glyph->image() == nullptr) ==
+                                      (expectedGlyph->image() == nullptr));
+            if (glyph->image() != nullptr && expectedGlyph->image() != nullptr) {
+                REPORTER_ASSERT(reporter, memcmp(glyph->image(), expectedGlyph->image(),
+                                                 expectedGlyph->imageSize()) == 0,
+                                "%s", glyph->getPackedID().dump().c_str());
+            }
+        }
+        if (withPaths) {
+            strike->preparePaths(glyphIDs, glyphs.data());
+            expected->preparePaths(glyphIDs, expectedGlyphs.data());
+            for (size_t i = 0; i < glyphIDs.size(); i++) {
+                REPORTER_ASSERT(reporter, (glyphs[i]->path() == nullptr) ==
+                                          (expectedGlyphs[i]->path() == nullptr));
+                if (glyphs[i]->path() != nullptr && expectedGlyphs[i]->path() != nullptr) {
+                    REPORTER_ASSERT(reporter, *glyphs[i]->path() == *expectedGlyphs[i]->path());
+                }
+            }
+        }
+        // Everything was already there.
+        REPORTER_ASSERT(reporter, cache->getTotalMemoryUsed() == memoryUsed);
+    };
+
+    {
+        SkStrikeCache cache;
+        sk_sp<SkStrike> strike = cache.prerasterizeImages(strikeSpec, glyphIDs, executor.get());
+        strike->prerasterizePaths(glyphIDs, executor.get());
+        check(strike.get(), &cache, /*withPaths=*/true);
+    }
+
+    {
+        // Without an executor.
+        SkStrikeCache cache;
+        sk_sp<SkStrike> strike = cache.prerasterizeImages(strikeSpec, glyphIDs, nullptr);
+        check(strike.get(), &cache, /*withPaths=*/false);
+    }
+
+    {
+        // While other threads draw some of the same glyphs.
+        SkStrikeCache cache;
+        sk_sp<SkStrike> strike = strikeSpec.findOrCreateStrike(&cache);
+        auto readerExecutor = SkExecutor::MakeFIFOThreadPool(2);
+        SkTaskGroup readers(*readerExecutor);
+        readers.batch(2, [&](int reader) {
+            std::vector<const SkGlyph*> glyphs(packedIDs.size());
+            auto half = SkSpan(packedIDs).subspan(reader * packedIDs.size() / 2,
+                                                  packedIDs.size() / 2);
+            strike->prepareImages(half, glyphs.data());
+        });
+        strike->prerasterizeImages(packedIDs, executor.get());
+        readers.wait();
+        check(strike.get(), &cache, /*withPaths=*/false);
+    }
+}
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/core/SkBitmap.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkClipOp.h"
+#include "include/core/SkExecutor.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkPath.h"
+#include "include/core/SkPathTypes.h"
+#include "include/core/SkRRect.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRegion.h"
+#include "include/core/SkSurfaceProps.h"
+#include "src/base/SkArenaAlloc.h"
+#include "src/base/SkRandom.h"
+#include "src/core/SkBlitter.h"
+#include "src/core/SkRasterClip.h"
+#include "src/core/SkScan.h"
+#include "tests/Test.h"
+#include "tools/ToolUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+extern bool gSkUseSparseStripPathFill;
+
+static constexpr int kW = 300, kH = 200;
+
+static std::vector<SkPath> test_paths() {
+    std::vector<SkPath> paths;
+
+    paths.push_back(SkPath::Circle(150, 100, 70.3f));
+    paths.push_back(SkPath::RRect(SkRect::MakeLTRB(-20.5f, 10.25f, 180.75f, 230), 40, 25));
+
+    // A self-intersecting star, which differs between winding and even-odd.
+    SkPath star;
+    for (int i = 0; i < 5; ++i) {
+        float a = i * 4 * SK_ScalarPI / 5;
+        SkPoint p = {150 + 90 * std::sin(a), 100 - 90 * std::cos(a)};
+        i == 0 ? star.moveTo(p) : star.lineTo(p);
+    }
+    star.close();
+    paths.push_back(star);
+    star.setFillType(SkPathFillType::kEvenOdd);
+    paths.push_back(star);
+
+    // Lots of overlapping curves.
+    SkRandom rand(3);
+    SkPath curves;
+    curves.moveTo(rand.nextF() * kW, rand.nextF() * kH);
+    for (int i = 0; i < 40; ++i) {
+        curves.cubicTo(rand.nextF() * kW, rand.nextF() * kH,
+                       rand.nextF() * kW, rand.nextF() * kH,
+                       rand.nextF() * kW, rand.nextF() * kH);
+        curves.conicTo(rand.nextF() * kW, rand.nextF() * kH,
+                       rand.nextF() * kW, rand.nextF() * kH, 0.7f);
+    }
+    paths.push_back(curves);
+    curves.setFillType(SkPathFillType::kEvenOdd);
+    paths.push_back(curves);
+
+    SkPath inverse = SkPath::Oval(SkRect::MakeLTRB(40.5f, 30, 250, 170.5f));
+    inverse.setFillType(SkPathFillType::kInverseWinding);
+    paths.push_back(inverse);
+
+    return paths;
+}
+
+enum class Filler { kAAA, kSparseStrip };
+
+static SkBitmap fill(const SkPath& path, const SkRasterClip& clip, Filler filler,
+                     SkExecutor* executor = nullptr) {
+    SkBitmap bm;
+    bm.allocPixels(SkImageInfo::MakeA8(kW, kH));
+    bm.eraseColor(SK_ColorTRANSPARENT);
+
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    SkSTArenaAlloc<2048> alloc;
+    SkBlitter* blitter = SkBlitter::Choose(bm.pixmap(), SkMatrix::I(), paint, &alloc,
+                                           /*drawCoverage=*/false, /*clipShader=*/nullptr,
+                                           SkSurfaceProps());
+    if (filler == Filler::kAAA) {
+        SkScan::AntiFillPath(path, clip, blitter);
+    } else {
+        SkScan::SparseStripFillPath(path, clip, blitter, executor);
+    }
+    return bm;
+}
+
+// Coverage from counting samples of a 16x16 grid in each pixel.
+static SkBitmap supersampled(const SkPath& path) {
+    constexpr int kScale = 16;
+    SkBitmap big;
+    big.allocPixels(SkImageInfo::MakeA8(kW * kScale, kH * kScale));
+    big.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(big);
+    canvas.scale(kScale, kScale);
+    canvas.drawPath(path, SkPaint());
+
+    SkBitmap bm;
+    bm.allocPixels(SkImageInfo::MakeA8(kW, kH));
+    for (int y = 0; y < kH; ++y) {
+        for (int x = 0; x < kW; ++x) {
+            int samples = 0;
+            for (int j = 0; j < kScale; ++j) {
+                for (int i = 0; i < kScale; ++i) {
+                    samples += *big.getAddr8(x * kScale + i, y * kScale + j) ? 1 : 0;
+                }
+            }
+            *bm.getAddr8(x, y) = (samples * 255 + kScale * kScale / 2) / (kScale * kScale);
+        }
+    }
+    return bm;
+}
+
+// How far a fill is from the supersampled coverage, in total and in how many pixels are far off.
+struct Error {
+    int64_t fTotal  = 0;
+    int     fFarOff = 0;
+};
+
+static Error error(const SkBitmap& expected, const SkBitmap& actual) {
+    Error err;
+    for (int y = 0; y < kH; ++y) {
+        for (int x = 0; x < kW; ++x) {
+            int diff = std::abs(*expected.getAddr8(x, y) - *actual.getAddr8(x, y));
+            err.fTotal += diff;
+            err.fFarOff += diff > 16 ? 1 : 0;
+        }
+    }
+    return err;
+}
+
+DEF_TEST(SparseStrip_MatchesSupersampled, r) {
+    const SkRasterClip clip(SkIRect::MakeWH(kW, kH));
+    std::vector<SkPath> paths = test_paths();
+    for (int i = 0; i < (int)paths.size(); ++i) {
+        const SkBitmap expected = supersampled(paths[i]);
+        const Error aaa   = error(expected, fill(paths[i], clip, Filler::kAAA)),
+                    strip = error(expected, fill(paths[i], clip, Filler::kSparseStrip));
+        // Where edges cross inside a pixel, the winding of the pieces is averaged before the
+        // fill rule is applied, so those pixels can be far off. Analytic AA approximates there
+        // too; we should do no worse overall.
+        if (strip.fTotal > std::max(aaa.fTotal, (int64_t)kW * kH / 8) ||
+            strip.fFarOff > std::max(aaa.fFarOff, kW * kH / 1000)) {
+            ERRORF(r, "path %d: total difference %lld vs. %lld for AAA, "
+                      "%d vs. %d pixels off by more than 16",
+                   i, (long long)strip.fTotal, (long long)aaa.fTotal, strip.fFarOff, aaa.fFarOff);
+        }
+    }
+}
+
+DEF_TEST(SparseStrip_Clipped, r) {
+    const SkRasterClip noClip(SkIRect::MakeWH(kW, kH));
+
+    SkRegion rgn;
+    rgn.op(SkIRect::MakeLTRB(0, 0, 120, 200), SkRegion::kUnion_Op);
+    rgn.op(SkIRect::MakeLTRB(100, 50, 300, 150), SkRegion::kUnion_Op);
+    rgn.op(SkIRect::MakeLTRB(37, 21, 263, 178), SkRegion::kIntersect_Op);
+    SkRasterClip complexClip(SkIRect::MakeWH(kW, kH));
+    complexClip.op(rgn, SkClipOp::kIntersect);
+
+    const SkRect aaClipRect = SkRect::MakeLTRB(10.5f, 5.5f, 280.5f, 190.5f);
+    SkRasterClip aaClip(SkIRect::MakeWH(kW, kH));
+    aaClip.op(SkRRect::MakeRectXY(aaClipRect, 30, 30), SkMatrix::I(), SkClipOp::kIntersect,
+              /*doAA=*/true);
+
+    for (const SkPath& path : test_paths()) {
+        const SkBitmap unclipped = fill(path, noClip, Filler::kSparseStrip);
+        const SkBitmap clipped   = fill(path, complexClip, Filler::kSparseStrip);
+        const SkBitmap aaClipped = fill(path, aaClip, Filler::kSparseStrip);
+        for (int y = 0; y < kH; ++y) {
+            for (int x = 0; x < kW; ++x) {
+                // Clipping moves lines around, which can change the last bit of a sum.
+                const int expected = rgn.contains(x, y) ? *unclipped.getAddr8(x, y) : 0;
+                if (std::abs(*clipped.getAddr8(x, y) - expected) > 1) {
+                    ERRORF(r, "complex clip (%d, %d): expected %d, got %d",
+                           x, y, expected, *clipped.getAddr8(x, y));
+                    return;
+                }
+                // The AA clip can only remove coverage, and only near its edges.
+                const SkRect pixel = SkRect::MakeXYWH(x, y, 1, 1);
+                const bool inside  = aaClipRect.makeInset(30, 30).contains(pixel),
+                           outside = !aaClipRect.intersects(pixel);
+                const int aa = *aaClipped.getAddr8(x, y), full = *unclipped.getAddr8(x, y);
+                if (aa > full + 1 || (inside && std::abs(aa - full) > 1) || (outside && aa)) {
+                    ERRORF(r, "aa clip (%d, %d): unclipped %d, got %d", x, y, full, aa);
+                    return;
+                }
+            }
+        }
+    }
+}
+
+DEF_TEST(SparseStrip_ThreadedMatchesSerial, r) {
+    std::unique_ptr<SkExecutor> executor = SkExecutor::MakeFIFOThreadPool(4);
+    SkRasterClip clip(SkIRect::MakeWH(kW, kH));
+    for (const SkPath& path : test_paths()) {
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(fill(path, clip, Filler::kSparseStrip),
+                                                   fill(path, clip, Filler::kSparseStrip,
+                                                        executor.get())));
+    }
+}
+
+DEF_TEST(SparseStrip_SelectedBySkDraw, r) {
+    const SkPath path = test_paths()[2];
+    const SkRasterClip clip(SkIRect::MakeWH(kW, kH));
+    SkPaint paint;
+    paint.setAntiAlias(true);
+
+    const bool wasSparseStrip = gSkUseSparseStripPathFill;
+    for (bool sparseStrip : {false, true}) {
+        SkBitmap bm;
+        bm.allocPixels(SkImageInfo::MakeA8(kW, kH));
+        bm.eraseColor(SK_ColorTRANSPARENT);
+        gSkUseSparseStripPathFill = sparseStrip;
+        SkCanvas(bm).drawPath(path, paint);
+
+        const SkBitmap expected =
+                fill(path, clip, sparseStrip ? Filler::kSparseStrip : Filler::kAAA);
+        REPORTER_ASSERT(r, ToolUtils::equal_pixels(bm, expected));
+    }
+    gSkUseSparseStripPathFill = wasSparseStrip;
+}
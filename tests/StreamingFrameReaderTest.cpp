@@ -0,0 +1,340 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/codec/SkCodec.h"
+#include "include/codec/SkCodecAnimation.h"
+#include "include/codec/SkStreamingFrameReader.h"
+#include "include/core/SkAlphaType.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkBlendMode.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkColor.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImage.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkStream.h"
+#include "tests/Test.h"
+#include "tools/Resources.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// A stream that can't seek or rewind, and has only received the bytes up to a limit, as if they
+// were arriving over a network.
+class ArrivingStream : public SkStream {
+public:
+    ArrivingStream(sk_sp<SkData> data) : fData(std::move(data)) {}
+
+    void receive(size_t bytes) { fLimit = std::min(fData->size(), fLimit + bytes); }
+    bool isAllDataReceived() const { return fLimit == fData->size(); }
+    size_t received() const { return fLimit; }
+
+    size_t read(void* buffer, size_t size) override {
+        size = std::min(size, fLimit - fPosition);
+        memcpy(buffer, fData->bytes() + fPosition, size);
+        fPosition += size;
+        return size;
+    }
+
+    bool isAtEnd() const override { return fPosition == fData->size(); }
+
+private:
+    const sk_sp<SkData> fData;
+    size_t              fLimit = 0;
+    size_t              fPosition = 0;
+};
+
+// Reads the whole of |data|, |step| bytes at a time.
+std::unique_ptr<SkStreamingFrameReader> read_all(skiatest::Reporter* r, const char* path,
+                                                 sk_sp<SkData> data, size_t step,
+                                                 bool keepFrameData) {
+    auto stream = std::make_unique<ArrivingStream>(std::move(data));
+    ArrivingStream* arriving = stream.get();
+    SkStreamingFrameReader::Options options;
+    options.fKeepFrameData = keepFrameData;
+    std::unique_ptr<SkStreamingFrameReader> reader =
+            SkStreamingFrameReader::Make(std::move(stream), options);
+
+    SkCodec::Result result;
+    int frameCount = 0;
+    while ((result = reader->read()) == SkCodec::kIncompleteInput &&
+           !arriving->isAllDataReceived()) {
+        // Frames are reported as their headers arrive, before the rest of the image.
+        REPORTER_ASSERT(r, reader->getFrameCount() >= frameCount, "%s", path);
+        frameCount = reader->getFrameCount();
+        for (int i = 0; i + 1 < frameCount; ++i) {
+            SkCodec::FrameInfo info;
+            REPORTER_ASSERT(r, reader->getFrameInfo(i, &info) && info.fFullyReceived,
+                            "%s: frame %d of %d with %zu bytes", path, i, frameCount,
+                            arriving->received());
+        }
+        arriving->receive(step);
+    }
+    REPORTER_ASSERT(r, result == SkCodec::kSuccess, "%s: result %d", path, result);
+    return reader;
+}
+
+// Decodes the standalone images of a reader's frames, and draws each onto the frames before it.
+std::vector<SkBitmap> composite_frames(skiatest::Reporter* r, const char* path,
+                                       SkStreamingFrameReader* reader) {
+    std::vector<SkBitmap> frames;
+    SkBitmap canvasBitmap, restoreBitmap;
+    canvasBitmap.allocN32Pixels(reader->dimensions().width(), reader->dimensions().height());
+    canvasBitmap.eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(canvasBitmap);
+
+    for (int i = 0; i < reader->getFrameCount(); ++i) {
+        SkCodec::FrameInfo info;
+        reader->getFrameInfo(i, &info);
+        if (info.fDisposalMethod == SkCodecAnimation::DisposalMethod::kRestorePrevious) {
+            restoreBitmap.allocPixels(canvasBitmap.info());
+            canvasBitmap.readPixels(restoreBitmap.pixmap());
+        }
+
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(reader->takeFrameData(i));
+        if (!codec) {
+            // This format's decoder isn't built.
+            return {};
+        }
+        REPORTER_ASSERT(r, codec->getFrameCount() == 1, "%s: frame %d", path, i);
+        SkBitmap frame;
+        frame.allocPixels(codec->getInfo().makeColorType(kN32_SkColorType)
+                                          .makeAlphaType(kPremul_SkAlphaType)
+                                          .makeColorSpace(nullptr));
+        REPORTER_ASSERT(r, codec->getPixels(frame.pixmap()) == SkCodec::kSuccess,
+                        "%s: frame %d", path, i);
+
+        SkPaint paint;
+        paint.setBlendMode(info.fBlend == SkCodecAnimation::Blend::kSrc ? SkBlendMode::kSrc
+                                                                         : SkBlendMode::kSrcOver);
+        canvas.save();
+        canvas.clipIRect(info.fFrameRect);
+        canvas.drawImage(frame.asImage(), info.fFrameRect.x(), info.fFrameRect.y(),
+                         SkSamplingOptions(), &paint);
+        canvas.restore();
+
+        frames.emplace_back();
+        frames.back().allocPixels(canvasBitmap.info());
+        canvasBitmap.readPixels(frames.back().pixmap());
+
+        switch (info.fDisposalMethod) {
+            case SkCodecAnimation::DisposalMethod::kKeep:
+                break;
+            case SkCodecAnimation::DisposalMethod::kRestoreBGColor:
+                canvas.save();
+                canvas.clipIRect(info.fFrameRect);
+                canvas.clear(SK_ColorTRANSPARENT);
+                canvas.restore();
+                break;
+            case SkCodecAnimation::DisposalMethod::kRestorePrevious:
+                canvas.writePixels(restoreBitmap, 0, 0);
+                break;
+        }
+    }
+    return frames;
+}
+
+bool close_pixels(const SkBitmap& a, const SkBitmap& b, int tolerance) {
+    for (int y = 0; y < a.height(); ++y) {
+        const uint8_t* rowA = static_cast<const uint8_t*>(a.getAddr(0, y));
+        const uint8_t* rowB = static_cast<const uint8_t*>(b.getAddr(0, y));
+        for (size_t x = 0; x < a.info().minRowBytes(); ++x) {
+            if (std::abs(rowA[x] - rowB[x]) > tolerance) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+// The frames read from a stream as it arrives match those of an SkCodec, which has all of it.
+DEF_TEST(Codec_StreamingFrameReader, r) {
+    static const struct {
+        const char* fPath;
+        int         fFrameCount;
+    } gRecs[] = {
+        {"images/required.gif",                                        7},
+        {"images/alphabetAnim.gif",                                   13},
+        {"images/randPixelsAnim.gif",                                 13},
+        {"images/randPixelsAnim2.gif",                                 4},
+        {"images/test640x479.gif",                                     4},
+        {"images/colorTables.gif",                                     2},
+        {"images/box.gif",                                             1},
+        {"images/stoplight.webp",                                      3},
+        {"images/blendBG.webp",                                        7},
+        {"images/required.webp",                                       7},
+        {"images/yellow_rose.webp",                                    1},
+        {"images/webp-color-profile-lossy-alpha.webp",                 1},
+        {"images/mandrill_512.png",                                    1},
+        {"images/arrow.png",                                           1},
+        {"images/apng-test-suite--dispose-ops--none-basic.png",        3},
+        {"images/apng-test-suite--blend-ops--over-repeatedly.png",   128},
+    };
+
+    for (const auto& rec : gRecs) {
+        sk_sp<SkData> data = GetResourceAsData(rec.fPath);
+        if (!data) {
+            continue;
+        }
+        for (size_t step : {(size_t)7, (size_t)97, data->size()}) {
+            std::unique_ptr<SkStreamingFrameReader> reader = read_all(r, rec.fPath, data, step,
+                                                                      /*keepFrameData=*/true);
+            REPORTER_ASSERT(r, reader->hasHeader());
+            REPORTER_ASSERT(r, reader->getFrameCount() == rec.fFrameCount, "%s: %d frames",
+                            rec.fPath, reader->getFrameCount());
+
+            // SkPngCodec reads an APNG as a still image.
+            std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(data);
+            if (!codec || codec->getFrameCount() != rec.fFrameCount) {
+                continue;
+            }
+            REPORTER_ASSERT(r, reader->getEncodedFormat() == codec->getEncodedFormat());
+            REPORTER_ASSERT(r, reader->dimensions() == codec->dimensions());
+            REPORTER_ASSERT(r, reader->getRepetitionCount() == codec->getRepetitionCount(),
+                            "%s: repetition count %d", rec.fPath, reader->getRepetitionCount());
+
+            for (int i = 0; rec.fFrameCount > 1 && i < rec.fFrameCount; ++i) {
+                SkCodec::FrameInfo expected, actual;
+                REPORTER_ASSERT(r, codec->getFrameInfo(i, &expected));
+                REPORTER_ASSERT(r, reader->getFrameInfo(i, &actual));
+                REPORTER_ASSERT(r, expected.fRequiredFrame == actual.fRequiredFrame &&
+                                   expected.fDuration == actual.fDuration &&
+                                   expected.fFullyReceived == actual.fFullyReceived &&
+                                   expected.fAlphaType == actual.fAlphaType &&
+                                   expected.fHasAlphaWithinBounds ==
+                                           actual.fHasAlphaWithinBounds &&
+                                   expected.fDisposalMethod == actual.fDisposalMethod &&
+                                   expected.fBlend == actual.fBlend &&
+                                   expected.fFrameRect == actual.fFrameRect,
+                                "%s: frame %d", rec.fPath, i);
+            }
+            if (step != 97) {
+                continue;
+            }
+
+            // Each frame's standalone image, composited, matches the frame SkCodec decodes.
+            std::vector<SkBitmap> frames = composite_frames(r, rec.fPath, reader.get());
+            for (size_t i = 0; i < frames.size(); ++i) {
+                SkBitmap expected;
+                expected.allocPixels(frames[i].info());
+                SkCodec::Options options;
+                options.fFrameIndex = i;
+                REPORTER_ASSERT(r, codec->getPixels(expected.pixmap(), &options) ==
+                                   SkCodec::kSuccess);
+                REPORTER_ASSERT(r, close_pixels(expected, frames[i], 2), "%s: frame %zu",
+                                rec.fPath, i);
+            }
+        }
+    }
+}
+
+// The last frames of these APNGs, composited from their standalone images, are green.
+DEF_TEST(Codec_StreamingFrameReader_apng, r) {
+    static const struct {
+        const char* fPath;
+        int         fRepetitionCount;
+        bool        fEndsGreen;
+    } gRecs[] = {
+        {"images/apng-test-suite--basic--ignoring-default-image.png",
+         SkCodec::kRepetitionCountInfinite, true},
+        {"images/apng-test-suite--dispose-ops--none-basic.png",              0, true},
+        {"images/apng-test-suite--blend-ops--source-on-solid.png",           0, true},
+        {"images/apng-test-suite--blend-ops--over-on-solid-and-transparent.png", 0, true},
+        {"images/apng-test-suite--blend-ops--over-repeatedly.png",           0, true},
+        {"images/apng-test-suite--regions--dispose-op-none.png",             0, true},
+        {"images/apng-test-suite--num-plays--0.png",
+         SkCodec::kRepetitionCountInfinite, false},
+        {"images/apng-test-suite--num-plays--2.png",                         1, false},
+    };
+    for (const auto& rec : gRecs) {
+        sk_sp<SkData> data = GetResourceAsData(rec.fPath);
+        if (!data) {
+            continue;
+        }
+        std::unique_ptr<SkStreamingFrameReader> reader = read_all(r, rec.fPath, data, 61,
+                                                                  /*keepFrameData=*/true);
+        REPORTER_ASSERT(r, reader->getRepetitionCount() == rec.fRepetitionCount, "%s",
+                        rec.fPath);
+        if (!rec.fEndsGreen) {
+            continue;
+        }
+        std::vector<SkBitmap> frames = composite_frames(r, rec.fPath, reader.get());
+        if (frames.empty()) {
+            continue;
+        }
+        const SkBitmap& last = frames.back();
+        for (SkIPoint p : {SkIPoint{0, 0}, SkIPoint{last.width() / 2, last.height() / 2},
+                           SkIPoint{last.width() - 1, last.height() - 1}}) {
+            REPORTER_ASSERT(r, last.getColor(p.x(), p.y()) == SK_ColorGREEN,
+                            "%s: 0x%08x at %d, %d", rec.fPath, last.getColor(p.x(), p.y()),
+                            p.x(), p.y());
+        }
+        // Taking a frame's data forgets it.
+        REPORTER_ASSERT(r, !reader->takeFrameData(0));
+    }
+}
+
+// A PLTE chunk may come after the first frame's fcTL, as long as it precedes the image data. The
+// first frame's standalone image still needs it.
+DEF_TEST(Codec_StreamingFrameReader_apngPaletteAfterControl, r) {
+    static constexpr char kPath[] = "images/apng-plte-after-fctl.png";
+    sk_sp<SkData> data = GetResourceAsData(kPath);
+    if (!data) {
+        return;
+    }
+    for (size_t step : {(size_t)7, data->size()}) {
+        std::unique_ptr<SkStreamingFrameReader> reader = read_all(r, kPath, data, step,
+                                                                  /*keepFrameData=*/true);
+        REPORTER_ASSERT(r, reader->getFrameCount() == 2, "%d frames", reader->getFrameCount());
+        std::vector<SkBitmap> frames = composite_frames(r, kPath, reader.get());
+        if (frames.size() != 2) {
+            continue;
+        }
+        REPORTER_ASSERT(r, frames[0].getColor(8, 8) == SK_ColorRED,
+                        "0x%08x", frames[0].getColor(8, 8));
+        REPORTER_ASSERT(r, frames[1].getColor(8, 8) == SK_ColorGREEN,
+                        "0x%08x", frames[1].getColor(8, 8));
+    }
+}
+
+DEF_TEST(Codec_StreamingFrameReader_partial, r) {
+    sk_sp<SkData> data = GetResourceAsData("images/alphabetAnim.gif");
+    if (!data) {
+        return;
+    }
+    // Without the last half of the image, the first frames are still read.
+    auto stream = std::make_unique<ArrivingStream>(data);
+    stream->receive(data->size() / 2);
+    std::unique_ptr<SkStreamingFrameReader> reader =
+            SkStreamingFrameReader::Make(std::move(stream));
+    REPORTER_ASSERT(r, reader->read() == SkCodec::kIncompleteInput);
+    REPORTER_ASSERT(r, reader->hasHeader() && reader->dimensions() == SkISize::Make(100, 100));
+    const int frameCount = reader->getFrameCount();
+    REPORTER_ASSERT(r, frameCount > 1 && frameCount < 13, "%d frames", frameCount);
+    SkCodec::FrameInfo info;
+    REPORTER_ASSERT(r, reader->getFrameInfo(0, &info) && info.fFullyReceived);
+    REPORTER_ASSERT(r, !reader->getFrameInfo(frameCount, &info));
+    // Frame data is only kept if asked for.
+    REPORTER_ASSERT(r, !reader->takeFrameData(0));
+
+    // A format that it can't read.
+    reader = SkStreamingFrameReader::Make(
+            SkMemoryStream::Make(GetResourceAsData("images/mandrill_512_q075.jpg")));
+    REPORTER_ASSERT(r, reader->read() == SkCodec::kUnimplemented);
+    REPORTER_ASSERT(r, reader->read() == SkCodec::kUnimplemented);
+    REPORTER_ASSERT(r, reader->getFrameCount() == 0);
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "include/codec/SkAndroidCodec.h"
+#include "include/codec/SkCodec.h"
+#include "include/codec/SkEncodedImageFormat.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkData.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSize.h"
+#include "include/core/SkStream.h"
+#include "tests/Test.h"
+#include "tools/Resources.h"
+#include "tools/TranscodeUtils.h"
+
+#include <cstring>
+#include <memory>
+
+// Decodes 'data' as SkAndroidCodec would with this sample size, to the info Transcode() uses.
+static bool decode(sk_sp<SkData> data, int sampleSize, SkBitmap* dst) {
+    std::unique_ptr<SkAndroidCodec> codec = SkAndroidCodec::MakeFromData(std::move(data));
+    if (!codec) {
+        return false;
+    }
+    const SkImageInfo& info = codec->getInfo();
+    dst->allocPixels(SkImageInfo::Make(
+            codec->getSampledDimensions(sampleSize),
+            kRGBA_8888_SkColorType,
+            info.isOpaque() ? kOpaque_SkAlphaType : kUnpremul_SkAlphaType,
+            info.refColorSpace()));
+    SkAndroidCodec::AndroidOptions options;
+    options.fSampleSize = sampleSize;
+    return codec->getAndroidPixels(dst->info(), dst->getPixels(), dst->rowBytes(), &options) ==
+           SkCodec::kSuccess;
+}
+
+static bool same_pixels(const SkBitmap& a, const SkBitmap& b) {
+    if (a.dimensions() != b.dimensions()) {
+        return false;
+    }
+    for (int y = 0; y < a.height(); ++y) {
+        if (memcmp(a.getAddr(0, y), b.getAddr(0, y), a.info().minRowBytes())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Streaming into PNG, which is lossless, gives the pixels SkAndroidCodec decodes.
+DEF_TEST(Transcode_MatchesAndroidCodec, r) {
+    const struct {
+        const char* fPath;
+        bool        fStreamed;
+    } sources[] = {
+        {"images/mandrill_512_q075.jpg", true},  // native scaling, and sampling what's left
+        {"images/color_wheel.png",       false},  // decoded incrementally, not by scanline
+        {"images/randPixels.bmp",        false},  // bottom-up
+    };
+    for (const auto& source : sources) {
+        sk_sp<SkData> data = GetResourceAsData(source.fPath);
+        if (!data) {
+            continue;
+        }
+        for (int sampleSize : {1, 2, 3, 6}) {
+            ToolUtils::TranscodeOptions options;
+            options.fSampleSize = sampleSize;
+            options.fStripRows = 7;
+            ToolUtils::TranscodeStats stats;
+            SkDynamicMemoryWStream png;
+            if (!ToolUtils::Transcode(SkCodec::MakeFromData(data), &png, options, &stats)) {
+                ERRORF(r, "%s, sample size %d: transcoding failed", source.fPath, sampleSize);
+                continue;
+            }
+            REPORTER_ASSERT(r, stats.fStreamed == source.fStreamed, "%s", source.fPath);
+
+            SkBitmap expected, actual;
+            REPORTER_ASSERT(r, decode(data, sampleSize, &expected));
+            REPORTER_ASSERT(r, decode(png.detachAsData(), 1, &actual));
+            REPORTER_ASSERT(r, stats.fDimensions == expected.dimensions());
+            REPORTER_ASSERT(r, same_pixels(expected, actual),
+                            "%s, sample size %d", source.fPath, sampleSize);
+        }
+    }
+}
+
+DEF_TEST(Transcode_Formats, r) {
+    sk_sp<SkData> data = GetResourceAsData("images/mandrill_512_q075.jpg");
+    if (!data) {
+        return;
+    }
+    for (SkEncodedImageFormat format : {SkEncodedImageFormat::kJPEG,
+                                        SkEncodedImageFormat::kWEBP}) {
+        ToolUtils::TranscodeOptions options;
+        options.fFormat = format;
+        options.fSampleSize = 3;
+        ToolUtils::TranscodeStats stats;
+        SkDynamicMemoryWStream dst;
+        REPORTER_ASSERT(r, ToolUtils::Transcode(SkCodec::MakeFromData(data), &dst, options,
+                                                &stats));
+        // Only JPEG can be encoded by rows.
+        REPORTER_ASSERT(r, stats.fStreamed == (format == SkEncodedImageFormat::kJPEG));
+        std::unique_ptr<SkCodec> codec = SkCodec::MakeFromData(dst.detachAsData());
+        REPORTER_ASSERT(r, codec && codec->getEncodedFormat() == format &&
+                           codec->dimensions() == SkISize::Make(170, 170));
+    }
+}
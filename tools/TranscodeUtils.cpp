@@ -0,0 +1,179 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "tools/TranscodeUtils.h"
+
+#include "include/codec/SkAndroidCodec.h"
+#include "include/codec/SkCodec.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkImageInfo.h"
+#include "include/core/SkPixmap.h"
+#include "include/core/SkRect.h"
+#include "include/core/SkStream.h"
+#include "include/encode/SkEncoder.h"
+#include "include/encode/SkJpegEncoder.h"
+#include "include/encode/SkPngEncoder.h"
+#include "include/encode/SkWebpEncoder.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace ToolUtils {
+
+namespace {
+
+// As in SkSampledCodec: a dimension sampled down to at least one pixel, keeping every
+// sampleSize'th pixel from the middle of the first sampleSize.
+int sampled_dimension(int dimension, int sampleSize) {
+    return std::max(1, dimension / sampleSize);
+}
+
+int sample_start(int sampleSize) { return sampleSize / 2; }
+
+// The dimensions the codec decodes to before sampling by the returned sample size, like
+// SkSampledCodec::accountForNativeScaling().
+SkISize native_dimensions(SkCodec* codec, int* sampleSize) {
+    if (codec->getEncodedFormat() == SkEncodedImageFormat::kJPEG) {
+        for (int native : {8, 4, 2}) {
+            if (*sampleSize % native == 0) {
+                *sampleSize /= native;
+                return codec->getScaledDimensions(1.0f / native);
+            }
+        }
+    }
+    return codec->dimensions();
+}
+
+std::unique_ptr<SkEncoder> make_encoder(SkWStream* dst,
+                                        const SkPixmap& src,
+                                        const TranscodeOptions& options) {
+    switch (options.fFormat) {
+        case SkEncodedImageFormat::kPNG:
+            return SkPngEncoder::Make(dst, src, {});
+        case SkEncodedImageFormat::kJPEG: {
+            SkJpegEncoder::Options jpegOptions;
+            jpegOptions.fQuality = options.fQuality;
+            return SkJpegEncoder::Make(dst, src, jpegOptions);
+        }
+        default:
+            return nullptr;
+    }
+}
+
+bool encode(SkWStream* dst, const SkPixmap& src, const TranscodeOptions& options) {
+    if (options.fFormat == SkEncodedImageFormat::kWEBP) {
+        SkWebpEncoder::Options webpOptions;
+        webpOptions.fQuality = options.fQuality;
+        return SkWebpEncoder::Encode(dst, src, webpOptions);
+    }
+    std::unique_ptr<SkEncoder> encoder = make_encoder(dst, src, options);
+    return encoder && encoder->encodeRows(src.height());
+}
+
+}  // namespace
+
+bool Transcode(std::unique_ptr<SkCodec> codec,
+               SkWStream* dst,
+               const TranscodeOptions& options,
+               TranscodeStats* stats) {
+    if (!codec || options.fSampleSize < 1 || options.fStripRows < 1) {
+        return false;
+    }
+    TranscodeStats unused;
+    stats = stats ? stats : &unused;
+
+    int sampleSize = options.fSampleSize;
+    const SkISize nativeSize = native_dimensions(codec.get(), &sampleSize);
+    const SkISize size = {sampled_dimension(nativeSize.width(), sampleSize),
+                          sampled_dimension(nativeSize.height(), sampleSize)};
+    const SkImageInfo& srcInfo = codec->getInfo();
+    const SkImageInfo info = SkImageInfo::Make(
+            size,
+            kRGBA_8888_SkColorType,
+            srcInfo.isOpaque() ? kOpaque_SkAlphaType : kUnpremul_SkAlphaType,
+            options.fColorSpace ? options.fColorSpace : srcInfo.refColorSpace());
+    stats->fDimensions = size;
+
+    // Decode a scanline at a time into a strip of rows, sampling them as we go, and encode each
+    // strip as it fills.
+    const SkImageInfo nativeInfo = info.makeDimensions(nativeSize);
+    if (options.fFormat != SkEncodedImageFormat::kWEBP &&
+        codec->startScanlineDecode(nativeInfo) == SkCodec::kSuccess &&
+        codec->getScanlineOrder() == SkCodec::kTopDown_SkScanlineOrder) {
+        // Like SkSampledCodec::sampledDecode(), which divides what's left after native scaling.
+        const int sampleX = nativeSize.width() / size.width(),
+                  sampleY = nativeSize.height() / size.height();
+        SkBitmap strip, scanline;
+        strip.allocPixels(info.makeWH(size.width(), std::min(options.fStripRows,
+                                                              size.height())));
+        if (sampleX > 1) {
+            scanline.allocPixels(nativeInfo.makeWH(nativeSize.width(), 1));
+        }
+        stats->fStreamed = true;
+        stats->fPixelBytes = strip.computeByteSize() + scanline.computeByteSize();
+
+        // The encoder only reads the rows passed to encodeRows(), but needs the image's info.
+        const SkPixmap image{info, strip.getPixels(), strip.rowBytes()};
+        std::unique_ptr<SkEncoder> encoder = make_encoder(dst, image, options);
+        if (!encoder) {
+            return false;
+        }
+        int nativeY = 0;
+        for (int top = 0; top < size.height(); top += strip.height()) {
+            const int rows = std::min(strip.height(), size.height() - top);
+            for (int y = 0; y < rows; ++y) {
+                // Incomplete input is filled in by the codec, so encode what there is.
+                const int wantY = sample_start(sampleY) + (top + y) * sampleY;
+                (void)codec->skipScanlines(wantY - nativeY);
+                if (sampleX > 1) {
+                    (void)codec->getScanlines(scanline.getPixels(), 1, scanline.rowBytes());
+                    const uint32_t* src = scanline.getAddr32(sample_start(sampleX), 0);
+                    uint32_t* dstRow = strip.getAddr32(0, y);
+                    for (int x = 0; x < size.width(); ++x) {
+                        dstRow[x] = src[x * sampleX];
+                    }
+                } else {
+                    (void)codec->getScanlines(strip.getAddr(0, y), 1, strip.rowBytes());
+                }
+                nativeY = wantY + 1;
+            }
+            SkPixmap stripRows;
+            if (!strip.pixmap().extractSubset(&stripRows, SkIRect::MakeWH(size.width(), rows)) ||
+                !encoder->encodeRows(stripRows)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Otherwise decode the whole image, which SkAndroidCodec samples the same way. (Codecs that
+    // scale natively by any amount, like WebP's, may round the dimensions differently.)
+    std::unique_ptr<SkAndroidCodec> androidCodec = SkAndroidCodec::MakeFromCodec(std::move(codec));
+    if (!androidCodec) {
+        return false;
+    }
+    const SkImageInfo sampledInfo =
+            info.makeDimensions(androidCodec->getSampledDimensions(options.fSampleSize));
+    SkBitmap bitmap;
+    if (!bitmap.tryAllocPixels(sampledInfo)) {
+        return false;
+    }
+    stats->fDimensions = sampledInfo.dimensions();
+    stats->fStreamed = false;
+    stats->fPixelBytes = bitmap.computeByteSize();
+    SkAndroidCodec::AndroidOptions androidOptions;
+    androidOptions.fSampleSize = options.fSampleSize;
+    const SkCodec::Result result = androidCodec->getAndroidPixels(
+            sampledInfo, bitmap.getPixels(), bitmap.rowBytes(), &androidOptions);
+    if (result != SkCodec::kSuccess && result != SkCodec::kIncompleteInput &&
+        result != SkCodec::kErrorInInput) {
+        return false;
+    }
+    return encode(dst, bitmap.pixmap(), options);
+}
+
+}  // namespace ToolUtils
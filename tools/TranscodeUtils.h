@@ -0,0 +1,52 @@
+/*
+ * Copyright 2026 Google LLC
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef TranscodeUtils_DEFINED
+#define TranscodeUtils_DEFINED
+
+#include "include/codec/SkEncodedImageFormat.h"
+#include "include/core/SkColorSpace.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkSize.h"
+
+#include <cstddef>
+#include <memory>
+
+class SkCodec;
+class SkWStream;
+
+namespace ToolUtils {
+
+struct TranscodeOptions {
+    SkEncodedImageFormat fFormat = SkEncodedImageFormat::kPNG;  // PNG, JPEG or WEBP
+    int                  fSampleSize = 1;   // downscales like SkAndroidCodec's sample size
+    sk_sp<SkColorSpace>  fColorSpace;       // of the output; nullptr keeps the source's
+    int                  fQuality = 90;     // for JPEG and WEBP
+    int                  fStripRows = 16;   // rows decoded and then encoded at a time
+};
+
+struct TranscodeStats {
+    SkISize fDimensions = {0, 0};
+    bool    fStreamed = false;   // whether the image was transcoded a strip at a time
+    size_t  fPixelBytes = 0;     // the most pixel memory held at once
+};
+
+// Decodes the codec's image and encodes it to dst. When the codec decodes scanlines from the top
+// down and the format can be encoded by rows (PNG and JPEG), only a strip of rows is in memory at
+// once. Otherwise the whole image is decoded first. Rows and columns are point sampled, after any
+// scaling the codec does natively, exactly as SkAndroidCodec samples them.
+//
+// Note that the JPEG encoder optimizes its Huffman tables, so libjpeg still buffers the image's
+// DCT coefficients (about 3 bytes per pixel) until the last row is encoded.
+bool Transcode(std::unique_ptr<SkCodec>,
+               SkWStream* dst,
+               const TranscodeOptions&,
+               TranscodeStats* = nullptr);
+
+}  // namespace ToolUtils
+
+#endif
@@ -5,6 +5,7 @@
 * found in the LICENSE file.
 */
 
+#include "include/codec/SkCodec.h"
 #include "include/core/SkCanvas.h"
 #include "include/core/SkData.h"
 #include "include/core/SkImage.h"
@@ -12,7 +13,13 @@
 #include "include/core/SkSurface.h"
 #include "include/encode/SkPngEncoder.h"
 #include "modules/skcms/skcms.h"
+#include "src/base/SkTime.h"
 #include "src/core/SkColorSpacePriv.h"
+#include "tools/ProcStats.h"
+#include "tools/TranscodeUtils.h"
+
+#include <cstdlib>
+#include <cstring>
 
 static void write_png(const char* path, sk_sp<SkImage> img) {
     sk_sp<SkData> png = SkPngEncoder::Encode(nullptr, img.get(), {});
@@ -20,11 +27,80 @@ static void write_png(const char* path, sk_sp<SkImage> img) {
     SkFILEWStream(path).write(png->data(), png->size());
 }
 
+static bool ends_with(const char* str, const char* suffix) {
+    const size_t length = strlen(str), suffixLength = strlen(suffix);
+    return length >= suffixLength && !strcmp(str + length - suffixLength, suffix);
+}
+
+// Streams the source image into the destination a strip of rows at a time, and reports the time
+// and peak memory it took.
+static int transcode(int argc, char** argv) {
+    if (argc < 2) {
+        SkDebugf("Usage: imgcvt --transcode <source> <destination .png, .jpg or .webp>"
+                 " [sample size] [destination profile]\n");
+        return 1;
+    }
+    const char* source_path = argv[0];
+    const char* dst_path = argv[1];
+
+    ToolUtils::TranscodeOptions options;
+    if (ends_with(dst_path, ".jpg") || ends_with(dst_path, ".jpeg")) {
+        options.fFormat = SkEncodedImageFormat::kJPEG;
+    } else if (ends_with(dst_path, ".webp")) {
+        options.fFormat = SkEncodedImageFormat::kWEBP;
+    }
+    if (argc > 2) {
+        options.fSampleSize = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        sk_sp<SkData> dst_blob = SkData::MakeFromFileName(argv[3]);
+        skcms_ICCProfile dst_profile;
+        if (!dst_blob || !skcms_Parse(dst_blob->data(), dst_blob->size(), &dst_profile) ||
+            !(options.fColorSpace = SkColorSpace::Make(dst_profile))) {
+            SkDebugf("Can't use %s as a destination profile.\n", argv[3]);
+            return 1;
+        }
+    }
+
+    std::unique_ptr<SkCodec> codec = SkCodec::MakeFromStream(SkStream::MakeFromFile(source_path));
+    if (!codec) {
+        SkDebugf("Couldn't decode %s.\n", source_path);
+        return 1;
+    }
+    const SkISize src_size = codec->dimensions();
+    SkFILEWStream dst(dst_path);
+    if (!dst.isValid()) {
+        SkDebugf("Couldn't open %s.\n", dst_path);
+        return 1;
+    }
+
+    ToolUtils::TranscodeStats stats;
+    const double start = SkTime::GetMSecs();
+    if (!ToolUtils::Transcode(std::move(codec), &dst, options, &stats)) {
+        SkDebugf("Transcoding %s failed.\n", source_path);
+        return 1;
+    }
+    dst.flush();
+    const double ms = SkTime::GetMSecs() - start;
+    SkDebugf("%dx%d -> %dx%d, %s: %.0f ms, %.1f Mpixels/s, %zu KB of pixels, peak RSS %d MB\n",
+             src_size.width(), src_size.height(),
+             stats.fDimensions.width(), stats.fDimensions.height(),
+             stats.fStreamed ? "streamed" : "decoded whole",
+             ms, src_size.area() / (ms * 1000), stats.fPixelBytes >> 10,
+             sk_tools::getMaxResidentSetSizeMB());
+    return 0;
+}
+
 int main(int argc, char** argv) {
+    if (argc > 1 && !strcmp(argv[1], "--transcode")) {
+        return transcode(argc - 2, argv + 2);
+    }
+
     const char* source_path = argc > 1 ? argv[1] : nullptr;
     if (!source_path) {
         SkDebugf("Please pass an image or profile to convert"
-                 " as the first argument to this program.\n");
+                 " as the first argument to this program,"
+                 " or --transcode to stream an image into another format.\n");
         return 1;
     }
 